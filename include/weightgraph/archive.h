@@ -0,0 +1,144 @@
+/**
+ * \file weightgraph/archive.h
+ *
+ * \brief Compact binary archives of weight logs.
+ *
+ * An archive holds the entries of a log in blocks of up to
+ * \ref WEIGHTGRAPH_ARCHIVE_BLOCK_ENTRIES entries.  Dates are stored as day
+ * numbers and weights in hundredths, and each block stores the differences
+ * between consecutive entries, bit-packed at the narrowest width that holds
+ * all of them.  A daily log of weights to a tenth takes a few bits an entry.
+ * An index of the blocks at the end of the archive allows a reader to seek
+ * to a date without decoding the blocks before it.
+ *
+ * Archives are a log format like any other: the parser recognizes them by
+ * their first bytes, or by a ".wga" extension.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#pragma once
+
+#include <weightgraph/session.h>
+#include <weightgraph/status_codes.h>
+#include <weightgraph/weightgraph.h>
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+extern "C" {
+# endif /*__cplusplus*/
+
+/**
+ * \brief The most entries in a block of an archive.
+ */
+#define WEIGHTGRAPH_ARCHIVE_BLOCK_ENTRIES 1024
+
+/**
+ * \brief A writer that encodes a log as an archive.
+ */
+typedef struct weightgraph_archive_writer weightgraph_archive_writer;
+
+/**
+ * \brief Create a writer that encodes a log as an archive.
+ *
+ * The archive is written to page 0 of the sink, a block at a time, so only
+ * the current block and the index are held in memory.
+ *
+ * \param writer        Pointer to receive the new writer.
+ * \param alloc         The allocator to use for this writer.
+ * \param sink          The sink to which the archive is written, which must
+ *                      outlive the writer.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_archive_writer_create(
+    weightgraph_archive_writer** writer, RCPR_SYM(allocator)* alloc,
+    const weightgraph_sink* sink);
+
+/**
+ * \brief Record the initial moving average of the log in the archive.
+ *
+ * \param writer        The writer.
+ * \param average       The initial moving average.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_archive_writer_average(
+    weightgraph_archive_writer* writer, double average);
+
+/**
+ * \brief Add an entry to the archive.
+ *
+ * Entries are kept in the order they are added.  Dates must all be written
+ * as "YYYY-MM-DD", with the same number of digits in each year, or all as
+ * "MM/DD".  Weights must be whole hundredths.
+ *
+ * \param writer        The writer.
+ * \param date          The date of the entry.
+ * \param weight        The weight of the entry.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_ARCHIVE_ENCODE if the entry can't be stored exactly.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_archive_writer_push(
+    weightgraph_archive_writer* writer, const char* date, double weight);
+
+/**
+ * \brief Write the last block and the index, and close the archive.
+ *
+ * \param writer        The writer.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_archive_writer_finish(weightgraph_archive_writer* writer);
+
+/**
+ * \brief Get the resource handle for an archive writer.
+ *
+ * \param writer        The writer.
+ *
+ * \returns the resource handle, which is used to release the writer.
+ */
+RCPR_SYM(resource)* weightgraph_archive_writer_resource_handle(
+    weightgraph_archive_writer* writer);
+
+/**
+ * \brief Decode an archive straight onto a session.
+ *
+ * The session is reset to the initial moving average of the archive, and
+ * each block is decoded and pushed onto it, without parsing dates or
+ * building an entry tree.  Entries before a given date are skipped by
+ * searching the block index, without decoding the blocks that hold them.
+ *
+ * \param session       The session.
+ * \param buffer        The archive.
+ * \param buffer_size   The size of the archive.
+ * \param since         The first date to push, in the style of the dates of
+ *                      the archive, or NULL to push every entry.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_OUT_OF_ORDER if the entries of the archive aren't in strictly
+ *        increasing date order, in which case it must be parsed instead.
+ *      - ERROR_ARCHIVE_FORMAT if the archive is malformed.
+ *      - ERROR_BAD_ARGUMENTS if the since date isn't in the style of the
+ *        archive.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_archive_load(
+    weightgraph_session* session, const uint8_t* buffer, size_t buffer_size,
+    const char* since);
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+}
+# endif /*__cplusplus*/
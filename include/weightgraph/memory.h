@@ -0,0 +1,123 @@
+/**
+ * \file weightgraph/memory.h
+ *
+ * \brief Accounting of the memory allocated by the weightgraph library.
+ *
+ * Every allocation made by the library, through the caller's allocator or
+ * otherwise, is attributed to a category.  Once enabled, the number of
+ * allocations, the bytes allocated, the bytes still live and the high-water
+ * mark of live bytes are counted for each category, and for the library as a
+ * whole.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+extern "C" {
+# endif /*__cplusplus*/
+
+/**
+ * \brief The categories to which allocations are attributed.
+ */
+enum weightgraph_memory_category
+{
+    /* weightgraph ASTs. */
+    WEIGHTGRAPH_MEMORY_GRAPH,
+    /* entries of an AST. */
+    WEIGHTGRAPH_MEMORY_ENTRY,
+    /* copies of entry and sample dates. */
+    WEIGHTGRAPH_MEMORY_DATE,
+    /* parsers and their line buffers. */
+    WEIGHTGRAPH_MEMORY_PARSER,
+    /* memory allocated by expat on behalf of a parser. */
+    WEIGHTGRAPH_MEMORY_EXPAT,
+    /* sessions and their sample arrays. */
+    WEIGHTGRAPH_MEMORY_SESSION,
+    /* plotters. */
+    WEIGHTGRAPH_MEMORY_PLOTTER,
+    /* output graphs, their pages, and rendered page buffers. */
+    WEIGHTGRAPH_MEMORY_OUTPUT,
+    /* raster canvases and PNG encoding buffers. */
+    WEIGHTGRAPH_MEMORY_RASTER,
+    /* archive writers, and the blocks decoded by parsers. */
+    WEIGHTGRAPH_MEMORY_ARCHIVE,
+    /* the periods of rollups, and the work of computing them. */
+    WEIGHTGRAPH_MEMORY_ROLLUP,
+    /* outlier filters, and the marks of the samples they reject. */
+    WEIGHTGRAPH_MEMORY_FILTER,
+    /* the number of categories, which also selects the total. */
+    WEIGHTGRAPH_MEMORY_CATEGORY_COUNT
+};
+
+/**
+ * \brief A snapshot of the memory counted for a category.
+ */
+typedef struct weightgraph_memory_stats weightgraph_memory_stats;
+
+struct weightgraph_memory_stats
+{
+    /* the number of allocations and reallocations. */
+    uint64_t allocations;
+    /* the number of blocks reclaimed. */
+    uint64_t reclaims;
+    /* the bytes requested, counting only the growth of reallocations. */
+    uint64_t bytes;
+    /* the bytes currently allocated, and the most ever allocated at once. */
+    uint64_t live_bytes;
+    uint64_t peak_bytes;
+};
+
+/**
+ * \brief Start counting the memory allocated by the library.
+ *
+ * Counting is off by default, so that allocations only cost a branch.  It
+ * should be enabled before the library allocates anything, as blocks
+ * allocated before it is enabled are not counted when they are reclaimed.
+ * Counting can't be turned off again.
+ */
+void weightgraph_memory_stats_enable(void);
+
+/**
+ * \brief Read the memory counted for a category.
+ *
+ * The counters are updated independently, so a snapshot taken while other
+ * threads allocate may be slightly inconsistent.
+ *
+ * \param stats         The snapshot to fill in.
+ * \param category      The category to read, or
+ *                      \ref WEIGHTGRAPH_MEMORY_CATEGORY_COUNT for the total
+ *                      of all categories.
+ */
+void weightgraph_memory_stats_read(
+    weightgraph_memory_stats* stats, int category);
+
+/**
+ * \brief Start a new high-water mark of the memory counted.
+ *
+ * The peak of each category, and of the total, is lowered to the bytes that
+ * are live now, so that the peak read afterwards is the most allocated at
+ * once since the reset.  This lets the peak of each phase of a program be
+ * measured in turn.
+ */
+void weightgraph_memory_stats_reset_peak(void);
+
+/**
+ * \brief Get the name of a memory category.
+ *
+ * \param category      The category, or
+ *                      \ref WEIGHTGRAPH_MEMORY_CATEGORY_COUNT for the total.
+ *
+ * \returns the name of the category, such as "entry", or "total".
+ */
+const char* weightgraph_memory_category_name(int category);
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+}
+# endif /*__cplusplus*/
@@ -0,0 +1,502 @@
+/**
+ * \file weightgraph/session.h
+ *
+ * \brief Streaming interface for computing and rendering weight graphs.
+ *
+ * A session accepts samples in date order, computes the moving average of
+ * each as it arrives, and renders the graph to a caller-supplied sink.  This
+ * allows a graph to be produced without a process or file per graph.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#pragma once
+
+#include <weightgraph/status_codes.h>
+#include <weightgraph/weightgraph.h>
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+extern "C" {
+# endif /*__cplusplus*/
+
+/**
+ * \brief The number of samples over which the moving average is computed.
+ */
+#define WEIGHTGRAPH_AVERAGE_WINDOW 10
+
+/**
+ * \brief The default number of earlier weights against which the outlier
+ * filter judges each weight.
+ */
+#define WEIGHTGRAPH_FILTER_WINDOW 7
+
+/**
+ * \brief The largest number of earlier weights the outlier filter can judge
+ * a weight against.
+ */
+#define WEIGHTGRAPH_FILTER_MAX_WINDOW 1000
+
+/**
+ * \brief The default number of scaled median absolute deviations from the
+ * median beyond which the outlier filter rejects a weight.
+ */
+#define WEIGHTGRAPH_FILTER_THRESHOLD 3.0
+
+/**
+ * \brief Output formats supported by the renderer.
+ */
+enum weightgraph_format
+{
+    WEIGHTGRAPH_FORMAT_EPS,
+    WEIGHTGRAPH_FORMAT_PNG,
+};
+
+/**
+ * \brief A single sample, with its moving average.
+ */
+typedef struct weightgraph_sample weightgraph_sample;
+
+struct weightgraph_sample
+{
+    const char* date;
+    double weight;
+    double moving_average;
+    /* true if the outlier filter rejected the weight, which then left the
+     * moving average and the range of the weights as they were. */
+    bool rejected;
+};
+
+/**
+ * \brief The calendar periods into which a session can be rolled up.
+ */
+enum weightgraph_period
+{
+    /* each day on its own. */
+    WEIGHTGRAPH_PERIOD_DAY,
+    /* weeks, starting on Monday. */
+    WEIGHTGRAPH_PERIOD_WEEK,
+    WEIGHTGRAPH_PERIOD_MONTH,
+    WEIGHTGRAPH_PERIOD_YEAR,
+    /* the number of periods. */
+    WEIGHTGRAPH_PERIOD_COUNT
+};
+
+/**
+ * \brief The aggregates of the samples in a calendar period of a rollup.
+ */
+typedef struct weightgraph_period_summary weightgraph_period_summary;
+
+struct weightgraph_period_summary
+{
+    /* the first day of the period, written as the dates of the log are. */
+    const char* date;
+    /* the number of samples in the period, leaving out any rejected by the
+     * outlier filter unless every one was. */
+    size_t count;
+    /* the mean, lowest and highest of their weights. */
+    double mean;
+    double min_weight;
+    double max_weight;
+    /* the moving average after the last sample in the period. */
+    double moving_average;
+};
+
+/**
+ * \brief A caller-supplied destination for rendered output.
+ *
+ * An EPS graph is a single document, opened with page 0.  A raster graph is
+ * written as one image per page; a graph with a single page that can not be
+ * appended to is opened with page 0, and otherwise each image is opened with
+ * its page number, starting at 1.  The sink is only called from the thread
+ * that renders the graph.
+ */
+typedef struct weightgraph_sink weightgraph_sink;
+
+struct weightgraph_sink
+{
+    /* context data passed to each callback. */
+    void* context;
+
+    /* start an output.  If offset is non-zero, the existing output is kept
+     * up to offset, and writes continue from there. */
+    status (*open)(void* context, size_t page, long offset);
+
+    /* write data to the current output. */
+    status (*write)(void* context, const void* data, size_t size);
+
+    /* finish the current output. */
+    status (*close)(void* context);
+};
+
+/**
+ * \brief The point at which rendering of a graph can be resumed.
+ */
+typedef struct weightgraph_render_state weightgraph_render_state;
+
+struct weightgraph_render_state
+{
+    /* the number of samples rendered before this point. */
+    size_t count;
+    /* the Y-axis of the graph. */
+    double axis_min;
+    double axis_max;
+    double tick_step;
+    /* the previous plot point. */
+    double prevx;
+    double prevy;
+    /* the current page, and the number of entries plotted on it. */
+    size_t page;
+    size_t page_entries;
+    /* true if the current page is still open. */
+    bool page_open;
+    /* the EPS output offset at which rendering resumes. */
+    long offset;
+};
+
+/**
+ * \brief Options controlling how a graph is rendered.
+ */
+typedef struct weightgraph_render_options weightgraph_render_options;
+
+struct weightgraph_render_options
+{
+    /* the output format (WEIGHTGRAPH_FORMAT_*). */
+    int format;
+    /* the width and height, in pixels, of raster output. */
+    size_t raster_size;
+    /* the number of entries plotted on each page. */
+    size_t page_size;
+    /* the number of threads used to render pages. */
+    size_t threads;
+    /* true if later renders may append pages to this graph. */
+    bool appendable;
+    /* the state from which to resume rendering, or NULL to start afresh. */
+    const weightgraph_render_state* resume;
+};
+
+/**
+ * \brief A weight graph session.
+ */
+typedef struct weightgraph_session weightgraph_session;
+
+/**
+ * \brief Create an empty weight graph session.
+ *
+ * \param session       Pointer to receive the new session.
+ * \param alloc         The allocator to use for this operation.
+ * \param average       The initial moving average for this session.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_session_create(
+    weightgraph_session** session, RCPR_SYM(allocator)* alloc,
+    double average);
+
+/**
+ * \brief Reset a session to empty, starting from a new initial average.
+ *
+ * The sample array is kept, so that a session reused for many graphs only
+ * grows it as far as the longest history requires, unless it was widened
+ * for a weight that couldn't be held in fixed point.  A rollup that is reset
+ * becomes an ordinary session.  An outlier filter is kept, with its window
+ * emptied.
+ *
+ * \param session       The session.
+ * \param average       The initial moving average for the next graph.
+ */
+void weightgraph_session_reset(weightgraph_session* session, double average);
+
+/**
+ * \brief Filter the weights pushed onto an empty session for outliers.
+ *
+ * Each weight is judged against the given number of weights pushed before
+ * it, with the Hampel identifier: it is rejected if it lies further from
+ * their median than the threshold times their median absolute deviation,
+ * scaled to the standard deviation of normally distributed weights, or times
+ * half of one percent of the median, if that is more.  The earlier weights
+ * are held in an order-statistic tree, so each weight is judged in time
+ * logarithmic in the window.  A rejected sample is kept, and marked, but
+ * left out of the moving average and the range of the weights.  Weights are
+ * only judged once the window is full.  The filter is kept when the session
+ * is reset.
+ *
+ * \param session       The session, which must be empty.
+ * \param window        The number of earlier weights against which each
+ *                      weight is judged, from 3 to
+ *                      \ref WEIGHTGRAPH_FILTER_MAX_WINDOW, or 0 to stop
+ *                      filtering.
+ * \param threshold     The threshold, which must be positive.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_BAD_ARGUMENTS if the session is not empty, or is a rollup, or
+ *        if the window or threshold is out of range.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_session_filter(
+    weightgraph_session* session, size_t window, double threshold);
+
+/**
+ * \brief Push a sample onto the session, updating the moving average.
+ *
+ * Samples must be pushed in date order.  The date is copied.  While every
+ * weight, and the initial average, is a whole number of hundredths, samples
+ * are held in fixed point, in half the space, and each moving average is
+ * computed exactly from an integer running sum.  A weight rejected by the
+ * outlier filter is kept, but leaves the moving average as it was.
+ *
+ * \param session       The session.
+ * \param date          The date of the sample.
+ * \param weight        The weight of the sample.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_BAD_ARGUMENTS if the session is a rollup.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_session_push(
+    weightgraph_session* session, const char* date, double weight);
+
+/**
+ * \brief Get the moving average after the most recently pushed sample.
+ *
+ * \param session       The session.
+ *
+ * \returns the current moving average.
+ */
+double weightgraph_session_average(const weightgraph_session* session);
+
+/**
+ * \brief Get the moving average from which the session started.
+ *
+ * \param session       The session.
+ *
+ * \returns the initial moving average.
+ */
+double weightgraph_session_initial_average(const weightgraph_session* session);
+
+/**
+ * \brief Get the number of samples pushed onto the session.
+ *
+ * \param session       The session.
+ *
+ * \returns the number of samples.
+ */
+size_t weightgraph_session_count(const weightgraph_session* session);
+
+/**
+ * \brief Get a sample that has been pushed onto the session.
+ *
+ * While every weight is a whole number of hundredths, a session holds its
+ * samples in fixed point, and converts them to doubles only here.
+ *
+ * \param session       The session.
+ * \param index         The index of the sample, starting at 0.
+ * \param sample        Pointer to receive the sample, whose date remains
+ *                      valid until the session is reset or released.
+ *
+ * \returns true if there is such a sample.
+ */
+bool weightgraph_session_sample(
+    const weightgraph_session* session, size_t index,
+    weightgraph_sample* sample);
+
+/**
+ * \brief Get the moving average window as it stood before a given sample.
+ *
+ * \param session       The session.
+ * \param index         The index of the sample, up to the sample count.
+ * \param window        Array of \ref WEIGHTGRAPH_AVERAGE_WINDOW values to
+ *                      receive the window.
+ * \param next          Pointer to receive the slot in the window that the
+ *                      sample replaces.
+ */
+void weightgraph_session_window(
+    const weightgraph_session* session, size_t index, double* window,
+    int* next);
+
+/**
+ * \brief Roll the samples of a session up into calendar periods.
+ *
+ * The rollup is a new session with a sample per period, dated the first day
+ * of the period, whose weight is the mean of the weights in the period and
+ * whose moving average is the one after the last of them, so that it renders
+ * like any other session.  Its Y-axis covers the same range as the session
+ * rolled up.  The samples are split into chunks, which are claimed by up to
+ * the given number of threads, first to place each sample in its period,
+ * then to compute the aggregates of the periods that start in each chunk.
+ * Dates must all be "YYYY-MM-DD", or all "MM/DD", in which case weeks start
+ * no earlier than the first of January.  Samples rejected by the outlier
+ * filter are left out of the aggregates of their period, unless every sample
+ * in it was rejected, in which case they are aggregated and the period is
+ * marked rejected.
+ *
+ * \param rollup        Pointer to receive the rollup.
+ * \param alloc         The allocator to use for this operation.
+ * \param session       The session to roll up, which must be in date order.
+ * \param period        The period (WEIGHTGRAPH_PERIOD_*).
+ * \param threads       The number of threads to use.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_BAD_ARGUMENTS if the period is unknown.
+ *      - ERROR_ROLLUP_DATE if a date can't be placed in a period.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_session_rollup(
+    weightgraph_session** rollup, RCPR_SYM(allocator)* alloc,
+    const weightgraph_session* session, int period, size_t threads);
+
+/**
+ * \brief Get the aggregates of a period of a rollup.
+ *
+ * \param rollup        The rollup.
+ * \param index         The index of the period, starting at 0.
+ * \param summary       Pointer to receive the aggregates, whose date remains
+ *                      valid until the rollup is reset or released.
+ *
+ * \returns true if the session is a rollup with such a period.
+ */
+bool weightgraph_session_period(
+    const weightgraph_session* rollup, size_t index,
+    weightgraph_period_summary* summary);
+
+/**
+ * \brief Select a calendar period by name.
+ *
+ * \param name          The name: "day", "week", "month" or "year".
+ * \param period        Pointer to receive the period (WEIGHTGRAPH_PERIOD_*).
+ *
+ * \returns true if the name is known.
+ */
+bool weightgraph_period_from_name(const char* name, int* period);
+
+/**
+ * \brief Render the samples in the session to the given sink.
+ *
+ * When resume state is given, only samples after the resume point are
+ * rendered, continuing the output from a previous render.  If those samples
+ * change the Y-axis of the graph, ERROR_CHECKPOINT_STALE is returned before
+ * anything is written to the sink.
+ *
+ * \param session       The session.
+ * \param options       The rendering options.
+ * \param sink          The sink to which output is written.
+ * \param state         Optional pointer to receive the point from which a
+ *                      later render could resume, or NULL.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_session_render(
+    weightgraph_session* session, const weightgraph_render_options* options,
+    const weightgraph_sink* sink, weightgraph_render_state* state);
+
+/**
+ * \brief Get the resource handle for a session.
+ *
+ * \param session       The session.
+ *
+ * \returns the resource handle, which is used to release the session.
+ */
+RCPR_SYM(resource)* weightgraph_session_resource_handle(
+    weightgraph_session* session);
+
+/**
+ * \brief A plotter, which renders samples as they are pushed.
+ *
+ * Unlike a session, a plotter keeps none of the samples pushed onto it, only
+ * the moving average window, so a graph of any length can be rendered in
+ * constant memory.  The number of samples and the range of their weights
+ * must be known up front, as they determine the pages and Y-axis of the
+ * graph.
+ */
+typedef struct weightgraph_plotter weightgraph_plotter;
+
+/**
+ * \brief Create a plotter, starting the graph on the given sink.
+ *
+ * The Y-axis covers the range of weights and the initial average.  Resuming
+ * from a previous render is not supported.
+ *
+ * \param plotter       Pointer to receive the new plotter.
+ * \param alloc         The allocator to use for this operation.
+ * \param options       The rendering options.
+ * \param sink          The sink to which output is written.
+ * \param average       The initial moving average.
+ * \param count         The number of samples that will be pushed.
+ * \param min_weight    The lowest weight that will be pushed.
+ * \param max_weight    The highest weight that will be pushed.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_plotter_create(
+    weightgraph_plotter** plotter, RCPR_SYM(allocator)* alloc,
+    const weightgraph_render_options* options, const weightgraph_sink* sink,
+    double average, size_t count, double min_weight, double max_weight);
+
+/**
+ * \brief Push a sample onto the plotter, updating the moving average and
+ * plotting the sample.
+ *
+ * Samples must be pushed in date order.  The date is not kept.
+ *
+ * \param plotter       The plotter.
+ * \param date          The date of the sample.
+ * \param weight        The weight of the sample.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_BAD_ARGUMENTS if the sample is beyond the count or range
+ *        given when the plotter was created.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_plotter_push(
+    weightgraph_plotter* plotter, const char* date, double weight);
+
+/**
+ * \brief Get the moving average after the most recently pushed sample.
+ *
+ * \param plotter       The plotter.
+ *
+ * \returns the current moving average.
+ */
+double weightgraph_plotter_average(const weightgraph_plotter* plotter);
+
+/**
+ * \brief Finish the graph once every sample has been pushed.
+ *
+ * \param plotter       The plotter.
+ * \param state         Optional pointer to receive the point from which a
+ *                      later render could resume, or NULL.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_BAD_ARGUMENTS if fewer samples were pushed than the count
+ *        given when the plotter was created.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_plotter_finalize(
+    weightgraph_plotter* plotter, weightgraph_render_state* state);
+
+/**
+ * \brief Get the resource handle for a plotter.
+ *
+ * \param plotter       The plotter.
+ *
+ * \returns the resource handle, which is used to release the plotter.
+ */
+RCPR_SYM(resource)* weightgraph_plotter_resource_handle(
+    weightgraph_plotter* plotter);
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+}
+# endif /*__cplusplus*/
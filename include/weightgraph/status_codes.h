@@ -20,6 +20,27 @@ extern "C" {
 #define ERROR_PARSER_CREATE     80
 #define ERROR_XML_PARSE         81
 #define ERROR_OUTPUT_FILE_OPEN  82
+#define ERROR_BAD_ARGUMENTS     83
+#define ERROR_OUTPUT_WRITE      84
+#define ERROR_PNG_ENCODE        85
+#define ERROR_CHECKPOINT_READ   86
+#define ERROR_CHECKPOINT_WRITE  87
+#define ERROR_CHECKPOINT_STALE  88
+#define ERROR_BATCH_INCOMPLETE  89
+#define ERROR_DAEMON_SOCKET     90
+#define ERROR_BAD_REQUEST       91
+#define ERROR_OUT_OF_ORDER      92
+#define ERROR_PIPELINE_STOPPED  93
+#define ERROR_DUPLICATE_DATE    94
+#define ERROR_DECOMPRESS        95
+#define ERROR_RECORD_PARSE      96
+#define ERROR_PERF_REGRESSION   97
+#define ERROR_ARCHIVE_FORMAT    98
+#define ERROR_ARCHIVE_ENCODE    99
+#define ERROR_ROLLUP_DATE       100
+#define ERROR_OUTPUT_CACHE      101
+#define ERROR_BATCH_COLLISION   102
+#define ERROR_TEST_FAILED       103
 
 /* C++ compatibility. */
 # ifdef   __cplusplus
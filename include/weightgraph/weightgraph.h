@@ -31,6 +31,10 @@ struct weightgraph
     RCPR_SYM(allocator)* alloc;
     RCPR_SYM(rbtree)* entries;
     double initial_average;
+    /* the number of entries, and the range of their weights. */
+    size_t entry_count;
+    double min_weight;
+    double max_weight;
     bool error;
 };
 
@@ -61,6 +65,213 @@ struct weightgraph_entry
 status weightgraph_create(
     weightgraph** graph, RCPR_SYM(allocator)* alloc, double average);
 
+/**
+ * \brief Parse the given buffer, creating a weightgraph AST.
+ *
+ * \param graph         Pointer to receive the AST.
+ * \param alloc         The allocator to use.
+ * \param buffer        The buffer to parse.
+ * \param buffer_size   The size of the buffer to parse.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_parse_buffer(
+    weightgraph** graph, RCPR_SYM(allocator)* alloc,
+    const uint8_t* buffer, size_t buffer_size);
+
+/**
+ * \brief Formats of weight log understood by the parser.
+ *
+ * Besides the XML format, a log may be CSV, with a "date,weight" record per
+ * line, or NDJSON, with a {"date": "05/01", "weight": 127.2} object per
+ * line.  The initial moving average is given by a "moving-average,130.5"
+ * CSV record, or a {"moving-average": 130.5} object.  A CSV log may start
+ * with a header line, and blank lines and lines starting with '#' are
+ * skipped.
+ */
+enum weightgraph_input_format
+{
+    /* detect the format from the start of each document. */
+    WEIGHTGRAPH_INPUT_AUTO,
+    WEIGHTGRAPH_INPUT_XML,
+    WEIGHTGRAPH_INPUT_CSV,
+    WEIGHTGRAPH_INPUT_NDJSON,
+    /* a binary archive, as written by a weightgraph_archive_writer. */
+    WEIGHTGRAPH_INPUT_ARCHIVE,
+};
+
+/**
+ * \brief Select the format of a log by the extension of its name.
+ *
+ * A ".gz" suffix is ignored, so that "log.csv.gz" is a CSV log.
+ *
+ * \param filename      The name of the log.
+ *
+ * \returns the format (WEIGHTGRAPH_INPUT_*), or WEIGHTGRAPH_INPUT_AUTO if the
+ * extension is not recognized.
+ */
+int weightgraph_input_format_from_name(const char* filename);
+
+/**
+ * \brief Detect the format of a log from its first bytes.
+ *
+ * A log starting with the archive magic is an archive.  Otherwise, a log
+ * starting with '<' is XML, and one starting with '{' is NDJSON; anything
+ * else is CSV.  Leading whitespace and a byte order mark are skipped.
+ *
+ * \param buffer        The start of the log.
+ * \param buffer_size   The size of the buffer.
+ *
+ * \returns the format (WEIGHTGRAPH_INPUT_*), or WEIGHTGRAPH_INPUT_AUTO if the
+ * buffer holds only whitespace.
+ */
+int weightgraph_input_format_sniff(const uint8_t* buffer, size_t buffer_size);
+
+/**
+ * \brief A parser that can be reused to parse many weight logs.
+ */
+typedef struct weightgraph_parser weightgraph_parser;
+
+/**
+ * \brief Create a parser that can be reused to parse many documents.
+ *
+ * \param parser        Pointer to receive the new parser.
+ * \param alloc         The allocator to use for this parser and the ASTs it
+ *                      creates.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_parser_create(
+    weightgraph_parser** parser, RCPR_SYM(allocator)* alloc);
+
+/**
+ * \brief Set the format of the logs parsed by a parser.
+ *
+ * A new parser detects the format of each log it parses.
+ *
+ * \param parser        The parser.
+ * \param format        The format (WEIGHTGRAPH_INPUT_*).
+ */
+void weightgraph_parser_set_format(weightgraph_parser* parser, int format);
+
+/**
+ * \brief Parse the given buffer with a reusable parser, creating a
+ * weightgraph AST.
+ *
+ * The parser is reset before each document, so a single parser can parse
+ * any number of documents without being recreated.
+ *
+ * \param parser        The parser.
+ * \param graph         Pointer to receive the AST.
+ * \param buffer        The buffer to parse.
+ * \param buffer_size   The size of the buffer to parse.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_parser_parse(
+    weightgraph_parser* parser, weightgraph** graph, const uint8_t* buffer,
+    size_t buffer_size);
+
+/**
+ * \brief Parse the log records appended to a weight log, creating a
+ * weightgraph AST of just those records.
+ *
+ * The buffer holds the part of the log after the last record that was
+ * parsed, as given by \ref weightgraph_parser_log_end.  It may end with the
+ * closing tag of the log, or part way through a record that is still being
+ * written, which is left for the next call.
+ *
+ * \param parser        The parser.
+ * \param graph         Pointer to receive the AST.
+ * \param buffer        The buffer to parse.
+ * \param buffer_size   The size of the buffer to parse.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_parser_parse_records(
+    weightgraph_parser* parser, weightgraph** graph, const uint8_t* buffer,
+    size_t buffer_size);
+
+/**
+ * \brief Get the offset just past the last log record in the last buffer
+ * parsed.
+ *
+ * \param parser        The parser.
+ *
+ * \returns the offset in the buffer just past the last log element, or 0 if
+ * the buffer held no complete log element.
+ */
+size_t weightgraph_parser_log_end(const weightgraph_parser* parser);
+
+/**
+ * \brief Callbacks receiving the elements of a streamed weight log.
+ *
+ * A callback that returns a failure stops the parse, and that failure is
+ * returned by \ref weightgraph_parser_stream.
+ */
+typedef struct weightgraph_stream_handler weightgraph_stream_handler;
+
+struct weightgraph_stream_handler
+{
+    void* context;
+    /* called with the initial moving average of the log. */
+    status (*beginning_average)(void* context, double average);
+    /* called with each log entry, in the order of the document. */
+    status (*log)(void* context, const char* date, double weight);
+};
+
+/**
+ * \brief Begin streaming a document through a reusable parser.
+ *
+ * Each element is passed to the handler as soon as it has been parsed,
+ * without building an AST, so the document can be parsed a piece at a time
+ * as it is read.
+ *
+ * \param parser        The parser.
+ * \param handler       The handler, which must outlive the document.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_parser_stream_begin(
+    weightgraph_parser* parser, const weightgraph_stream_handler* handler);
+
+/**
+ * \brief Stream the next piece of a document through the parser.
+ *
+ * \param parser        The parser.
+ * \param buffer        The next piece of the document.
+ * \param buffer_size   The size of the piece.
+ * \param final         true if this piece ends the document.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - the failure returned by a handler callback.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_parser_stream(
+    weightgraph_parser* parser, const uint8_t* buffer, size_t buffer_size,
+    bool final);
+
+/**
+ * \brief Get the resource handle for a weightgraph parser.
+ *
+ * \param parser        The parser.
+ *
+ * \returns the resource handle, which is used to release the parser.
+ */
+RCPR_SYM(resource)* weightgraph_parser_resource_handle(
+    weightgraph_parser* parser);
+
 /**
  * \brief Create an entry node for the weight graph.
  *
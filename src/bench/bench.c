@@ -0,0 +1,153 @@
+/**
+ * \file bench/bench.c
+ *
+ * \brief Main entry point for the weightgraph benchmark.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench_internal.h"
+
+/* forward decls. */
+static status bench_write_log(const bench_options* options);
+static status bench_generated(const bench_options* options);
+
+int main(int argc, char* argv[])
+{
+    status retval;
+    bench_options options;
+
+    /* parse the command-line options. */
+    retval = bench_options_parse(&options, argc, argv);
+    if (STATUS_SUCCESS != retval)
+    {
+        return 1;
+    }
+
+    if (options.generate)
+    {
+        retval = bench_write_log(&options);
+    }
+    else if (NULL != options.input_file)
+    {
+        retval = bench_run(&options, options.input_file);
+    }
+    else
+    {
+        retval = bench_generated(&options);
+    }
+
+    if (STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Error: status %d.\n", (int)retval);
+    }
+
+    return (int)retval;
+}
+
+/**
+ * \brief Write a generated log to the output file, or stdout.
+ *
+ * \param options       The generator options.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status bench_write_log(const bench_options* options)
+{
+    status retval;
+    FILE* out = stdout;
+
+    if (NULL != options->output_file)
+    {
+        out = fopen(options->output_file, "w");
+        if (NULL == out)
+        {
+            return ERROR_OUTPUT_FILE_OPEN;
+        }
+    }
+
+    retval = bench_generate(out, options);
+
+    if (stdout != out && 0 != fclose(out) && STATUS_SUCCESS == retval)
+    {
+        retval = ERROR_OUTPUT_WRITE;
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Benchmark a log generated into a temporary file.
+ *
+ * The file is created in TMPDIR, or /tmp, and removed afterwards.
+ *
+ * \param options       The benchmark and generator options.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status bench_generated(const bench_options* options)
+{
+    status retval;
+    const char* dir = getenv("TMPDIR");
+    char* path;
+    FILE* out;
+    int fd;
+
+    if (NULL == dir || 0 == *dir)
+    {
+        dir = "/tmp";
+    }
+
+    path = (char*)malloc(strlen(dir) + sizeof("/weightgraph-bench-XXXXXX"));
+    if (NULL == path)
+    {
+        return ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+    strcpy(path, dir);
+    strcat(path, "/weightgraph-bench-XXXXXX");
+
+    fd = mkstemp(path);
+    if (fd < 0)
+    {
+        retval = ERROR_OUTPUT_FILE_OPEN;
+        goto cleanup_path;
+    }
+
+    out = fdopen(fd, "w");
+    if (NULL == out)
+    {
+        close(fd);
+        retval = ERROR_OUTPUT_FILE_OPEN;
+        goto cleanup_file;
+    }
+
+    /* generate the log, then benchmark it. */
+    retval = bench_generate(out, options);
+    if (0 != fclose(out) && STATUS_SUCCESS == retval)
+    {
+        retval = ERROR_OUTPUT_WRITE;
+    }
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_file;
+    }
+
+    retval = bench_run(options, path);
+
+cleanup_file:
+    unlink(path);
+
+cleanup_path:
+    free(path);
+
+    return retval;
+}
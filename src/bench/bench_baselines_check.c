@@ -0,0 +1,343 @@
+/**
+ * \file bench/bench_baselines_check.c
+ *
+ * \brief Check the results of a benchmark against stored baselines.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench_internal.h"
+
+/**
+ * \brief The longest line of a baselines file.
+ */
+#define BENCH_BASELINE_LINE_MAX 512
+
+/**
+ * \brief Memory baselines are stored to a thousandth of a byte per entry, so
+ * a result may exceed its baseline by this much through rounding alone.
+ */
+#define BENCH_BASELINE_ROUNDING 0.0005
+
+/**
+ * \brief The baselines of a stage.
+ */
+typedef struct bench_baseline bench_baseline;
+
+struct bench_baseline
+{
+    bool found;
+    double ns_per_entry;
+    double peak_bytes_per_entry;
+};
+
+/**
+ * \brief The baselines read from a file.
+ */
+typedef struct bench_baselines bench_baselines;
+
+struct bench_baselines
+{
+    unsigned time_tolerance;
+    unsigned memory_tolerance;
+    bench_baseline stages[BENCH_STAGE_COUNT];
+};
+
+/* forward decls. */
+static status bench_baselines_read(
+    bench_baselines* baselines, const char* filename,
+    const bench_result* results);
+static bool bench_baselines_parse_line(
+    bench_baselines* baselines, char* line, const bench_result* results);
+static bool bench_baseline_check_stage(
+    const bench_baselines* baselines, const bench_result* result,
+    size_t stage);
+
+/**
+ * \brief Check the results of a benchmark against stored baselines.
+ *
+ * The baselines are lines of "key=value" fields: "time_tolerance" and
+ * "memory_tolerance" give the percentage by which a stage may exceed its
+ * baselines, and each "stage" line gives the "ns_per_entry" and
+ * "peak_bytes_per_entry" of a stage.  Blank lines and lines starting with '#'
+ * are skipped.  Each stage that exceeds its baselines by more than the
+ * tolerance is reported on stderr.
+ *
+ * \param options       The benchmark options, naming the baselines and the
+ *                      stage to check, if only one is.
+ * \param results       The results of each stage.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS if no stage regressed.
+ *      - ERROR_PERF_REGRESSION if a stage regressed.
+ *      - ERROR_READ_FAILED if the baselines can't be read.
+ *      - ERROR_BAD_ARGUMENTS if the baselines are malformed, or don't cover a
+ *        stage that is checked.
+ */
+status bench_baselines_check(
+    const bench_options* options, const bench_result* results)
+{
+    status retval;
+    bench_baselines baselines;
+    bool checked = false, regressed = false;
+
+    retval = bench_baselines_read(&baselines, options->baselines_file, results);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    for (size_t stage = 0; stage < BENCH_STAGE_COUNT; ++stage)
+    {
+        if (NULL != options->check_stage
+            && strcmp(options->check_stage, results[stage].stage))
+        {
+            continue;
+        }
+
+        if (!baselines.stages[stage].found)
+        {
+            fprintf(
+                stderr, "Error: %s has no baseline for stage %s.\n",
+                options->baselines_file, results[stage].stage);
+            return ERROR_BAD_ARGUMENTS;
+        }
+
+        checked = true;
+        if (!bench_baseline_check_stage(&baselines, &results[stage], stage))
+        {
+            regressed = true;
+        }
+    }
+
+    if (!checked)
+    {
+        fprintf(stderr, "Error: unknown stage '%s'.\n", options->check_stage);
+        return ERROR_BAD_ARGUMENTS;
+    }
+
+    return regressed ? ERROR_PERF_REGRESSION : STATUS_SUCCESS;
+}
+
+/**
+ * \brief Read the baselines from a file.
+ *
+ * \param baselines     The baselines to fill in.
+ * \param filename      The file to read.
+ * \param results       The results, which name the stages.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_READ_FAILED if the file can't be read.
+ *      - ERROR_BAD_ARGUMENTS if the file is malformed.
+ */
+static status bench_baselines_read(
+    bench_baselines* baselines, const char* filename,
+    const bench_result* results)
+{
+    status retval = STATUS_SUCCESS;
+    char line[BENCH_BASELINE_LINE_MAX];
+    unsigned line_number = 0;
+    FILE* in;
+
+    memset(baselines, 0, sizeof(*baselines));
+    baselines->time_tolerance = BENCH_DEFAULT_TIME_TOLERANCE;
+    baselines->memory_tolerance = BENCH_DEFAULT_MEMORY_TOLERANCE;
+
+    in = fopen(filename, "r");
+    if (NULL == in)
+    {
+        fprintf(stderr, "Error: couldn't read baselines %s.\n", filename);
+        return ERROR_READ_FAILED;
+    }
+
+    while (NULL != fgets(line, sizeof(line), in))
+    {
+        ++line_number;
+        if (!bench_baselines_parse_line(baselines, line, results))
+        {
+            fprintf(
+                stderr, "Error: %s:%u: malformed baseline.\n", filename,
+                line_number);
+            retval = ERROR_BAD_ARGUMENTS;
+            break;
+        }
+    }
+
+    if (STATUS_SUCCESS == retval && ferror(in))
+    {
+        fprintf(stderr, "Error: couldn't read baselines %s.\n", filename);
+        retval = ERROR_READ_FAILED;
+    }
+
+    fclose(in);
+
+    return retval;
+}
+
+/**
+ * \brief Parse a line of a baselines file.
+ *
+ * \param baselines     The baselines to update.
+ * \param line          The line, which is modified.
+ * \param results       The results, which name the stages.
+ *
+ * \returns true if the line is valid.
+ */
+static bool bench_baselines_parse_line(
+    bench_baselines* baselines, char* line, const bench_result* results)
+{
+    bench_baseline baseline;
+    long stage = -1;
+    char* saveptr;
+    char* field;
+
+    memset(&baseline, 0, sizeof(baseline));
+
+    for (field = strtok_r(line, " \t\r\n", &saveptr); NULL != field;
+         field = strtok_r(NULL, " \t\r\n", &saveptr))
+    {
+        char* value = strchr(field, '=');
+        unsigned long tolerance;
+        double amount;
+        char* end;
+
+        /* a comment runs to the end of the line. */
+        if ('#' == *field)
+        {
+            break;
+        }
+
+        if (NULL == value)
+        {
+            return false;
+        }
+        *value++ = 0;
+
+        if (!strcmp(field, "stage"))
+        {
+            for (stage = 0; stage < BENCH_STAGE_COUNT; ++stage)
+            {
+                if (!strcmp(value, results[stage].stage))
+                {
+                    break;
+                }
+            }
+
+            if (BENCH_STAGE_COUNT == stage)
+            {
+                return false;
+            }
+
+            continue;
+        }
+
+        if (!strcmp(field, "time_tolerance")
+            || !strcmp(field, "memory_tolerance"))
+        {
+            tolerance = strtoul(value, &end, 10);
+            if (0 == *value || 0 != *end || tolerance > 10000)
+            {
+                return false;
+            }
+
+            if ('t' == *field)
+            {
+                baselines->time_tolerance = (unsigned)tolerance;
+            }
+            else
+            {
+                baselines->memory_tolerance = (unsigned)tolerance;
+            }
+
+            continue;
+        }
+
+        amount = strtod(value, &end);
+        if (0 == *value || 0 != *end || !(amount >= 0.0))
+        {
+            return false;
+        }
+
+        if (!strcmp(field, "ns_per_entry"))
+        {
+            baseline.ns_per_entry = amount;
+        }
+        else if (!strcmp(field, "peak_bytes_per_entry"))
+        {
+            baseline.peak_bytes_per_entry = amount;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    if (stage >= 0)
+    {
+        baseline.found = true;
+        baselines->stages[stage] = baseline;
+    }
+
+    return true;
+}
+
+/**
+ * \brief Check the result of a stage against its baselines.
+ *
+ * The outcome is printed to stdout, and a regression to stderr as well.
+ *
+ * \param baselines     The baselines.
+ * \param result        The result of the stage.
+ * \param stage         The stage.
+ *
+ * \returns true if the stage is within its baselines.
+ */
+static bool bench_baseline_check_stage(
+    const bench_baselines* baselines, const bench_result* result,
+    size_t stage)
+{
+    const bench_baseline* baseline = &baselines->stages[stage];
+    double time_limit =
+        baseline->ns_per_entry
+            * (1.0 + (double)baselines->time_tolerance / 100.0);
+    double memory_limit =
+        baseline->peak_bytes_per_entry
+            * (1.0 + (double)baselines->memory_tolerance / 100.0)
+        + BENCH_BASELINE_ROUNDING;
+    bool time_ok = result->ns_per_entry <= time_limit;
+    bool memory_ok = result->peak_bytes_per_entry <= memory_limit;
+
+    printf(
+        "check=%s ns_per_entry=%.1f ns_limit=%.1f "
+        "peak_bytes_per_entry=%.3f peak_bytes_limit=%.3f result=%s\n",
+        result->stage, result->ns_per_entry, time_limit,
+        result->peak_bytes_per_entry, memory_limit,
+        (time_ok && memory_ok) ? "ok" : "regressed");
+
+    if (!time_ok)
+    {
+        fprintf(
+            stderr,
+            "Regression: stage %s took %.1f ns per entry, over %.1f, its "
+            "baseline of %.1f plus %u%%.\n",
+            result->stage, result->ns_per_entry, time_limit,
+            baseline->ns_per_entry, baselines->time_tolerance);
+    }
+
+    if (!memory_ok)
+    {
+        fprintf(
+            stderr,
+            "Regression: stage %s peaked at %.3f bytes per entry, over %.3f, "
+            "its baseline of %.3f plus %u%%.\n",
+            result->stage, result->peak_bytes_per_entry, memory_limit,
+            baseline->peak_bytes_per_entry, baselines->memory_tolerance);
+    }
+
+    return time_ok && memory_ok;
+}
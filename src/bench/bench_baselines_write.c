@@ -0,0 +1,60 @@
+/**
+ * \file bench/bench_baselines_write.c
+ *
+ * \brief Write the results of a benchmark as baselines.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "bench_internal.h"
+
+/**
+ * \brief Write the results of a benchmark as baselines.
+ *
+ * The baselines are written in the format read by
+ * \ref bench_baselines_check, with the default tolerances.
+ *
+ * \param filename      The file to write.
+ * \param results       The results of each stage.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_OUTPUT_FILE_OPEN if the file can't be created.
+ *      - ERROR_OUTPUT_WRITE if the file can't be written.
+ */
+status bench_baselines_write(const char* filename, const bench_result* results)
+{
+    FILE* out;
+    bool failed;
+
+    out = fopen(filename, "w");
+    if (NULL == out)
+    {
+        return ERROR_OUTPUT_FILE_OPEN;
+    }
+
+    fprintf(
+        out,
+        "# weightgraph_bench baselines, per entry of the log.  Regenerate "
+        "with -W.\n"
+        "time_tolerance=%d\n"
+        "memory_tolerance=%d\n",
+        BENCH_DEFAULT_TIME_TOLERANCE, BENCH_DEFAULT_MEMORY_TOLERANCE);
+
+    for (size_t stage = 0; stage < BENCH_STAGE_COUNT; ++stage)
+    {
+        fprintf(
+            out, "stage=%s ns_per_entry=%.3f peak_bytes_per_entry=%.3f\n",
+            results[stage].stage, results[stage].ns_per_entry,
+            results[stage].peak_bytes_per_entry);
+    }
+
+    failed = ferror(out);
+    if (0 != fclose(out) || failed)
+    {
+        return ERROR_OUTPUT_WRITE;
+    }
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,377 @@
+/**
+ * \file bench/bench_generate.c
+ *
+ * \brief Write a synthetic weight log.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <stdlib.h>
+
+#include "bench_internal.h"
+
+/**
+ * \brief The weight around which the random walk wanders, in tenths.
+ */
+#define BENCH_CENTER_WEIGHT 1800
+
+/**
+ * \brief The most days skipped by a gap.
+ */
+#define BENCH_MAX_GAP 7
+
+/**
+ * \brief The number of days from 0000-03-01 to 1900-01-01.
+ */
+#define BENCH_EPOCH_DAYS 693901
+
+/**
+ * \brief A generated entry, kept in memory to be shuffled.
+ */
+typedef struct bench_entry bench_entry;
+
+struct bench_entry
+{
+    uint32_t day;
+    int32_t weight;
+};
+
+/**
+ * \brief The state of the generator.
+ */
+typedef struct bench_generator bench_generator;
+
+struct bench_generator
+{
+    const bench_options* options;
+    /* separate streams, so that dates don't depend on weights. */
+    uint64_t day_state;
+    uint64_t weight_state;
+    uint64_t shuffle_state;
+    /* the current entry. */
+    size_t index;
+    uint32_t day;
+    int32_t weight;
+};
+
+/* forward decls. */
+static void bench_generator_init(
+    bench_generator* gen, const bench_options* options);
+static void bench_generator_next(bench_generator* gen);
+static uint64_t bench_random(uint64_t* state);
+static uint64_t bench_seed(uint64_t seed, uint64_t stream);
+static int bench_year_width(const bench_options* options);
+static void bench_civil(uint32_t day, long* year, int* month, int* mday);
+static void bench_write_header(FILE* out, int format);
+static void bench_write_entry(
+    FILE* out, int format, int width, uint32_t day, int32_t weight);
+static void bench_write_trailer(FILE* out, int format);
+
+/**
+ * \brief Write a synthetic weight log.
+ *
+ * Entries start on 1900-01-01 and follow a random walk around 180.0.  The
+ * same options and seed always produce the same log.  A sorted log is
+ * written as it is generated; a shuffled log is generated in memory first,
+ * at eight bytes an entry.
+ *
+ * \param out           The stream to which the log is written.
+ * \param options       The generator options.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status bench_generate(FILE* out, const bench_options* options)
+{
+    bench_generator gen;
+    bench_entry* entries = NULL;
+    int width = bench_year_width(options);
+
+    bench_generator_init(&gen, options);
+
+    /* a shuffled log is generated in full before it is written. */
+    if (options->shuffled)
+    {
+        entries =
+            (bench_entry*)malloc(options->entries * sizeof(bench_entry));
+        if (NULL == entries)
+        {
+            return ERROR_GENERAL_OUT_OF_MEMORY;
+        }
+
+        for (size_t i = 0; i < options->entries; ++i)
+        {
+            bench_generator_next(&gen);
+            entries[i].day = gen.day;
+            entries[i].weight = gen.weight;
+        }
+
+        /* Fisher-Yates shuffle. */
+        for (size_t i = options->entries - 1; i > 0; --i)
+        {
+            size_t j = bench_random(&gen.shuffle_state) % (i + 1);
+            bench_entry tmp = entries[i];
+
+            entries[i] = entries[j];
+            entries[j] = tmp;
+        }
+    }
+
+    bench_write_header(out, options->log_format);
+
+    for (size_t i = 0; i < options->entries; ++i)
+    {
+        if (NULL != entries)
+        {
+            bench_write_entry(
+                out, options->log_format, width, entries[i].day,
+                entries[i].weight);
+        }
+        else
+        {
+            bench_generator_next(&gen);
+            bench_write_entry(
+                out, options->log_format, width, gen.day, gen.weight);
+        }
+    }
+
+    bench_write_trailer(out, options->log_format);
+
+    free(entries);
+
+    if (0 != fflush(out) || ferror(out))
+    {
+        return ERROR_OUTPUT_WRITE;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Initialize the generator.
+ *
+ * \param gen           The generator.
+ * \param options       The generator options.
+ */
+static void bench_generator_init(
+    bench_generator* gen, const bench_options* options)
+{
+    gen->options = options;
+    gen->day_state = bench_seed(options->seed, 1);
+    gen->weight_state = bench_seed(options->seed, 2);
+    gen->shuffle_state = bench_seed(options->seed, 3);
+    gen->index = 0;
+    gen->day = 0;
+    gen->weight = BENCH_CENTER_WEIGHT;
+}
+
+/**
+ * \brief Generate the next entry in date order.
+ *
+ * \param gen           The generator.
+ */
+static void bench_generator_next(bench_generator* gen)
+{
+    const bench_options* options = gen->options;
+
+    /* the first entry falls on the first day. */
+    if (gen->index++ > 0)
+    {
+        /* a duplicate repeats the date of the last entry. */
+        if (bench_random(&gen->day_state) % 100 >= options->duplicate_percent)
+        {
+            gen->day += 1;
+
+            /* a gap skips a few days. */
+            if (bench_random(&gen->day_state) % 100 < options->gap_percent)
+            {
+                gen->day += 1 + bench_random(&gen->day_state) % BENCH_MAX_GAP;
+            }
+        }
+    }
+
+    /* wander, drifting back toward the center. */
+    gen->weight +=
+        (BENCH_CENTER_WEIGHT - gen->weight) / 50
+            + (int32_t)(bench_random(&gen->weight_state) % 11) - 5;
+    if (gen->weight < 10)
+    {
+        gen->weight = 10;
+    }
+}
+
+/**
+ * \brief Get the next number from a xorshift64* generator.
+ *
+ * \param state         The state of the generator.
+ *
+ * \returns the next number.
+ */
+static uint64_t bench_random(uint64_t* state)
+{
+    uint64_t x = *state;
+
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+
+    return x * UINT64_C(0x2545f4914f6cdd1d);
+}
+
+/**
+ * \brief Derive the non-zero initial state of a generator stream.
+ *
+ * \param seed          The seed.
+ * \param stream        The stream number.
+ *
+ * \returns the initial state, mixed with splitmix64.
+ */
+static uint64_t bench_seed(uint64_t seed, uint64_t stream)
+{
+    uint64_t z = seed + stream * UINT64_C(0x9e3779b97f4a7c15);
+
+    z = (z ^ (z >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+    z = (z ^ (z >> 27)) * UINT64_C(0x94d049bb133111eb);
+    z ^= z >> 31;
+
+    return (0 == z) ? 1 : z;
+}
+
+/**
+ * \brief Get the width of the year of every date, so that the dates of a
+ * long log still sort as strings.
+ *
+ * The day sequence is replayed to find the last date.
+ *
+ * \param options       The generator options.
+ *
+ * \returns the number of digits in each year.
+ */
+static int bench_year_width(const bench_options* options)
+{
+    bench_generator gen;
+    long year;
+    int month, mday;
+    int width = 4;
+
+    bench_generator_init(&gen, options);
+    for (size_t i = 0; i < options->entries; ++i)
+    {
+        bench_generator_next(&gen);
+    }
+
+    bench_civil(gen.day, &year, &month, &mday);
+    for (long limit = 10000; year >= limit; limit *= 10)
+    {
+        ++width;
+    }
+
+    return width;
+}
+
+/**
+ * \brief Convert a day number to a date in the proleptic Gregorian calendar.
+ *
+ * \param day           The number of days since 1900-01-01.
+ * \param year          Pointer to receive the year.
+ * \param month         Pointer to receive the month, from 1.
+ * \param mday          Pointer to receive the day of the month, from 1.
+ */
+static void bench_civil(uint32_t day, long* year, int* month, int* mday)
+{
+    long z = (long)day + BENCH_EPOCH_DAYS;
+    long era = z / 146097;
+    long doe = z - era * 146097;
+    long yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    long doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    long mp = (5 * doy + 2) / 153;
+
+    *mday = (int)(doy - (153 * mp + 2) / 5 + 1);
+    *month = (int)(mp < 10 ? mp + 3 : mp - 9);
+    *year = yoe + era * 400 + (*month <= 2 ? 1 : 0);
+}
+
+/**
+ * \brief Write the start of a log, with its initial moving average.
+ *
+ * \param out           The stream.
+ * \param format        The log format (WEIGHTGRAPH_INPUT_*).
+ */
+static void bench_write_header(FILE* out, int format)
+{
+    switch (format)
+    {
+        case WEIGHTGRAPH_INPUT_CSV:
+            fprintf(out, "date,weight\nmoving-average,180.0\n");
+            break;
+
+        case WEIGHTGRAPH_INPUT_NDJSON:
+            fprintf(out, "{\"moving-average\": 180.0}\n");
+            break;
+
+        default:
+            fprintf(
+                out,
+                "<weight-log>\n"
+                "    <beginning-averages moving-average=\"180.0\"/>\n");
+            break;
+    }
+}
+
+/**
+ * \brief Write an entry of a log.
+ *
+ * \param out           The stream.
+ * \param format        The log format (WEIGHTGRAPH_INPUT_*).
+ * \param width         The number of digits in the year.
+ * \param day           The number of days since 1900-01-01.
+ * \param weight        The weight, in tenths.
+ */
+static void bench_write_entry(
+    FILE* out, int format, int width, uint32_t day, int32_t weight)
+{
+    long year;
+    int month, mday;
+
+    bench_civil(day, &year, &month, &mday);
+
+    switch (format)
+    {
+        case WEIGHTGRAPH_INPUT_CSV:
+            fprintf(
+                out, "%0*ld-%02d-%02d,%d.%d\n", width, year, month, mday,
+                (int)(weight / 10), (int)(weight % 10));
+            break;
+
+        case WEIGHTGRAPH_INPUT_NDJSON:
+            fprintf(
+                out, "{\"date\": \"%0*ld-%02d-%02d\", \"weight\": %d.%d}\n",
+                width, year, month, mday, (int)(weight / 10),
+                (int)(weight % 10));
+            break;
+
+        default:
+            fprintf(
+                out, "    <log date=\"%0*ld-%02d-%02d\" weight=\"%d.%d\"/>\n",
+                width, year, month, mday, (int)(weight / 10),
+                (int)(weight % 10));
+            break;
+    }
+}
+
+/**
+ * \brief Write the end of a log.
+ *
+ * \param out           The stream.
+ * \param format        The log format (WEIGHTGRAPH_INPUT_*).
+ */
+static void bench_write_trailer(FILE* out, int format)
+{
+    if (WEIGHTGRAPH_INPUT_XML == format)
+    {
+        fprintf(out, "</weight-log>\n");
+    }
+}
@@ -0,0 +1,202 @@
+/**
+ * \file bench/bench_internal.h
+ *
+ * \brief Helpers for the benchmark and synthetic log generator.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "main_internal.h"
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+extern "C" {
+# endif /*__cplusplus*/
+
+/**
+ * \brief The default percentage by which a stage may exceed its baseline
+ * time.  Times depend on the machine and its load, so this is generous.
+ */
+#define BENCH_DEFAULT_TIME_TOLERANCE 100
+
+/**
+ * \brief The default percentage by which a stage may exceed its baseline
+ * peak memory.
+ */
+#define BENCH_DEFAULT_MEMORY_TOLERANCE 10
+
+/**
+ * \brief Command-line options for the benchmark.
+ */
+typedef struct bench_options bench_options;
+
+struct bench_options
+{
+    /* true if a log is generated instead of benchmarked. */
+    bool generate;
+    /* the log to benchmark, or NULL to benchmark a generated log. */
+    const char* input_file;
+    /* the file to which a log is generated, or NULL for stdout. */
+    const char* output_file;
+    /* the number of entries in a generated log. */
+    size_t entries;
+    /* true if the entries of a generated log are not in date order. */
+    bool shuffled;
+    /* the percentage of entries that skip days, or repeat a date. */
+    unsigned gap_percent;
+    unsigned duplicate_percent;
+    /* the seed of the generator. */
+    uint64_t seed;
+    /* the format of a generated log (WEIGHTGRAPH_INPUT_*). */
+    int log_format;
+    /* the number of times each stage is run. */
+    size_t runs;
+    /* the rendering options for the plot stage. */
+    int output_format;
+    size_t raster_size;
+    size_t page_size;
+    /* true if the memory allocated by the library is counted. */
+    bool memory;
+    /* the baselines to check the results against, or NULL. */
+    const char* baselines_file;
+    /* the only stage to check, or NULL to check every stage. */
+    const char* check_stage;
+    /* the file to which the results are written as baselines, or NULL. */
+    const char* baselines_output;
+};
+
+/**
+ * \brief The stages that are timed, in the order they run.
+ */
+enum bench_stage
+{
+    BENCH_STAGE_READ,
+    BENCH_STAGE_PARSE,
+    BENCH_STAGE_TREE,
+    BENCH_STAGE_AVERAGE,
+    BENCH_STAGE_PLOT,
+    BENCH_STAGE_COUNT,
+};
+
+/**
+ * \brief The cost of a stage, per entry of the log.
+ */
+typedef struct bench_result bench_result;
+
+struct bench_result
+{
+    const char* stage;
+    /* the median time of the stage. */
+    double ns_per_entry;
+    /* the most memory the library allocated at once during the stage, above
+     * what was live when it began. */
+    double peak_bytes_per_entry;
+};
+
+/**
+ * \brief Parse the command-line options for the benchmark.
+ *
+ * \param options       The options structure to populate.
+ * \param argc          The number of command-line arguments.
+ * \param argv          The command-line arguments.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status bench_options_parse(bench_options* options, int argc, char* argv[]);
+
+/**
+ * \brief Write a synthetic weight log.
+ *
+ * Entries start on 1900-01-01 and follow a random walk around 180.0.  The
+ * same options and seed always produce the same log.  A sorted log is
+ * written as it is generated; a shuffled log is generated in memory first,
+ * at eight bytes an entry.
+ *
+ * \param out           The stream to which the log is written.
+ * \param options       The generator options.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status bench_generate(FILE* out, const bench_options* options);
+
+/**
+ * \brief Benchmark the stages of rendering a log, and print the results.
+ *
+ * Reading, parsing, building the entry tree, averaging and plotting are each
+ * timed separately, over the given number of runs.  The results are printed
+ * to stdout as one line of "key=value" fields per stage, followed, if memory
+ * is counted, by one line per memory category that was allocated from.  The
+ * results are then checked against baselines, or written as baselines, if
+ * the options ask for it.
+ *
+ * \param options       The benchmark options.
+ * \param filename      The log to benchmark.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status bench_run(const bench_options* options, const char* filename);
+
+/**
+ * \brief Check the results of a benchmark against stored baselines.
+ *
+ * The baselines are lines of "key=value" fields: "time_tolerance" and
+ * "memory_tolerance" give the percentage by which a stage may exceed its
+ * baselines, and each "stage" line gives the "ns_per_entry" and
+ * "peak_bytes_per_entry" of a stage.  Blank lines and lines starting with '#'
+ * are skipped.  Each stage that exceeds its baselines by more than the
+ * tolerance is reported on stderr.
+ *
+ * \param options       The benchmark options, naming the baselines and the
+ *                      stage to check, if only one is.
+ * \param results       The results of each stage.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS if no stage regressed.
+ *      - ERROR_PERF_REGRESSION if a stage regressed.
+ *      - ERROR_READ_FAILED if the baselines can't be read.
+ *      - ERROR_BAD_ARGUMENTS if the baselines are malformed, or don't cover a
+ *        stage that is checked.
+ */
+status bench_baselines_check(
+    const bench_options* options, const bench_result* results);
+
+/**
+ * \brief Write the results of a benchmark as baselines.
+ *
+ * The baselines are written in the format read by
+ * \ref bench_baselines_check, with the default tolerances.
+ *
+ * \param filename      The file to write.
+ * \param results       The results of each stage.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_OUTPUT_FILE_OPEN if the file can't be created.
+ *      - ERROR_OUTPUT_WRITE if the file can't be written.
+ */
+status bench_baselines_write(const char* filename, const bench_result* results);
+
+/**
+ * \brief Get the time of a monotonic clock.
+ *
+ * \returns the time, in nanoseconds.
+ */
+uint64_t bench_now(void);
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+}
+# endif /*__cplusplus*/
@@ -0,0 +1,26 @@
+/**
+ * \file bench/bench_now.c
+ *
+ * \brief Read a monotonic clock.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <time.h>
+
+#include "bench_internal.h"
+
+/**
+ * \brief Get the time of a monotonic clock.
+ *
+ * \returns the time, in nanoseconds.
+ */
+uint64_t bench_now(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000 + (uint64_t)now.tv_nsec;
+}
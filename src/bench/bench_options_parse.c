@@ -0,0 +1,345 @@
+/**
+ * \file bench/bench_options_parse.c
+ *
+ * \brief Parse the command-line options for the benchmark.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench_internal.h"
+
+/**
+ * \brief The default number of entries in a generated log.
+ */
+#define BENCH_DEFAULT_ENTRIES 100000
+
+/**
+ * \brief The largest number of entries in a generated log.
+ */
+#define BENCH_MAX_ENTRIES 500000000
+
+/**
+ * \brief The default number of runs of each stage.
+ */
+#define BENCH_DEFAULT_RUNS 5
+
+/**
+ * \brief The default width and height of raster output, in pixels.
+ */
+#define BENCH_DEFAULT_RASTER_SIZE 600
+
+/**
+ * \brief The default number of entries plotted on each page.
+ */
+#define BENCH_DEFAULT_PAGE_SIZE 31
+
+/* forward decls. */
+static void bench_options_usage(const char* name);
+static bool bench_options_parse_count(const char* arg, size_t* count);
+static bool bench_options_parse_percent(const char* arg, unsigned* percent);
+
+/**
+ * \brief Parse the command-line options for the benchmark.
+ *
+ * \param options       The options structure to populate.
+ * \param argc          The number of command-line arguments.
+ * \param argv          The command-line arguments.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status bench_options_parse(bench_options* options, int argc, char* argv[])
+{
+    int ch;
+    long size;
+    char* end;
+
+    /* set defaults. */
+    memset(options, 0, sizeof(*options));
+    options->entries = BENCH_DEFAULT_ENTRIES;
+    options->seed = 1;
+    options->log_format = WEIGHTGRAPH_INPUT_XML;
+    options->runs = BENCH_DEFAULT_RUNS;
+    options->output_format = WEIGHTGRAPH_FORMAT_EPS;
+    options->raster_size = BENCH_DEFAULT_RASTER_SIZE;
+    options->page_size = BENCH_DEFAULT_PAGE_SIZE;
+
+    while (-1 != (ch = getopt(argc, argv, "B:D:f:G:gmn:o:p:r:S:s:t:W:xz:")))
+    {
+        switch (ch)
+        {
+            case 'B':
+                options->baselines_file = optarg;
+                break;
+
+            case 'D':
+                if (!bench_options_parse_percent(
+                        optarg, &options->duplicate_percent))
+                {
+                    fprintf(
+                        stderr, "Error: invalid percentage '%s'.\n", optarg);
+                    goto usage;
+                }
+                break;
+
+            case 'f':
+                if (!strcmp(optarg, "eps"))
+                {
+                    options->output_format = WEIGHTGRAPH_FORMAT_EPS;
+                }
+                else if (!strcmp(optarg, "png"))
+                {
+                    options->output_format = WEIGHTGRAPH_FORMAT_PNG;
+                }
+                else
+                {
+                    fprintf(stderr, "Error: unknown format '%s'.\n", optarg);
+                    goto usage;
+                }
+                break;
+
+            case 'G':
+                if (!bench_options_parse_percent(
+                        optarg, &options->gap_percent))
+                {
+                    fprintf(
+                        stderr, "Error: invalid percentage '%s'.\n", optarg);
+                    goto usage;
+                }
+                break;
+
+            case 'g':
+                options->generate = true;
+                break;
+
+            case 'm':
+                options->memory = true;
+                break;
+
+            case 'n':
+                if (!bench_options_parse_count(optarg, &options->entries))
+                {
+                    fprintf(
+                        stderr, "Error: invalid entry count '%s'.\n", optarg);
+                    goto usage;
+                }
+                break;
+
+            case 'o':
+                options->output_file = optarg;
+                break;
+
+            case 'p':
+                size = strtol(optarg, &end, 10);
+                if (0 != *end || size < 1 || size > 100000)
+                {
+                    fprintf(
+                        stderr, "Error: invalid page size '%s'.\n", optarg);
+                    goto usage;
+                }
+                options->page_size = (size_t)size;
+                break;
+
+            case 'r':
+                size = strtol(optarg, &end, 10);
+                if (0 != *end || size < 1 || size > 1000)
+                {
+                    fprintf(
+                        stderr, "Error: invalid run count '%s'.\n", optarg);
+                    goto usage;
+                }
+                options->runs = (size_t)size;
+                break;
+
+            case 'S':
+                options->check_stage = optarg;
+                break;
+
+            case 's':
+                size = strtol(optarg, &end, 10);
+                if (0 != *end || size < 1 || size > 16384)
+                {
+                    fprintf(stderr, "Error: invalid size '%s'.\n", optarg);
+                    goto usage;
+                }
+                options->raster_size = (size_t)size;
+                break;
+
+            case 't':
+                if (!strcmp(optarg, "xml"))
+                {
+                    options->log_format = WEIGHTGRAPH_INPUT_XML;
+                }
+                else if (!strcmp(optarg, "csv"))
+                {
+                    options->log_format = WEIGHTGRAPH_INPUT_CSV;
+                }
+                else if (!strcmp(optarg, "ndjson"))
+                {
+                    options->log_format = WEIGHTGRAPH_INPUT_NDJSON;
+                }
+                else
+                {
+                    fprintf(
+                        stderr, "Error: unknown log format '%s'.\n", optarg);
+                    goto usage;
+                }
+                break;
+
+            case 'W':
+                options->baselines_output = optarg;
+                break;
+
+            case 'x':
+                options->shuffled = true;
+                break;
+
+            case 'z':
+                options->seed = strtoull(optarg, &end, 10);
+                if (0 == *optarg || 0 != *end)
+                {
+                    fprintf(stderr, "Error: invalid seed '%s'.\n", optarg);
+                    goto usage;
+                }
+                break;
+
+            default:
+                goto usage;
+        }
+    }
+
+    /* a generated log is written to the output, or stdout. */
+    if (options->generate)
+    {
+        if (optind < argc)
+        {
+            fprintf(stderr, "Error: -g doesn't take an input.\n");
+            goto usage;
+        }
+
+        return STATUS_SUCCESS;
+    }
+
+    /* a benchmark runs over the input, or over a generated log. */
+    if (NULL != options->output_file || optind + 1 < argc)
+    {
+        fprintf(stderr, "Error: expecting at most one input and no -o.\n");
+        goto usage;
+    }
+
+    if (optind < argc)
+    {
+        options->input_file = argv[optind];
+    }
+
+    if (NULL != options->check_stage && NULL == options->baselines_file)
+    {
+        fprintf(stderr, "Error: -S requires -B.\n");
+        goto usage;
+    }
+
+    /* baselines include the peak memory of each stage. */
+    if (NULL != options->baselines_file || NULL != options->baselines_output)
+    {
+        options->memory = true;
+    }
+
+    return STATUS_SUCCESS;
+
+usage:
+    bench_options_usage(argv[0]);
+    return ERROR_BAD_ARGUMENTS;
+}
+
+/**
+ * \brief Print usage information.
+ *
+ * \param name          The name of the program.
+ */
+static void bench_options_usage(const char* name)
+{
+    fprintf(
+        stderr,
+        "Usage: %s -g [-n entries] [-x] [-G percent] [-D percent] [-z seed]\n"
+        "           [-t xml|csv|ndjson] [-o output]\n"
+        "       %s [-n entries] [-x] [-G percent] [-D percent] [-z seed]\n"
+        "           [-t xml|csv|ndjson] [-r runs] [-f eps|png] "
+        "[-p entries] [-s pixels]\n"
+        "           [-m] [-B baselines [-S stage]] [-W baselines] [input]\n",
+        name, name);
+}
+
+/**
+ * \brief Parse an entry count, with an optional k or m suffix.
+ *
+ * \param arg           The argument to parse.
+ * \param count         Pointer to receive the count.
+ *
+ * \returns true if the count is valid.
+ */
+static bool bench_options_parse_count(const char* arg, size_t* count)
+{
+    unsigned long long value;
+    char* end;
+
+    if (*arg < '0' || *arg > '9')
+    {
+        return false;
+    }
+
+    value = strtoull(arg, &end, 10);
+    if (value > BENCH_MAX_ENTRIES)
+    {
+        return false;
+    }
+
+    if ('k' == *end || 'K' == *end)
+    {
+        value *= 1000;
+        ++end;
+    }
+    else if ('m' == *end || 'M' == *end)
+    {
+        value *= 1000000;
+        ++end;
+    }
+
+    if (0 != *end || value < 1 || value > BENCH_MAX_ENTRIES)
+    {
+        return false;
+    }
+
+    *count = (size_t)value;
+
+    return true;
+}
+
+/**
+ * \brief Parse a percentage from 0 to 100.
+ *
+ * \param arg           The argument to parse.
+ * \param percent       Pointer to receive the percentage.
+ *
+ * \returns true if the percentage is valid.
+ */
+static bool bench_options_parse_percent(const char* arg, unsigned* percent)
+{
+    long value;
+    char* end;
+
+    value = strtol(arg, &end, 10);
+    if (0 == *arg || 0 != *end || value < 0 || value > 100)
+    {
+        return false;
+    }
+
+    *percent = (unsigned)value;
+
+    return true;
+}
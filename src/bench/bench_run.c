@@ -0,0 +1,680 @@
+/**
+ * \file bench/bench_run.c
+ *
+ * \brief Benchmark the stages of rendering a log.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_rbtree;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief A parsed entry, with its date in the date arena.
+ */
+typedef struct bench_sample bench_sample;
+
+struct bench_sample
+{
+    size_t date;
+    double weight;
+};
+
+/**
+ * \brief The entries parsed from a log, ready to be built into a tree.
+ */
+typedef struct bench_samples bench_samples;
+
+struct bench_samples
+{
+    double initial_average;
+    bench_sample* samples;
+    size_t count;
+    size_t capacity;
+    /* the terminated dates of every sample, back to back. */
+    char* dates;
+    size_t dates_size;
+    size_t dates_capacity;
+};
+
+/**
+ * \brief The state shared by the runs of a benchmark.
+ */
+typedef struct bench_context bench_context;
+
+struct bench_context
+{
+    const char* filename;
+    allocator* alloc;
+    weightgraph_parser* parser;
+    weightgraph_stream_handler handler;
+    weightgraph_render_options render_options;
+    weightgraph_sink sink;
+    bench_samples set;
+    /* the size of the log, and of the graph. */
+    size_t size;
+    size_t output_size;
+    /* true if the memory allocated by the library is counted. */
+    bool memory;
+    /* the most memory allocated at once by each stage, over every run. */
+    uint64_t stage_peaks[BENCH_STAGE_COUNT];
+    /* the most memory allocated at once in each category, and in total. */
+    uint64_t category_peaks[WEIGHTGRAPH_MEMORY_CATEGORY_COUNT + 1];
+};
+
+/* forward decls. */
+static status bench_run_once(bench_context* ctx, uint64_t* times);
+static uint64_t bench_memory_mark(const bench_context* ctx);
+static void bench_memory_peak(bench_context* ctx, int stage, uint64_t live);
+static status bench_samples_average(void* context, double average);
+static status bench_samples_log(
+    void* context, const char* date, double weight);
+static status bench_tree_build(weightgraph* graph, const bench_samples* set);
+static status bench_sink_open(void* context, size_t page, long offset);
+static status bench_sink_write(void* context, const void* data, size_t size);
+static status bench_sink_close(void* context);
+static int bench_time_compare(const void* lhs, const void* rhs);
+static void bench_report(
+    const bench_options* options, const bench_context* ctx, uint64_t* times,
+    bench_result* results);
+
+/**
+ * \brief Benchmark the stages of rendering a log, and print the results.
+ *
+ * Reading, parsing, building the entry tree, averaging and plotting are each
+ * timed separately, over the given number of runs.  The results are printed
+ * to stdout as one line of "key=value" fields per stage, followed, if memory
+ * is counted, by one line per memory category that was allocated from.  The
+ * results are then checked against baselines, or written as baselines, if
+ * the options ask for it.
+ *
+ * \param options       The benchmark options.
+ * \param filename      The log to benchmark.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status bench_run(const bench_options* options, const char* filename)
+{
+    status retval, release_retval;
+    bench_context ctx;
+    bench_result results[BENCH_STAGE_COUNT];
+    uint64_t* times;
+
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.filename = filename;
+    ctx.memory = options->memory;
+
+    /* counting must start before the library allocates anything. */
+    if (ctx.memory)
+    {
+        weightgraph_memory_stats_enable();
+    }
+
+    /* the time of each run, grouped by stage. */
+    times =
+        (uint64_t*)calloc(BENCH_STAGE_COUNT * options->runs, sizeof(*times));
+    if (NULL == times)
+    {
+        retval = ERROR_GENERAL_OUT_OF_MEMORY;
+        goto done;
+    }
+
+    retval = malloc_allocator_create(&ctx.alloc);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_times;
+    }
+
+    retval = weightgraph_parser_create(&ctx.parser, ctx.alloc);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_allocator;
+    }
+
+    weightgraph_parser_set_format(
+        ctx.parser, weightgraph_input_format_from_name(filename));
+
+    ctx.handler.context = &ctx.set;
+    ctx.handler.beginning_average = &bench_samples_average;
+    ctx.handler.log = &bench_samples_log;
+
+    ctx.render_options.format = options->output_format;
+    ctx.render_options.raster_size = options->raster_size;
+    ctx.render_options.page_size = options->page_size;
+    ctx.render_options.threads = 1;
+
+    ctx.sink.context = &ctx.output_size;
+    ctx.sink.open = &bench_sink_open;
+    ctx.sink.write = &bench_sink_write;
+    ctx.sink.close = &bench_sink_close;
+
+    for (size_t run = 0; run < options->runs; ++run)
+    {
+        uint64_t run_times[BENCH_STAGE_COUNT];
+
+        retval = bench_run_once(&ctx, run_times);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_parser;
+        }
+
+        for (size_t stage = 0; stage < BENCH_STAGE_COUNT; ++stage)
+        {
+            times[stage * options->runs + run] = run_times[stage];
+        }
+    }
+
+    bench_report(options, &ctx, times, results);
+
+    if (NULL != options->baselines_output)
+    {
+        retval = bench_baselines_write(options->baselines_output, results);
+        if (STATUS_SUCCESS != retval)
+        {
+            fprintf(
+                stderr, "Error writing baselines to %s.\n",
+                options->baselines_output);
+            goto cleanup_parser;
+        }
+    }
+
+    if (NULL != options->baselines_file)
+    {
+        retval = bench_baselines_check(options, results);
+        goto cleanup_parser;
+    }
+
+    retval = STATUS_SUCCESS;
+    goto cleanup_parser;
+
+cleanup_parser:
+    release_retval =
+        resource_release(weightgraph_parser_resource_handle(ctx.parser));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_allocator:
+    release_retval = resource_release(allocator_resource_handle(ctx.alloc));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_times:
+    free(times);
+    free(ctx.set.samples);
+    free(ctx.set.dates);
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Run and time each stage once.
+ *
+ * \param ctx           The benchmark state.
+ * \param times         Array to receive the time of each stage.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status bench_run_once(bench_context* ctx, uint64_t* times)
+{
+    status retval, release_retval;
+    weightgraph* graph;
+    weightgraph_session* session;
+    uint8_t* buffer;
+    uint64_t start, stop, live;
+
+    /* read the log into memory. */
+    live = bench_memory_mark(ctx);
+    start = bench_now();
+    retval = main_read_file(&buffer, &ctx->size, ctx->filename);
+    if (STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Error reading input file.\n");
+        goto done;
+    }
+    stop = bench_now();
+    times[BENCH_STAGE_READ] = stop - start;
+    bench_memory_peak(ctx, BENCH_STAGE_READ, live);
+
+    /* parse it into a flat array of entries. */
+    ctx->set.initial_average = 0.0;
+    ctx->set.count = 0;
+    ctx->set.dates_size = 0;
+    live = bench_memory_mark(ctx);
+    start = bench_now();
+    retval = weightgraph_parser_stream_begin(ctx->parser, &ctx->handler);
+    if (STATUS_SUCCESS == retval)
+    {
+        retval =
+            weightgraph_parser_stream(ctx->parser, buffer, ctx->size, true);
+    }
+    free(buffer);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+    stop = bench_now();
+    times[BENCH_STAGE_PARSE] = stop - start;
+    bench_memory_peak(ctx, BENCH_STAGE_PARSE, live);
+
+    /* build the entry tree, as the parser does. */
+    live = bench_memory_mark(ctx);
+    start = bench_now();
+    retval = weightgraph_create(&graph, ctx->alloc, ctx->set.initial_average);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    retval = bench_tree_build(graph, &ctx->set);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_graph;
+    }
+    stop = bench_now();
+    times[BENCH_STAGE_TREE] = stop - start;
+    bench_memory_peak(ctx, BENCH_STAGE_TREE, live);
+
+    /* compute the moving averages in date order. */
+    live = bench_memory_mark(ctx);
+    start = bench_now();
+    retval =
+        weightgraph_session_create(
+            &session, ctx->alloc, graph->initial_average);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_graph;
+    }
+
+    retval = main_push_entries(session, graph);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_session;
+    }
+    stop = bench_now();
+    times[BENCH_STAGE_AVERAGE] = stop - start;
+    bench_memory_peak(ctx, BENCH_STAGE_AVERAGE, live);
+
+    /* plot the graph, discarding the output. */
+    ctx->output_size = 0;
+    live = bench_memory_mark(ctx);
+    start = bench_now();
+    retval =
+        weightgraph_session_render(
+            session, &ctx->render_options, &ctx->sink, NULL);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_session;
+    }
+    stop = bench_now();
+    times[BENCH_STAGE_PLOT] = stop - start;
+    bench_memory_peak(ctx, BENCH_STAGE_PLOT, live);
+
+    /* success. */
+    retval = STATUS_SUCCESS;
+    goto cleanup_session;
+
+cleanup_session:
+    release_retval =
+        resource_release(weightgraph_session_resource_handle(session));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_graph:
+    release_retval = resource_release(&graph->hdr);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Start measuring the memory allocated by a stage.
+ *
+ * \param ctx           The benchmark state.
+ *
+ * \returns the bytes the library has live before the stage, or zero if
+ * memory isn't counted.
+ */
+static uint64_t bench_memory_mark(const bench_context* ctx)
+{
+    weightgraph_memory_stats memory;
+
+    if (!ctx->memory)
+    {
+        return 0;
+    }
+
+    weightgraph_memory_stats_reset_peak();
+    weightgraph_memory_stats_read(&memory, WEIGHTGRAPH_MEMORY_CATEGORY_COUNT);
+
+    return memory.live_bytes;
+}
+
+/**
+ * \brief Record the most memory allocated at once by a stage.
+ *
+ * The peak of each category is also folded into the peaks over every stage,
+ * as each stage resets them.
+ *
+ * \param ctx           The benchmark state.
+ * \param stage         The stage that just finished.
+ * \param live          The bytes the library had live before the stage.
+ */
+static void bench_memory_peak(bench_context* ctx, int stage, uint64_t live)
+{
+    if (!ctx->memory)
+    {
+        return;
+    }
+
+    for (int i = 0; i <= WEIGHTGRAPH_MEMORY_CATEGORY_COUNT; ++i)
+    {
+        weightgraph_memory_stats memory;
+
+        weightgraph_memory_stats_read(&memory, i);
+        if (memory.peak_bytes > ctx->category_peaks[i])
+        {
+            ctx->category_peaks[i] = memory.peak_bytes;
+        }
+
+        /* the total gives the peak of the stage, above what it began with. */
+        if (WEIGHTGRAPH_MEMORY_CATEGORY_COUNT == i
+            && memory.peak_bytes > live
+            && memory.peak_bytes - live > ctx->stage_peaks[stage])
+        {
+            ctx->stage_peaks[stage] = memory.peak_bytes - live;
+        }
+    }
+}
+
+/**
+ * \brief Record the initial moving average of the log.
+ *
+ * \param context       The parsed entries.
+ * \param average       The initial moving average.
+ *
+ * \returns STATUS_SUCCESS.
+ */
+static status bench_samples_average(void* context, double average)
+{
+    bench_samples* set = (bench_samples*)context;
+
+    set->initial_average = average;
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Append a parsed entry.
+ *
+ * \param context       The parsed entries.
+ * \param date          The date of the entry.
+ * \param weight        The weight of the entry.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if the entry can't be stored.
+ */
+static status bench_samples_log(
+    void* context, const char* date, double weight)
+{
+    bench_samples* set = (bench_samples*)context;
+    size_t date_size = strlen(date) + 1;
+
+    /* grow the entries and the date arena as needed. */
+    if (set->count == set->capacity)
+    {
+        size_t capacity = (0 == set->capacity) ? 1024 : 2 * set->capacity;
+        void* samples =
+            realloc(set->samples, capacity * sizeof(bench_sample));
+
+        if (NULL == samples)
+        {
+            return ERROR_GENERAL_OUT_OF_MEMORY;
+        }
+
+        set->samples = (bench_sample*)samples;
+        set->capacity = capacity;
+    }
+
+    if (set->dates_size + date_size > set->dates_capacity)
+    {
+        size_t capacity =
+            (0 == set->dates_capacity) ? 16384 : 2 * set->dates_capacity;
+        void* dates = realloc(set->dates, capacity);
+
+        if (NULL == dates)
+        {
+            return ERROR_GENERAL_OUT_OF_MEMORY;
+        }
+
+        set->dates = (char*)dates;
+        set->dates_capacity = capacity;
+    }
+
+    memcpy(set->dates + set->dates_size, date, date_size);
+    set->samples[set->count].date = set->dates_size;
+    set->samples[set->count].weight = weight;
+    set->dates_size += date_size;
+    ++set->count;
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Build the entry tree of the parsed entries.
+ *
+ * \param graph         The AST to which the entries are added.
+ * \param set           The parsed entries.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status bench_tree_build(weightgraph* graph, const bench_samples* set)
+{
+    status retval;
+    weightgraph_entry* entry;
+
+    for (size_t i = 0; i < set->count; ++i)
+    {
+        const bench_sample* sample = &set->samples[i];
+
+        retval =
+            weightgraph_entry_create(
+                &entry, graph->alloc, set->dates + sample->date,
+                sample->weight);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        /* like the parser, drop an entry that can't be added. */
+        retval = rbtree_insert(graph->entries, &entry->hdr);
+        if (STATUS_SUCCESS != retval)
+        {
+            resource_release(&entry->hdr);
+            continue;
+        }
+
+        if (0 == graph->entry_count || entry->weight < graph->min_weight)
+        {
+            graph->min_weight = entry->weight;
+        }
+        if (0 == graph->entry_count || entry->weight > graph->max_weight)
+        {
+            graph->max_weight = entry->weight;
+        }
+        ++graph->entry_count;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Start an output that is discarded.
+ *
+ * \param context       The output size.
+ * \param page          The page number.
+ * \param offset        The offset at which to continue.
+ *
+ * \returns STATUS_SUCCESS.
+ */
+static status bench_sink_open(void* context, size_t page, long offset)
+{
+    (void)context;
+    (void)page;
+    (void)offset;
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Count the bytes of output, and discard them.
+ *
+ * \param context       The output size.
+ * \param data          The data.
+ * \param size          The size of the data.
+ *
+ * \returns STATUS_SUCCESS.
+ */
+static status bench_sink_write(void* context, const void* data, size_t size)
+{
+    (void)data;
+
+    *(size_t*)context += size;
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Finish an output that is discarded.
+ *
+ * \param context       The output size.
+ *
+ * \returns STATUS_SUCCESS.
+ */
+static status bench_sink_close(void* context)
+{
+    (void)context;
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Compare two times, for sorting.
+ *
+ * \param lhs           The left-hand side.
+ * \param rhs           The right-hand side.
+ *
+ * \returns less than, equal to, or greater than zero.
+ */
+static int bench_time_compare(const void* lhs, const void* rhs)
+{
+    uint64_t l = *(const uint64_t*)lhs;
+    uint64_t r = *(const uint64_t*)rhs;
+
+    return (l > r) - (l < r);
+}
+
+/**
+ * \brief Print the results of the benchmark.
+ *
+ * \param options       The benchmark options.
+ * \param ctx           The benchmark state.
+ * \param times         The time of each run, grouped by stage.
+ * \param results       Array to receive the results of each stage.
+ */
+static void bench_report(
+    const bench_options* options, const bench_context* ctx, uint64_t* times,
+    bench_result* results)
+{
+    static const char* names[BENCH_STAGE_COUNT] = {
+        "read", "parse", "tree", "average", "plot" };
+    size_t entries = ctx->set.count;
+    double per_entry = (0 == entries) ? 0.0 : 1.0 / (double)entries;
+
+    printf(
+        "log=%s bytes=%zu entries=%zu runs=%zu output_bytes=%zu\n",
+        ctx->filename, ctx->size, entries, options->runs, ctx->output_size);
+
+    for (size_t stage = 0; stage < BENCH_STAGE_COUNT; ++stage)
+    {
+        uint64_t* stage_times = times + stage * options->runs;
+        uint64_t median;
+
+        qsort(
+            stage_times, options->runs, sizeof(uint64_t), &bench_time_compare);
+        median = stage_times[options->runs / 2];
+
+        results[stage].stage = names[stage];
+        results[stage].ns_per_entry = (double)median * per_entry;
+        results[stage].peak_bytes_per_entry =
+            (double)ctx->stage_peaks[stage] * per_entry;
+
+        printf(
+            "stage=%s min_ns=%llu median_ns=%llu max_ns=%llu "
+            "ns_per_entry=%.1f",
+            names[stage], (unsigned long long)stage_times[0],
+            (unsigned long long)median,
+            (unsigned long long)stage_times[options->runs - 1],
+            results[stage].ns_per_entry);
+
+        if (options->memory)
+        {
+            printf(
+                " peak_bytes=%llu peak_bytes_per_entry=%.1f",
+                (unsigned long long)ctx->stage_peaks[stage],
+                results[stage].peak_bytes_per_entry);
+        }
+
+        printf("\n");
+    }
+
+    if (!options->memory)
+    {
+        return;
+    }
+
+    /* everything but the parser is released after each run, so the peak
+     * is that of a single run. */
+    for (int i = 0; i < WEIGHTGRAPH_MEMORY_CATEGORY_COUNT; ++i)
+    {
+        weightgraph_memory_stats memory;
+
+        weightgraph_memory_stats_read(&memory, i);
+        if (0 == memory.allocations)
+        {
+            continue;
+        }
+
+        printf(
+            "memory=%s allocations_per_run=%.1f peak_bytes=%llu "
+            "peak_bytes_per_entry=%.1f\n",
+            weightgraph_memory_category_name(i),
+            (double)memory.allocations / (double)options->runs,
+            (unsigned long long)ctx->category_peaks[i],
+            (double)ctx->category_peaks[i] * per_entry);
+    }
+}
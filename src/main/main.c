@@ -7,39 +7,100 @@
  * distribution for the license terms under which this software is distributed.
  */
 
-#include <expat.h>
 #include <stdint.h>
 #include <stdio.h>
-#include <sys/stat.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "main_internal.h"
 
 RCPR_IMPORT_allocator;
-RCPR_IMPORT_rbtree;
 RCPR_IMPORT_resource;
 
+/* forward decls. */
+static bool main_checkpoint_matches(
+    const main_checkpoint* checkpoint, const main_options* options,
+    const weightgraph_session* session);
+static uint64_t main_history_digest(
+    const weightgraph_session* session, size_t count);
+static status main_save_checkpoint(
+    const main_options* options, const weightgraph_session* session,
+    const weightgraph_render_state* state);
+
 int main(int argc, char* argv[])
 {
     status retval, release_retval;
-    uint8_t* buffer;
-    size_t size;
-    weightgraph* graph;
+    main_options options;
+    weightgraph_render_options render_options;
+    weightgraph_render_state state;
+    main_checkpoint checkpoint;
+    main_file_sink file;
+    weightgraph_sink sink;
+    weightgraph_session* session;
+    weightgraph_session* rollup;
+    weightgraph_session* graph;
     allocator* alloc;
-    output_graph_file* out;
-    rbtree_node* tmp;
-    rbtree_node* nil;
-    double moving_average;
-    double average_array[10];
-    int index = 0;
+    uint64_t trace_start;
 
-    /* verify that there is a command-line argument: the filename. */
-    if (argc <= 1)
+    /* parse the command-line options. */
+    retval = main_options_parse(&options, argc, argv);
+    if (STATUS_SUCCESS != retval)
     {
-        fprintf(stderr, "Error: expecting one argument -- the input file.\n");
         retval = 1;
         goto done;
     }
 
+    /* gather statistics if requested. */
+    if (MAIN_STATS_OFF != options.stats_format)
+    {
+        main_stats_enable(options.stats_format);
+    }
+
+    /* trace the run if the environment asks for it. */
+    main_trace_enable();
+
+    /* convert the log to an archive instead of rendering it. */
+    if (options.archive)
+    {
+        retval = main_archive_convert(&options);
+        goto done;
+    }
+
+    /* render a batch of logs instead of a single log. */
+    if (options.batch)
+    {
+        retval = main_batch_run(&options);
+        goto done;
+    }
+
+    /* serve render requests instead of rendering a single log. */
+    if (NULL != options.socket_file)
+    {
+        retval = main_daemon_run(&options);
+        goto done;
+    }
+
+    /* keep the output up to date with the input. */
+    if (options.watch)
+    {
+        retval = main_watch_run(&options);
+        goto done;
+    }
+
+    /* render the log as it is parsed. */
+    if (options.streaming)
+    {
+        retval = main_stream_render(&options);
+        goto done;
+    }
+
+    /* sort the log in runs, outside of memory. */
+    if (0 != options.sort_budget)
+    {
+        retval = main_sort_render(&options);
+        goto done;
+    }
+
     /* attempt to create the allocator. */
     retval = malloc_allocator_create(&alloc);
     if (STATUS_SUCCESS != retval)
@@ -48,111 +109,141 @@ int main(int argc, char* argv[])
         goto done;
     }
 
-    /* attempt to read the input file into a buffer. */
-    retval = main_read_file(&buffer, &size, argv[1]);
-    if (STATUS_SUCCESS != retval)
+    /* load the logs onto a session. */
+    if (options.input_count > 1)
     {
-        fprintf(stderr, "Error reading input file.\n");
-        goto cleanup_allocator;
+        main_stats_phase(MAIN_STATS_PHASE_LOAD);
+        retval = main_merge_load(&session, alloc, &options);
+    }
+    else if (options.pipelined)
+    {
+        main_stats_phase(MAIN_STATS_PHASE_LOAD);
+        retval = main_pipeline_load(&session, alloc, &options);
+    }
+    else
+    {
+        retval = main_load(&session, alloc, &options);
+    }
+    if (ERROR_OUT_OF_ORDER == retval)
+    {
+        fprintf(stderr, "Error: log entries are not in date order.\n");
     }
-
-    /* parse the XML file into a tree of values and a set of initial values. */
-    retval = main_parse_buffer(&graph, alloc, buffer, size);
     if (STATUS_SUCCESS != retval)
     {
-        goto cleanup_buffer;
+        goto cleanup_allocator;
     }
 
-    /* start the moving average with the initial average. */
-    moving_average = graph->initial_average;
-    /* build the initial average array. */
-    for (int i = 0; i < 10; ++i)
+    /* a merged or pipelined load counts its entries once they land. */
+    if (options.input_count > 1 || options.pipelined)
     {
-        average_array[i] = moving_average;
+        main_stats_count_entries(weightgraph_session_count(session));
     }
 
-    /* create the output graph file, and write the initial values. */
-    retval = output_graph_create(&out, alloc, "output.eps", moving_average);
-    if (STATUS_SUCCESS != retval)
+    /* roll the entries up into calendar periods, which are graphed in their
+     * place. */
+    graph = session;
+    if (WEIGHTGRAPH_PERIOD_DAY != options.period)
     {
-        goto cleanup_graph;
+        main_stats_phase(MAIN_STATS_PHASE_ROLLUP);
+        trace_start = main_trace_begin();
+        retval =
+            weightgraph_session_rollup(
+                &rollup, alloc, session, options.period, options.threads);
+        main_trace_end(
+            "rollup", trace_start, weightgraph_session_count(session));
+        if (ERROR_ROLLUP_DATE == retval)
+        {
+            fprintf(
+                stderr,
+                "Error: dates must all be YYYY-MM-DD, or all MM/DD, to be "
+                "rolled up.\n");
+        }
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_session;
+        }
+
+        graph = rollup;
     }
 
-    /* get the nil node for the entry tree. */
-    nil = rbtree_nil_node(graph->entries);
+    /* set up the rendering options. */
+    memset(&render_options, 0, sizeof(render_options));
+    render_options.format = options.output_format;
+    render_options.raster_size = options.raster_size;
+    render_options.page_size = options.page_size;
+    render_options.threads = options.threads;
+    render_options.appendable = (NULL != options.checkpoint_file);
 
-    /* for each date, compute the new moving average, and update the graph. */
-    tmp = rbtree_root_node(graph->entries);
-    if (nil != tmp)
+    /* resume from a checkpoint that still describes this log. */
+    if (NULL != options.checkpoint_file)
     {
-        /* get the minimum node for the tree. */
-        tmp = rbtree_minimum_node(graph->entries, tmp);
-
-        /* while this node is not NULL, walk the tree. */
-        while (nil != tmp)
+        main_stats_phase(MAIN_STATS_PHASE_CHECKPOINT);
+        if (STATUS_SUCCESS ==
+                main_checkpoint_read(&checkpoint, options.checkpoint_file)
+         && main_checkpoint_matches(&checkpoint, &options, graph))
         {
-            /* get the entry. */
-            weightgraph_entry* entry =
-                (weightgraph_entry*)rbtree_node_value(graph->entries, tmp);
-
-            /* compute the updated moving average. */
-            average_array[index] = entry->weight;
-            ++index;
-            if (index >= 10)
-            {
-                index = 0;
-            }
-            moving_average = 0;
-            for (int i = 0; i < 10; ++i)
-            {
-                moving_average += average_array[i] * 0.1;
-            }
-
-            /* plot this entry. */
-            retval =
-                output_graph_plot(
-                    out, entry->date, entry->weight, moving_average);
-            if (STATUS_SUCCESS != retval)
-            {
-                goto cleanup_file;
-            }
-
-            /* get the next node in the tree. */
-            tmp = rbtree_successor_node(graph->entries, tmp);
+            render_options.resume = &checkpoint.state;
         }
     }
 
-    /* write the final data to the graph. */
-    retval = output_graph_finalize(out);
+    /* render the graph to the output file. */
+    main_stats_phase(MAIN_STATS_PHASE_RENDER);
+    main_file_sink_init(&sink, &file, options.output_file);
+    trace_start = main_trace_begin();
+    retval = weightgraph_session_render(graph, &render_options, &sink, &state);
+    if (ERROR_CHECKPOINT_STALE == retval)
+    {
+        /* the checkpoint can't be used, so render the whole graph. */
+        render_options.resume = NULL;
+        retval =
+            weightgraph_session_render(
+                graph, &render_options, &sink, &state);
+    }
+    main_trace_end("render", trace_start, weightgraph_session_count(graph));
     if (STATUS_SUCCESS != retval)
     {
-        goto cleanup_file;
+        goto cleanup_rollup;
+    }
+
+    /* save the point from which the next run can resume. */
+    if (NULL != options.checkpoint_file)
+    {
+        main_stats_phase(MAIN_STATS_PHASE_CHECKPOINT);
+        retval = main_save_checkpoint(&options, graph, &state);
+        if (STATUS_SUCCESS != retval)
+        {
+            fprintf(stderr, "Error writing checkpoint file.\n");
+            goto cleanup_rollup;
+        }
     }
 
     /* output the new moving average. */
-    printf("Final moving average: %lf\n", moving_average);
+    printf(
+        "Final moving average: %lf\n", weightgraph_session_average(graph));
 
     /* success. */
     retval = STATUS_SUCCESS;
-    goto cleanup_file;
+    goto cleanup_rollup;
 
-cleanup_file:
-    release_retval = resource_release(&out->hdr);
-    if (STATUS_SUCCESS != release_retval)
+cleanup_rollup:
+    if (graph != session)
     {
-        retval = release_retval;
+        release_retval =
+            resource_release(weightgraph_session_resource_handle(graph));
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
     }
 
-cleanup_graph:
-    release_retval = resource_release(&graph->hdr);
+cleanup_session:
+    release_retval =
+        resource_release(weightgraph_session_resource_handle(session));
     if (STATUS_SUCCESS != release_retval)
     {
         retval = release_retval;
     }
 
-cleanup_buffer:
-    free(buffer);
-
 cleanup_allocator:
     release_retval = resource_release(allocator_resource_handle(alloc));
     if (STATUS_SUCCESS != release_retval)
@@ -161,5 +252,129 @@ cleanup_allocator:
     }
 
 done:
+    main_stats_report();
+    main_trace_flush();
     return retval;
 }
+
+/**
+ * \brief Determine whether a checkpoint was written for the given log.
+ *
+ * The checkpoint must have been written with the same rendering options,
+ * and the log must still contain the entries rendered so far, unchanged, so
+ * that only entries have been appended since.
+ *
+ * \param checkpoint    The checkpoint.
+ * \param options       The command-line options.
+ * \param session       The session holding the entries of the log.
+ *
+ * \returns true if rendering can resume from this checkpoint.
+ */
+static bool main_checkpoint_matches(
+    const main_checkpoint* checkpoint, const main_options* options,
+    const weightgraph_session* session)
+{
+    size_t count = checkpoint->state.count;
+    double window[WEIGHTGRAPH_AVERAGE_WINDOW];
+    int next;
+
+    if (checkpoint->format != options->output_format
+     || checkpoint->page_size != options->page_size
+     || checkpoint->raster_size != options->raster_size
+     || checkpoint->initial_average
+            != weightgraph_session_initial_average(session)
+     || count > weightgraph_session_count(session))
+    {
+        return false;
+    }
+
+    /* the averaging state must carry on from the checkpoint. */
+    weightgraph_session_window(session, count, window, &next);
+    if (next != checkpoint->average_index
+     || memcmp(window, checkpoint->average_array, sizeof(window)))
+    {
+        return false;
+    }
+
+    return checkpoint->digest == main_history_digest(session, count);
+}
+
+/**
+ * \brief Compute a digest of the dates, weights and rejections of a run of
+ * samples.
+ *
+ * This is a 64-bit FNV-1a hash, which is cheap to compute relative to
+ * rendering, and catches entries that were edited after being rendered.
+ *
+ * \param session       The session holding the samples.
+ * \param count         The number of samples to digest.
+ *
+ * \returns the digest.
+ */
+static uint64_t main_history_digest(
+    const weightgraph_session* session, size_t count)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        weightgraph_sample sample;
+        const uint8_t* date;
+        const uint8_t* weight = (const uint8_t*)&sample.weight;
+
+        weightgraph_session_sample(session, i, &sample);
+        date = (const uint8_t*)sample.date;
+
+        /* hash the date, including its terminator. */
+        do
+        {
+            hash = (hash ^ *date) * 0x100000001b3ULL;
+        } while (0 != *date++);
+
+        /* hash the weight. */
+        for (size_t j = 0; j < sizeof(sample.weight); ++j)
+        {
+            hash = (hash ^ weight[j]) * 0x100000001b3ULL;
+        }
+
+        /* a rejected sample was drawn differently. */
+        if (sample.rejected)
+        {
+            hash = (hash ^ 0xff) * 0x100000001b3ULL;
+        }
+    }
+
+    return hash;
+}
+
+/**
+ * \brief Save a checkpoint for the point from which the graph can resume.
+ *
+ * \param options       The command-line options.
+ * \param session       The session holding the entries of the log.
+ * \param state         The resume point of the rendered graph.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_save_checkpoint(
+    const main_options* options, const weightgraph_session* session,
+    const weightgraph_render_state* state)
+{
+    main_checkpoint checkpoint;
+
+    memset(&checkpoint, 0, sizeof(checkpoint));
+    checkpoint.format = options->output_format;
+    checkpoint.page_size = options->page_size;
+    checkpoint.raster_size = options->raster_size;
+    checkpoint.initial_average = weightgraph_session_initial_average(session);
+    checkpoint.state = *state;
+    checkpoint.digest = main_history_digest(session, state->count);
+
+    weightgraph_session_window(
+        session, state->count, checkpoint.average_array,
+        &checkpoint.average_index);
+
+    return main_checkpoint_write(&checkpoint, options->checkpoint_file);
+}
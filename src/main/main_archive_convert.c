@@ -0,0 +1,229 @@
+/**
+ * \file main/main_archive_convert.c
+ *
+ * \brief Convert a log to an archive.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <stdlib.h>
+
+#include "main_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief The size of each piece of the log that is read and parsed.
+ */
+#define MAIN_ARCHIVE_CHUNK_SIZE 65536
+
+/**
+ * \brief The state of a conversion.
+ */
+typedef struct main_archive_context main_archive_context;
+
+struct main_archive_context
+{
+    weightgraph_archive_writer* writer;
+    size_t count;
+};
+
+/* forward decls. */
+static status main_archive_average(void* context, double average);
+static status main_archive_log(void* context, const char* date, double weight);
+
+/**
+ * \brief Convert a log to an archive.
+ *
+ * The log is streamed through the parser a piece at a time, and each entry
+ * is passed straight to an archive writer, which writes the archive a block
+ * at a time.  Entries are archived in the order of the log.
+ *
+ * \param options       The command-line options.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_ARCHIVE_ENCODE if an entry can't be stored in an archive.
+ *      - a non-zero error code on failure.
+ */
+status main_archive_convert(const main_options* options)
+{
+    status retval, release_retval;
+    weightgraph_stream_handler handler;
+    main_archive_context context;
+    main_file_sink file;
+    weightgraph_sink sink;
+    weightgraph_parser* parser;
+    main_input input;
+    allocator* alloc;
+    uint8_t* chunk;
+    size_t size;
+    uint64_t trace_start;
+
+    /* attempt to create the allocator. */
+    retval = malloc_allocator_create(&alloc);
+    if (STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Could not create allocator.\n");
+        goto done;
+    }
+
+    retval = weightgraph_parser_create(&parser, alloc);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_allocator;
+    }
+
+    weightgraph_parser_set_format(
+        parser, weightgraph_input_format_from_name(options->input_file));
+
+    chunk = (uint8_t*)malloc(MAIN_ARCHIVE_CHUNK_SIZE);
+    if (NULL == chunk)
+    {
+        retval = ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_parser;
+    }
+
+    /* the archive is written as the log is parsed. */
+    main_file_sink_init(&sink, &file, options->output_file);
+    context.count = 0;
+    retval = weightgraph_archive_writer_create(&context.writer, alloc, &sink);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_chunk;
+    }
+
+    retval = main_input_open(&input, options->input_file);
+    if (STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Error reading input file.\n");
+        goto cleanup_writer;
+    }
+
+    handler.context = &context;
+    handler.beginning_average = &main_archive_average;
+    handler.log = &main_archive_log;
+    retval = weightgraph_parser_stream_begin(parser, &handler);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_input;
+    }
+
+    /* parse each piece as soon as it is read. */
+    main_stats_phase(MAIN_STATS_PHASE_PARSE);
+    do
+    {
+        retval =
+            main_input_read(&input, chunk, MAIN_ARCHIVE_CHUNK_SIZE, &size);
+        if (STATUS_SUCCESS != retval)
+        {
+            break;
+        }
+
+        trace_start = main_trace_begin();
+        retval = weightgraph_parser_stream(parser, chunk, size, 0 == size);
+        main_trace_end("parse", trace_start, size);
+    } while (STATUS_SUCCESS == retval && size > 0);
+    if (ERROR_ARCHIVE_ENCODE == retval)
+    {
+        fprintf(
+            stderr,
+            "Error: an entry can't be archived.  Dates must all be "
+            "YYYY-MM-DD or all MM/DD,\nand weights whole hundredths.\n");
+    }
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_input;
+    }
+
+    main_stats_count_entries(context.count);
+
+    /* write the last block and the index. */
+    trace_start = main_trace_begin();
+    retval = weightgraph_archive_writer_finish(context.writer);
+    main_trace_end("flush", trace_start, context.count);
+    if (STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Error writing output file.\n");
+        goto cleanup_input;
+    }
+
+    printf("Archived %zu entries.\n", context.count);
+
+    /* success. */
+    retval = STATUS_SUCCESS;
+    goto cleanup_input;
+
+cleanup_input:
+    main_input_close(&input);
+
+cleanup_writer:
+    release_retval =
+        resource_release(
+            weightgraph_archive_writer_resource_handle(context.writer));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_chunk:
+    free(chunk);
+
+cleanup_parser:
+    release_retval =
+        resource_release(weightgraph_parser_resource_handle(parser));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_allocator:
+    release_retval = resource_release(allocator_resource_handle(alloc));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Record the beginning average of the log in the archive.
+ *
+ * \param context       The conversion.
+ * \param average       The initial moving average.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_archive_average(void* context, double average)
+{
+    main_archive_context* archive = (main_archive_context*)context;
+
+    return weightgraph_archive_writer_average(archive->writer, average);
+}
+
+/**
+ * \brief Add a log entry to the archive.
+ *
+ * \param context       The conversion.
+ * \param date          The date of the entry.
+ * \param weight        The weight of the entry.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_ARCHIVE_ENCODE if the entry can't be stored in an archive.
+ *      - a non-zero error code on failure.
+ */
+static status main_archive_log(void* context, const char* date, double weight)
+{
+    main_archive_context* archive = (main_archive_context*)context;
+
+    ++archive->count;
+
+    return weightgraph_archive_writer_push(archive->writer, date, weight);
+}
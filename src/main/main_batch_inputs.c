@@ -0,0 +1,262 @@
+/**
+ * \file main/main_batch_inputs.c
+ *
+ * \brief List the input files for a batch run.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <dirent.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "main_internal.h"
+
+/**
+ * \brief A growable list of input file names.
+ */
+typedef struct main_batch_list main_batch_list;
+
+struct main_batch_list
+{
+    char** names;
+    size_t count;
+    size_t capacity;
+};
+
+/* forward decls. */
+static status main_batch_list_add(
+    main_batch_list* list, const char* prefix, const char* name,
+    size_t name_size);
+static status main_batch_list_directory(
+    main_batch_list* list, const char* path);
+static status main_batch_list_manifest(
+    main_batch_list* list, const char* path);
+static int main_batch_name_compare(const void* lhs, const void* rhs);
+
+/**
+ * \brief List the input files for a batch run.
+ *
+ * The path is either a directory, in which case every XML, CSV or NDJSON
+ * log in it, compressed or not, is listed, or a manifest naming one input
+ * file per line.  Blank lines and lines starting with '#' in a manifest are
+ * skipped.  Directory listings are sorted, so that a batch is rendered in the
+ * same order on every run.
+ *
+ * \param inputs        Pointer to receive the list of input file names.
+ * \param count         Pointer to receive the number of input files.
+ * \param path          The directory or manifest.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status main_batch_inputs(char*** inputs, size_t* count, const char* path)
+{
+    status retval;
+    struct stat st;
+    main_batch_list list;
+
+    memset(&list, 0, sizeof(list));
+
+    /* stat the path to decide how to list it. */
+    if (0 != stat(path, &st))
+    {
+        return ERROR_STAT_FAILED;
+    }
+
+    if (S_ISDIR(st.st_mode))
+    {
+        retval = main_batch_list_directory(&list, path);
+    }
+    else
+    {
+        retval = main_batch_list_manifest(&list, path);
+    }
+
+    if (STATUS_SUCCESS != retval)
+    {
+        main_batch_inputs_release(list.names, list.count);
+        return retval;
+    }
+
+    *inputs = list.names;
+    *count = list.count;
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Add a file name to the list.
+ *
+ * \param list          The list.
+ * \param prefix        The directory of the file, or NULL.
+ * \param name          The name of the file.
+ * \param name_size     The length of the name.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_batch_list_add(
+    main_batch_list* list, const char* prefix, const char* name,
+    size_t name_size)
+{
+    size_t prefix_size = (NULL == prefix) ? 0 : strlen(prefix) + 1;
+    char* copy;
+
+    /* grow the list geometrically. */
+    if (list->count == list->capacity)
+    {
+        size_t capacity = (0 == list->capacity) ? 64 : 2 * list->capacity;
+        char** names =
+            (char**)realloc(list->names, capacity * sizeof(char*));
+        if (NULL == names)
+        {
+            return ERROR_GENERAL_OUT_OF_MEMORY;
+        }
+
+        list->names = names;
+        list->capacity = capacity;
+    }
+
+    /* join the prefix and name. */
+    copy = (char*)malloc(prefix_size + name_size + 1);
+    if (NULL == copy)
+    {
+        return ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    if (NULL != prefix)
+    {
+        memcpy(copy, prefix, prefix_size - 1);
+        copy[prefix_size - 1] = '/';
+    }
+    memcpy(copy + prefix_size, name, name_size);
+    copy[prefix_size + name_size] = 0;
+
+    list->names[list->count++] = copy;
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief List every log in a directory, compressed or not.
+ *
+ * \param list          The list.
+ * \param path          The directory.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_batch_list_directory(
+    main_batch_list* list, const char* path)
+{
+    status retval = STATUS_SUCCESS;
+    struct dirent* entry;
+    DIR* dir;
+
+    dir = opendir(path);
+    if (NULL == dir)
+    {
+        return ERROR_OPEN_FAILED;
+    }
+
+    while (STATUS_SUCCESS == retval && NULL != (entry = readdir(dir)))
+    {
+        size_t size = strlen(entry->d_name);
+
+        /* only logs, compressed or not, are listed. */
+        if (WEIGHTGRAPH_INPUT_AUTO
+                == weightgraph_input_format_from_name(entry->d_name))
+        {
+            continue;
+        }
+
+        retval = main_batch_list_add(list, path, entry->d_name, size);
+    }
+
+    closedir(dir);
+
+    /* render in a stable order, regardless of directory order. */
+    if (STATUS_SUCCESS == retval && list->count > 1)
+    {
+        qsort(
+            list->names, list->count, sizeof(char*),
+            &main_batch_name_compare);
+    }
+
+    return retval;
+}
+
+/**
+ * \brief List the files named in a manifest.
+ *
+ * \param list          The list.
+ * \param path          The manifest.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_batch_list_manifest(
+    main_batch_list* list, const char* path)
+{
+    status retval;
+    uint8_t* buffer;
+    size_t size;
+    char* line;
+    char* end;
+
+    retval = main_read_file(&buffer, &size, path);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* the buffer is zero terminated, so it can be walked as a string. */
+    for (line = (char*)buffer; STATUS_SUCCESS == retval && 0 != *line;
+         line = ('\n' == *end) ? end + 1 : end)
+    {
+        size_t line_size;
+
+        end = strchr(line, '\n');
+        if (NULL == end)
+        {
+            end = line + strlen(line);
+        }
+
+        /* trim a carriage return. */
+        line_size = end - line;
+        if (line_size > 0 && '\r' == line[line_size - 1])
+        {
+            --line_size;
+        }
+
+        /* skip blank lines and comments. */
+        if (0 == line_size || '#' == *line)
+        {
+            continue;
+        }
+
+        retval = main_batch_list_add(list, NULL, line, line_size);
+    }
+
+    free(buffer);
+
+    return retval;
+}
+
+/**
+ * \brief Compare two file names for qsort.
+ *
+ * \param lhs           Pointer to the left-hand name.
+ * \param rhs           Pointer to the right-hand name.
+ *
+ * \returns the comparison of the names.
+ */
+static int main_batch_name_compare(const void* lhs, const void* rhs)
+{
+    return strcmp(*(char* const*)lhs, *(char* const*)rhs);
+}
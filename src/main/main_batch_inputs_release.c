@@ -0,0 +1,28 @@
+/**
+ * \file main/main_batch_inputs_release.c
+ *
+ * \brief Release a list of batch input files.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <stdlib.h>
+
+#include "main_internal.h"
+
+/**
+ * \brief Release a list of input files created by \ref main_batch_inputs.
+ *
+ * \param inputs        The list of input file names.
+ * \param count         The number of input files.
+ */
+void main_batch_inputs_release(char** inputs, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        free(inputs[i]);
+    }
+
+    free(inputs);
+}
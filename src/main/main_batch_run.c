@@ -0,0 +1,763 @@
+/**
+ * \file main/main_batch_run.c
+ *
+ * \brief Render a batch of logs on a work-stealing thread pool.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "main_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief A worker in the batch thread pool.
+ */
+typedef struct main_batch_worker main_batch_worker;
+
+/**
+ * \brief Shared state for the batch thread pool.
+ */
+typedef struct main_batch_job main_batch_job;
+
+struct main_batch_worker
+{
+    main_batch_job* job;
+    size_t index;
+    pthread_t thread;
+    /* the range [begin, end) of inputs still queued on this worker.  The
+     * worker takes inputs from the front, and thieves take from the back. */
+    pthread_mutex_t lock;
+    size_t begin;
+    size_t end;
+    /* buffers reused across the files rendered by this worker. */
+    uint8_t* buffer;
+    size_t buffer_capacity;
+    char* output;
+    size_t output_capacity;
+    /* the number of files rendered by this worker, and of those that were
+     * taken from the output cache. */
+    size_t rendered;
+    size_t cached;
+};
+
+struct main_batch_job
+{
+    const main_options* options;
+    char** inputs;
+    size_t count;
+    main_batch_worker* workers;
+    size_t worker_count;
+};
+
+/* forward decls. */
+static void* main_batch_thread(void* context);
+static bool main_batch_pop(main_batch_worker* worker, size_t* index);
+static bool main_batch_steal(main_batch_worker* worker, size_t* index);
+static status main_batch_render(
+    main_batch_worker* worker, weightgraph_parser* parser,
+    weightgraph_session* session, const char* input);
+static status main_batch_cache_render(
+    main_batch_worker* worker, weightgraph_session* session, const char* key);
+static status main_batch_draw(
+    main_batch_worker* worker, weightgraph_session* session,
+    const char* output);
+static status main_batch_output_name(
+    main_batch_worker* worker, const char* input);
+static const char* main_batch_output_stem(const char* input, size_t* size);
+static status main_batch_check_outputs(const main_batch_job* job);
+static int main_batch_stem_compare(const void* lhs, const void* rhs);
+
+/**
+ * \brief Render every input file of a batch on a work-stealing thread pool.
+ *
+ * Each worker reuses its parser, session and read buffer across the files it
+ * renders.  Failures are reported per file, and the throughput of the batch
+ * is printed when it completes.  A batch in which two inputs would be
+ * rendered to the same output is refused before anything is rendered.  If
+ * the batch has an output cache, graphs already in it are not rendered
+ * again, and the cache is trimmed to its limit once the batch completes.
+ *
+ * \param options       The command-line options.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS if every file was rendered.
+ *      - ERROR_BATCH_COLLISION if two inputs have the same output name.
+ *      - a non-zero error code on failure.
+ */
+status main_batch_run(const main_options* options)
+{
+    status retval;
+    main_batch_job job;
+    struct timespec start, stop;
+    size_t started = 0;
+    size_t rendered = 0;
+    size_t cached = 0;
+    size_t evicted = 0;
+    double seconds;
+
+    memset(&job, 0, sizeof(job));
+    job.options = options;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    /* list the inputs. */
+    retval = main_batch_inputs(&job.inputs, &job.count, options->input_file);
+    if (STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Error listing batch inputs.\n");
+        goto done;
+    }
+
+    /* concurrent workers must never write the same output. */
+    retval = main_batch_check_outputs(&job);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_inputs;
+    }
+
+    /* there is no use for more workers than files. */
+    job.worker_count = options->threads;
+    if (job.worker_count > job.count)
+    {
+        job.worker_count = job.count;
+    }
+    if (0 == job.worker_count)
+    {
+        job.worker_count = 1;
+    }
+
+    job.workers =
+        (main_batch_worker*)calloc(
+            job.worker_count, sizeof(main_batch_worker));
+    if (NULL == job.workers)
+    {
+        retval = ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_inputs;
+    }
+
+    /* split the inputs evenly; idle workers steal from the rest. */
+    for (size_t i = 0; i < job.worker_count; ++i)
+    {
+        job.workers[i].job = &job;
+        job.workers[i].index = i;
+        job.workers[i].begin = i * job.count / job.worker_count;
+        job.workers[i].end = (i + 1) * job.count / job.worker_count;
+        pthread_mutex_init(&job.workers[i].lock, NULL);
+    }
+
+    /* start the workers. */
+    for (started = 0; started < job.worker_count; ++started)
+    {
+        if (0 !=
+            pthread_create(
+                &job.workers[started].thread, NULL, &main_batch_thread,
+                &job.workers[started]))
+        {
+            break;
+        }
+    }
+
+    /* if no thread could be started, render the batch on this one. */
+    if (0 == started)
+    {
+        main_batch_thread(&job.workers[0]);
+    }
+
+    /* wait for the batch to be rendered. */
+    for (size_t i = 0; i < started; ++i)
+    {
+        pthread_join(job.workers[i].thread, NULL);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+
+    /* release the workers. */
+    for (size_t i = 0; i < job.worker_count; ++i)
+    {
+        rendered += job.workers[i].rendered;
+        cached += job.workers[i].cached;
+        pthread_mutex_destroy(&job.workers[i].lock);
+        free(job.workers[i].buffer);
+        free(job.workers[i].output);
+    }
+
+    free(job.workers);
+
+    /* report the throughput of the batch. */
+    seconds =
+        (double)(stop.tv_sec - start.tv_sec)
+            + (double)(stop.tv_nsec - start.tv_nsec) / 1e9;
+    printf(
+        "Rendered %zu of %zu files in %.3f seconds (%.1f files/second).\n",
+        rendered, job.count, seconds,
+        (seconds > 0.0) ? (double)rendered / seconds : 0.0);
+
+    /* evict what no longer fits in the cache. */
+    if (NULL != options->cache_directory)
+    {
+        if (STATUS_SUCCESS !=
+            main_cache_trim(
+                options->cache_directory, options->cache_limit, &evicted))
+        {
+            fprintf(
+                stderr, "Warning: couldn't trim the output cache %s.\n",
+                options->cache_directory);
+        }
+
+        printf(
+            "Reused %zu of them from the output cache, and evicted %zu "
+            "entries.\n", cached, evicted);
+    }
+
+    retval = (rendered == job.count) ? STATUS_SUCCESS : ERROR_BATCH_INCOMPLETE;
+    goto cleanup_inputs;
+
+cleanup_inputs:
+    main_batch_inputs_release(job.inputs, job.count);
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Render inputs until none remain on this worker or any other.
+ *
+ * \param context       The worker.
+ *
+ * \returns NULL.
+ */
+static void* main_batch_thread(void* context)
+{
+    status retval;
+    main_batch_worker* worker = (main_batch_worker*)context;
+    main_batch_job* job = worker->job;
+    allocator* alloc;
+    weightgraph_parser* parser;
+    weightgraph_session* session;
+    size_t index;
+
+    main_trace_thread_name("batch worker");
+
+    /* each worker has its own allocator, parser and session.  A worker that
+     * can't start leaves its inputs to be stolen by the others. */
+    retval = malloc_allocator_create(&alloc);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    retval = weightgraph_parser_create(&parser, alloc);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_allocator;
+    }
+
+    retval = main_session_create(&session, alloc, 0.0, job->options);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_parser;
+    }
+
+    /* render inputs, stealing more when this worker runs out. */
+    while (main_batch_pop(worker, &index) || main_batch_steal(worker, &index))
+    {
+        retval =
+            main_batch_render(worker, parser, session, job->inputs[index]);
+        if (STATUS_SUCCESS != retval)
+        {
+            fprintf(
+                stderr, "Error rendering %s (status %d).\n",
+                job->inputs[index], retval);
+            continue;
+        }
+
+        ++worker->rendered;
+    }
+
+    /* there is no one to report a release failure to. */
+    resource_release(weightgraph_session_resource_handle(session));
+
+cleanup_parser:
+    resource_release(weightgraph_parser_resource_handle(parser));
+
+cleanup_allocator:
+    resource_release(allocator_resource_handle(alloc));
+
+done:
+    return NULL;
+}
+
+/**
+ * \brief Take the next input from the front of this worker's queue.
+ *
+ * \param worker        The worker.
+ * \param index         Pointer to receive the index of the input.
+ *
+ * \returns true if an input was taken.
+ */
+static bool main_batch_pop(main_batch_worker* worker, size_t* index)
+{
+    bool found = false;
+
+    pthread_mutex_lock(&worker->lock);
+    if (worker->begin < worker->end)
+    {
+        *index = worker->begin++;
+        found = true;
+    }
+    pthread_mutex_unlock(&worker->lock);
+
+    return found;
+}
+
+/**
+ * \brief Steal half of the remaining inputs of another worker.
+ *
+ * The stolen inputs are taken from the back of the victim's queue, away from
+ * the end its owner is working on, and become this worker's queue.  The
+ * first of them is returned to be rendered right away.
+ *
+ * \param worker        The worker, whose own queue is empty.
+ * \param index         Pointer to receive the index of the input.
+ *
+ * \returns true if an input was stolen; false if no work remains.
+ */
+static bool main_batch_steal(main_batch_worker* worker, size_t* index)
+{
+    main_batch_job* job = worker->job;
+
+    for (size_t i = 1; i < job->worker_count; ++i)
+    {
+        main_batch_worker* victim =
+            &job->workers[(worker->index + i) % job->worker_count];
+        size_t first, last;
+
+        pthread_mutex_lock(&victim->lock);
+        if (victim->begin == victim->end)
+        {
+            pthread_mutex_unlock(&victim->lock);
+            continue;
+        }
+
+        /* take the back half, rounding up so a single input is taken. */
+        last = victim->end;
+        first = last - (last - victim->begin + 1) / 2;
+        victim->end = first;
+        pthread_mutex_unlock(&victim->lock);
+
+        /* the rest of the stolen range becomes this worker's queue. */
+        pthread_mutex_lock(&worker->lock);
+        worker->begin = first + 1;
+        worker->end = last;
+        pthread_mutex_unlock(&worker->lock);
+
+        *index = first;
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * \brief Render a single input file.
+ *
+ * If the batch has an output cache, the graph is looked up in it by its key,
+ * and a cached graph is linked or copied to the output without averaging or
+ * rendering it.  Otherwise, the graph is rendered into the cache, then placed
+ * at the output the same way.  A cache that can't be read or written is
+ * reported, and the graph is rendered straight to the output instead.
+ *
+ * \param worker        The worker.
+ * \param parser        The worker's parser.
+ * \param session       The worker's session.
+ * \param input         The name of the input file.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_batch_render(
+    main_batch_worker* worker, weightgraph_parser* parser,
+    weightgraph_session* session, const char* input)
+{
+    status retval, release_retval;
+    const main_options* options = worker->job->options;
+    char key[MAIN_CACHE_KEY_SIZE];
+    weightgraph* graph;
+    size_t size;
+    uint64_t trace_start;
+    bool hit = false;
+
+    /* read the input file into the worker's buffer. */
+    retval =
+        main_read_file_buffer(
+            &worker->buffer, &worker->buffer_capacity, &size, input);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* parse the log, in the format named by its extension. */
+    weightgraph_parser_set_format(
+        parser, weightgraph_input_format_from_name(input));
+    trace_start = main_trace_begin();
+    retval = weightgraph_parser_parse(parser, &graph, worker->buffer, size);
+    main_trace_end("build", trace_start, size);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    main_stats_count_entries(graph->entry_count);
+
+    /* name the output after the input. */
+    retval = main_batch_output_name(worker, input);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_graph;
+    }
+
+    /* a graph in the cache needs neither averaging nor rendering. */
+    if (NULL != options->cache_directory)
+    {
+        trace_start = main_trace_begin();
+        main_cache_key(key, options, graph);
+        retval =
+            main_cache_fetch(
+                options->cache_directory, key, worker->output, &hit);
+        main_trace_end("cache", trace_start, graph->entry_count);
+        if (ERROR_OUTPUT_CACHE == retval)
+        {
+            fprintf(
+                stderr, "Warning: couldn't read %s from the output cache.\n",
+                input);
+            hit = false;
+        }
+        else if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_graph;
+        }
+
+        if (hit)
+        {
+            ++worker->cached;
+            goto cleanup_graph;
+        }
+    }
+
+    /* start the session over from this log's initial average. */
+    weightgraph_session_reset(session, graph->initial_average);
+    retval = main_push_entries(session, graph);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_graph;
+    }
+
+    /* render into the cache if there is one and it works, and straight to
+     * the output otherwise. */
+    if (NULL != options->cache_directory)
+    {
+        retval = main_batch_cache_render(worker, session, key);
+        if (ERROR_OUTPUT_CACHE != retval)
+        {
+            goto cleanup_graph;
+        }
+
+        fprintf(
+            stderr, "Warning: couldn't add %s to the output cache.\n", input);
+    }
+
+    retval = main_batch_draw(worker, session, worker->output);
+    goto cleanup_graph;
+
+cleanup_graph:
+    release_retval = resource_release(&graph->hdr);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Render a graph into the output cache, then place it at the output.
+ *
+ * \param worker        The worker, whose output name is set.
+ * \param session       The session holding the graph.
+ * \param key           The key of the graph.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_OUTPUT_CACHE if the graph could not be added to the cache.
+ *      - a non-zero error code on failure.
+ */
+static status main_batch_cache_render(
+    main_batch_worker* worker, weightgraph_session* session, const char* key)
+{
+    status retval;
+    const main_options* options = worker->job->options;
+    const char* extension =
+        (WEIGHTGRAPH_FORMAT_PNG == options->output_format) ? ".png" : ".eps";
+    char* staging;
+    char* output;
+    size_t size;
+    bool hit;
+
+    retval = main_cache_stage(&staging, options->cache_directory);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    size = strlen(staging) + sizeof("/graph") + strlen(extension);
+    output = (char*)malloc(size);
+    if (NULL == output)
+    {
+        retval = ERROR_GENERAL_OUT_OF_MEMORY;
+        goto discard_staging;
+    }
+
+    /* a single page is cached as "graph.png", and several pages as
+     * "graph-1.png", "graph-2.png", and so on. */
+    snprintf(output, size, "%s/graph%s", staging, extension);
+    retval = main_batch_draw(worker, session, output);
+    free(output);
+    if (ERROR_OUTPUT_FILE_OPEN == retval || ERROR_OUTPUT_WRITE == retval)
+    {
+        /* the cache, not the graph, is at fault. */
+        retval = ERROR_OUTPUT_CACHE;
+        goto discard_staging;
+    }
+    else if (STATUS_SUCCESS != retval)
+    {
+        goto discard_staging;
+    }
+
+    retval = main_cache_commit(options->cache_directory, staging, key);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto discard_staging;
+    }
+
+    /* the entry is committed, so there is nothing left to discard. */
+    retval =
+        main_cache_fetch(options->cache_directory, key, worker->output, &hit);
+    if (STATUS_SUCCESS == retval && !hit)
+    {
+        retval = ERROR_OUTPUT_CACHE;
+    }
+    goto cleanup_staging;
+
+discard_staging:
+    main_cache_discard(staging);
+
+cleanup_staging:
+    free(staging);
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Render a graph to a file, and the pages after it.
+ *
+ * \param worker        The worker.
+ * \param session       The session holding the graph.
+ * \param output        The name of the output file.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_batch_draw(
+    main_batch_worker* worker, weightgraph_session* session,
+    const char* output)
+{
+    status retval;
+    const main_options* options = worker->job->options;
+    weightgraph_render_options render_options;
+    weightgraph_render_state state;
+    main_file_sink file;
+    weightgraph_sink sink;
+    uint64_t trace_start;
+
+    /* the pool is already busy, so each graph is rendered on one thread. */
+    memset(&render_options, 0, sizeof(render_options));
+    render_options.format = options->output_format;
+    render_options.raster_size = options->raster_size;
+    render_options.page_size = options->page_size;
+    render_options.threads = 1;
+
+    main_file_sink_init(&sink, &file, output);
+    trace_start = main_trace_begin();
+    retval =
+        weightgraph_session_render(session, &render_options, &sink, &state);
+    main_trace_end("render", trace_start, weightgraph_session_count(session));
+
+    return retval;
+}
+
+/**
+ * \brief Build the name of the output file for an input file.
+ *
+ * The output is written to the output directory, named after the input file
+ * with its extension, and any ".gz" suffix, replaced by that of the output
+ * format.
+ *
+ * \param worker        The worker, whose output name buffer is updated.
+ * \param input         The name of the input file.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_batch_output_name(
+    main_batch_worker* worker, const char* input)
+{
+    const main_options* options = worker->job->options;
+    const char* extension =
+        (WEIGHTGRAPH_FORMAT_PNG == options->output_format) ? ".png" : ".eps";
+    size_t dir_size = strlen(options->output_file);
+    size_t base_size;
+    const char* base = main_batch_output_stem(input, &base_size);
+    size_t size;
+
+    /* grow the name buffer if needed. */
+    size = dir_size + 1 + base_size + strlen(extension) + 1;
+    if (worker->output_capacity < size)
+    {
+        char* output = (char*)realloc(worker->output, size);
+        if (NULL == output)
+        {
+            return ERROR_GENERAL_OUT_OF_MEMORY;
+        }
+
+        worker->output = output;
+        worker->output_capacity = size;
+    }
+
+    /* join the directory, base name and extension. */
+    memcpy(worker->output, options->output_file, dir_size);
+    worker->output[dir_size] = '/';
+    memcpy(worker->output + dir_size + 1, base, base_size);
+    strcpy(worker->output + dir_size + 1 + base_size, extension);
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Find the part of an input file name that names its output: the name
+ * without its directory and extension, and any ".gz" suffix.
+ *
+ * \param input         The name of the input file.
+ * \param size          Pointer to receive the length of the stem.
+ *
+ * \returns the start of the stem, within the input name.
+ */
+static const char* main_batch_output_stem(const char* input, size_t* size)
+{
+    const char* base = strrchr(input, '/');
+    size_t base_size;
+
+    /* strip the directory and extension of the input. */
+    base = (NULL == base) ? input : base + 1;
+    base_size = strlen(base);
+    if (base_size > 3 && !strcmp(base + base_size - 3, ".gz"))
+    {
+        base_size -= 3;
+    }
+    for (size_t i = base_size; i-- > 1; )
+    {
+        if ('.' == base[i])
+        {
+            base_size = i;
+            break;
+        }
+    }
+
+    *size = base_size;
+    return base;
+}
+
+/**
+ * \brief Refuse a batch in which two inputs, such as "a.xml" and "a.csv", or
+ * logs of the same name in different directories, have the same output.
+ *
+ * \param job           The batch, with its inputs listed.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS if every input has its own output.
+ *      - ERROR_BATCH_COLLISION if two inputs have the same output name.
+ *      - a non-zero error code on failure.
+ */
+static status main_batch_check_outputs(const main_batch_job* job)
+{
+    status retval = STATUS_SUCCESS;
+    const char** inputs;
+
+    if (job->count < 2)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    inputs = (const char**)malloc(job->count * sizeof(const char*));
+    if (NULL == inputs)
+    {
+        return ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    /* sort the inputs by stem, so that colliding inputs are adjacent. */
+    memcpy(inputs, job->inputs, job->count * sizeof(const char*));
+    qsort(inputs, job->count, sizeof(const char*), &main_batch_stem_compare);
+
+    for (size_t i = 1; i < job->count; ++i)
+    {
+        if (0 == main_batch_stem_compare(&inputs[i - 1], &inputs[i]))
+        {
+            fprintf(
+                stderr, "Error: %s and %s would be rendered to the same "
+                "output.\n", inputs[i - 1], inputs[i]);
+            retval = ERROR_BATCH_COLLISION;
+        }
+    }
+
+    free(inputs);
+
+    return retval;
+}
+
+/**
+ * \brief Compare the output stems of two input file names.
+ *
+ * \param lhs           Pointer to the left-hand name.
+ * \param rhs           Pointer to the right-hand name.
+ *
+ * \returns the comparison of the stems.
+ */
+static int main_batch_stem_compare(const void* lhs, const void* rhs)
+{
+    size_t left_size, right_size;
+    const char* left =
+        main_batch_output_stem(*(const char* const*)lhs, &left_size);
+    const char* right =
+        main_batch_output_stem(*(const char* const*)rhs, &right_size);
+    int order =
+        memcmp(left, right, (left_size < right_size) ? left_size : right_size);
+
+    if (0 != order)
+    {
+        return order;
+    }
+
+    return (left_size < right_size) ? -1 : (left_size > right_size);
+}
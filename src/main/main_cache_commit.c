@@ -0,0 +1,89 @@
+/**
+ * \file main/main_cache_commit.c
+ *
+ * \brief Commit a staging directory to the output cache.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "main_internal.h"
+
+/**
+ * \brief Commit a staging directory to the cache under a key.
+ *
+ * The staged files are made read-only, so that an output linked to one can't
+ * be rewritten in place, and the staging directory is renamed to the key.  If
+ * another worker committed the key first, the staging directory is discarded.
+ *
+ * \param directory     The cache directory.
+ * \param staging       The staging directory.
+ * \param key           The key of the graph.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_OUTPUT_CACHE if the staging directory could not be committed.
+ */
+status main_cache_commit(
+    const char* directory, const char* staging, const char* key)
+{
+    status retval;
+    size_t size = strlen(directory) + 1 + strlen(key) + 1;
+    struct dirent* file;
+    char* entry;
+    DIR* dir;
+
+    /* make each staged file read-only. */
+    dir = opendir(staging);
+    if (NULL == dir)
+    {
+        return ERROR_OUTPUT_CACHE;
+    }
+
+    while (NULL != (file = readdir(dir)))
+    {
+        if ('.' != file->d_name[0]
+         && 0 != fchmodat(dirfd(dir), file->d_name, 0444, 0))
+        {
+            closedir(dir);
+            return ERROR_OUTPUT_CACHE;
+        }
+    }
+
+    closedir(dir);
+
+    entry = (char*)malloc(size);
+    if (NULL == entry)
+    {
+        return ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    snprintf(entry, size, "%s/%s", directory, key);
+
+    /* the rename publishes the entry whole.  A rename onto an entry that
+     * already exists fails, and leaves that entry to be used instead. */
+    if (0 == rename(staging, entry))
+    {
+        retval = STATUS_SUCCESS;
+    }
+    else if (EEXIST == errno || ENOTEMPTY == errno)
+    {
+        main_cache_discard(staging);
+        retval = STATUS_SUCCESS;
+    }
+    else
+    {
+        retval = ERROR_OUTPUT_CACHE;
+    }
+
+    free(entry);
+
+    return retval;
+}
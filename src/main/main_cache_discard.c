@@ -0,0 +1,43 @@
+/**
+ * \file main/main_cache_discard.c
+ *
+ * \brief Remove a directory of the output cache.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "main_internal.h"
+
+/**
+ * \brief Remove a cache entry or staging directory, and the files in it.
+ *
+ * \param path          The directory to remove.
+ */
+void main_cache_discard(const char* path)
+{
+    struct dirent* file;
+    DIR* dir = opendir(path);
+
+    /* a directory that can't be read can't be emptied either. */
+    if (NULL == dir)
+    {
+        return;
+    }
+
+    /* the cache holds no subdirectories, so removing files empties it. */
+    while (NULL != (file = readdir(dir)))
+    {
+        if ('.' != file->d_name[0])
+        {
+            unlinkat(dirfd(dir), file->d_name, 0);
+        }
+    }
+
+    closedir(dir);
+    rmdir(path);
+}
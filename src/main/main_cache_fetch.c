@@ -0,0 +1,242 @@
+/**
+ * \file main/main_cache_fetch.c
+ *
+ * \brief Replace the outputs of a graph with those in the output cache.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "main_internal.h"
+
+/* forward decls. */
+static status main_cache_place(const char* source, const char* target);
+static status main_cache_copy(const char* source, const char* target);
+
+/**
+ * \brief Replace the outputs of a graph with those cached under a key, if
+ * there are any.
+ *
+ * Each cached file, such as "graph.png" or "graph-2.png", replaces the output
+ * of the same suffix, such as "out.png" or "out-2.png".  Outputs are hard
+ * links to the cached files where possible, and copies otherwise.  An entry
+ * that is used is marked as the most recently used.
+ *
+ * \param directory     The cache directory.
+ * \param key           The key of the graph.
+ * \param output        The name of the output file of the graph.
+ * \param hit           Pointer to receive true if the outputs were cached.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success, whether or not the outputs were cached.
+ *      - ERROR_OUTPUT_CACHE if the cache could not be read.
+ *      - ERROR_OUTPUT_FILE_OPEN if an output could not be created.
+ *      - ERROR_OUTPUT_WRITE if an output could not be written.
+ *      - a non-zero error code on failure.
+ */
+status main_cache_fetch(
+    const char* directory, const char* key, const char* output, bool* hit)
+{
+    status retval;
+    const char* slash = strrchr(output, '/');
+    const char* dot = strrchr(output, '.');
+    size_t entry_size = strlen(directory) + 1 + strlen(key) + 1;
+    size_t stem_size;
+    char* entry;
+    char* source = NULL;
+    char* target = NULL;
+    struct dirent* file;
+    DIR* dir;
+
+    *hit = false;
+
+    /* only a dot in the last path component starts an extension. */
+    if (NULL == dot || (NULL != slash && dot < slash))
+    {
+        dot = output + strlen(output);
+    }
+    stem_size = (size_t)(dot - output);
+
+    entry = (char*)malloc(entry_size);
+    if (NULL == entry)
+    {
+        retval = ERROR_GENERAL_OUT_OF_MEMORY;
+        goto done;
+    }
+
+    snprintf(entry, entry_size, "%s/%s", directory, key);
+
+    /* a key without an entry is a miss. */
+    dir = opendir(entry);
+    if (NULL == dir)
+    {
+        retval = (ENOENT == errno) ? STATUS_SUCCESS : ERROR_OUTPUT_CACHE;
+        goto cleanup_entry;
+    }
+
+    /* place each cached page under the name of the output. */
+    while (NULL != (file = readdir(dir)))
+    {
+        size_t name_size = strlen(file->d_name);
+        char* tmp;
+
+        if (strncmp(file->d_name, "graph", 5))
+        {
+            continue;
+        }
+
+        tmp = (char*)realloc(source, entry_size + 1 + name_size);
+        if (NULL == tmp)
+        {
+            retval = ERROR_GENERAL_OUT_OF_MEMORY;
+            goto cleanup_dir;
+        }
+        source = tmp;
+
+        tmp = (char*)realloc(target, stem_size + name_size);
+        if (NULL == tmp)
+        {
+            retval = ERROR_GENERAL_OUT_OF_MEMORY;
+            goto cleanup_dir;
+        }
+        target = tmp;
+
+        /* "graph-2.png" becomes the stem of the output, then "-2.png". */
+        snprintf(
+            source, entry_size + 1 + name_size, "%s/%s", entry, file->d_name);
+        snprintf(
+            target, stem_size + name_size, "%.*s%s", (int)stem_size, output,
+            file->d_name + 5);
+
+        retval = main_cache_place(source, target);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_dir;
+        }
+    }
+
+    /* the time of an entry is when it was last used. */
+    utimensat(AT_FDCWD, entry, NULL, 0);
+
+    *hit = true;
+    retval = STATUS_SUCCESS;
+    goto cleanup_dir;
+
+cleanup_dir:
+    closedir(dir);
+    free(source);
+    free(target);
+
+cleanup_entry:
+    free(entry);
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Place a cached file at the name of an output, replacing any file
+ * already there.
+ *
+ * \param source        The name of the cached file.
+ * \param target        The name of the output.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_OUTPUT_CACHE if the cached file could not be read.
+ *      - ERROR_OUTPUT_FILE_OPEN if the output could not be created.
+ *      - ERROR_OUTPUT_WRITE if the output could not be written.
+ */
+static status main_cache_place(const char* source, const char* target)
+{
+    if (0 != unlink(target) && ENOENT != errno)
+    {
+        return ERROR_OUTPUT_FILE_OPEN;
+    }
+
+    /* a link costs nothing, but can't cross file systems. */
+    if (0 == link(source, target))
+    {
+        return STATUS_SUCCESS;
+    }
+
+    return main_cache_copy(source, target);
+}
+
+/**
+ * \brief Copy a cached file to the name of an output.
+ *
+ * \param source        The name of the cached file.
+ * \param target        The name of the output, which doesn't exist.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_OUTPUT_CACHE if the cached file could not be read.
+ *      - ERROR_OUTPUT_FILE_OPEN if the output could not be created.
+ *      - ERROR_OUTPUT_WRITE if the output could not be written.
+ */
+static status main_cache_copy(const char* source, const char* target)
+{
+    status retval;
+    uint8_t buffer[16384];
+    ssize_t size;
+    int in, out;
+
+    in = open(source, O_RDONLY);
+    if (in < 0)
+    {
+        retval = ERROR_OUTPUT_CACHE;
+        goto done;
+    }
+
+    out = open(target, O_WRONLY | O_CREAT | O_EXCL, 0644);
+    if (out < 0)
+    {
+        retval = ERROR_OUTPUT_FILE_OPEN;
+        goto cleanup_in;
+    }
+
+    /* copy the file, stopping at the first error. */
+    retval = STATUS_SUCCESS;
+    while (0 != (size = read(in, buffer, sizeof(buffer))))
+    {
+        if (size < 0)
+        {
+            retval = ERROR_OUTPUT_CACHE;
+            break;
+        }
+
+        if (write(out, buffer, (size_t)size) != size)
+        {
+            retval = ERROR_OUTPUT_WRITE;
+            break;
+        }
+
+        main_stats_count_written((size_t)size);
+    }
+
+    if (0 != close(out) && STATUS_SUCCESS == retval)
+    {
+        retval = ERROR_OUTPUT_WRITE;
+    }
+
+    /* don't leave a partial copy behind. */
+    if (STATUS_SUCCESS != retval)
+    {
+        unlink(target);
+    }
+
+cleanup_in:
+    close(in);
+
+done:
+    return retval;
+}
@@ -0,0 +1,124 @@
+/**
+ * \file main/main_cache_key.c
+ *
+ * \brief Compute the key under which the output of a graph is cached.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "main_internal.h"
+
+RCPR_IMPORT_rbtree;
+
+/**
+ * \brief The version of the cache, hashed into every key, which is raised
+ * whenever the same log and options would render a different output.
+ */
+#define MAIN_CACHE_VERSION 1
+
+/**
+ * \brief A 128-bit hash, held in two 64-bit halves.
+ */
+typedef struct main_cache_digest main_cache_digest;
+
+struct main_cache_digest
+{
+    uint64_t high;
+    uint64_t low;
+};
+
+/* forward decls. */
+static void main_cache_hash(
+    main_cache_digest* hash, const void* data, size_t size);
+
+/**
+ * \brief Compute the key under which the output of a graph is cached.
+ *
+ * The key is a 128-bit FNV-1a hash of everything the output depends on: the
+ * version of the cache, the rendering options, the outlier filter, the
+ * initial average, and the date and weight of each entry, in date order.  It
+ * is computed from the parsed log, without averaging it.
+ *
+ * \param key           Buffer of \ref MAIN_CACHE_KEY_SIZE bytes to receive the
+ *                      key.
+ * \param options       The command-line options.
+ * \param graph         The parsed log.
+ */
+void main_cache_key(
+    char* key, const main_options* options, const weightgraph* graph)
+{
+    static const char digits[] = "0123456789abcdef";
+    main_cache_digest hash = { 0x6c62272e07bb0142ULL, 0x62b821756295c58dULL };
+    int version = MAIN_CACHE_VERSION;
+    rbtree_node* nil = rbtree_nil_node(graph->entries);
+    rbtree_node* tmp = rbtree_root_node(graph->entries);
+
+    /* hash the options that change the output. */
+    main_cache_hash(&hash, &version, sizeof(version));
+    main_cache_hash(
+        &hash, &options->output_format, sizeof(options->output_format));
+    main_cache_hash(
+        &hash, &options->raster_size, sizeof(options->raster_size));
+    main_cache_hash(&hash, &options->page_size, sizeof(options->page_size));
+    main_cache_hash(
+        &hash, &options->outlier_window, sizeof(options->outlier_window));
+    main_cache_hash(
+        &hash, &options->outlier_threshold,
+        sizeof(options->outlier_threshold));
+    main_cache_hash(
+        &hash, &graph->initial_average, sizeof(graph->initial_average));
+
+    /* hash the entries, in date order. */
+    if (nil != tmp)
+    {
+        tmp = rbtree_minimum_node(graph->entries, tmp);
+    }
+
+    while (nil != tmp)
+    {
+        weightgraph_entry* entry =
+            (weightgraph_entry*)rbtree_node_value(graph->entries, tmp);
+
+        /* the terminator keeps the date apart from the weight. */
+        main_cache_hash(&hash, entry->date, strlen(entry->date) + 1);
+        main_cache_hash(&hash, &entry->weight, sizeof(entry->weight));
+
+        tmp = rbtree_successor_node(graph->entries, tmp);
+    }
+
+    /* write the hash as hex digits, most significant first. */
+    for (int i = 0; i < 16; ++i)
+    {
+        key[i] = digits[(hash.high >> (60 - 4 * i)) & 0xf];
+        key[16 + i] = digits[(hash.low >> (60 - 4 * i)) & 0xf];
+    }
+
+    key[MAIN_CACHE_KEY_SIZE - 1] = 0;
+}
+
+/**
+ * \brief Add bytes to a 128-bit FNV-1a hash.
+ *
+ * \param hash          The hash to update.
+ * \param data          The bytes to hash.
+ * \param size          The number of bytes.
+ */
+static void main_cache_hash(
+    main_cache_digest* hash, const void* data, size_t size)
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        uint64_t low = hash->low ^ bytes[i];
+        uint64_t low_low = (low & 0xffffffffULL) * 0x13bULL;
+        uint64_t low_high = (low >> 32) * 0x13bULL + (low_low >> 32);
+
+        /* multiply by the prime, 2^88 + 0x13b, modulo 2^128. */
+        hash->high = hash->high * 0x13bULL + (low_high >> 32) + (low << 24);
+        hash->low = (low_high << 32) | (low_low & 0xffffffffULL);
+    }
+}
@@ -0,0 +1,58 @@
+/**
+ * \file main/main_cache_stage.c
+ *
+ * \brief Create a staging directory in the output cache.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "main_internal.h"
+
+/**
+ * \brief Create a staging directory in the cache, into which a graph is
+ * rendered before it is committed.
+ *
+ * \param staging       Pointer to receive the name of the staging directory,
+ *                      which must be freed by the caller.
+ * \param directory     The cache directory, which is created if need be.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_OUTPUT_CACHE if the directory could not be created.
+ *      - a non-zero error code on failure.
+ */
+status main_cache_stage(char** staging, const char* directory)
+{
+    size_t size = strlen(directory) + sizeof("/.stage-XXXXXX");
+    char* name;
+
+    /* another worker may have created the cache first. */
+    if (0 != mkdir(directory, 0755) && EEXIST != errno)
+    {
+        return ERROR_OUTPUT_CACHE;
+    }
+
+    name = (char*)malloc(size);
+    if (NULL == name)
+    {
+        return ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    /* staging directories start with a dot, so they are never taken for
+     * entries. */
+    snprintf(name, size, "%s/.stage-XXXXXX", directory);
+    if (NULL == mkdtemp(name))
+    {
+        free(name);
+        return ERROR_OUTPUT_CACHE;
+    }
+
+    *staging = name;
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,234 @@
+/**
+ * \file main/main_cache_trim.c
+ *
+ * \brief Evict the least recently used entries of the output cache.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "main_internal.h"
+
+/**
+ * \brief An entry of the cache, as found by a scan.
+ */
+typedef struct main_cache_entry main_cache_entry;
+
+struct main_cache_entry
+{
+    char* name;
+    struct timespec used;
+    size_t size;
+};
+
+/* forward decls. */
+static status main_cache_scan(
+    int fd, const char* name, main_cache_entry* entry);
+static int main_cache_entry_compare(const void* lhs, const void* rhs);
+
+/**
+ * \brief Evict the least recently used entries of the cache until the files
+ * it holds fit in a limit.
+ *
+ * \param directory     The cache directory.
+ * \param limit         The most bytes the cached files may take.
+ * \param evicted       Pointer to receive the number of entries evicted.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_OUTPUT_CACHE if the cache could not be read.
+ *      - a non-zero error code on failure.
+ */
+status main_cache_trim(const char* directory, size_t limit, size_t* evicted)
+{
+    status retval;
+    main_cache_entry* entries = NULL;
+    size_t count = 0;
+    size_t capacity = 0;
+    size_t total = 0;
+    size_t path_size;
+    char* path = NULL;
+    struct dirent* file;
+    DIR* dir;
+
+    *evicted = 0;
+
+    /* a cache that was never created holds nothing. */
+    dir = opendir(directory);
+    if (NULL == dir)
+    {
+        retval = (ENOENT == errno) ? STATUS_SUCCESS : ERROR_OUTPUT_CACHE;
+        goto done;
+    }
+
+    /* find the size and last use of each entry, skipping staging
+     * directories and anything else not named by a key. */
+    while (NULL != (file = readdir(dir)))
+    {
+        if ('.' == file->d_name[0]
+         || MAIN_CACHE_KEY_SIZE - 1 != strlen(file->d_name))
+        {
+            continue;
+        }
+
+        /* grow the list geometrically. */
+        if (count == capacity)
+        {
+            size_t size = (0 == capacity) ? 64 : 2 * capacity;
+            main_cache_entry* tmp =
+                (main_cache_entry*)realloc(
+                    entries, size * sizeof(main_cache_entry));
+            if (NULL == tmp)
+            {
+                retval = ERROR_GENERAL_OUT_OF_MEMORY;
+                goto cleanup_entries;
+            }
+
+            entries = tmp;
+            capacity = size;
+        }
+
+        retval = main_cache_scan(dirfd(dir), file->d_name, &entries[count]);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_entries;
+        }
+
+        total += entries[count].size;
+        ++count;
+    }
+
+    /* evict from the least recently used entry until the rest fit. */
+    qsort(entries, count, sizeof(main_cache_entry), &main_cache_entry_compare);
+
+    path_size = strlen(directory) + 1 + MAIN_CACHE_KEY_SIZE;
+    path = (char*)malloc(path_size);
+    if (NULL == path)
+    {
+        retval = ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_entries;
+    }
+
+    for (size_t i = 0; i < count && total > limit; ++i)
+    {
+        snprintf(path, path_size, "%s/%s", directory, entries[i].name);
+        main_cache_discard(path);
+
+        total -= entries[i].size;
+        ++*evicted;
+    }
+
+    retval = STATUS_SUCCESS;
+    goto cleanup_entries;
+
+cleanup_entries:
+    for (size_t i = 0; i < count; ++i)
+    {
+        free(entries[i].name);
+    }
+
+    free(entries);
+    free(path);
+    closedir(dir);
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Find the size and last use of a cache entry.
+ *
+ * \param fd            The cache directory.
+ * \param name          The name of the entry.
+ * \param entry         The entry to fill in.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_OUTPUT_CACHE if the entry could not be read.
+ *      - a non-zero error code on failure.
+ */
+static status main_cache_scan(
+    int fd, const char* name, main_cache_entry* entry)
+{
+    struct stat st;
+    struct dirent* file;
+    DIR* dir;
+    int entry_fd;
+
+    entry_fd = openat(fd, name, O_RDONLY | O_DIRECTORY);
+    if (entry_fd < 0 || 0 != fstat(entry_fd, &st))
+    {
+        if (entry_fd >= 0)
+        {
+            close(entry_fd);
+        }
+
+        return ERROR_OUTPUT_CACHE;
+    }
+
+    /* the directory takes ownership of the descriptor. */
+    dir = fdopendir(entry_fd);
+    if (NULL == dir)
+    {
+        close(entry_fd);
+        return ERROR_OUTPUT_CACHE;
+    }
+
+    /* the time of an entry is when it was last used. */
+    entry->used = st.st_mtim;
+    entry->size = 0;
+
+    while (NULL != (file = readdir(dir)))
+    {
+        if ('.' != file->d_name[0]
+         && 0 == fstatat(dirfd(dir), file->d_name, &st, 0))
+        {
+            entry->size += (size_t)st.st_size;
+        }
+    }
+
+    closedir(dir);
+
+    entry->name = strdup(name);
+    if (NULL == entry->name)
+    {
+        return ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Order cache entries from the least to the most recently used.
+ *
+ * \param lhs           The left-hand entry.
+ * \param rhs           The right-hand entry.
+ *
+ * \returns less than, equal to or greater than zero as the left-hand entry
+ * was used before, at the same time as, or after the right-hand entry.
+ */
+static int main_cache_entry_compare(const void* lhs, const void* rhs)
+{
+    const main_cache_entry* left = (const main_cache_entry*)lhs;
+    const main_cache_entry* right = (const main_cache_entry*)rhs;
+
+    if (left->used.tv_sec != right->used.tv_sec)
+    {
+        return (left->used.tv_sec < right->used.tv_sec) ? -1 : 1;
+    }
+
+    if (left->used.tv_nsec != right->used.tv_nsec)
+    {
+        return (left->used.tv_nsec < right->used.tv_nsec) ? -1 : 1;
+    }
+
+    return 0;
+}
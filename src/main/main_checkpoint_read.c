@@ -0,0 +1,91 @@
+/**
+ * \file main/main_checkpoint_read.c
+ *
+ * \brief Read a checkpoint file.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <inttypes.h>
+#include <string.h>
+
+#include "main_internal.h"
+
+/**
+ * \brief Read a checkpoint file.
+ *
+ * \param checkpoint    The checkpoint to populate.
+ * \param filename      The name of the checkpoint file.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status main_checkpoint_read(main_checkpoint* checkpoint, const char* filename)
+{
+    status retval;
+    FILE* fp;
+    int version, page_open;
+    weightgraph_render_state* state = &checkpoint->state;
+
+    memset(checkpoint, 0, sizeof(*checkpoint));
+
+    /* open the checkpoint file. */
+    fp = fopen(filename, "r");
+    if (NULL == fp)
+    {
+        retval = ERROR_CHECKPOINT_READ;
+        goto done;
+    }
+
+    /* read the fields in the order in which they are written. */
+    if (1 != fscanf(fp, "weightgraph-checkpoint %d\n", &version)
+     || 1 != version
+     || 1 != fscanf(fp, "format %d\n", &checkpoint->format)
+     || 1 != fscanf(fp, "page-size %zu\n", &checkpoint->page_size)
+     || 1 != fscanf(fp, "raster-size %zu\n", &checkpoint->raster_size)
+     || 1 != fscanf(fp, "initial-average %la\n", &checkpoint->initial_average)
+     || 1 != fscanf(fp, "count %zu\n", &state->count)
+     || 1 != fscanf(fp, "digest %" SCNx64 "\n", &checkpoint->digest)
+     || 1 != fscanf(fp, "average-index %d\n", &checkpoint->average_index)
+     || checkpoint->average_index < 0
+     || checkpoint->average_index >= WEIGHTGRAPH_AVERAGE_WINDOW)
+    {
+        retval = ERROR_CHECKPOINT_READ;
+        goto cleanup_fp;
+    }
+
+    for (int i = 0; i < WEIGHTGRAPH_AVERAGE_WINDOW; ++i)
+    {
+        if (1 != fscanf(fp, "average %la\n", &checkpoint->average_array[i]))
+        {
+            retval = ERROR_CHECKPOINT_READ;
+            goto cleanup_fp;
+        }
+    }
+
+    if (3 != fscanf(
+                fp, "axis %la %la %la\n", &state->axis_min,
+                &state->axis_max, &state->tick_step)
+     || 2 != fscanf(fp, "prev %la %la\n", &state->prevx, &state->prevy)
+     || 3 != fscanf(
+                fp, "page %zu %zu %d\n", &state->page, &state->page_entries,
+                &page_open)
+     || 1 != fscanf(fp, "offset %ld\n", &state->offset))
+    {
+        retval = ERROR_CHECKPOINT_READ;
+        goto cleanup_fp;
+    }
+    state->page_open = (0 != page_open);
+
+    /* success. */
+    retval = STATUS_SUCCESS;
+    goto cleanup_fp;
+
+cleanup_fp:
+    fclose(fp);
+
+done:
+    return retval;
+}
@@ -0,0 +1,107 @@
+/**
+ * \file main/main_checkpoint_write.c
+ *
+ * \brief Write a checkpoint file.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "main_internal.h"
+
+/**
+ * \brief Write a checkpoint file.
+ *
+ * The checkpoint is written to a temporary file that then replaces the
+ * original, so that an interrupted write never leaves a partial checkpoint.
+ *
+ * \param checkpoint    The checkpoint to write.
+ * \param filename      The name of the checkpoint file.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status main_checkpoint_write(
+    const main_checkpoint* checkpoint, const char* filename)
+{
+    status retval;
+    size_t tmpname_size = strlen(filename) + 5;
+    char* tmpname;
+    FILE* fp;
+    long written;
+    const weightgraph_render_state* state = &checkpoint->state;
+
+    /* build the temporary filename. */
+    tmpname = (char*)malloc(tmpname_size);
+    if (NULL == tmpname)
+    {
+        retval = ERROR_GENERAL_OUT_OF_MEMORY;
+        goto done;
+    }
+    snprintf(tmpname, tmpname_size, "%s.tmp", filename);
+
+    /* open the temporary file. */
+    fp = fopen(tmpname, "w");
+    if (NULL == fp)
+    {
+        retval = ERROR_CHECKPOINT_WRITE;
+        goto cleanup_tmpname;
+    }
+
+    /* doubles are written in hex so that they round-trip exactly. */
+    fprintf(fp, "weightgraph-checkpoint 1\n");
+    fprintf(fp, "format %d\n", checkpoint->format);
+    fprintf(fp, "page-size %zu\n", checkpoint->page_size);
+    fprintf(fp, "raster-size %zu\n", checkpoint->raster_size);
+    fprintf(fp, "initial-average %a\n", checkpoint->initial_average);
+    fprintf(fp, "count %zu\n", state->count);
+    fprintf(fp, "digest %016" PRIx64 "\n", checkpoint->digest);
+    fprintf(fp, "average-index %d\n", checkpoint->average_index);
+    for (int i = 0; i < WEIGHTGRAPH_AVERAGE_WINDOW; ++i)
+    {
+        fprintf(fp, "average %a\n", checkpoint->average_array[i]);
+    }
+    fprintf(
+        fp, "axis %a %a %a\n", state->axis_min, state->axis_max,
+        state->tick_step);
+    fprintf(fp, "prev %a %a\n", state->prevx, state->prevy);
+    fprintf(
+        fp, "page %zu %zu %d\n", state->page, state->page_entries,
+        state->page_open ? 1 : 0);
+    fprintf(fp, "offset %ld\n", state->offset);
+
+    /* close the file, flushing it. */
+    written = ftell(fp);
+    if (ferror(fp) | fclose(fp))
+    {
+        retval = ERROR_CHECKPOINT_WRITE;
+        goto cleanup_file;
+    }
+
+    main_stats_count_written((written < 0) ? 0 : (size_t)written);
+
+    /* replace the old checkpoint. */
+    if (0 != rename(tmpname, filename))
+    {
+        retval = ERROR_CHECKPOINT_WRITE;
+        goto cleanup_file;
+    }
+
+    /* success. */
+    retval = STATUS_SUCCESS;
+    goto cleanup_tmpname;
+
+cleanup_file:
+    remove(tmpname);
+
+cleanup_tmpname:
+    free(tmpname);
+
+done:
+    return retval;
+}
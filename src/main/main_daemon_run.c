@@ -0,0 +1,1183 @@
+/**
+ * \file main/main_daemon_run.c
+ *
+ * \brief Serve render requests on a Unix domain socket.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "main_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief The number of parsed logs kept between requests.
+ */
+#define MAIN_DAEMON_CACHE_SIZE 16
+
+/**
+ * \brief The number of accepted connections that may wait for a worker.
+ */
+#define MAIN_DAEMON_QUEUE_SIZE 16
+
+/**
+ * \brief The longest a connection may go without sending or receiving, in
+ * seconds, before it is closed.
+ */
+#define MAIN_DAEMON_TIMEOUT 10
+
+/**
+ * \brief A parsed log, cached until its file changes.
+ */
+typedef struct main_daemon_series main_daemon_series;
+
+struct main_daemon_series
+{
+    /* the path of the log, or NULL if this slot is empty. */
+    char* path;
+    /* the identity and modification time of the file when it was parsed. */
+    dev_t dev;
+    ino_t ino;
+    off_t size;
+    struct timespec mtime;
+    /* the session holding the entries of the log. */
+    weightgraph_session* session;
+    /* the rollups of the log into each calendar period, made as they are
+     * first requested, or NULL. */
+    weightgraph_session* rollups[WEIGHTGRAPH_PERIOD_COUNT];
+    /* the request clock when this log was last used. */
+    uint64_t last_used;
+};
+
+/**
+ * \brief The warm state of the daemon, kept between requests.
+ */
+typedef struct main_daemon main_daemon;
+
+/**
+ * \brief A worker serving connections to the daemon.
+ */
+typedef struct main_daemon_worker main_daemon_worker;
+
+struct main_daemon
+{
+    const main_options* options;
+    /* guards the parser, buffer, cached logs, clock and latency histogram,
+     * which are shared by the workers. */
+    pthread_mutex_t lock;
+    allocator* alloc;
+    weightgraph_parser* parser;
+    uint8_t* buffer;
+    size_t buffer_capacity;
+    main_daemon_series cache[MAIN_DAEMON_CACHE_SIZE];
+    uint64_t clock;
+    main_latency_histogram latency;
+    /* guards the queue of accepted connections, and the connection each
+     * worker is serving. */
+    pthread_mutex_t queue_lock;
+    pthread_cond_t queue_ready;
+    pthread_cond_t queue_space;
+    int queue[MAIN_DAEMON_QUEUE_SIZE];
+    size_t queue_head;
+    size_t queue_count;
+    bool closing;
+    main_daemon_worker* workers;
+    size_t worker_count;
+};
+
+struct main_daemon_worker
+{
+    main_daemon* daemon;
+    pthread_t thread;
+    /* the session used for samples sent with a request, owned by this
+     * worker so that they are read and rendered without locking. */
+    allocator* alloc;
+    weightgraph_session* scratch;
+    /* the connection being served, or -1. */
+    int fd;
+    /* the time the current request has waited for the lock, in
+     * microseconds. */
+    uint64_t waited;
+};
+
+/* the write end of a pipe that stops the listener, written by the signal
+ * handler or a shutdown request. */
+static int main_daemon_wake_fd = -1;
+
+/* forward decls. */
+static void main_daemon_signal(int sig);
+static void main_daemon_wake(void);
+static status main_daemon_listen(int* sock, const char* path);
+static status main_daemon_serve(main_daemon* daemon, int sock, int wake);
+static void main_daemon_enqueue(main_daemon* daemon, int fd);
+static void* main_daemon_thread(void* context);
+static void main_daemon_connection(main_daemon_worker* worker, int fd);
+static void main_daemon_lock(main_daemon_worker* worker);
+static uint64_t main_daemon_micros(
+    const struct timespec* start, const struct timespec* stop);
+static status main_daemon_request(
+    main_daemon_worker* worker, char* line, FILE* in, FILE* out);
+static status main_daemon_render_file(
+    main_daemon_worker* worker, char* args, FILE* out);
+static status main_daemon_render_samples(
+    main_daemon_worker* worker, char* args, FILE* in, FILE* out);
+static status main_daemon_series_get(
+    main_daemon* daemon, weightgraph_session** session, const char* path,
+    int period);
+static void main_daemon_series_drop_rollups(main_daemon_series* series);
+static status main_daemon_render(
+    main_daemon* daemon, weightgraph_session* session, int format,
+    const char* output, FILE* out);
+static bool main_daemon_parse_format(int* format, const char* name);
+
+/**
+ * \brief Serve render requests on a Unix domain socket until shut down.
+ *
+ * Connections are served by a pool of workers, one connection per worker at
+ * a time.  The parser, sessions and buffers are kept warm between requests,
+ * and parsed logs, and their rollups, are cached until their files change.
+ * A connection that sends or receives nothing for a while is closed, so that
+ * a stalled client can't hold a worker forever.
+ *
+ * \param options       The command-line options.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status main_daemon_run(const main_options* options)
+{
+    status retval;
+    main_daemon daemon;
+    struct sigaction action;
+    size_t started = 0;
+    int sock;
+    int wake[2];
+
+    memset(&daemon, 0, sizeof(daemon));
+    daemon.options = options;
+    pthread_mutex_init(&daemon.lock, NULL);
+    pthread_mutex_init(&daemon.queue_lock, NULL);
+    pthread_cond_init(&daemon.queue_ready, NULL);
+    pthread_cond_init(&daemon.queue_space, NULL);
+
+    /* create the warm state. */
+    retval = malloc_allocator_create(&daemon.alloc);
+    if (STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Could not create allocator.\n");
+        goto cleanup_locks;
+    }
+
+    retval = weightgraph_parser_create(&daemon.parser, daemon.alloc);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_allocator;
+    }
+
+    /* each worker has its own allocator and scratch session. */
+    daemon.worker_count = (0 == options->threads) ? 1 : options->threads;
+    daemon.workers =
+        (main_daemon_worker*)calloc(
+            daemon.worker_count, sizeof(main_daemon_worker));
+    if (NULL == daemon.workers)
+    {
+        retval = ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_parser;
+    }
+
+    for (size_t i = 0; i < daemon.worker_count; ++i)
+    {
+        main_daemon_worker* worker = &daemon.workers[i];
+
+        worker->daemon = &daemon;
+        worker->fd = -1;
+
+        retval = malloc_allocator_create(&worker->alloc);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_workers;
+        }
+
+        retval =
+            main_session_create(&worker->scratch, worker->alloc, 0.0, options);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_workers;
+        }
+    }
+
+    /* the listener is woken through a pipe when the daemon stops. */
+    if (0 != pipe(wake))
+    {
+        retval = ERROR_DAEMON_SOCKET;
+        goto cleanup_workers;
+    }
+
+    fcntl(wake[1], F_SETFL, O_NONBLOCK);
+    main_daemon_wake_fd = wake[1];
+
+    /* stop cleanly on a signal, and survive clients that hang up. */
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = &main_daemon_signal;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    retval = main_daemon_listen(&sock, options->socket_file);
+    if (STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Error listening on %s.\n", options->socket_file);
+        goto cleanup_wake;
+    }
+
+    /* start the workers. */
+    for (started = 0; started < daemon.worker_count; ++started)
+    {
+        if (0 !=
+            pthread_create(
+                &daemon.workers[started].thread, NULL, &main_daemon_thread,
+                &daemon.workers[started]))
+        {
+            break;
+        }
+    }
+
+    /* accept connections until shut down, if any worker could start. */
+    retval =
+        (0 == started)
+            ? ERROR_DAEMON_SOCKET : main_daemon_serve(&daemon, sock, wake[0]);
+
+    close(sock);
+    unlink(options->socket_file);
+
+    /* stop the workers, waking any still reading from a client. */
+    pthread_mutex_lock(&daemon.queue_lock);
+    daemon.closing = true;
+    for (size_t i = 0; i < started; ++i)
+    {
+        if (daemon.workers[i].fd >= 0)
+        {
+            shutdown(daemon.workers[i].fd, SHUT_RD);
+        }
+    }
+    pthread_cond_broadcast(&daemon.queue_ready);
+    pthread_cond_broadcast(&daemon.queue_space);
+    pthread_mutex_unlock(&daemon.queue_lock);
+
+    for (size_t i = 0; i < started; ++i)
+    {
+        pthread_join(daemon.workers[i].thread, NULL);
+    }
+
+    /* hang up on the connections no worker got to. */
+    while (daemon.queue_count > 0)
+    {
+        close(daemon.queue[daemon.queue_head]);
+        daemon.queue_head = (daemon.queue_head + 1) % MAIN_DAEMON_QUEUE_SIZE;
+        --daemon.queue_count;
+    }
+
+    /* release the cached logs. */
+    for (size_t i = 0; i < MAIN_DAEMON_CACHE_SIZE; ++i)
+    {
+        free(daemon.cache[i].path);
+        main_daemon_series_drop_rollups(&daemon.cache[i]);
+        if (NULL != daemon.cache[i].session)
+        {
+            resource_release(
+                weightgraph_session_resource_handle(daemon.cache[i].session));
+        }
+    }
+
+    free(daemon.buffer);
+
+cleanup_wake:
+    main_daemon_wake_fd = -1;
+    close(wake[0]);
+    close(wake[1]);
+
+cleanup_workers:
+    for (size_t i = 0; i < daemon.worker_count; ++i)
+    {
+        if (NULL != daemon.workers[i].scratch)
+        {
+            resource_release(
+                weightgraph_session_resource_handle(
+                    daemon.workers[i].scratch));
+        }
+
+        if (NULL != daemon.workers[i].alloc)
+        {
+            resource_release(
+                allocator_resource_handle(daemon.workers[i].alloc));
+        }
+    }
+
+    free(daemon.workers);
+
+cleanup_parser:
+    resource_release(weightgraph_parser_resource_handle(daemon.parser));
+
+cleanup_allocator:
+    resource_release(allocator_resource_handle(daemon.alloc));
+
+cleanup_locks:
+    pthread_cond_destroy(&daemon.queue_space);
+    pthread_cond_destroy(&daemon.queue_ready);
+    pthread_mutex_destroy(&daemon.queue_lock);
+    pthread_mutex_destroy(&daemon.lock);
+
+    return retval;
+}
+
+/**
+ * \brief Stop serving requests.
+ *
+ * \param sig           The signal.
+ */
+static void main_daemon_signal(int sig)
+{
+    (void)sig;
+
+    main_daemon_wake();
+}
+
+/**
+ * \brief Wake the listener, so that it stops the daemon.
+ *
+ * This is safe to call from a signal handler.
+ */
+static void main_daemon_wake(void)
+{
+    char byte = 0;
+    int fd = main_daemon_wake_fd;
+
+    /* a full pipe already wakes the listener. */
+    if (fd >= 0 && write(fd, &byte, 1) < 0)
+    {
+        return;
+    }
+}
+
+/**
+ * \brief Listen on a Unix domain socket.
+ *
+ * A socket left behind by a previous daemon is replaced.  Any other file at
+ * the path is left alone.
+ *
+ * \param sock          Pointer to receive the listening socket.
+ * \param path          The path of the socket.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_daemon_listen(int* sock, const char* path)
+{
+    struct sockaddr_un addr;
+    struct stat st;
+    int fd;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path))
+    {
+        return ERROR_DAEMON_SOCKET;
+    }
+    strcpy(addr.sun_path, path);
+
+    /* remove a stale socket. */
+    if (0 == lstat(path, &st) && S_ISSOCK(st.st_mode))
+    {
+        unlink(path);
+    }
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        return ERROR_DAEMON_SOCKET;
+    }
+
+    if (0 != bind(fd, (struct sockaddr*)&addr, sizeof(addr))
+     || 0 != listen(fd, 16))
+    {
+        close(fd);
+        return ERROR_DAEMON_SOCKET;
+    }
+
+    *sock = fd;
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Accept connections, and queue them for the workers, until the daemon
+ * stops.
+ *
+ * \param daemon        The daemon.
+ * \param sock          The listening socket.
+ * \param wake          The read end of the pipe that wakes the listener.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_daemon_serve(main_daemon* daemon, int sock, int wake)
+{
+    struct timeval timeout = { MAIN_DAEMON_TIMEOUT, 0 };
+    int fd;
+
+    for (;;)
+    {
+        struct pollfd fds[2] = {
+            { sock, POLLIN, 0 }, { wake, POLLIN, 0 } };
+
+        if (poll(fds, 2, -1) < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+
+            return ERROR_DAEMON_SOCKET;
+        }
+
+        /* anything written to the pipe stops the daemon. */
+        if (0 != fds[1].revents)
+        {
+            return STATUS_SUCCESS;
+        }
+
+        if (0 == (fds[0].revents & POLLIN))
+        {
+            continue;
+        }
+
+        fd = accept(sock, NULL, NULL);
+        if (fd < 0)
+        {
+            if (EINTR == errno || ECONNABORTED == errno)
+            {
+                continue;
+            }
+
+            return ERROR_DAEMON_SOCKET;
+        }
+
+        /* a client that stops sending or receiving is hung up on. */
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        main_daemon_enqueue(daemon, fd);
+    }
+}
+
+/**
+ * \brief Queue an accepted connection for the next free worker, waiting for
+ * room in the queue if need be.
+ *
+ * \param daemon        The daemon.
+ * \param fd            The connection.
+ */
+static void main_daemon_enqueue(main_daemon* daemon, int fd)
+{
+    pthread_mutex_lock(&daemon->queue_lock);
+    while (MAIN_DAEMON_QUEUE_SIZE == daemon->queue_count && !daemon->closing)
+    {
+        pthread_cond_wait(&daemon->queue_space, &daemon->queue_lock);
+    }
+
+    if (daemon->closing)
+    {
+        close(fd);
+    }
+    else
+    {
+        daemon->queue[
+            (daemon->queue_head + daemon->queue_count++)
+                % MAIN_DAEMON_QUEUE_SIZE] = fd;
+        pthread_cond_signal(&daemon->queue_ready);
+    }
+    pthread_mutex_unlock(&daemon->queue_lock);
+}
+
+/**
+ * \brief Serve queued connections until the daemon stops.
+ *
+ * \param context       The worker.
+ *
+ * \returns NULL.
+ */
+static void* main_daemon_thread(void* context)
+{
+    main_daemon_worker* worker = (main_daemon_worker*)context;
+    main_daemon* daemon = worker->daemon;
+    int fd;
+
+    main_trace_thread_name("daemon worker");
+
+    for (;;)
+    {
+        /* take the next connection, claiming it while the lock is held so
+         * that a stopping daemon can wake this worker. */
+        pthread_mutex_lock(&daemon->queue_lock);
+        while (0 == daemon->queue_count && !daemon->closing)
+        {
+            pthread_cond_wait(&daemon->queue_ready, &daemon->queue_lock);
+        }
+
+        if (daemon->closing)
+        {
+            pthread_mutex_unlock(&daemon->queue_lock);
+            break;
+        }
+
+        fd = daemon->queue[daemon->queue_head];
+        daemon->queue_head = (daemon->queue_head + 1) % MAIN_DAEMON_QUEUE_SIZE;
+        --daemon->queue_count;
+        worker->fd = fd;
+        pthread_cond_signal(&daemon->queue_space);
+        pthread_mutex_unlock(&daemon->queue_lock);
+
+        main_daemon_connection(worker, fd);
+    }
+
+    return NULL;
+}
+
+/**
+ * \brief Serve the requests on a connection until the client hangs up or
+ * stops sending, or the daemon stops and shuts down its end.
+ *
+ * Each request is a line, and each is answered with a line starting with
+ * "ok" or "error".  The latency of each request is recorded, from when its
+ * line is read until its reply is sent, less any time it waited for the
+ * requests of other connections.
+ *
+ * \param worker        The worker.
+ * \param fd            The connection, which is closed when done.
+ */
+static void main_daemon_connection(main_daemon_worker* worker, int fd)
+{
+    main_daemon* daemon = worker->daemon;
+    struct timespec start, stop;
+    FILE* in = NULL;
+    FILE* out = NULL;
+    char* line = NULL;
+    size_t line_capacity = 0;
+    ssize_t line_size;
+    uint64_t micros;
+    int out_fd;
+
+    /* use separate streams for each direction of the socket. */
+    out_fd = dup(fd);
+    if (out_fd < 0)
+    {
+        goto release;
+    }
+
+    out = fdopen(out_fd, "w");
+    if (NULL == out)
+    {
+        close(out_fd);
+        goto release;
+    }
+
+    in = fdopen(fd, "r");
+    if (NULL == in)
+    {
+        goto release;
+    }
+
+    while ((line_size = getline(&line, &line_capacity, in)) > 0)
+    {
+        /* a line cut short by a hang-up or timeout is not a request. */
+        if ('\n' != line[line_size - 1])
+        {
+            break;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        worker->waited = 0;
+
+        /* strip the line ending. */
+        while (line_size > 0
+            && ('\n' == line[line_size - 1] || '\r' == line[line_size - 1]))
+        {
+            line[--line_size] = 0;
+        }
+
+        /* skip blank lines. */
+        if (0 == line_size)
+        {
+            continue;
+        }
+
+        main_daemon_request(worker, line, in, out);
+        if (0 != fflush(out))
+        {
+            break;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &stop);
+        micros = main_daemon_micros(&start, &stop);
+        micros -= (worker->waited < micros) ? worker->waited : micros;
+
+        pthread_mutex_lock(&daemon->lock);
+        main_latency_histogram_record(&daemon->latency, micros);
+        pthread_mutex_unlock(&daemon->lock);
+    }
+
+release:
+    /* give up the connection before closing it, so that a stopping daemon
+     * never shuts down a descriptor that has been reused. */
+    pthread_mutex_lock(&daemon->queue_lock);
+    worker->fd = -1;
+    pthread_mutex_unlock(&daemon->queue_lock);
+
+    free(line);
+    if (NULL != out)
+    {
+        fclose(out);
+    }
+    if (NULL != in)
+    {
+        fclose(in);
+    }
+    else
+    {
+        close(fd);
+    }
+}
+
+/**
+ * \brief Take the lock on the shared state of the daemon, counting the time
+ * spent waiting for it against the current request.
+ *
+ * \param worker        The worker.
+ */
+static void main_daemon_lock(main_daemon_worker* worker)
+{
+    struct timespec start, stop;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pthread_mutex_lock(&worker->daemon->lock);
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+
+    worker->waited += main_daemon_micros(&start, &stop);
+}
+
+/**
+ * \brief Get the time between two readings of the monotonic clock.
+ *
+ * \param start         The earlier reading.
+ * \param stop          The later reading.
+ *
+ * \returns the time, in microseconds.
+ */
+static uint64_t main_daemon_micros(
+    const struct timespec* start, const struct timespec* stop)
+{
+    return
+        (uint64_t)(stop->tv_sec - start->tv_sec) * 1000000
+            + (stop->tv_nsec - start->tv_nsec) / 1000;
+}
+
+/**
+ * \brief Dispatch a single request.
+ *
+ * \param worker        The worker serving the request.
+ * \param line          The request line, which is modified.
+ * \param in            The stream from which any request body is read.
+ * \param out           The stream to which the reply is written.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_daemon_request(
+    main_daemon_worker* worker, char* line, FILE* in, FILE* out)
+{
+    status retval;
+    char* command = line;
+    char* args;
+
+    /* split the command from its arguments. */
+    args = line + strcspn(line, " \t");
+    if (0 != *args)
+    {
+        *args++ = 0;
+    }
+
+    if (!strcmp(command, "render"))
+    {
+        retval = main_daemon_render_file(worker, args, out);
+    }
+    else if (!strcmp(command, "samples"))
+    {
+        retval = main_daemon_render_samples(worker, args, in, out);
+    }
+    else if (!strcmp(command, "stats"))
+    {
+        main_daemon_lock(worker);
+        main_latency_histogram_write(&worker->daemon->latency, out);
+        pthread_mutex_unlock(&worker->daemon->lock);
+        retval = STATUS_SUCCESS;
+        fprintf(out, "ok\n");
+    }
+    else if (!strcmp(command, "shutdown"))
+    {
+        main_daemon_wake();
+        retval = STATUS_SUCCESS;
+        fprintf(out, "ok\n");
+    }
+    else
+    {
+        retval = ERROR_BAD_REQUEST;
+    }
+
+    if (STATUS_SUCCESS != retval)
+    {
+        fprintf(out, "error %d\n", retval);
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Render a log file.
+ *
+ * The arguments are the format, the input file and the output file, and
+ * optionally the calendar period into which the log is rolled up.  The log
+ * is looked up, and rendered, holding the lock on the cached logs.
+ *
+ * \param worker        The worker serving the request.
+ * \param args          The request arguments, which are modified.
+ * \param out           The stream to which the reply is written.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_daemon_render_file(
+    main_daemon_worker* worker, char* args, FILE* out)
+{
+    main_daemon* daemon = worker->daemon;
+    status retval;
+    weightgraph_session* session;
+    char* save;
+    const char* format_name = strtok_r(args, " \t", &save);
+    const char* input = strtok_r(NULL, " \t", &save);
+    const char* output = strtok_r(NULL, " \t", &save);
+    const char* period_name = strtok_r(NULL, " \t", &save);
+    int format;
+    int period = WEIGHTGRAPH_PERIOD_DAY;
+
+    if (NULL == output || NULL != strtok_r(NULL, " \t", &save)
+     || !main_daemon_parse_format(&format, format_name)
+     || (NULL != period_name
+      && !weightgraph_period_from_name(period_name, &period)))
+    {
+        return ERROR_BAD_REQUEST;
+    }
+
+    main_daemon_lock(worker);
+    retval = main_daemon_series_get(daemon, &session, input, period);
+    if (STATUS_SUCCESS == retval)
+    {
+        retval = main_daemon_render(daemon, session, format, output, out);
+    }
+    pthread_mutex_unlock(&daemon->lock);
+
+    return retval;
+}
+
+/**
+ * \brief Render samples sent with the request.
+ *
+ * The arguments are the format, the output file and the initial moving
+ * average.  The request is followed by one "date weight" line per sample,
+ * in date order, and ends with a line reading "end".  The samples are held
+ * in the worker's own session, so no lock is needed.
+ *
+ * \param worker        The worker serving the request.
+ * \param args          The request arguments, which are modified.
+ * \param in            The stream from which the samples are read.
+ * \param out           The stream to which the reply is written.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_daemon_render_samples(
+    main_daemon_worker* worker, char* args, FILE* in, FILE* out)
+{
+    status retval = STATUS_SUCCESS;
+    char* save;
+    const char* format_name = strtok_r(args, " \t", &save);
+    const char* output = strtok_r(NULL, " \t", &save);
+    const char* average = strtok_r(NULL, " \t", &save);
+    char* line = NULL;
+    size_t line_capacity = 0;
+    ssize_t line_size;
+    bool ended = false;
+    char* end;
+    double initial_average;
+    int format;
+
+    if (NULL == average || !main_daemon_parse_format(&format, format_name))
+    {
+        return ERROR_BAD_REQUEST;
+    }
+
+    initial_average = strtod(average, &end);
+    if (0 != *end)
+    {
+        return ERROR_BAD_REQUEST;
+    }
+
+    weightgraph_session_reset(worker->scratch, initial_average);
+
+    /* read the samples.  The whole body is consumed even on error, so that
+     * the next request on the connection starts in the right place. */
+    while ((line_size = getline(&line, &line_capacity, in)) > 0)
+    {
+        char* date;
+        char* weight;
+        double value;
+
+        /* a body cut short by a hang-up or timeout is never ended. */
+        if ('\n' != line[line_size - 1])
+        {
+            break;
+        }
+
+        date = strtok_r(line, " \t\r\n", &save);
+        if (NULL == date)
+        {
+            continue;
+        }
+        else if (!strcmp(date, "end"))
+        {
+            ended = true;
+            break;
+        }
+
+        /* after an error, only the end of the body is of interest. */
+        if (STATUS_SUCCESS != retval)
+        {
+            continue;
+        }
+
+        weight = strtok_r(NULL, " \t\r\n", &save);
+        if (NULL == weight)
+        {
+            retval = ERROR_BAD_REQUEST;
+            continue;
+        }
+
+        value = strtod(weight, &end);
+        if (0 != *end)
+        {
+            retval = ERROR_BAD_REQUEST;
+            continue;
+        }
+
+        retval = weightgraph_session_push(worker->scratch, date, value);
+    }
+
+    free(line);
+
+    if (!ended)
+    {
+        return ERROR_BAD_REQUEST;
+    }
+
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    return
+        main_daemon_render(
+            worker->daemon, worker->scratch, format, output, out);
+}
+
+/**
+ * \brief Get the session holding a log, parsing it only if it has changed.
+ *
+ * Logs are cached by path, along with the identity, size and modification
+ * time of the file.  When the cache is full, the least recently used log is
+ * replaced.  A rollup of a log is cached with it once it has been made, and
+ * is dropped along with the log.  The caller holds the lock on the cached
+ * logs.
+ *
+ * \param daemon        The daemon.
+ * \param session       Pointer to receive the session, or its rollup.
+ * \param path          The path of the log.
+ * \param period        The period into which the log is rolled up
+ *                      (WEIGHTGRAPH_PERIOD_*).
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_daemon_series_get(
+    main_daemon* daemon, weightgraph_session** session, const char* path,
+    int period)
+{
+    status retval, release_retval;
+    main_daemon_series* slot = NULL;
+    struct stat st;
+    weightgraph* graph;
+    size_t size;
+    uint64_t trace_start;
+
+    ++daemon->clock;
+
+    if (0 != stat(path, &st))
+    {
+        return ERROR_STAT_FAILED;
+    }
+
+    /* find the log, or the slot to replace with it. */
+    for (size_t i = 0; i < MAIN_DAEMON_CACHE_SIZE; ++i)
+    {
+        main_daemon_series* series = &daemon->cache[i];
+
+        if (NULL != series->path && !strcmp(series->path, path))
+        {
+            slot = series;
+            break;
+        }
+
+        if (NULL == slot
+         || (NULL != slot->path
+          && (NULL == series->path
+           || series->last_used < slot->last_used)))
+        {
+            slot = series;
+        }
+    }
+
+    /* an unchanged log is served from the cache. */
+    if (NULL != slot->path && !strcmp(slot->path, path)
+     && slot->dev == st.st_dev && slot->ino == st.st_ino
+     && slot->size == st.st_size
+     && slot->mtime.tv_sec == st.st_mtim.tv_sec
+     && slot->mtime.tv_nsec == st.st_mtim.tv_nsec)
+    {
+        slot->last_used = daemon->clock;
+        goto rollup;
+    }
+
+    /* evict whatever the slot held. */
+    if (NULL != slot->path)
+    {
+        free(slot->path);
+        slot->path = NULL;
+    }
+    main_daemon_series_drop_rollups(slot);
+
+    /* read and parse the log with the warm buffer and parser. */
+    retval =
+        main_read_file_buffer(
+            &daemon->buffer, &daemon->buffer_capacity, &size, path);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    weightgraph_parser_set_format(
+        daemon->parser, weightgraph_input_format_from_name(path));
+    trace_start = main_trace_begin();
+    retval =
+        weightgraph_parser_parse(daemon->parser, &graph, daemon->buffer, size);
+    main_trace_end("build", trace_start, size);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* reuse the slot's session, if it has one. */
+    if (NULL == slot->session)
+    {
+        retval =
+            main_session_create(
+                &slot->session, daemon->alloc, graph->initial_average,
+                daemon->options);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_graph;
+        }
+    }
+    else
+    {
+        weightgraph_session_reset(slot->session, graph->initial_average);
+    }
+
+    retval = main_push_entries(slot->session, graph);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_graph;
+    }
+
+    slot->path = strdup(path);
+    if (NULL == slot->path)
+    {
+        retval = ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_graph;
+    }
+
+    /* success. */
+    slot->dev = st.st_dev;
+    slot->ino = st.st_ino;
+    slot->size = st.st_size;
+    slot->mtime = st.st_mtim;
+    slot->last_used = daemon->clock;
+    retval = STATUS_SUCCESS;
+    goto cleanup_graph;
+
+cleanup_graph:
+    release_retval = resource_release(&graph->hdr);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+rollup:
+    if (WEIGHTGRAPH_PERIOD_DAY == period)
+    {
+        *session = slot->session;
+        return STATUS_SUCCESS;
+    }
+
+    /* roll the log up the first time the period is asked for. */
+    if (NULL == slot->rollups[period])
+    {
+        trace_start = main_trace_begin();
+        retval =
+            weightgraph_session_rollup(
+                &slot->rollups[period], daemon->alloc, slot->session, period,
+                daemon->options->threads);
+        main_trace_end(
+            "rollup", trace_start, weightgraph_session_count(slot->session));
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    *session = slot->rollups[period];
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Release the rollups cached with a log.
+ *
+ * \param series        The cached log.
+ */
+static void main_daemon_series_drop_rollups(main_daemon_series* series)
+{
+    for (int i = 0; i < WEIGHTGRAPH_PERIOD_COUNT; ++i)
+    {
+        if (NULL != series->rollups[i])
+        {
+            resource_release(
+                weightgraph_session_resource_handle(series->rollups[i]));
+            series->rollups[i] = NULL;
+        }
+    }
+}
+
+/**
+ * \brief Render a session to a file, and reply with its moving average.
+ *
+ * \param daemon        The daemon.
+ * \param session       The session to render.
+ * \param format        The output format.
+ * \param output        The name of the output file.
+ * \param out           The stream to which the reply is written.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_daemon_render(
+    main_daemon* daemon, weightgraph_session* session, int format,
+    const char* output, FILE* out)
+{
+    status retval;
+    weightgraph_render_options render_options;
+    weightgraph_render_state state;
+    main_file_sink file;
+    weightgraph_sink sink;
+    uint64_t trace_start;
+
+    memset(&render_options, 0, sizeof(render_options));
+    render_options.format = format;
+    render_options.raster_size = daemon->options->raster_size;
+    render_options.page_size = daemon->options->page_size;
+    render_options.threads = daemon->options->threads;
+
+    main_file_sink_init(&sink, &file, output);
+    trace_start = main_trace_begin();
+    retval =
+        weightgraph_session_render(session, &render_options, &sink, &state);
+    main_trace_end("render", trace_start, weightgraph_session_count(session));
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    fprintf(out, "ok %lf\n", weightgraph_session_average(session));
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Parse the name of an output format.
+ *
+ * \param format        Pointer to receive the format.
+ * \param name          The name of the format, or NULL.
+ *
+ * \returns true if the format is known.
+ */
+static bool main_daemon_parse_format(int* format, const char* name)
+{
+    if (NULL == name)
+    {
+        return false;
+    }
+    else if (!strcmp(name, "eps"))
+    {
+        *format = WEIGHTGRAPH_FORMAT_EPS;
+        return true;
+    }
+    else if (!strcmp(name, "png"))
+    {
+        *format = WEIGHTGRAPH_FORMAT_PNG;
+        return true;
+    }
+
+    return false;
+}
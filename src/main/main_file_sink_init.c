@@ -0,0 +1,189 @@
+/**
+ * \file main/main_file_sink_init.c
+ *
+ * \brief Initialize a sink that writes graph output to files.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "main_internal.h"
+
+/* forward decls. */
+static status main_file_sink_open(void* context, size_t page, long offset);
+static status main_file_sink_write(
+    void* context, const void* data, size_t size);
+static status main_file_sink_close(void* context);
+
+/**
+ * \brief Initialize a sink that writes graph output to files.
+ *
+ * Page 0 is written to the output filename.  Otherwise, the page number is
+ * inserted before the extension, so that page 2 of "graph.png" is written to
+ * "graph-2.png".  An existing file with other hard links is replaced rather
+ * than rewritten.
+ *
+ * \param sink          The sink to initialize.
+ * \param file          The file sink state.
+ * \param filename      The name of the output file.
+ */
+void main_file_sink_init(
+    weightgraph_sink* sink, main_file_sink* file, const char* filename)
+{
+    file->filename = filename;
+    file->fp = NULL;
+
+    sink->context = file;
+    sink->open = &main_file_sink_open;
+    sink->write = &main_file_sink_write;
+    sink->close = &main_file_sink_close;
+}
+
+/**
+ * \brief Open the output file for a page.
+ *
+ * \param context       The file sink.
+ * \param page          The page number, or 0 for the output file itself.
+ * \param offset        If non-zero, the existing file is truncated to this
+ *                      offset, and writes continue from there.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_file_sink_open(void* context, size_t page, long offset)
+{
+    main_file_sink* file = (main_file_sink*)context;
+    size_t name_size = strlen(file->filename) + 32;
+    const char* slash = strrchr(file->filename, '/');
+    const char* dot = strrchr(file->filename, '.');
+    struct stat st;
+    char* name;
+
+    /* only a dot in the last path component starts an extension. */
+    if (NULL == dot || (NULL != slash && dot < slash))
+    {
+        dot = file->filename + strlen(file->filename);
+    }
+
+    name = (char*)malloc(name_size);
+    if (NULL == name)
+    {
+        return ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    /* number the page, if requested. */
+    if (0 == page)
+    {
+        snprintf(name, name_size, "%s", file->filename);
+    }
+    else
+    {
+        snprintf(
+            name, name_size, "%.*s-%zu%s", (int)(dot - file->filename),
+            file->filename, page, dot);
+    }
+
+    /* a file with other links, such as one in the output cache of a batch,
+     * is replaced rather than rewritten, so that the other links keep their
+     * contents. */
+    if (0 == lstat(name, &st) && S_ISREG(st.st_mode) && st.st_nlink > 1)
+    {
+        if (0 != offset)
+        {
+            free(name);
+            return ERROR_CHECKPOINT_STALE;
+        }
+
+        unlink(name);
+    }
+
+    if (0 == offset)
+    {
+        file->fp = fopen(name, "w");
+        free(name);
+
+        return (NULL == file->fp) ? ERROR_OUTPUT_FILE_OPEN : STATUS_SUCCESS;
+    }
+
+    /* the file must still contain everything up to the offset. */
+    file->fp = fopen(name, "r+");
+    free(name);
+    if (NULL == file->fp)
+    {
+        return ERROR_CHECKPOINT_STALE;
+    }
+
+    if (0 != fseek(file->fp, 0, SEEK_END) || ftell(file->fp) < offset)
+    {
+        fclose(file->fp);
+        file->fp = NULL;
+        return ERROR_CHECKPOINT_STALE;
+    }
+
+    /* drop everything after the offset, and continue from there. */
+    if (0 != ftruncate(fileno(file->fp), offset)
+     || 0 != fseek(file->fp, offset, SEEK_SET))
+    {
+        fclose(file->fp);
+        file->fp = NULL;
+        return ERROR_OUTPUT_WRITE;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Write data to the open output file.
+ *
+ * \param context       The file sink.
+ * \param data          The data to write.
+ * \param size          The size of the data.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_file_sink_write(
+    void* context, const void* data, size_t size)
+{
+    main_file_sink* file = (main_file_sink*)context;
+    uint64_t trace_start =
+        (size >= MAIN_TRACE_FLUSH_MIN) ? main_trace_begin() : 0;
+
+    if (size != fwrite(data, 1, size, file->fp))
+    {
+        return ERROR_OUTPUT_WRITE;
+    }
+
+    main_stats_count_written(size);
+    main_trace_end("flush", trace_start, size);
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Close the open output file.
+ *
+ * \param context       The file sink.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_file_sink_close(void* context)
+{
+    main_file_sink* file = (main_file_sink*)context;
+    uint64_t trace_start = main_trace_begin();
+    int result = fclose(file->fp);
+
+    main_trace_end("flush", trace_start, 0);
+    file->fp = NULL;
+
+    return (0 == result) ? STATUS_SUCCESS : ERROR_OUTPUT_WRITE;
+}
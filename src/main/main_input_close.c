@@ -0,0 +1,42 @@
+/**
+ * \file main/main_input_close.c
+ *
+ * \brief Close an input file.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "main_internal.h"
+
+/**
+ * \brief Close an input file, stopping its decompression thread.
+ *
+ * \param input         The input.
+ */
+void main_input_close(main_input* input)
+{
+    if (input->started)
+    {
+        /* the thread may be waiting for a free chunk. */
+        pthread_mutex_lock(&input->lock);
+        input->stop = true;
+        pthread_cond_broadcast(&input->cond);
+        pthread_mutex_unlock(&input->lock);
+
+        pthread_join(input->thread, NULL);
+
+        pthread_cond_destroy(&input->cond);
+        pthread_mutex_destroy(&input->lock);
+    }
+
+    for (size_t i = 0; i < MAIN_INPUT_SLOTS; ++i)
+    {
+        free(input->slots[i]);
+    }
+
+    close(input->fd);
+}
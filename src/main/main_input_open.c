@@ -0,0 +1,45 @@
+/**
+ * \file main/main_input_open.c
+ *
+ * \brief Open an input file.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "main_internal.h"
+
+/**
+ * \brief Open an input file, detecting whether it is gzip-compressed.
+ *
+ * \param input         The input to initialize.
+ * \param filename      The name of the file to open.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status main_input_open(main_input* input, const char* filename)
+{
+    uint8_t magic[2];
+
+    memset(input, 0, sizeof(*input));
+
+    input->fd = open(filename, O_RDONLY);
+    if (input->fd < 0)
+    {
+        return ERROR_OPEN_FAILED;
+    }
+
+    /* a gzip member starts with these magic bytes; the read position is
+     * left at the start of the file. */
+    input->compressed =
+        sizeof(magic) == pread(input->fd, magic, sizeof(magic), 0)
+     && 0x1f == magic[0] && 0x8b == magic[1];
+
+    return STATUS_SUCCESS;
+}
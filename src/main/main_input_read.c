@@ -0,0 +1,318 @@
+/**
+ * \file main/main_input_read.c
+ *
+ * \brief Read the next piece of an input file.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include "main_internal.h"
+
+/* forward decls. */
+static status main_input_start(main_input* input);
+static void* main_input_thread(void* context);
+static status main_input_inflate(
+    main_input* input, z_stream* stream, uint8_t* in, uint8_t* out,
+    size_t* out_size, bool* eof);
+
+/**
+ * \brief Read the next piece of an input file.
+ *
+ * A compressed input is decompressed by a thread started on the first read,
+ * a chunk at a time, up to \ref MAIN_INPUT_SLOTS chunks ahead of the reader,
+ * so that decompression overlaps with whatever the reader does with the
+ * data.  Memory use is bounded, and nothing is written to disk.
+ *
+ * \param input         The input.
+ * \param buffer        The buffer to receive the data.
+ * \param size          The size of the buffer.
+ * \param read_size     Pointer to receive the number of bytes read, which is
+ *                      zero at the end of the input.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_DECOMPRESS if the compressed data is corrupt or truncated.
+ *      - a non-zero error code on failure.
+ */
+status main_input_read(
+    main_input* input, uint8_t* buffer, size_t size, size_t* read_size)
+{
+    status retval;
+    size_t slot, available;
+
+    /* an uncompressed input is read directly. */
+    if (!input->compressed)
+    {
+        uint64_t trace_start = main_trace_begin();
+        ssize_t tmp = read(input->fd, buffer, size);
+        if (tmp < 0)
+        {
+            return ERROR_READ_FAILED;
+        }
+
+        main_trace_end("read", trace_start, (size_t)tmp);
+
+        main_stats_count_read((size_t)tmp);
+        *read_size = (size_t)tmp;
+        return STATUS_SUCCESS;
+    }
+
+    if (!input->started)
+    {
+        retval = main_input_start(input);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    /* wait for a chunk, or for the thread to finish. */
+    pthread_mutex_lock(&input->lock);
+    while (input->head == input->tail && !input->done)
+    {
+        pthread_cond_wait(&input->cond, &input->lock);
+    }
+    if (input->head == input->tail)
+    {
+        retval = input->retval;
+        pthread_mutex_unlock(&input->lock);
+
+        *read_size = 0;
+        return retval;
+    }
+    pthread_mutex_unlock(&input->lock);
+
+    /* copy what fits from the head chunk. */
+    slot = input->head % MAIN_INPUT_SLOTS;
+    available = input->slot_sizes[slot] - input->head_offset;
+    if (size > available)
+    {
+        size = available;
+    }
+    memcpy(buffer, input->slots[slot] + input->head_offset, size);
+    input->head_offset += size;
+    *read_size = size;
+
+    /* hand a finished chunk back to the thread. */
+    if (input->head_offset == input->slot_sizes[slot])
+    {
+        pthread_mutex_lock(&input->lock);
+        ++input->head;
+        input->head_offset = 0;
+        pthread_cond_broadcast(&input->cond);
+        pthread_mutex_unlock(&input->lock);
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Allocate the chunks of a compressed input, and start its
+ * decompression thread.
+ *
+ * \param input         The input.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_input_start(main_input* input)
+{
+    for (size_t i = 0; i < MAIN_INPUT_SLOTS; ++i)
+    {
+        input->slots[i] = (uint8_t*)malloc(MAIN_INPUT_CHUNK_SIZE);
+        if (NULL == input->slots[i])
+        {
+            return ERROR_GENERAL_OUT_OF_MEMORY;
+        }
+    }
+
+    pthread_mutex_init(&input->lock, NULL);
+    pthread_cond_init(&input->cond, NULL);
+
+    if (0 != pthread_create(&input->thread, NULL, &main_input_thread, input))
+    {
+        pthread_cond_destroy(&input->cond);
+        pthread_mutex_destroy(&input->lock);
+        return ERROR_READ_FAILED;
+    }
+
+    input->started = true;
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Decompress the input into free chunks until it ends.
+ *
+ * \param context       The input.
+ *
+ * \returns NULL.
+ */
+static void* main_input_thread(void* context)
+{
+    status retval;
+    main_input* input = (main_input*)context;
+    z_stream stream;
+    uint8_t* in;
+    size_t slot;
+    bool eof = false;
+    uint64_t trace_start;
+
+    main_trace_thread_name("decompress");
+
+    in = (uint8_t*)malloc(MAIN_INPUT_CHUNK_SIZE);
+    if (NULL == in)
+    {
+        retval = ERROR_GENERAL_OUT_OF_MEMORY;
+        goto done;
+    }
+
+    /* accept a gzip wrapper only. */
+    memset(&stream, 0, sizeof(stream));
+    if (Z_OK != inflateInit2(&stream, 16 + MAX_WBITS))
+    {
+        retval = ERROR_DECOMPRESS;
+        goto cleanup_in;
+    }
+
+    do
+    {
+        /* wait for a free chunk. */
+        pthread_mutex_lock(&input->lock);
+        while (input->tail - input->head == MAIN_INPUT_SLOTS && !input->stop)
+        {
+            pthread_cond_wait(&input->cond, &input->lock);
+        }
+        if (input->stop)
+        {
+            pthread_mutex_unlock(&input->lock);
+            retval = STATUS_SUCCESS;
+            goto cleanup_stream;
+        }
+        pthread_mutex_unlock(&input->lock);
+
+        /* fill it. */
+        slot = input->tail % MAIN_INPUT_SLOTS;
+        trace_start = main_trace_begin();
+        retval =
+            main_input_inflate(
+                input, &stream, in, input->slots[slot],
+                &input->slot_sizes[slot], &eof);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_stream;
+        }
+        main_trace_end("decompress", trace_start, input->slot_sizes[slot]);
+
+        /* pass it to the reader. */
+        if (input->slot_sizes[slot] > 0)
+        {
+            pthread_mutex_lock(&input->lock);
+            ++input->tail;
+            pthread_cond_broadcast(&input->cond);
+            pthread_mutex_unlock(&input->lock);
+        }
+    } while (!eof);
+
+    /* success. */
+    retval = STATUS_SUCCESS;
+    goto cleanup_stream;
+
+cleanup_stream:
+    inflateEnd(&stream);
+
+cleanup_in:
+    free(in);
+
+done:
+    pthread_mutex_lock(&input->lock);
+    input->retval = retval;
+    input->done = true;
+    pthread_cond_broadcast(&input->cond);
+    pthread_mutex_unlock(&input->lock);
+
+    return NULL;
+}
+
+/**
+ * \brief Decompress the input until a chunk is full or the input ends.
+ *
+ * Concatenated gzip members are decompressed one after another, as gzip
+ * itself does.
+ *
+ * \param input         The input.
+ * \param stream        The zlib stream.
+ * \param in            Buffer of \ref MAIN_INPUT_CHUNK_SIZE bytes for
+ *                      compressed data, which the stream refers to.
+ * \param out           The chunk to fill.
+ * \param out_size      Pointer to receive the number of bytes in the chunk.
+ * \param eof           Set to true when the input has ended.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_DECOMPRESS if the compressed data is corrupt or truncated.
+ *      - a non-zero error code on failure.
+ */
+static status main_input_inflate(
+    main_input* input, z_stream* stream, uint8_t* in, uint8_t* out,
+    size_t* out_size, bool* eof)
+{
+    ssize_t size;
+    int rc;
+
+    stream->next_out = out;
+    stream->avail_out = MAIN_INPUT_CHUNK_SIZE;
+
+    while (stream->avail_out > 0)
+    {
+        /* refill the compressed data. */
+        if (0 == stream->avail_in)
+        {
+            size = read(input->fd, in, MAIN_INPUT_CHUNK_SIZE);
+            if (size < 0)
+            {
+                return ERROR_READ_FAILED;
+            }
+
+            main_stats_count_read((size_t)size);
+
+            /* the input must end between members. */
+            if (0 == size)
+            {
+                if (0 != stream->total_in)
+                {
+                    return ERROR_DECOMPRESS;
+                }
+
+                *eof = true;
+                break;
+            }
+
+            stream->next_in = in;
+            stream->avail_in = (uInt)size;
+        }
+
+        rc = inflate(stream, Z_NO_FLUSH);
+        if (Z_STREAM_END == rc)
+        {
+            /* start over for the next member; total_in is cleared, so it
+             * shows whether a member has been started. */
+            inflateReset(stream);
+        }
+        else if (Z_OK != rc)
+        {
+            return ERROR_DECOMPRESS;
+        }
+    }
+
+    *out_size = MAIN_INPUT_CHUNK_SIZE - stream->avail_out;
+
+    return STATUS_SUCCESS;
+}
@@ -9,7 +9,15 @@
 
 #pragma once
 
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <sys/types.h>
+#include <weightgraph/archive.h>
+#include <weightgraph/memory.h>
+#include <weightgraph/session.h>
 #include <weightgraph/status_codes.h>
 #include <weightgraph/weightgraph.h>
 
@@ -18,6 +26,98 @@
 extern "C" {
 # endif /*__cplusplus*/
 
+/**
+ * \brief How entries from different inputs that share a date are combined.
+ */
+enum main_duplicate_policy
+{
+    /* two inputs sharing a date is an error. */
+    MAIN_DUPLICATE_ERROR,
+    /* the entry from the input given last wins. */
+    MAIN_DUPLICATE_LAST,
+    /* the weights of the entries are averaged. */
+    MAIN_DUPLICATE_AVERAGE,
+};
+
+/**
+ * \brief How run statistics are reported.
+ */
+enum main_stats_format
+{
+    /* statistics are not gathered. */
+    MAIN_STATS_OFF,
+    /* one line of text per phase, on stderr. */
+    MAIN_STATS_TEXT,
+    /* a single JSON object, on stderr. */
+    MAIN_STATS_JSON,
+};
+
+/**
+ * \brief Command-line options for the main program.
+ */
+typedef struct main_options main_options;
+
+struct main_options
+{
+    const char* input_file;
+    /* every input named on the command line, starting with input_file. */
+    char* const* input_files;
+    size_t input_count;
+    /* the policy for dates shared by inputs (MAIN_DUPLICATE_*). */
+    int duplicate_policy;
+    const char* output_file;
+    /* the output format (WEIGHTGRAPH_FORMAT_*). */
+    int output_format;
+    /* the width and height, in pixels, of raster output. */
+    size_t raster_size;
+    /* the number of entries plotted on each page. */
+    size_t page_size;
+    /* the number of threads used to render pages. */
+    size_t threads;
+    /* the checkpoint file for incremental rendering, or NULL. */
+    const char* checkpoint_file;
+    /* true if the input is a manifest or directory of logs to render. */
+    bool batch;
+    /* the socket on which to serve render requests, or NULL. */
+    const char* socket_file;
+    /* true if the output is updated whenever the input changes. */
+    bool watch;
+    /* true if the input is parsed and averaged in a pipeline. */
+    bool pipelined;
+    /* true if the input is rendered as it is parsed, without holding it. */
+    bool streaming;
+    /* the memory budget of an external sort of the input, or 0. */
+    size_t sort_budget;
+    /* how run statistics are reported (MAIN_STATS_*). */
+    int stats_format;
+    /* true if the input is converted to an archive instead of rendered. */
+    bool archive;
+    /* the calendar period into which entries are rolled up before they are
+     * rendered (WEIGHTGRAPH_PERIOD_*). */
+    int period;
+    /* the window and threshold of the outlier filter, or a window of 0 if
+     * no weight is rejected. */
+    size_t outlier_window;
+    double outlier_threshold;
+    /* the directory of the output cache of a batch, or NULL. */
+    const char* cache_directory;
+    /* the most bytes of outputs the cache keeps. */
+    size_t cache_limit;
+};
+
+/**
+ * \brief Parse the command-line options for the main program.
+ *
+ * \param options       The options structure to populate.
+ * \param argc          The number of command-line arguments.
+ * \param argv          The command-line arguments.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status main_options_parse(main_options* options, int argc, char* argv[]);
+
 /**
  * \brief Stat and read the given file into a buffer.
  *
@@ -33,94 +133,938 @@ status main_read_file(
     uint8_t** buffer, size_t* buffer_size, const char* filename);
 
 /**
- * \brief Parse the given buffer, creating a weightgraph AST.
+ * \brief Stat and read the given file into a reusable buffer.
+ *
+ * The buffer is grown with realloc when the file does not fit, so reading
+ * many files into the same buffer only allocates for the largest of them.
+ * The contents are followed by a zero byte.  On failure, the buffer remains
+ * owned by the caller.  A gzip-compressed file is decompressed as it is read.
+ *
+ * \param buffer        Pointer to the buffer, which may be NULL.
+ * \param capacity      Pointer to the capacity of the buffer.
+ * \param buffer_size   Pointer to receive the size of the contents.
+ * \param filename      The name of the file to read.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status main_read_file_buffer(
+    uint8_t** buffer, size_t* capacity, size_t* buffer_size,
+    const char* filename);
+
+/**
+ * \brief Stat and read the given file, from an offset to its end, into a
+ * reusable buffer.
+ *
+ * The buffer is grown with realloc when the data does not fit, so reading
+ * many files into the same buffer only allocates for the largest of them.
+ * The contents are followed by a zero byte.  On failure, the buffer remains
+ * owned by the caller.
+ *
+ * \param buffer        Pointer to the buffer, which may be NULL.
+ * \param capacity      Pointer to the capacity of the buffer.
+ * \param buffer_size   Pointer to receive the number of bytes read.
+ * \param filename      The name of the file to read.
+ * \param offset        The offset from which to read.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status main_read_file_range(
+    uint8_t** buffer, size_t* capacity, size_t* buffer_size,
+    const char* filename, off_t offset);
+
+/**
+ * \brief The number of decompressed chunks buffered ahead of the reader.
+ */
+#define MAIN_INPUT_SLOTS 4
+
+/**
+ * \brief The size of each chunk read from, or decompressed from, an input.
+ */
+#define MAIN_INPUT_CHUNK_SIZE 65536
+
+/**
+ * \brief An input file, read a chunk at a time, which may be compressed.
+ */
+typedef struct main_input main_input;
+
+struct main_input
+{
+    int fd;
+    /* true if the file is gzip-compressed. */
+    bool compressed;
+    /* true once the decompression thread has been started. */
+    bool started;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    /* decompressed chunks, passed from the thread to the reader. */
+    uint8_t* slots[MAIN_INPUT_SLOTS];
+    size_t slot_sizes[MAIN_INPUT_SLOTS];
+    /* the number of chunks consumed by the reader, and filled by the
+     * thread. */
+    size_t head;
+    size_t tail;
+    /* the number of bytes of the head chunk already read. */
+    size_t head_offset;
+    /* set by the thread when it finishes, with its status. */
+    bool done;
+    status retval;
+    /* set by the reader to stop the thread early. */
+    bool stop;
+};
+
+/**
+ * \brief Open an input file, detecting whether it is gzip-compressed.
  *
- * \param graph         Pointer to receive the AST.
- * \param alloc         The allocator to use.
- * \param buffer        The buffer to parse.
- * \param buffer_size   The size of the buffer to parse.
+ * \param input         The input to initialize.
+ * \param filename      The name of the file to open.
  *
  * \returns a status code indicating success or failure.
  *      - STATUS_SUCCESS on success.
  *      - a non-zero error code on failure.
  */
-status main_parse_buffer(
-    weightgraph** graph, RCPR_SYM(allocator)* alloc,
-    const uint8_t* buffer, size_t buffer_size);
+status main_input_open(main_input* input, const char* filename);
 
 /**
- * \brief An output graph file.
+ * \brief Read the next piece of an input file.
+ *
+ * A compressed input is decompressed by a thread started on the first read,
+ * a chunk at a time, up to \ref MAIN_INPUT_SLOTS chunks ahead of the reader,
+ * so that decompression overlaps with whatever the reader does with the
+ * data.  Memory use is bounded, and nothing is written to disk.
+ *
+ * \param input         The input.
+ * \param buffer        The buffer to receive the data.
+ * \param size          The size of the buffer.
+ * \param read_size     Pointer to receive the number of bytes read, which is
+ *                      zero at the end of the input.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_DECOMPRESS if the compressed data is corrupt or truncated.
+ *      - a non-zero error code on failure.
+ */
+status main_input_read(
+    main_input* input, uint8_t* buffer, size_t size, size_t* read_size);
+
+/**
+ * \brief Close an input file, stopping its decompression thread.
+ *
+ * \param input         The input.
+ */
+void main_input_close(main_input* input);
+
+/**
+ * \brief Create an empty session, filtering its weights for outliers if the
+ * options ask for it.
+ *
+ * \param session       Pointer to receive the session.
+ * \param alloc         The allocator to use for this operation.
+ * \param average       The initial moving average for this session.
+ * \param options       The command-line options.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
  */
-typedef struct output_graph_file output_graph_file;
+status main_session_create(
+    weightgraph_session** session, RCPR_SYM(allocator)* alloc,
+    double average, const main_options* options);
 
-struct output_graph_file
+/**
+ * \brief Read and parse a log, and push its entries onto a new session.
+ *
+ * \param session       Pointer to receive the session.
+ * \param alloc         The allocator to use for this operation.
+ * \param options       The command-line options, naming the log.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status main_load(
+    weightgraph_session** session, RCPR_SYM(allocator)* alloc,
+    const main_options* options);
+
+/**
+ * \brief Push the entries of a parsed log onto a session, in date order.
+ *
+ * \param session       The session.
+ * \param graph         The parsed log.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status main_push_entries(weightgraph_session* session, weightgraph* graph);
+
+/**
+ * \brief A sink that writes graph output to files.
+ */
+typedef struct main_file_sink main_file_sink;
+
+struct main_file_sink
 {
-    RCPR_SYM(resource) hdr;
-    RCPR_SYM(allocator)* alloc;
+    /* the name of the output file. */
+    const char* filename;
+    /* the file currently open, or NULL. */
     FILE* fp;
-    /* the skip per x plot. */
-    double xskip;
-    /* how much to scale the weight. */
-    double yscale;
-    /* how much to add to the weight to correct the graph to zero. */
-    double yoffset;
-    double prevx;
-    double prevy;
 };
 
 /**
- * \brief Create an output graph file, and write the preamble.
+ * \brief Initialize a sink that writes graph output to files.
+ *
+ * Page 0 is written to the output filename.  Otherwise, the page number is
+ * inserted before the extension, so that page 2 of "graph.png" is written to
+ * "graph-2.png".  An existing file with other hard links is replaced rather
+ * than rewritten.
  *
- * \param fp            Pointer to receive the file pointer.
- * \param alloc         Allocator to use for this operation.
+ * \param sink          The sink to initialize.
+ * \param file          The file sink state.
  * \param filename      The name of the output file.
- * \param old_average   The previous average.
+ */
+void main_file_sink_init(
+    weightgraph_sink* sink, main_file_sink* file, const char* filename);
+
+/**
+ * \brief A checkpoint from which a later run can render only new entries.
+ */
+typedef struct main_checkpoint main_checkpoint;
+
+struct main_checkpoint
+{
+    /* the options with which the graph was rendered. */
+    int format;
+    size_t page_size;
+    size_t raster_size;
+    double initial_average;
+    /* a digest of the entries before the resume point. */
+    uint64_t digest;
+    /* the moving average ring buffer at the resume point. */
+    double average_array[WEIGHTGRAPH_AVERAGE_WINDOW];
+    int average_index;
+    /* the renderer state at the resume point. */
+    weightgraph_render_state state;
+};
+
+/**
+ * \brief Read a checkpoint file.
+ *
+ * \param checkpoint    The checkpoint to populate.
+ * \param filename      The name of the checkpoint file.
  *
  * \returns a status code indicating success or failure.
  *      - STATUS_SUCCESS on success.
  *      - a non-zero error code on failure.
  */
-status output_graph_create(
-    output_graph_file** fp, RCPR_SYM(allocator)* alloc, const char* filename,
-    double old_average);
+status main_checkpoint_read(main_checkpoint* checkpoint, const char* filename);
 
 /**
- * \brief Plot a weight on the graph.
+ * \brief Write a checkpoint file.
+ *
+ * The checkpoint is written to a temporary file that then replaces the
+ * original, so that an interrupted write never leaves a partial checkpoint.
  *
- * \param out               Output file pointer.
- * \param date              The date for this entry.
- * \param weight            The weight for this entry.
- * \param moving_average    The moving average for this entry.
+ * \param checkpoint    The checkpoint to write.
+ * \param filename      The name of the checkpoint file.
  *
  * \returns a status code indicating success or failure.
  *      - STATUS_SUCCESS on success.
  *      - a non-zero error code on failure.
  */
-status output_graph_plot(
-    output_graph_file* out, const char* date, double weight,
-    double moving_average);
+status main_checkpoint_write(
+    const main_checkpoint* checkpoint, const char* filename);
 
 /**
- * \brief Write the epilogue for the graph.
+ * \brief List the input files for a batch run.
  *
- * \param out               Output file pointer.
+ * The path is either a directory, in which case every XML, CSV or NDJSON
+ * log in it, compressed or not, is listed, or a manifest naming one input
+ * file per line.  Blank lines and lines starting with '#' in a manifest are
+ * skipped.  Directory listings are sorted, so that a batch is rendered in the
+ * same order on every run.
+ *
+ * \param inputs        Pointer to receive the list of input file names.
+ * \param count         Pointer to receive the number of input files.
+ * \param path          The directory or manifest.
  *
  * \returns a status code indicating success or failure.
  *      - STATUS_SUCCESS on success.
  *      - a non-zero error code on failure.
  */
-status output_graph_finalize(output_graph_file* out);
+status main_batch_inputs(char*** inputs, size_t* count, const char* path);
+
+/**
+ * \brief Release a list of input files created by \ref main_batch_inputs.
+ *
+ * \param inputs        The list of input file names.
+ * \param count         The number of input files.
+ */
+void main_batch_inputs_release(char** inputs, size_t count);
 
 /**
- * \brief Release an output graph file resource.
+ * \brief Render every input file of a batch on a work-stealing thread pool.
+ *
+ * Each worker reuses its parser, session and read buffer across the files it
+ * renders.  Failures are reported per file, and the throughput of the batch
+ * is printed when it completes.  A batch in which two inputs would be
+ * rendered to the same output is refused before anything is rendered.  If
+ * the batch has an output cache, graphs already in it are not rendered
+ * again, and the cache is trimmed to its limit once the batch completes.
  *
- * \param r         The resource to release.
+ * \param options       The command-line options.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS if every file was rendered.
+ *      - ERROR_BATCH_COLLISION if two inputs have the same output name.
+ *      - a non-zero error code on failure.
+ */
+status main_batch_run(const main_options* options);
+
+/**
+ * \brief The size of a cache key, written as hex digits, with its terminator.
+ */
+#define MAIN_CACHE_KEY_SIZE 33
+
+/**
+ * \brief Compute the key under which the output of a graph is cached.
+ *
+ * The key is a 128-bit FNV-1a hash of everything the output depends on: the
+ * version of the cache, the rendering options, the outlier filter, the
+ * initial average, and the date and weight of each entry, in date order.  It
+ * is computed from the parsed log, without averaging it.
+ *
+ * \param key           Buffer of \ref MAIN_CACHE_KEY_SIZE bytes to receive the
+ *                      key.
+ * \param options       The command-line options.
+ * \param graph         The parsed log.
+ */
+void main_cache_key(
+    char* key, const main_options* options, const weightgraph* graph);
+
+/**
+ * \brief Replace the outputs of a graph with those cached under a key, if
+ * there are any.
+ *
+ * Each cached file, such as "graph.png" or "graph-2.png", replaces the output
+ * of the same suffix, such as "out.png" or "out-2.png".  Outputs are hard
+ * links to the cached files where possible, and copies otherwise.  An entry
+ * that is used is marked as the most recently used.
+ *
+ * \param directory     The cache directory.
+ * \param key           The key of the graph.
+ * \param output        The name of the output file of the graph.
+ * \param hit           Pointer to receive true if the outputs were cached.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success, whether or not the outputs were cached.
+ *      - ERROR_OUTPUT_CACHE if the cache could not be read.
+ *      - ERROR_OUTPUT_FILE_OPEN if an output could not be created.
+ *      - ERROR_OUTPUT_WRITE if an output could not be written.
+ *      - a non-zero error code on failure.
+ */
+status main_cache_fetch(
+    const char* directory, const char* key, const char* output, bool* hit);
+
+/**
+ * \brief Create a staging directory in the cache, into which a graph is
+ * rendered before it is committed.
+ *
+ * \param staging       Pointer to receive the name of the staging directory,
+ *                      which must be freed by the caller.
+ * \param directory     The cache directory, which is created if need be.
  *
  * \returns a status code indicating success or failure.
  *      - STATUS_SUCCESS on success.
+ *      - ERROR_OUTPUT_CACHE if the directory could not be created.
  *      - a non-zero error code on failure.
  */
-status output_graph_resource_release(RCPR_SYM(resource)* r);
+status main_cache_stage(char** staging, const char* directory);
+
+/**
+ * \brief Commit a staging directory to the cache under a key.
+ *
+ * The staged files are made read-only, so that an output linked to one can't
+ * be rewritten in place, and the staging directory is renamed to the key.  If
+ * another worker committed the key first, the staging directory is discarded.
+ *
+ * \param directory     The cache directory.
+ * \param staging       The staging directory.
+ * \param key           The key of the graph.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_OUTPUT_CACHE if the staging directory could not be committed.
+ */
+status main_cache_commit(
+    const char* directory, const char* staging, const char* key);
+
+/**
+ * \brief Remove a cache entry or staging directory, and the files in it.
+ *
+ * \param path          The directory to remove.
+ */
+void main_cache_discard(const char* path);
+
+/**
+ * \brief Evict the least recently used entries of the cache until the files
+ * it holds fit in a limit.
+ *
+ * \param directory     The cache directory.
+ * \param limit         The most bytes the cached files may take.
+ * \param evicted       Pointer to receive the number of entries evicted.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_OUTPUT_CACHE if the cache could not be read.
+ *      - a non-zero error code on failure.
+ */
+status main_cache_trim(const char* directory, size_t limit, size_t* evicted);
+
+/**
+ * \brief The number of buckets in a latency histogram.
+ */
+#define MAIN_LATENCY_BUCKETS 25
+
+/**
+ * \brief A histogram of request latencies, in power of two microseconds.
+ */
+typedef struct main_latency_histogram main_latency_histogram;
+
+struct main_latency_histogram
+{
+    uint64_t buckets[MAIN_LATENCY_BUCKETS];
+    uint64_t count;
+    uint64_t sum_micros;
+};
+
+/**
+ * \brief Record a request latency in a histogram.
+ *
+ * Bucket i counts latencies of at most 2^i microseconds that did not fit in
+ * a smaller bucket.  The last bucket counts everything larger.
+ *
+ * \param histogram     The histogram.
+ * \param micros        The latency, in microseconds.
+ */
+void main_latency_histogram_record(
+    main_latency_histogram* histogram, uint64_t micros);
+
+/**
+ * \brief Write a latency histogram in the Prometheus text exposition format.
+ *
+ * Buckets are cumulative, as that format expects, so that the histogram can
+ * be scraped by standard monitoring tools.
+ *
+ * \param histogram     The histogram.
+ * \param fp            The stream to which it is written.
+ */
+void main_latency_histogram_write(
+    const main_latency_histogram* histogram, FILE* fp);
+
+/**
+ * \brief Serve render requests on a Unix domain socket until shut down.
+ *
+ * Connections are served by a pool of workers, one connection per worker at
+ * a time.  The parser, sessions and buffers are kept warm between requests,
+ * and parsed logs, and their rollups, are cached until their files change.
+ * A connection that sends or receives nothing for a while is closed, so that
+ * a stalled client can't hold a worker forever.
+ *
+ * \param options       The command-line options.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status main_daemon_run(const main_options* options);
+
+/**
+ * \brief Render the input, then update the output whenever it changes.
+ *
+ * Records appended to the input are parsed on their own, from the end of
+ * the last record parsed, and only they are drawn onto the graph.  The input
+ * is parsed and rendered again in full if it is replaced, shrinks, or has a
+ * record appended out of date order.
+ *
+ * \param options       The command-line options.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status main_watch_run(const main_options* options);
+
+/**
+ * \brief The longest date, including its terminator, carried in a slot of a
+ * sample ring.  Longer dates are carried on the heap.
+ */
+#define MAIN_RING_DATE_SIZE 32
+
+/**
+ * \brief An element of a log passed through a sample ring.
+ */
+typedef struct main_ring_sample main_ring_sample;
+
+struct main_ring_sample
+{
+    /* true for the beginning average, false for a log entry. */
+    bool average;
+    /* the beginning average, or the weight of the entry. */
+    double value;
+    char date[MAIN_RING_DATE_SIZE];
+    /* a date too long for the slot, owned by whoever holds the sample, or
+     * NULL. */
+    char* long_date;
+};
+
+/**
+ * \brief A lock-free, single-producer, single-consumer ring of samples.
+ */
+typedef struct main_sample_ring main_sample_ring;
+
+struct main_sample_ring
+{
+    main_ring_sample* slots;
+    size_t mask;
+    /* the next slot to pop, advanced only by the consumer. */
+    _Alignas(64) atomic_size_t head;
+    /* the next slot to push, advanced only by the producer. */
+    _Alignas(64) atomic_size_t tail;
+    atomic_bool closed;
+    atomic_bool abandoned;
+};
+
+/**
+ * \brief Initialize a single-producer, single-consumer sample ring.
+ *
+ * \param ring          The ring to initialize.
+ * \param capacity      The number of samples the ring holds, which must be a
+ *                      power of two.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status main_sample_ring_init(main_sample_ring* ring, size_t capacity);
+
+/**
+ * \brief Dispose of a sample ring, and the long dates of any samples left in
+ * it.
+ *
+ * \param ring          The ring, which neither side may still be using.
+ */
+void main_sample_ring_dispose(main_sample_ring* ring);
+
+/**
+ * \brief Push a sample onto the ring, waiting while it is full.
+ *
+ * Only the producer may call this.
+ *
+ * \param ring          The ring.
+ * \param sample        The sample to push.
+ *
+ * \returns true if the sample was pushed, or false if the consumer has
+ * abandoned the ring.
+ */
+bool main_sample_ring_push(
+    main_sample_ring* ring, const main_ring_sample* sample);
+
+/**
+ * \brief Pop a sample from the ring, waiting while it is empty.
+ *
+ * Only the consumer may call this.
+ *
+ * \param ring          The ring.
+ * \param sample        The sample to populate.
+ *
+ * \returns true if a sample was popped, or false if the producer has closed
+ * the ring and every sample has been popped.
+ */
+bool main_sample_ring_pop(main_sample_ring* ring, main_ring_sample* sample);
+
+/**
+ * \brief Close the ring, indicating that no more samples will be pushed.
+ *
+ * Only the producer may call this.
+ *
+ * \param ring          The ring.
+ */
+void main_sample_ring_close(main_sample_ring* ring);
+
+/**
+ * \brief Abandon the ring, so that a producer waiting on it stops.
+ *
+ * Only the consumer may call this.
+ *
+ * \param ring          The ring.
+ */
+void main_sample_ring_abandon(main_sample_ring* ring);
+
+/**
+ * \brief Read, parse and average a log in a pipeline, pushing its entries
+ * onto a new session.
+ *
+ * A parser thread reads the log a piece at a time and streams its entries
+ * through a sample ring to the calling thread, which computes the moving
+ * average of each entry as it arrives.  The entries must be in date order,
+ * and entries that share a date are pushed in the order of the log.
+ *
+ * \param session       Pointer to receive the session.
+ * \param alloc         The allocator to use for this operation.
+ * \param options       The command-line options, naming the log.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_OUT_OF_ORDER if the entries are not in date order.
+ *      - a non-zero error code on failure.
+ */
+status main_pipeline_load(
+    weightgraph_session** session, RCPR_SYM(allocator)* alloc,
+    const main_options* options);
+
+/**
+ * \brief Render a log whose entries are in date order without holding its
+ * entries in memory.
+ *
+ * The log is streamed through the parser twice, a piece at a time.  The
+ * first pass checks the date order and finds the number of entries and the
+ * range of their weights, which lay out the pages and Y-axis of the graph.
+ * The second pass plots each entry as soon as it is parsed.  Only the moving
+ * average window is kept, so memory use does not grow with the log.  Entries
+ * that share a date are plotted in the order of the log.
+ *
+ * \param options       The command-line options.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_OUT_OF_ORDER if the entries are not in date order.
+ *      - a non-zero error code on failure.
+ */
+status main_stream_render(const main_options* options);
+
+/**
+ * \brief Parse several logs in parallel, and merge their entries onto a new
+ * session in date order.
+ *
+ * Up to -j logs are parsed at once, each by its own thread.  The entries of
+ * the parsed logs are then combined with a k-way merge on date, applying the
+ * duplicate policy to entries that share a date.  The initial average is
+ * taken from the first log.
+ *
+ * \param session       Pointer to receive the session.
+ * \param alloc         The allocator to use for this operation.
+ * \param options       The command-line options, naming the logs.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_DUPLICATE_DATE if two logs share a date and the duplicate
+ *        policy is MAIN_DUPLICATE_ERROR.
+ *      - a non-zero error code on failure.
+ */
+status main_merge_load(
+    weightgraph_session** session, RCPR_SYM(allocator)* alloc,
+    const main_options* options);
+
+/**
+ * \brief Render a log whose entries may be in any order, holding no more
+ * than the sort budget of entries in memory.
+ *
+ * The log is parsed a piece at a time.  Its entries are gathered into a
+ * buffer of compact records the size of the sort budget, which is sorted
+ * and spilled to a temporary file whenever it fills.  The sorted runs are
+ * merged in levels, a fixed number at a time, and the final merge streams
+ * the entries in date order into a plotter.  Entries that share a date are
+ * plotted in the order they appear in the log, as they are when a log is
+ * parsed in memory.
+ *
+ * \param options       The command-line options.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status main_sort_render(const main_options* options);
+
+/**
+ * \brief Convert a log to an archive.
+ *
+ * The log is streamed through the parser a piece at a time, and each entry
+ * is passed straight to an archive writer, which writes the archive a block
+ * at a time.  Entries are archived in the order of the log.
+ *
+ * \param options       The command-line options.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_ARCHIVE_ENCODE if an entry can't be stored in an archive.
+ *      - a non-zero error code on failure.
+ */
+status main_archive_convert(const main_options* options);
+
+/**
+ * \brief The phases of a run that are timed separately.
+ */
+enum main_stats_phase
+{
+    /* no phase is being timed. */
+    MAIN_STATS_PHASE_NONE = -1,
+    /* reading a log into memory. */
+    MAIN_STATS_PHASE_READ,
+    /* parsing a log into an entry tree. */
+    MAIN_STATS_PHASE_PARSE,
+    /* computing moving averages. */
+    MAIN_STATS_PHASE_AVERAGE,
+    /* reading, parsing and averaging overlapped, by several threads. */
+    MAIN_STATS_PHASE_LOAD,
+    /* sorting entries into runs, outside of memory. */
+    MAIN_STATS_PHASE_SORT,
+    /* rolling entries up into calendar periods. */
+    MAIN_STATS_PHASE_ROLLUP,
+    /* plotting and writing the graph. */
+    MAIN_STATS_PHASE_RENDER,
+    /* reading and writing the checkpoint. */
+    MAIN_STATS_PHASE_CHECKPOINT,
+    MAIN_STATS_PHASE_COUNT,
+};
+
+/**
+ * \brief Statistics gathered over a run, for --stats.
+ */
+typedef struct main_stats main_stats;
+
+struct main_stats
+{
+    /* how the statistics are reported, or MAIN_STATS_OFF. */
+    int format;
+    /* the wall and CPU clocks when the run, and the current phase, began. */
+    uint64_t start_wall_ns;
+    uint64_t start_cpu_ns;
+    int phase;
+    uint64_t phase_wall_ns;
+    uint64_t phase_cpu_ns;
+    /* the wall and CPU time spent in each phase. */
+    uint64_t wall_ns[MAIN_STATS_PHASE_COUNT];
+    uint64_t cpu_ns[MAIN_STATS_PHASE_COUNT];
+    /* counters, which may be updated by any thread. */
+    atomic_uint_fast64_t bytes_read;
+    atomic_uint_fast64_t bytes_written;
+    atomic_uint_fast64_t entries;
+};
+
+/**
+ * \brief The statistics of this run.
+ */
+extern main_stats main_run_stats;
+
+/**
+ * \brief Start gathering statistics for this run.
+ *
+ * Until this is called, the statistics functions return at once, so that
+ * a run without --stats pays for a branch and nothing more.  The memory
+ * allocated by the library is counted once this is called, so it must be
+ * called before anything is loaded.
+ *
+ * \param format        How the statistics are reported (MAIN_STATS_*).
+ */
+void main_stats_enable(int format);
+
+/**
+ * \brief End the current phase of the run, and begin another.
+ *
+ * The wall and CPU time between switches is added to the phase, so a phase
+ * may be entered more than once.  The CPU time is that of the whole
+ * process, including every thread.
+ *
+ * \param phase         The phase to begin (MAIN_STATS_PHASE_*), or
+ *                      MAIN_STATS_PHASE_NONE to end the current phase.
+ */
+void main_stats_phase(int phase);
+
+/**
+ * \brief Count bytes read from inputs.
+ *
+ * \param size          The number of bytes read.
+ */
+void main_stats_count_read(size_t size);
+
+/**
+ * \brief Count bytes written to outputs.
+ *
+ * \param size          The number of bytes written.
+ */
+void main_stats_count_written(size_t size);
+
+/**
+ * \brief Count log entries parsed.
+ *
+ * \param count         The number of entries parsed.
+ */
+void main_stats_count_entries(size_t count);
+
+/**
+ * \brief Report the statistics of this run on stderr, if they were
+ * gathered.
+ *
+ * The current phase is ended first.  Besides the time of each phase, the
+ * report gives the total wall and CPU time, the bytes read and written, the
+ * entries parsed and the peak resident set size of the process, and the
+ * allocations made by the library in each memory category.  Both formats
+ * list every phase and memory category, including those left unused, and
+ * give times in nanoseconds.
+ */
+void main_stats_report(void);
+
+/**
+ * \brief The environment variable naming the file to which a trace of the
+ * run is written.
+ */
+#define MAIN_TRACE_ENV "WEIGHTGRAPH_TRACE"
+
+/**
+ * \brief The number of events in each block of a thread's trace buffer.
+ */
+#define MAIN_TRACE_BLOCK_EVENTS 4096
+
+/**
+ * \brief The most blocks of events kept for each thread, beyond which
+ * events are dropped, so that a long-running daemon can be traced.
+ */
+#define MAIN_TRACE_MAX_BLOCKS 256
+
+/**
+ * \brief The smallest write to a file sink that is traced, so that a whole
+ * page or image is traced, but not each line of an EPS document.
+ */
+#define MAIN_TRACE_FLUSH_MIN 16384
+
+/**
+ * \brief A span of time spent by a thread, for the trace.
+ */
+typedef struct main_trace_event main_trace_event;
+
+struct main_trace_event
+{
+    /* the name of the span, which must be a string constant. */
+    const char* name;
+    /* when the span began, and how long it lasted. */
+    uint64_t start_ns;
+    uint64_t duration_ns;
+    /* how much the span processed, such as bytes or entries. */
+    uint64_t count;
+};
+
+/**
+ * \brief A block of trace events.
+ */
+typedef struct main_trace_block main_trace_block;
+
+struct main_trace_block
+{
+    main_trace_block* next;
+    size_t count;
+    main_trace_event events[MAIN_TRACE_BLOCK_EVENTS];
+};
+
+/**
+ * \brief The trace events recorded by a thread.
+ *
+ * Only the thread appends to its buffer, so recording an event takes no
+ * lock.  The buffer outlives the thread, until the trace is written.
+ */
+typedef struct main_trace_buffer main_trace_buffer;
+
+struct main_trace_buffer
+{
+    /* the buffer of the next thread. */
+    main_trace_buffer* next;
+    /* the id of the thread in the trace, and its name, if it was given. */
+    unsigned tid;
+    const char* thread_name;
+    /* the blocks of events, oldest first, and the block being filled. */
+    main_trace_block* first;
+    main_trace_block* last;
+    size_t blocks;
+    /* the events lost for want of memory, or beyond the last block. */
+    uint64_t dropped;
+};
+
+/**
+ * \brief The trace of a run.
+ */
+typedef struct main_trace main_trace;
+
+struct main_trace
+{
+    /* the file to which the trace is written, or NULL if it is off. */
+    const char* path;
+    /* the monotonic clock when tracing began. */
+    uint64_t start_ns;
+    /* the buffer of each thread that recorded an event. */
+    pthread_mutex_t lock;
+    main_trace_buffer* buffers;
+    unsigned next_tid;
+};
+
+/**
+ * \brief The trace of this run.
+ */
+extern main_trace main_run_trace;
+
+/**
+ * \brief Start tracing this run if \ref MAIN_TRACE_ENV names a file.
+ *
+ * This must be called before any other thread is started.  The calling
+ * thread is named "main" in the trace.
+ */
+void main_trace_enable(void);
+
+/**
+ * \brief Begin a span of the trace.
+ *
+ * \returns the time at which the span began, or zero if tracing is off.
+ */
+uint64_t main_trace_begin(void);
+
+/**
+ * \brief End a span of the trace, recording it in the calling thread's
+ * buffer.
+ *
+ * \param name          The name of the span, which must be a string
+ *                      constant.
+ * \param start_ns      The time returned by main_trace_begin, or zero, in
+ *                      which case nothing is recorded.
+ * \param count         How much the span processed, such as bytes or
+ *                      entries.
+ */
+void main_trace_end(const char* name, uint64_t start_ns, uint64_t count);
+
+/**
+ * \brief Name the calling thread in the trace.
+ *
+ * \param name          The name of the thread, which must be a string
+ *                      constant.
+ */
+void main_trace_thread_name(const char* name);
+
+/**
+ * \brief Get the calling thread's trace buffer, creating it on first use.
+ *
+ * \returns the buffer, or NULL if it could not be created.
+ */
+main_trace_buffer* main_trace_thread_buffer(void);
+
+/**
+ * \brief Write the trace, if tracing is on, as Chrome trace-event JSON.
+ *
+ * Every thread that recorded events must have stopped, other than the
+ * caller.  The buffers are released, and tracing is turned off.
+ */
+void main_trace_flush(void);
 
 /* C++ compatibility. */
 # ifdef   __cplusplus
@@ -0,0 +1,35 @@
+/**
+ * \file main/main_latency_histogram_record.c
+ *
+ * \brief Record a request latency in a histogram.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "main_internal.h"
+
+/**
+ * \brief Record a request latency in a histogram.
+ *
+ * Bucket i counts latencies of at most 2^i microseconds that did not fit in
+ * a smaller bucket.  The last bucket counts everything larger.
+ *
+ * \param histogram     The histogram.
+ * \param micros        The latency, in microseconds.
+ */
+void main_latency_histogram_record(
+    main_latency_histogram* histogram, uint64_t micros)
+{
+    size_t bucket = 0;
+
+    while (bucket < MAIN_LATENCY_BUCKETS - 1
+        && micros > ((uint64_t)1 << bucket))
+    {
+        ++bucket;
+    }
+
+    ++histogram->buckets[bucket];
+    ++histogram->count;
+    histogram->sum_micros += micros;
+}
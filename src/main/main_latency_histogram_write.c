@@ -0,0 +1,55 @@
+/**
+ * \file main/main_latency_histogram_write.c
+ *
+ * \brief Write a latency histogram for monitoring.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <inttypes.h>
+
+#include "main_internal.h"
+
+/**
+ * \brief Write a latency histogram in the Prometheus text exposition format.
+ *
+ * Buckets are cumulative, as that format expects, so that the histogram can
+ * be scraped by standard monitoring tools.
+ *
+ * \param histogram     The histogram.
+ * \param fp            The stream to which it is written.
+ */
+void main_latency_histogram_write(
+    const main_latency_histogram* histogram, FILE* fp)
+{
+    uint64_t total = 0;
+
+    fprintf(fp, "# TYPE weightgraph_request_latency_us histogram\n");
+    for (size_t i = 0; i < MAIN_LATENCY_BUCKETS; ++i)
+    {
+        total += histogram->buckets[i];
+
+        if (i < MAIN_LATENCY_BUCKETS - 1)
+        {
+            fprintf(
+                fp,
+                "weightgraph_request_latency_us_bucket{le=\"%" PRIu64 "\"} "
+                "%" PRIu64 "\n", (uint64_t)1 << i, total);
+        }
+        else
+        {
+            fprintf(
+                fp,
+                "weightgraph_request_latency_us_bucket{le=\"+Inf\"} "
+                "%" PRIu64 "\n", total);
+        }
+    }
+
+    fprintf(
+        fp, "weightgraph_request_latency_us_sum %" PRIu64 "\n",
+        histogram->sum_micros);
+    fprintf(
+        fp, "weightgraph_request_latency_us_count %" PRIu64 "\n",
+        histogram->count);
+}
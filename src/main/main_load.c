@@ -0,0 +1,171 @@
+/**
+ * \file main/main_load.c
+ *
+ * \brief Read and parse a log onto a new session.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <stdlib.h>
+
+#include "main_internal.h"
+
+RCPR_IMPORT_resource;
+
+/* forward decls. */
+static status main_load_archive(
+    weightgraph_session** session, RCPR_SYM(allocator)* alloc,
+    const main_options* options, const uint8_t* buffer, size_t size);
+
+/**
+ * \brief Read and parse a log, and push its entries onto a new session.
+ *
+ * An archive whose entries are in date order is decoded straight onto the
+ * session instead; any other archive is parsed like any other log.
+ *
+ * \param session       Pointer to receive the session.
+ * \param alloc         The allocator to use for this operation.
+ * \param options       The command-line options, naming the log.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status main_load(
+    weightgraph_session** session, RCPR_SYM(allocator)* alloc,
+    const main_options* options)
+{
+    status retval, release_retval;
+    uint8_t* buffer;
+    size_t size;
+    weightgraph* graph;
+    weightgraph_session* tmp;
+    uint64_t trace_start;
+
+    /* attempt to read the input file into a buffer. */
+    main_stats_phase(MAIN_STATS_PHASE_READ);
+    retval = main_read_file(&buffer, &size, options->input_file);
+    if (STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Error reading input file.\n");
+        goto done;
+    }
+
+    /* an archive in date order is decoded straight onto a session. */
+    main_stats_phase(MAIN_STATS_PHASE_PARSE);
+    if (WEIGHTGRAPH_INPUT_ARCHIVE
+            == weightgraph_input_format_sniff(buffer, size))
+    {
+        retval = main_load_archive(session, alloc, options, buffer, size);
+        if (ERROR_OUT_OF_ORDER != retval)
+        {
+            goto cleanup_buffer;
+        }
+    }
+
+    /* parse the XML file into a tree of values and a set of initial values. */
+    trace_start = main_trace_begin();
+    retval = weightgraph_parse_buffer(&graph, alloc, buffer, size);
+    main_trace_end("build", trace_start, size);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_buffer;
+    }
+
+    main_stats_count_entries(graph->entry_count);
+    main_stats_phase(MAIN_STATS_PHASE_AVERAGE);
+
+    /* start a session with the initial average. */
+    retval =
+        main_session_create(&tmp, alloc, graph->initial_average, options);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_graph;
+    }
+
+    /* push each entry onto the session in date order. */
+    retval = main_push_entries(tmp, graph);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_session;
+    }
+
+    /* success. */
+    *session = tmp;
+    retval = STATUS_SUCCESS;
+    goto cleanup_graph;
+
+cleanup_session:
+    release_retval = resource_release(weightgraph_session_resource_handle(tmp));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_graph:
+    release_retval = resource_release(&graph->hdr);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_buffer:
+    free(buffer);
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Decode an archive straight onto a new session.
+ *
+ * \param session       Pointer to receive the session.
+ * \param alloc         The allocator to use for this operation.
+ * \param options       The command-line options.
+ * \param buffer        The archive.
+ * \param size          The size of the archive.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_OUT_OF_ORDER if the archive must be parsed instead.
+ *      - a non-zero error code on failure.
+ */
+static status main_load_archive(
+    weightgraph_session** session, RCPR_SYM(allocator)* alloc,
+    const main_options* options, const uint8_t* buffer, size_t size)
+{
+    status retval, release_retval;
+    weightgraph_session* tmp;
+    uint64_t trace_start;
+
+    /* the archive sets the initial average. */
+    retval = main_session_create(&tmp, alloc, 0.0, options);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    trace_start = main_trace_begin();
+    retval = weightgraph_archive_load(tmp, buffer, size, NULL);
+    main_trace_end("decode", trace_start, weightgraph_session_count(tmp));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_session;
+    }
+
+    main_stats_count_entries(weightgraph_session_count(tmp));
+
+    /* success. */
+    *session = tmp;
+    return STATUS_SUCCESS;
+
+cleanup_session:
+    release_retval = resource_release(weightgraph_session_resource_handle(tmp));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
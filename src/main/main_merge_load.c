@@ -0,0 +1,472 @@
+/**
+ * \file main/main_merge_load.c
+ *
+ * \brief Parse several logs in parallel and merge them onto one session.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "main_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_rbtree;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief An input log being merged.
+ */
+typedef struct main_merge_input main_merge_input;
+
+struct main_merge_input
+{
+    const char* filename;
+    /* the allocator used by the thread that parses this log. */
+    allocator* alloc;
+    weightgraph* graph;
+    status retval;
+    /* the next entry to merge, and the end of the entries. */
+    rbtree_node* node;
+    rbtree_node* nil;
+};
+
+/**
+ * \brief The inputs shared by the parse threads.
+ */
+typedef struct main_merge_job main_merge_job;
+
+struct main_merge_job
+{
+    main_merge_input* inputs;
+    size_t count;
+    /* the next input to be claimed by a parse thread. */
+    atomic_size_t next;
+};
+
+/* forward decls. */
+static void* main_merge_parse_thread(void* context);
+static status main_merge_parse(main_merge_input* input);
+static status main_merge(
+    weightgraph_session* session, main_merge_input* inputs, size_t count,
+    int policy);
+static const weightgraph_entry* main_merge_entry(
+    const main_merge_input* input);
+static bool main_merge_before(
+    const main_merge_input* inputs, size_t lhs, size_t rhs);
+static void main_merge_sift_down(
+    const main_merge_input* inputs, size_t* heap, size_t size, size_t i);
+
+/**
+ * \brief Parse several logs in parallel, and merge their entries onto a new
+ * session in date order.
+ *
+ * Up to -j logs are parsed at once, each by its own thread.  The entries of
+ * the parsed logs are then combined with a k-way merge on date, applying the
+ * duplicate policy to entries that share a date.  The initial average is
+ * taken from the first log.
+ *
+ * \param session       Pointer to receive the session.
+ * \param alloc         The allocator to use for this operation.
+ * \param options       The command-line options, naming the logs.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_DUPLICATE_DATE if two logs share a date and the duplicate
+ *        policy is MAIN_DUPLICATE_ERROR.
+ *      - a non-zero error code on failure.
+ */
+status main_merge_load(
+    weightgraph_session** session, RCPR_SYM(allocator)* alloc,
+    const main_options* options)
+{
+    status retval, release_retval;
+    main_merge_job job;
+    weightgraph_session* tmp;
+    pthread_t* threads;
+    size_t thread_count, started, created = 0;
+    uint64_t trace_start;
+
+    memset(&job, 0, sizeof(job));
+    job.count = options->input_count;
+    atomic_init(&job.next, 0);
+
+    job.inputs =
+        (main_merge_input*)calloc(job.count, sizeof(main_merge_input));
+    if (NULL == job.inputs)
+    {
+        retval = ERROR_GENERAL_OUT_OF_MEMORY;
+        goto done;
+    }
+
+    /* each log gets its own allocator, as the allocator belongs to the
+     * thread that parses the log. */
+    for (created = 0; created < job.count; ++created)
+    {
+        job.inputs[created].filename = options->input_files[created];
+        retval = malloc_allocator_create(&job.inputs[created].alloc);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_inputs;
+        }
+    }
+
+    /* there is no use for more threads than logs. */
+    thread_count = options->threads;
+    if (thread_count > job.count)
+    {
+        thread_count = job.count;
+    }
+
+    threads = (pthread_t*)calloc(thread_count, sizeof(pthread_t));
+    if (NULL == threads)
+    {
+        retval = ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_inputs;
+    }
+
+    /* start the parse threads. */
+    for (started = 0; started < thread_count; ++started)
+    {
+        if (0 !=
+            pthread_create(
+                &threads[started], NULL, &main_merge_parse_thread, &job))
+        {
+            break;
+        }
+    }
+
+    /* this thread parses whatever a missing thread would have. */
+    if (0 == started)
+    {
+        main_merge_parse_thread(&job);
+    }
+
+    for (size_t i = 0; i < started; ++i)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    free(threads);
+
+    /* every log must have parsed. */
+    for (size_t i = 0; i < job.count; ++i)
+    {
+        if (STATUS_SUCCESS != job.inputs[i].retval)
+        {
+            fprintf(
+                stderr, "Error reading input file %s.\n",
+                job.inputs[i].filename);
+            retval = job.inputs[i].retval;
+            goto cleanup_inputs;
+        }
+    }
+
+    /* start a session with the initial average of the first log. */
+    retval =
+        main_session_create(
+            &tmp, alloc, job.inputs[0].graph->initial_average, options);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_inputs;
+    }
+
+    /* merge the entries onto the session. */
+    trace_start = main_trace_begin();
+    retval =
+        main_merge(
+            tmp, job.inputs, job.count, options->duplicate_policy);
+    main_trace_end("merge", trace_start, weightgraph_session_count(tmp));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_session;
+    }
+
+    /* success. */
+    *session = tmp;
+    retval = STATUS_SUCCESS;
+    goto cleanup_inputs;
+
+cleanup_session:
+    release_retval = resource_release(weightgraph_session_resource_handle(tmp));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_inputs:
+    for (size_t i = 0; i < created; ++i)
+    {
+        if (NULL != job.inputs[i].graph)
+        {
+            release_retval = resource_release(&job.inputs[i].graph->hdr);
+            if (STATUS_SUCCESS != release_retval)
+            {
+                retval = release_retval;
+            }
+        }
+
+        release_retval =
+            resource_release(allocator_resource_handle(job.inputs[i].alloc));
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
+    }
+
+    free(job.inputs);
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Parse logs until every log has been claimed.
+ *
+ * \param context       The merge job.
+ *
+ * \returns NULL.
+ */
+static void* main_merge_parse_thread(void* context)
+{
+    main_merge_job* job = (main_merge_job*)context;
+    size_t index;
+
+    main_trace_thread_name("merge parser");
+
+    while ((index = atomic_fetch_add(&job->next, 1)) < job->count)
+    {
+        job->inputs[index].retval = main_merge_parse(&job->inputs[index]);
+    }
+
+    return NULL;
+}
+
+/**
+ * \brief Read and parse a log, and point its cursor at its first entry.
+ *
+ * \param input         The input log.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_merge_parse(main_merge_input* input)
+{
+    status retval;
+    uint8_t* buffer;
+    size_t size;
+    uint64_t trace_start;
+
+    /* attempt to read the input file into a buffer. */
+    retval = main_read_file(&buffer, &size, input->filename);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* parse the XML file into a tree of values and a set of initial values. */
+    trace_start = main_trace_begin();
+    retval =
+        weightgraph_parse_buffer(&input->graph, input->alloc, buffer, size);
+    main_trace_end("build", trace_start, size);
+    free(buffer);
+    if (STATUS_SUCCESS != retval)
+    {
+        input->graph = NULL;
+        return retval;
+    }
+
+    /* start the cursor at the earliest entry. */
+    input->nil = rbtree_nil_node(input->graph->entries);
+    input->node = rbtree_root_node(input->graph->entries);
+    if (input->nil != input->node)
+    {
+        input->node = rbtree_minimum_node(input->graph->entries, input->node);
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Merge the entries of the parsed logs onto a session in date order.
+ *
+ * A binary heap holds the logs that still have entries, ordered by the date
+ * of their next entry, and then by their position on the command line.
+ * Entries that share a date are therefore popped one after another, in
+ * command-line order, and combined before they are pushed.
+ *
+ * \param session       The session.
+ * \param inputs        The parsed logs.
+ * \param count         The number of logs.
+ * \param policy        The duplicate policy (MAIN_DUPLICATE_*).
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_DUPLICATE_DATE if two logs share a date and the policy is
+ *        MAIN_DUPLICATE_ERROR.
+ *      - a non-zero error code on failure.
+ */
+static status main_merge(
+    weightgraph_session* session, main_merge_input* inputs, size_t count,
+    int policy)
+{
+    status retval;
+    size_t* heap;
+    size_t size = 0;
+
+    heap = (size_t*)calloc(count, sizeof(size_t));
+    if (NULL == heap)
+    {
+        return ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    /* build the heap from the logs that have entries. */
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (inputs[i].nil != inputs[i].node)
+        {
+            heap[size++] = i;
+        }
+    }
+    for (size_t i = size / 2; i-- > 0; )
+    {
+        main_merge_sift_down(inputs, heap, size, i);
+    }
+
+    while (size > 0)
+    {
+        const char* date = main_merge_entry(&inputs[heap[0]])->date;
+        double weight = 0.0;
+        double sum = 0.0;
+        size_t duplicates = 0;
+
+        /* take every entry with this date. */
+        do
+        {
+            main_merge_input* input = &inputs[heap[0]];
+
+            if (duplicates > 0 && MAIN_DUPLICATE_ERROR == policy)
+            {
+                fprintf(
+                    stderr, "Error: %s repeats the date %s.\n",
+                    input->filename, date);
+                retval = ERROR_DUPLICATE_DATE;
+                goto cleanup_heap;
+            }
+
+            weight = main_merge_entry(input)->weight;
+            sum += weight;
+            ++duplicates;
+
+            /* advance this log, dropping it from the heap when done. */
+            input->node =
+                rbtree_successor_node(input->graph->entries, input->node);
+            if (input->nil == input->node)
+            {
+                heap[0] = heap[--size];
+            }
+            main_merge_sift_down(inputs, heap, size, 0);
+        } while (
+            size > 0
+         && !strcmp(main_merge_entry(&inputs[heap[0]])->date, date));
+
+        /* the last entry wins unless the duplicates are averaged. */
+        if (MAIN_DUPLICATE_AVERAGE == policy)
+        {
+            weight = sum / duplicates;
+        }
+
+        retval = weightgraph_session_push(session, date, weight);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_heap;
+        }
+    }
+
+    /* success. */
+    retval = STATUS_SUCCESS;
+    goto cleanup_heap;
+
+cleanup_heap:
+    free(heap);
+
+    return retval;
+}
+
+/**
+ * \brief Get the next entry of a log.
+ *
+ * \param input         The log, which must have an entry left.
+ *
+ * \returns the entry under the cursor of the log.
+ */
+static const weightgraph_entry* main_merge_entry(
+    const main_merge_input* input)
+{
+    return
+        (const weightgraph_entry*)rbtree_node_value(
+            input->graph->entries, input->node);
+}
+
+/**
+ * \brief Determine whether one log's next entry merges before another's.
+ *
+ * \param inputs        The logs.
+ * \param lhs           The index of the first log.
+ * \param rhs           The index of the second log.
+ *
+ * \returns true if the first log's entry comes first.
+ */
+static bool main_merge_before(
+    const main_merge_input* inputs, size_t lhs, size_t rhs)
+{
+    int val =
+        strcmp(
+            main_merge_entry(&inputs[lhs])->date,
+            main_merge_entry(&inputs[rhs])->date);
+
+    return val < 0 || (0 == val && lhs < rhs);
+}
+
+/**
+ * \brief Move an element of a heap down to its place.
+ *
+ * \param inputs        The logs that the heap orders.
+ * \param heap          The heap of log indices.
+ * \param size          The number of logs in the heap.
+ * \param i             The position of the element to move.
+ */
+static void main_merge_sift_down(
+    const main_merge_input* inputs, size_t* heap, size_t size, size_t i)
+{
+    for (;;)
+    {
+        size_t least = i;
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+
+        if (left < size && main_merge_before(inputs, heap[left], heap[least]))
+        {
+            least = left;
+        }
+        if (right < size
+         && main_merge_before(inputs, heap[right], heap[least]))
+        {
+            least = right;
+        }
+        if (least == i)
+        {
+            return;
+        }
+
+        size_t swap = heap[i];
+        heap[i] = heap[least];
+        heap[least] = swap;
+        i = least;
+    }
+}
@@ -0,0 +1,561 @@
+/**
+ * \file main/main_options_parse.c
+ *
+ * \brief Parse the command-line options for the main program.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <getopt.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "main_internal.h"
+
+/**
+ * \brief The default width and height of raster output, in pixels.
+ */
+#define MAIN_DEFAULT_RASTER_SIZE 600
+
+/**
+ * \brief The default number of entries plotted on each page.
+ */
+#define MAIN_DEFAULT_PAGE_SIZE 31
+
+/**
+ * \brief The default size of the output cache of a batch, in bytes.
+ */
+#define MAIN_DEFAULT_CACHE_LIMIT (256UL * 1024 * 1024)
+
+/**
+ * \brief The smallest memory budget for an external sort, in bytes.
+ */
+#define MAIN_MIN_SORT_BUDGET 1024
+
+/**
+ * \brief The option value returned by getopt_long for --stats.
+ */
+#define MAIN_OPTION_STATS 256
+
+/**
+ * \brief The option value returned by getopt_long for --outliers.
+ */
+#define MAIN_OPTION_OUTLIERS 257
+
+/**
+ * \brief The option value returned by getopt_long for --cache-limit.
+ */
+#define MAIN_OPTION_CACHE_LIMIT 258
+
+/**
+ * \brief The long options, which have no short form.
+ */
+static const struct option main_long_options[] = {
+    { "stats", optional_argument, NULL, MAIN_OPTION_STATS },
+    { "outliers", optional_argument, NULL, MAIN_OPTION_OUTLIERS },
+    { "cache-limit", required_argument, NULL, MAIN_OPTION_CACHE_LIMIT },
+    { NULL, 0, NULL, 0 },
+};
+
+/* forward decls. */
+static void main_options_usage(const char* name);
+static bool main_options_parse_size(const char* arg, size_t* size);
+static bool main_options_parse_outliers(
+    const char* arg, main_options* options);
+
+/**
+ * \brief Parse the command-line options for the main program.
+ *
+ * \param options       The options structure to populate.
+ * \param argc          The number of command-line arguments.
+ * \param argv          The command-line arguments.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status main_options_parse(main_options* options, int argc, char* argv[])
+{
+    int ch;
+    long size;
+    char* end;
+    bool duplicate_policy_given = false;
+
+    /* set defaults. */
+    memset(options, 0, sizeof(*options));
+    options->output_format = WEIGHTGRAPH_FORMAT_EPS;
+    options->raster_size = MAIN_DEFAULT_RASTER_SIZE;
+    options->page_size = MAIN_DEFAULT_PAGE_SIZE;
+    options->threads = 1;
+
+    while (-1 != (ch =
+                getopt_long(
+                    argc, argv, "abC:c:d:f:j:M:m:o:Pp:r:Ss:w",
+                    main_long_options, NULL)))
+    {
+        switch (ch)
+        {
+            case MAIN_OPTION_STATS:
+                if (NULL == optarg || !strcmp(optarg, "text"))
+                {
+                    options->stats_format = MAIN_STATS_TEXT;
+                }
+                else if (!strcmp(optarg, "json"))
+                {
+                    options->stats_format = MAIN_STATS_JSON;
+                }
+                else
+                {
+                    fprintf(
+                        stderr, "Error: unknown stats format '%s'.\n",
+                        optarg);
+                    goto usage;
+                }
+                break;
+
+            case MAIN_OPTION_OUTLIERS:
+                options->outlier_window = WEIGHTGRAPH_FILTER_WINDOW;
+                options->outlier_threshold = WEIGHTGRAPH_FILTER_THRESHOLD;
+                if (NULL != optarg
+                 && !main_options_parse_outliers(optarg, options))
+                {
+                    fprintf(
+                        stderr, "Error: invalid outlier filter '%s'.\n",
+                        optarg);
+                    goto usage;
+                }
+                break;
+
+            case MAIN_OPTION_CACHE_LIMIT:
+                if (!main_options_parse_size(optarg, &options->cache_limit)
+                 || 0 == options->cache_limit)
+                {
+                    fprintf(
+                        stderr, "Error: invalid cache limit '%s'.\n", optarg);
+                    goto usage;
+                }
+                break;
+
+            case 'a':
+                options->archive = true;
+                break;
+
+            case 'b':
+                options->batch = true;
+                break;
+
+            case 'C':
+                options->cache_directory = optarg;
+                break;
+
+            case 'c':
+                options->checkpoint_file = optarg;
+                break;
+
+            case 'd':
+                options->socket_file = optarg;
+                break;
+
+            case 'f':
+                if (!strcmp(optarg, "eps"))
+                {
+                    options->output_format = WEIGHTGRAPH_FORMAT_EPS;
+                }
+                else if (!strcmp(optarg, "png"))
+                {
+                    options->output_format = WEIGHTGRAPH_FORMAT_PNG;
+                }
+                else
+                {
+                    fprintf(stderr, "Error: unknown format '%s'.\n", optarg);
+                    goto usage;
+                }
+                break;
+
+            case 'j':
+                size = strtol(optarg, &end, 10);
+                if (0 != *end || size < 1 || size > 1024)
+                {
+                    fprintf(
+                        stderr, "Error: invalid thread count '%s'.\n", optarg);
+                    goto usage;
+                }
+                options->threads = (size_t)size;
+                break;
+
+            case 'M':
+                if (!main_options_parse_size(optarg, &options->sort_budget)
+                 || options->sort_budget < MAIN_MIN_SORT_BUDGET)
+                {
+                    fprintf(
+                        stderr, "Error: invalid sort budget '%s'.\n", optarg);
+                    goto usage;
+                }
+                break;
+
+            case 'm':
+                if (!strcmp(optarg, "error"))
+                {
+                    options->duplicate_policy = MAIN_DUPLICATE_ERROR;
+                }
+                else if (!strcmp(optarg, "last"))
+                {
+                    options->duplicate_policy = MAIN_DUPLICATE_LAST;
+                }
+                else if (!strcmp(optarg, "average"))
+                {
+                    options->duplicate_policy = MAIN_DUPLICATE_AVERAGE;
+                }
+                else
+                {
+                    fprintf(
+                        stderr, "Error: unknown duplicate policy '%s'.\n",
+                        optarg);
+                    goto usage;
+                }
+                duplicate_policy_given = true;
+                break;
+
+            case 'o':
+                options->output_file = optarg;
+                break;
+
+            case 'P':
+                options->pipelined = true;
+                break;
+
+            case 'p':
+                size = strtol(optarg, &end, 10);
+                if (0 != *end || size < 1 || size > 100000)
+                {
+                    fprintf(
+                        stderr, "Error: invalid page size '%s'.\n", optarg);
+                    goto usage;
+                }
+                options->page_size = (size_t)size;
+                break;
+
+            case 'r':
+                if (!weightgraph_period_from_name(optarg, &options->period))
+                {
+                    fprintf(stderr, "Error: unknown period '%s'.\n", optarg);
+                    goto usage;
+                }
+                break;
+
+            case 'S':
+                options->streaming = true;
+                break;
+
+            case 's':
+                size = strtol(optarg, &end, 10);
+                if (0 != *end || size < 1 || size > 16384)
+                {
+                    fprintf(stderr, "Error: invalid size '%s'.\n", optarg);
+                    goto usage;
+                }
+                options->raster_size = (size_t)size;
+                break;
+
+            case 'w':
+                options->watch = true;
+                break;
+
+            default:
+                goto usage;
+        }
+    }
+
+    /* a daemon takes its inputs from requests. */
+    if (NULL != options->socket_file)
+    {
+        if (options->archive || options->batch || options->watch
+         || options->pipelined || options->streaming
+         || 0 != options->sort_budget || duplicate_policy_given
+         || NULL != options->checkpoint_file || NULL != options->output_file
+         || WEIGHTGRAPH_PERIOD_DAY != options->period
+         || NULL != options->cache_directory || 0 != options->cache_limit
+         || optind < argc)
+        {
+            fprintf(
+                stderr,
+                "Error: -d can't be used with -a, -b, -C, -c, -M, -m, -o, -P, "
+                "-r, -S, -w or an input.\n");
+            goto usage;
+        }
+
+        return STATUS_SUCCESS;
+    }
+
+    /* verify that there is a command-line argument: the filename. */
+    if (optind >= argc)
+    {
+        fprintf(stderr, "Error: expecting one argument -- the input file.\n");
+        goto usage;
+    }
+
+    options->input_file = argv[optind];
+    options->input_files = &argv[optind];
+    options->input_count = (size_t)(argc - optind);
+
+    /* only a single render can merge several inputs. */
+    if (options->input_count > 1
+     && (options->archive || options->batch || options->pipelined
+      || options->streaming || options->watch || 0 != options->sort_budget))
+    {
+        fprintf(
+            stderr,
+            "Error: -a, -b, -M, -P, -S and -w take a single input.\n");
+        goto usage;
+    }
+
+    /* only dates shared by several inputs need a policy. */
+    if (duplicate_policy_given && 1 == options->input_count)
+    {
+        fprintf(stderr, "Error: -m requires several inputs.\n");
+        goto usage;
+    }
+
+    /* a conversion writes a single archive, and renders nothing. */
+    if (options->archive)
+    {
+        if (options->batch || options->pipelined || options->streaming
+         || options->watch || 0 != options->sort_budget
+         || NULL != options->checkpoint_file)
+        {
+            fprintf(
+                stderr,
+                "Error: -a can't be used with -b, -c, -M, -P, -S or -w.\n");
+            goto usage;
+        }
+
+        if (NULL == options->output_file)
+        {
+            options->output_file = "output.wga";
+        }
+    }
+
+    /* only a log held in a session can be rolled up. */
+    if (WEIGHTGRAPH_PERIOD_DAY != options->period
+     && (options->archive || options->batch || options->streaming
+      || options->watch || 0 != options->sort_budget))
+    {
+        fprintf(
+            stderr, "Error: -r can't be used with -a, -b, -M, -S or -w.\n");
+        goto usage;
+    }
+
+    /* a plotter keeps no samples to mark, nor a conversion any graph. */
+    if (0 != options->outlier_window
+     && (options->archive || options->streaming || 0 != options->sort_budget))
+    {
+        fprintf(stderr, "Error: --outliers can't be used with -a, -M or -S.\n");
+        goto usage;
+    }
+
+    /* a watched input is a single log, rendered to a single output. */
+    if (options->watch
+     && (options->batch || NULL != options->checkpoint_file))
+    {
+        fprintf(stderr, "Error: -w can't be used with -b or -c.\n");
+        goto usage;
+    }
+
+    /* a pipelined input is loaded once, for a single render. */
+    if (options->pipelined && (options->batch || options->watch))
+    {
+        fprintf(stderr, "Error: -P can't be used with -b or -w.\n");
+        goto usage;
+    }
+
+    /* a streamed input is rendered once, in a single pass over its pages. */
+    if (options->streaming
+     && (options->batch || options->pipelined || options->watch
+      || NULL != options->checkpoint_file))
+    {
+        fprintf(stderr, "Error: -S can't be used with -b, -c, -P or -w.\n");
+        goto usage;
+    }
+
+    /* an externally sorted input is streamed to the output once sorted. */
+    if (0 != options->sort_budget
+     && (options->batch || options->pipelined || options->streaming
+      || options->watch || NULL != options->checkpoint_file))
+    {
+        fprintf(
+            stderr, "Error: -M can't be used with -b, -c, -P, -S or -w.\n");
+        goto usage;
+    }
+
+    /* a batch writes each graph to the output directory. */
+    if (options->batch)
+    {
+        if (NULL != options->checkpoint_file)
+        {
+            fprintf(stderr, "Error: -c can't be used with -b.\n");
+            goto usage;
+        }
+
+        if (NULL == options->output_file)
+        {
+            options->output_file = ".";
+        }
+    }
+
+    /* only a batch renders graphs that are likely to be rendered again. */
+    if (NULL != options->cache_directory && !options->batch)
+    {
+        fprintf(stderr, "Error: -C can only be used with -b.\n");
+        goto usage;
+    }
+
+    if (0 != options->cache_limit && NULL == options->cache_directory)
+    {
+        fprintf(stderr, "Error: --cache-limit requires -C.\n");
+        goto usage;
+    }
+
+    if (0 == options->cache_limit)
+    {
+        options->cache_limit = MAIN_DEFAULT_CACHE_LIMIT;
+    }
+
+    /* pick a default output file name for the format. */
+    if (NULL == options->output_file)
+    {
+        options->output_file =
+            (WEIGHTGRAPH_FORMAT_PNG == options->output_format)
+                ? "output.png" : "output.eps";
+    }
+
+    return STATUS_SUCCESS;
+
+usage:
+    main_options_usage(argv[0]);
+    return ERROR_BAD_ARGUMENTS;
+}
+
+/**
+ * \brief Print usage information.
+ *
+ * \param name          The name of the program.
+ */
+static void main_options_usage(const char* name)
+{
+    fprintf(
+        stderr,
+        "Usage: %s [-c checkpoint | -w] [-f eps|png] [-j threads] "
+        "[-o output] [-P] [-p entries]\n"
+        "           [-r day|week|month|year] [-s pixels] input\n"
+        "       %s [-c checkpoint] [-f eps|png] [-j threads] "
+        "[-m error|last|average] [-o output]\n"
+        "           [-p entries] [-r day|week|month|year] [-s pixels] "
+        "input input...\n"
+        "       %s -S [-f eps|png] [-o output] [-p entries] [-s pixels] "
+        "input\n"
+        "       %s -M bytes[k|m|g] [-f eps|png] [-o output] [-p entries] "
+        "[-s pixels] input\n"
+        "       %s -b [-C directory [--cache-limit=bytes[k|m|g]]] "
+        "[-f eps|png] [-j threads]\n"
+        "           [-o directory] [-p entries] [-s pixels] "
+        "manifest|directory\n"
+        "       %s -d socket [-j threads] [-p entries] [-s pixels]\n"
+        "       %s -a [-o output] input\n"
+        "Any form may be given --stats[=text|json] to report timing and "
+        "resource use.\n"
+        "Any form but -S, -M or -a may be given "
+        "--outliers[=window[,threshold]] to reject\n"
+        "outlying weights.\n",
+        name, name, name, name, name, name, name);
+}
+
+/**
+ * \brief Parse a size in bytes, with an optional k, m or g suffix.
+ *
+ * \param arg           The argument to parse.
+ * \param size          Pointer to receive the size.
+ *
+ * \returns true if the argument is a valid size.
+ */
+static bool main_options_parse_size(const char* arg, size_t* size)
+{
+    unsigned long long value;
+    unsigned int shift = 0;
+    char* end;
+
+    if (*arg < '0' || *arg > '9')
+    {
+        return false;
+    }
+
+    value = strtoull(arg, &end, 10);
+    switch (*end)
+    {
+        case 'k':
+        case 'K':
+            shift = 10;
+            ++end;
+            break;
+
+        case 'm':
+        case 'M':
+            shift = 20;
+            ++end;
+            break;
+
+        case 'g':
+        case 'G':
+            shift = 30;
+            ++end;
+            break;
+    }
+
+    if (0 != *end || value > (SIZE_MAX >> shift))
+    {
+        return false;
+    }
+
+    *size = (size_t)(value << shift);
+    return true;
+}
+
+/**
+ * \brief Parse the window, and optional threshold, of the outlier filter.
+ *
+ * \param arg           The argument to parse, as "window[,threshold]".
+ * \param options       The options structure to populate.
+ *
+ * \returns true if the argument is a valid window and threshold.
+ */
+static bool main_options_parse_outliers(
+    const char* arg, main_options* options)
+{
+    long window;
+    double threshold = WEIGHTGRAPH_FILTER_THRESHOLD;
+    char* end;
+
+    if (*arg < '0' || *arg > '9')
+    {
+        return false;
+    }
+
+    window = strtol(arg, &end, 10);
+    if (',' == *end)
+    {
+        threshold = strtod(end + 1, &end);
+    }
+
+    if (0 != *end || window < 3 || window > WEIGHTGRAPH_FILTER_MAX_WINDOW
+     || !(threshold > 0.0) || !isfinite(threshold))
+    {
+        return false;
+    }
+
+    options->outlier_window = (size_t)window;
+    options->outlier_threshold = threshold;
+    return true;
+}
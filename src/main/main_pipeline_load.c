@@ -0,0 +1,391 @@
+/**
+ * \file main/main_pipeline_load.c
+ *
+ * \brief Read, parse and average a log in a pipeline.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "main_internal.h"
+
+RCPR_IMPORT_resource;
+
+/**
+ * \brief The number of samples held by the pipeline ring.
+ */
+#define MAIN_PIPELINE_RING_SIZE 4096
+
+/**
+ * \brief The size of each piece of the log read by the parser thread.
+ */
+#define MAIN_PIPELINE_CHUNK_SIZE 65536
+
+/**
+ * \brief The number of entries averaged in each span of the trace.
+ */
+#define MAIN_PIPELINE_TRACE_BATCH 1024
+
+/**
+ * \brief The parse stage of the pipeline.
+ */
+typedef struct main_pipeline_parse main_pipeline_parse;
+
+struct main_pipeline_parse
+{
+    main_sample_ring* ring;
+    weightgraph_parser* parser;
+    const char* filename;
+    status retval;
+};
+
+/* forward decls. */
+static void* main_pipeline_parse_thread(void* context);
+static status main_pipeline_beginning_average(void* context, double average);
+static status main_pipeline_log(
+    void* context, const char* date, double weight);
+static status main_pipeline_average(
+    weightgraph_session* session, main_sample_ring* ring);
+static const char* main_pipeline_date(const main_ring_sample* sample);
+
+/**
+ * \brief Read, parse and average a log in a pipeline, pushing its entries
+ * onto a new session.
+ *
+ * A parser thread reads the log a piece at a time and streams its entries
+ * through a sample ring to the calling thread, which computes the moving
+ * average of each entry as it arrives.  The entries must be in date order,
+ * and entries that share a date are pushed in the order of the log.
+ *
+ * \param session       Pointer to receive the session.
+ * \param alloc         The allocator to use for this operation.
+ * \param options       The command-line options, naming the log.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_OUT_OF_ORDER if the entries are not in date order.
+ *      - a non-zero error code on failure.
+ */
+status main_pipeline_load(
+    weightgraph_session** session, RCPR_SYM(allocator)* alloc,
+    const main_options* options)
+{
+    status retval, release_retval;
+    main_sample_ring ring;
+    main_pipeline_parse parse;
+    weightgraph_session* tmp;
+    pthread_t thread;
+
+    retval = main_sample_ring_init(&ring, MAIN_PIPELINE_RING_SIZE);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* the parser is created here, as the allocator belongs to this thread. */
+    memset(&parse, 0, sizeof(parse));
+    parse.ring = &ring;
+    parse.filename = options->input_file;
+    retval = weightgraph_parser_create(&parse.parser, alloc);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_ring;
+    }
+
+    weightgraph_parser_set_format(
+        parse.parser,
+        weightgraph_input_format_from_name(options->input_file));
+
+    /* the initial average arrives through the ring. */
+    retval = main_session_create(&tmp, alloc, 0.0, options);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_parser;
+    }
+
+    /* start the parse stage. */
+    if (0 != pthread_create(&thread, NULL, &main_pipeline_parse_thread, &parse))
+    {
+        retval = ERROR_PIPELINE_STOPPED;
+        goto cleanup_session;
+    }
+
+    /* run the averaging stage on this thread as the samples arrive. */
+    retval = main_pipeline_average(tmp, &ring);
+    if (STATUS_SUCCESS != retval)
+    {
+        main_sample_ring_abandon(&ring);
+    }
+
+    pthread_join(thread, NULL);
+
+    /* a parse failure explains why the samples stopped. */
+    if (STATUS_SUCCESS != retval
+     || STATUS_SUCCESS != (retval = parse.retval))
+    {
+        goto cleanup_session;
+    }
+
+    /* success. */
+    *session = tmp;
+    goto cleanup_parser;
+
+cleanup_session:
+    release_retval = resource_release(weightgraph_session_resource_handle(tmp));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_parser:
+    release_retval =
+        resource_release(weightgraph_parser_resource_handle(parse.parser));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_ring:
+    main_sample_ring_dispose(&ring);
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Read and parse the log a piece at a time, pushing its elements
+ * onto the ring.
+ *
+ * \param context       The parse stage.
+ *
+ * \returns NULL.
+ */
+static void* main_pipeline_parse_thread(void* context)
+{
+    main_pipeline_parse* parse = (main_pipeline_parse*)context;
+    weightgraph_stream_handler handler;
+    main_input input;
+    uint8_t* chunk;
+    size_t size;
+    uint64_t trace_start;
+
+    main_trace_thread_name("parser");
+
+    handler.context = parse->ring;
+    handler.beginning_average = &main_pipeline_beginning_average;
+    handler.log = &main_pipeline_log;
+
+    chunk = (uint8_t*)malloc(MAIN_PIPELINE_CHUNK_SIZE);
+    if (NULL == chunk)
+    {
+        parse->retval = ERROR_GENERAL_OUT_OF_MEMORY;
+        goto done;
+    }
+
+    parse->retval = main_input_open(&input, parse->filename);
+    if (STATUS_SUCCESS != parse->retval)
+    {
+        goto cleanup_chunk;
+    }
+
+    parse->retval = weightgraph_parser_stream_begin(parse->parser, &handler);
+    if (STATUS_SUCCESS != parse->retval)
+    {
+        goto cleanup_input;
+    }
+
+    /* parse each piece as soon as it is read. */
+    do
+    {
+        parse->retval =
+            main_input_read(&input, chunk, MAIN_PIPELINE_CHUNK_SIZE, &size);
+        if (STATUS_SUCCESS != parse->retval)
+        {
+            break;
+        }
+
+        trace_start = main_trace_begin();
+        parse->retval =
+            weightgraph_parser_stream(parse->parser, chunk, size, 0 == size);
+        main_trace_end("parse", trace_start, size);
+    } while (STATUS_SUCCESS == parse->retval && size > 0);
+
+cleanup_input:
+    main_input_close(&input);
+
+cleanup_chunk:
+    free(chunk);
+
+done:
+    /* the averaging stage stops once the ring drains. */
+    main_sample_ring_close(parse->ring);
+
+    return NULL;
+}
+
+/**
+ * \brief Push the beginning average onto the ring.
+ *
+ * \param context       The ring.
+ * \param average       The initial moving average.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_pipeline_beginning_average(void* context, double average)
+{
+    main_ring_sample sample;
+
+    memset(&sample, 0, sizeof(sample));
+    sample.average = true;
+    sample.value = average;
+
+    if (!main_sample_ring_push((main_sample_ring*)context, &sample))
+    {
+        return ERROR_PIPELINE_STOPPED;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Push a log entry onto the ring.
+ *
+ * \param context       The ring.
+ * \param date          The date of the entry.
+ * \param weight        The weight of the entry.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_pipeline_log(
+    void* context, const char* date, double weight)
+{
+    main_ring_sample sample;
+    size_t date_size = strlen(date) + 1;
+
+    sample.average = false;
+    sample.value = weight;
+    sample.long_date = NULL;
+
+    /* a date too long for the slot is carried on the heap. */
+    if (date_size > MAIN_RING_DATE_SIZE)
+    {
+        sample.long_date = (char*)malloc(date_size);
+        if (NULL == sample.long_date)
+        {
+            return ERROR_GENERAL_OUT_OF_MEMORY;
+        }
+
+        memcpy(sample.long_date, date, date_size);
+        sample.date[0] = 0;
+    }
+    else
+    {
+        memcpy(sample.date, date, date_size);
+    }
+
+    if (!main_sample_ring_push((main_sample_ring*)context, &sample))
+    {
+        free(sample.long_date);
+        return ERROR_PIPELINE_STOPPED;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Push each entry from the ring onto the session as it arrives.
+ *
+ * Entries that share a date are pushed in the order they arrive, as the
+ * entry tree keeps them.
+ *
+ * \param session       The session.
+ * \param ring          The ring.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_OUT_OF_ORDER if the entries are not in date order.
+ *      - a non-zero error code on failure.
+ */
+static status main_pipeline_average(
+    weightgraph_session* session, main_sample_ring* ring)
+{
+    status retval = STATUS_SUCCESS;
+    main_ring_sample sample, last;
+    size_t count = 0;
+    uint64_t trace_start = main_trace_begin();
+
+    /* the last entry is kept, with its long date, to check the order. */
+    last.long_date = NULL;
+
+    while (main_sample_ring_pop(ring, &sample))
+    {
+        if (sample.average)
+        {
+            /* the beginning average must come before the entries. */
+            if (count > 0)
+            {
+                retval = ERROR_OUT_OF_ORDER;
+                goto cleanup_last;
+            }
+
+            weightgraph_session_reset(session, sample.value);
+            continue;
+        }
+
+        /* entries can't be sorted without holding them all. */
+        if (count > 0
+         && strcmp(main_pipeline_date(&sample), main_pipeline_date(&last)) < 0)
+        {
+            free(sample.long_date);
+            retval = ERROR_OUT_OF_ORDER;
+            goto cleanup_last;
+        }
+
+        retval =
+            weightgraph_session_push(
+                session, main_pipeline_date(&sample), sample.value);
+        free(last.long_date);
+        last = sample;
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_last;
+        }
+
+        ++count;
+
+        /* the entries are averaged in batches in the trace. */
+        if (0 == count % MAIN_PIPELINE_TRACE_BATCH)
+        {
+            main_trace_end(
+                "average", trace_start, MAIN_PIPELINE_TRACE_BATCH);
+            trace_start = main_trace_begin();
+        }
+    }
+
+    main_trace_end("average", trace_start, count % MAIN_PIPELINE_TRACE_BATCH);
+
+cleanup_last:
+    free(last.long_date);
+
+    return retval;
+}
+
+/**
+ * \brief Get the date of a sample from the ring.
+ *
+ * \param sample        The sample.
+ *
+ * \returns the date, in the slot or on the heap.
+ */
+static const char* main_pipeline_date(const main_ring_sample* sample)
+{
+    return (NULL != sample->long_date) ? sample->long_date : sample->date;
+}
@@ -0,0 +1,64 @@
+/**
+ * \file main/main_push_entries.c
+ *
+ * \brief Push the entries of a parsed log onto a session.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "main_internal.h"
+
+RCPR_IMPORT_rbtree;
+
+/**
+ * \brief Push the entries of a parsed log onto a session, in date order.
+ *
+ * \param session       The session.
+ * \param graph         The parsed log.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status main_push_entries(weightgraph_session* session, weightgraph* graph)
+{
+    status retval;
+    rbtree_node* tmp;
+    rbtree_node* nil;
+    uint64_t trace_start = main_trace_begin();
+
+    /* get the nil node for the entry tree. */
+    nil = rbtree_nil_node(graph->entries);
+
+    /* an empty tree has nothing to push. */
+    tmp = rbtree_root_node(graph->entries);
+    if (nil == tmp)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    /* get the minimum node for the tree. */
+    tmp = rbtree_minimum_node(graph->entries, tmp);
+
+    /* while this node is not NULL, walk the tree. */
+    while (nil != tmp)
+    {
+        /* get the entry. */
+        weightgraph_entry* entry =
+            (weightgraph_entry*)rbtree_node_value(graph->entries, tmp);
+
+        retval = weightgraph_session_push(session, entry->date, entry->weight);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        /* get the next node in the tree. */
+        tmp = rbtree_successor_node(graph->entries, tmp);
+    }
+
+    main_trace_end("average", trace_start, graph->entry_count);
+
+    return STATUS_SUCCESS;
+}
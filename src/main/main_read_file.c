@@ -7,11 +7,7 @@
  * distribution for the license terms under which this software is distributed.
  */
 
-#include <fcntl.h>
 #include <stdlib.h>
-#include <string.h>
-#include <sys/stat.h>
-#include <unistd.h>
 
 #include "main_internal.h"
 
@@ -30,58 +26,17 @@ status main_read_file(
     uint8_t** buffer, size_t* buffer_size, const char* filename)
 {
     status retval;
-    struct stat st;
-    size_t size;
-    uint8_t* tmp;
-    int fd;
+    size_t capacity = 0;
+    uint8_t* tmp = NULL;
 
-    /* stat the file to get its size. */
-    retval = stat(filename, &st);
+    retval = main_read_file_buffer(&tmp, &capacity, buffer_size, filename);
     if (STATUS_SUCCESS != retval)
     {
-        retval = ERROR_STAT_FAILED;
-        goto done;
-    }
-
-    /* get the size. */
-    size = st.st_size + 1;
-
-    /* allocate enough memory to hold the contents. */
-    tmp = (uint8_t*)malloc(size);
-    if (NULL == tmp)
-    {
-        retval = ERROR_GENERAL_OUT_OF_MEMORY;
-        goto done;
-    }
-
-    /* clear this memory. */
-    memset(tmp, 0, size);
-
-    /* open the file. */
-    fd = open(filename, O_RDONLY);
-    if (fd < 0)
-    {
-        retval = ERROR_OPEN_FAILED;
-        goto cleanup_tmp;
-    }
-
-    /* read the file contents into the buffer. */
-    ssize_t read_size = read(fd, tmp, size - 1);
-    if (read_size != (ssize_t)(size - 1))
-    {
-        retval = ERROR_READ_FAILED;
-        goto cleanup_tmp;
+        free(tmp);
+        return retval;
     }
 
     /* success.  Assign buffer. */
     *buffer = tmp;
-    *buffer_size = size - 1;
-    retval = STATUS_SUCCESS;
-    goto done;
-
-cleanup_tmp:
-    free(tmp);
-
-done:
-    return retval;
+    return STATUS_SUCCESS;
 }
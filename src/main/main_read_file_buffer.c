@@ -0,0 +1,100 @@
+/**
+ * \file main/main_read_file_buffer.c
+ *
+ * \brief Stat and read a file into a reusable buffer.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <stdlib.h>
+
+#include "main_internal.h"
+
+/**
+ * \brief Stat and read the given file into a reusable buffer.
+ *
+ * The buffer is grown with realloc when the file does not fit, so reading
+ * many files into the same buffer only allocates for the largest of them.
+ * The contents are followed by a zero byte.  On failure, the buffer remains
+ * owned by the caller.  A gzip-compressed file is decompressed as it is read.
+ *
+ * \param buffer        Pointer to the buffer, which may be NULL.
+ * \param capacity      Pointer to the capacity of the buffer.
+ * \param buffer_size   Pointer to receive the size of the contents.
+ * \param filename      The name of the file to read.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status main_read_file_buffer(
+    uint8_t** buffer, size_t* capacity, size_t* buffer_size,
+    const char* filename)
+{
+    status retval;
+    main_input input;
+    size_t size = 0;
+    size_t read_size;
+    uint8_t* tmp;
+
+    retval = main_input_open(&input, filename);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* an uncompressed file is read in one go. */
+    if (!input.compressed)
+    {
+        main_input_close(&input);
+        return
+            main_read_file_range(buffer, capacity, buffer_size, filename, 0);
+    }
+
+    /* the decompressed size is unknown, so read until the input ends. */
+    do
+    {
+        /* keep room for a chunk and the terminating byte. */
+        if (NULL == *buffer || *capacity < size + MAIN_INPUT_CHUNK_SIZE + 1)
+        {
+            size_t grown = 2 * *capacity;
+
+            if (grown < size + MAIN_INPUT_CHUNK_SIZE + 1)
+            {
+                grown = size + MAIN_INPUT_CHUNK_SIZE + 1;
+            }
+
+            tmp = (uint8_t*)realloc(*buffer, grown);
+            if (NULL == tmp)
+            {
+                retval = ERROR_GENERAL_OUT_OF_MEMORY;
+                goto cleanup_input;
+            }
+
+            *buffer = tmp;
+            *capacity = grown;
+        }
+
+        retval =
+            main_input_read(
+                &input, *buffer + size, MAIN_INPUT_CHUNK_SIZE, &read_size);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_input;
+        }
+
+        size += read_size;
+    } while (read_size > 0);
+
+    /* success. */
+    (*buffer)[size] = 0;
+    *buffer_size = size;
+    retval = STATUS_SUCCESS;
+    goto cleanup_input;
+
+cleanup_input:
+    main_input_close(&input);
+
+    return retval;
+}
@@ -0,0 +1,111 @@
+/**
+ * \file main/main_read_file_range.c
+ *
+ * \brief Stat and read the tail of a file into a reusable buffer.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "main_internal.h"
+
+/**
+ * \brief Stat and read the given file, from an offset to its end, into a
+ * reusable buffer.
+ *
+ * The buffer is grown with realloc when the data does not fit, so reading
+ * many files into the same buffer only allocates for the largest of them.
+ * The contents are followed by a zero byte.  On failure, the buffer remains
+ * owned by the caller.
+ *
+ * \param buffer        Pointer to the buffer, which may be NULL.
+ * \param capacity      Pointer to the capacity of the buffer.
+ * \param buffer_size   Pointer to receive the number of bytes read.
+ * \param filename      The name of the file to read.
+ * \param offset        The offset from which to read.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status main_read_file_range(
+    uint8_t** buffer, size_t* capacity, size_t* buffer_size,
+    const char* filename, off_t offset)
+{
+    status retval;
+    struct stat st;
+    size_t size;
+    uint8_t* tmp;
+    int fd;
+
+    /* stat the file to get its size. */
+    retval = stat(filename, &st);
+    if (STATUS_SUCCESS != retval)
+    {
+        retval = ERROR_STAT_FAILED;
+        goto done;
+    }
+
+    /* the file may have shrunk since the offset was recorded. */
+    if (st.st_size < offset)
+    {
+        retval = ERROR_READ_FAILED;
+        goto done;
+    }
+
+    /* get the size of the range. */
+    size = st.st_size - offset + 1;
+
+    /* grow the buffer if it can't hold the contents. */
+    if (NULL == *buffer || *capacity < size)
+    {
+        tmp = (uint8_t*)realloc(*buffer, size);
+        if (NULL == tmp)
+        {
+            retval = ERROR_GENERAL_OUT_OF_MEMORY;
+            goto done;
+        }
+
+        *buffer = tmp;
+        *capacity = size;
+    }
+
+    /* clear the terminating byte. */
+    (*buffer)[size - 1] = 0;
+
+    /* open the file. */
+    fd = open(filename, O_RDONLY);
+    if (fd < 0)
+    {
+        retval = ERROR_OPEN_FAILED;
+        goto done;
+    }
+
+    /* read the file contents into the buffer. */
+    uint64_t trace_start = main_trace_begin();
+    ssize_t read_size = pread(fd, *buffer, size - 1, offset);
+    main_trace_end("read", trace_start, size - 1);
+    if (read_size != (ssize_t)(size - 1))
+    {
+        retval = ERROR_READ_FAILED;
+        goto cleanup_fd;
+    }
+
+    /* success. */
+    main_stats_count_read(size - 1);
+    *buffer_size = size - 1;
+    retval = STATUS_SUCCESS;
+    goto cleanup_fd;
+
+cleanup_fd:
+    close(fd);
+
+done:
+    return retval;
+}
@@ -0,0 +1,22 @@
+/**
+ * \file main/main_sample_ring_abandon.c
+ *
+ * \brief Abandon a sample ring.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "main_internal.h"
+
+/**
+ * \brief Abandon the ring, so that a producer waiting on it stops.
+ *
+ * Only the consumer may call this.
+ *
+ * \param ring          The ring.
+ */
+void main_sample_ring_abandon(main_sample_ring* ring)
+{
+    atomic_store_explicit(&ring->abandoned, true, memory_order_relaxed);
+}
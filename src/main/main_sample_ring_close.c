@@ -0,0 +1,22 @@
+/**
+ * \file main/main_sample_ring_close.c
+ *
+ * \brief Close a sample ring.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "main_internal.h"
+
+/**
+ * \brief Close the ring, indicating that no more samples will be pushed.
+ *
+ * Only the producer may call this.
+ *
+ * \param ring          The ring.
+ */
+void main_sample_ring_close(main_sample_ring* ring)
+{
+    atomic_store_explicit(&ring->closed, true, memory_order_release);
+}
@@ -0,0 +1,33 @@
+/**
+ * \file main/main_sample_ring_dispose.c
+ *
+ * \brief Dispose of a sample ring.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <stdlib.h>
+
+#include "main_internal.h"
+
+/**
+ * \brief Dispose of a sample ring, and the long dates of any samples left in
+ * it.
+ *
+ * \param ring          The ring, which neither side may still be using.
+ */
+void main_sample_ring_dispose(main_sample_ring* ring)
+{
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+    /* an abandoned ring may still hold samples that were never popped. */
+    for (; head != tail; ++head)
+    {
+        free(ring->slots[head & ring->mask].long_date);
+    }
+
+    free(ring->slots);
+    ring->slots = NULL;
+}
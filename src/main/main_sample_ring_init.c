@@ -0,0 +1,43 @@
+/**
+ * \file main/main_sample_ring_init.c
+ *
+ * \brief Initialize a single-producer, single-consumer sample ring.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "main_internal.h"
+
+/**
+ * \brief Initialize a single-producer, single-consumer sample ring.
+ *
+ * \param ring          The ring to initialize.
+ * \param capacity      The number of samples the ring holds, which must be a
+ *                      power of two.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status main_sample_ring_init(main_sample_ring* ring, size_t capacity)
+{
+    memset(ring, 0, sizeof(*ring));
+
+    ring->slots = (main_ring_sample*)malloc(capacity * sizeof(*ring->slots));
+    if (NULL == ring->slots)
+    {
+        return ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    ring->mask = capacity - 1;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->closed, false);
+    atomic_init(&ring->abandoned, false);
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,51 @@
+/**
+ * \file main/main_sample_ring_pop.c
+ *
+ * \brief Pop a sample from a sample ring.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <sched.h>
+
+#include "main_internal.h"
+
+/**
+ * \brief Pop a sample from the ring, waiting while it is empty.
+ *
+ * Only the consumer may call this.
+ *
+ * \param ring          The ring.
+ * \param sample        The sample to populate.
+ *
+ * \returns true if a sample was popped, or false if the producer has closed
+ * the ring and every sample has been popped.
+ */
+bool main_sample_ring_pop(main_sample_ring* ring, main_ring_sample* sample)
+{
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+    /* wait for the producer to publish a slot. */
+    while (head == atomic_load_explicit(&ring->tail, memory_order_acquire))
+    {
+        /* samples pushed before the ring was closed are still popped. */
+        if (atomic_load_explicit(&ring->closed, memory_order_acquire))
+        {
+            if (head == atomic_load_explicit(&ring->tail, memory_order_acquire))
+            {
+                return false;
+            }
+
+            break;
+        }
+
+        sched_yield();
+    }
+
+    /* copy the slot, then release it to the producer. */
+    *sample = ring->slots[head & ring->mask];
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+
+    return true;
+}
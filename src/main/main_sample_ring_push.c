@@ -0,0 +1,47 @@
+/**
+ * \file main/main_sample_ring_push.c
+ *
+ * \brief Push a sample onto a sample ring.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <sched.h>
+
+#include "main_internal.h"
+
+/**
+ * \brief Push a sample onto the ring, waiting while it is full.
+ *
+ * Only the producer may call this.
+ *
+ * \param ring          The ring.
+ * \param sample        The sample to push.
+ *
+ * \returns true if the sample was pushed, or false if the consumer has
+ * abandoned the ring.
+ */
+bool main_sample_ring_push(
+    main_sample_ring* ring, const main_ring_sample* sample)
+{
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+    /* wait for the consumer to free a slot. */
+    while (tail - atomic_load_explicit(&ring->head, memory_order_acquire)
+            > ring->mask)
+    {
+        if (atomic_load_explicit(&ring->abandoned, memory_order_relaxed))
+        {
+            return false;
+        }
+
+        sched_yield();
+    }
+
+    /* fill the slot, then publish it. */
+    ring->slots[tail & ring->mask] = *sample;
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+
+    return true;
+}
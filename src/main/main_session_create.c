@@ -0,0 +1,63 @@
+/**
+ * \file main/main_session_create.c
+ *
+ * \brief Create a session with the outlier filter of the options.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "main_internal.h"
+
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Create an empty session, filtering its weights for outliers if the
+ * options ask for it.
+ *
+ * \param session       Pointer to receive the session.
+ * \param alloc         The allocator to use for this operation.
+ * \param average       The initial moving average for this session.
+ * \param options       The command-line options.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status main_session_create(
+    weightgraph_session** session, RCPR_SYM(allocator)* alloc,
+    double average, const main_options* options)
+{
+    status retval, release_retval;
+    weightgraph_session* tmp;
+
+    retval = weightgraph_session_create(&tmp, alloc, average);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    if (0 != options->outlier_window)
+    {
+        retval =
+            weightgraph_session_filter(
+                tmp, options->outlier_window, options->outlier_threshold);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_session;
+        }
+    }
+
+    /* success. */
+    *session = tmp;
+    return STATUS_SUCCESS;
+
+cleanup_session:
+    release_retval = resource_release(weightgraph_session_resource_handle(tmp));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
@@ -0,0 +1,829 @@
+/**
+ * \file main/main_sort_render.c
+ *
+ * \brief Render a log of any size and order with an external sort.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "main_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief The size of each piece of the log that is read and parsed.
+ */
+#define MAIN_SORT_CHUNK_SIZE 65536
+
+/**
+ * \brief The largest number of runs merged at once.
+ */
+#define MAIN_SORT_FAN_IN 64
+
+/**
+ * \brief The longest date, including its terminator, that a record holds.
+ */
+#define MAIN_SORT_DATE_SIZE 24
+
+/**
+ * \brief A compact log entry, as spilled to a run.
+ */
+typedef struct main_sort_record main_sort_record;
+
+struct main_sort_record
+{
+    double weight;
+    /* the position of the entry in the log, which orders entries that share
+     * a date. */
+    uint64_t sequence;
+    char date[MAIN_SORT_DATE_SIZE];
+};
+
+/**
+ * \brief A sorted run, spilled to a temporary file.
+ */
+typedef struct main_sort_run main_sort_run;
+
+struct main_sort_run
+{
+    FILE* file;
+    /* the number of merges that built this run. */
+    size_t level;
+};
+
+/**
+ * \brief The next record of a run being merged.
+ */
+typedef struct main_sort_cursor main_sort_cursor;
+
+struct main_sort_cursor
+{
+    main_sort_record record;
+    FILE* run;
+};
+
+/**
+ * \brief The state of an external sort.
+ */
+typedef struct main_sort main_sort;
+
+struct main_sort
+{
+    /* the records gathered since the last spill. */
+    main_sort_record* records;
+    size_t used;
+    size_t capacity;
+    /* the sorted runs spilled so far, from the highest level down. */
+    main_sort_run* runs;
+    size_t run_count;
+    size_t run_capacity;
+    /* the initial average, the number of entries and the range of their
+     * weights, found as the log is parsed. */
+    double average;
+    size_t count;
+    double min_weight;
+    double max_weight;
+};
+
+/**
+ * \brief Where a merge writes its records.
+ */
+typedef status (*main_sort_emit)(void* context, const main_sort_record* rec);
+
+/* forward decls. */
+static status main_sort_parse(main_sort* sort, const char* filename);
+static status main_sort_average(void* context, double average);
+static status main_sort_log(void* context, const char* date, double weight);
+static status main_sort_spill(main_sort* sort);
+static status main_sort_collapse(main_sort* sort, size_t first);
+static status main_sort_run_create(FILE** run);
+static int main_sort_compare(const void* lhs, const void* rhs);
+static status main_sort_merge(
+    main_sort_run* runs, size_t count, main_sort_emit emit, void* context);
+static status main_sort_read(main_sort_cursor* cursor, bool* done);
+static void main_sort_sift_down(
+    main_sort_cursor* heap, size_t size, size_t i);
+static status main_sort_emit_run(void* context, const main_sort_record* rec);
+static status main_sort_emit_plot(void* context, const main_sort_record* rec);
+
+/**
+ * \brief Render a log whose entries may be in any order, holding no more
+ * than the sort budget of entries in memory.
+ *
+ * The log is parsed a piece at a time.  Its entries are gathered into a
+ * buffer of compact records the size of the sort budget, which is sorted
+ * and spilled to a temporary file whenever it fills.  The sorted runs are
+ * merged in levels, a fixed number at a time, and the final merge streams
+ * the entries in date order into a plotter.  Entries that share a date are
+ * plotted in the order they appear in the log, as they are when a log is
+ * parsed in memory.
+ *
+ * \param options       The command-line options.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status main_sort_render(const main_options* options)
+{
+    status retval, release_retval;
+    weightgraph_render_options render_options;
+    main_sort sort;
+    main_file_sink file;
+    weightgraph_sink sink;
+    weightgraph_plotter* plotter;
+    allocator* alloc;
+    uint64_t trace_start;
+
+    memset(&sort, 0, sizeof(sort));
+
+    /* the sort buffer holds the whole budget. */
+    sort.capacity = options->sort_budget / sizeof(main_sort_record);
+    sort.records =
+        (main_sort_record*)malloc(sort.capacity * sizeof(main_sort_record));
+    if (NULL == sort.records)
+    {
+        retval = ERROR_GENERAL_OUT_OF_MEMORY;
+        goto done;
+    }
+
+    /* parse the log into sorted runs. */
+    main_stats_phase(MAIN_STATS_PHASE_SORT);
+    retval = main_sort_parse(&sort, options->input_file);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_sort;
+    }
+
+    main_stats_count_entries(sort.count);
+
+    /* the buffer is no longer needed once the runs are written. */
+    free(sort.records);
+    sort.records = NULL;
+
+    /* merge the runs until one merge can take them all. */
+    while (sort.run_count > MAIN_SORT_FAN_IN)
+    {
+        retval = main_sort_collapse(&sort, 0);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_sort;
+        }
+    }
+
+    /* attempt to create the allocator. */
+    retval = malloc_allocator_create(&alloc);
+    if (STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Could not create allocator.\n");
+        goto cleanup_sort;
+    }
+
+    /* set up the rendering options. */
+    main_stats_phase(MAIN_STATS_PHASE_RENDER);
+    memset(&render_options, 0, sizeof(render_options));
+    render_options.format = options->output_format;
+    render_options.raster_size = options->raster_size;
+    render_options.page_size = options->page_size;
+    render_options.threads = 1;
+
+    /* the axis of an empty graph covers just the initial average. */
+    if (0 == sort.count)
+    {
+        sort.min_weight = sort.average;
+        sort.max_weight = sort.average;
+    }
+
+    /* start the graph. */
+    main_file_sink_init(&sink, &file, options->output_file);
+    retval =
+        weightgraph_plotter_create(
+            &plotter, alloc, &render_options, &sink, sort.average, sort.count,
+            sort.min_weight, sort.max_weight);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_allocator;
+    }
+
+    /* plot the entries as they are merged. */
+    trace_start = main_trace_begin();
+    retval =
+        main_sort_merge(
+            sort.runs, sort.run_count, &main_sort_emit_plot, plotter);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_plotter;
+    }
+
+    retval = weightgraph_plotter_finalize(plotter, NULL);
+    main_trace_end("render", trace_start, sort.count);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_plotter;
+    }
+
+    /* output the new moving average. */
+    printf(
+        "Final moving average: %lf\n", weightgraph_plotter_average(plotter));
+
+    /* success. */
+    retval = STATUS_SUCCESS;
+    goto cleanup_plotter;
+
+cleanup_plotter:
+    release_retval =
+        resource_release(weightgraph_plotter_resource_handle(plotter));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_allocator:
+    release_retval = resource_release(allocator_resource_handle(alloc));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_sort:
+    for (size_t i = 0; i < sort.run_count; ++i)
+    {
+        fclose(sort.runs[i].file);
+    }
+    free(sort.runs);
+    free(sort.records);
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Read and parse the log a piece at a time, spilling its entries to
+ * sorted runs.
+ *
+ * \param sort          The sort.
+ * \param filename      The name of the log.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_sort_parse(main_sort* sort, const char* filename)
+{
+    status retval, release_retval;
+    weightgraph_stream_handler handler;
+    weightgraph_parser* parser;
+    allocator* alloc;
+    main_input input;
+    uint8_t* chunk;
+    size_t size;
+    uint64_t trace_start;
+
+    retval = malloc_allocator_create(&alloc);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    retval = weightgraph_parser_create(&parser, alloc);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_allocator;
+    }
+
+    weightgraph_parser_set_format(
+        parser, weightgraph_input_format_from_name(filename));
+
+    chunk = (uint8_t*)malloc(MAIN_SORT_CHUNK_SIZE);
+    if (NULL == chunk)
+    {
+        retval = ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_parser;
+    }
+
+    retval = main_input_open(&input, filename);
+    if (STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Error reading input file.\n");
+        goto cleanup_chunk;
+    }
+
+    handler.context = sort;
+    handler.beginning_average = &main_sort_average;
+    handler.log = &main_sort_log;
+    retval = weightgraph_parser_stream_begin(parser, &handler);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_input;
+    }
+
+    /* parse each piece as soon as it is read. */
+    do
+    {
+        retval = main_input_read(&input, chunk, MAIN_SORT_CHUNK_SIZE, &size);
+        if (STATUS_SUCCESS != retval)
+        {
+            break;
+        }
+
+        trace_start = main_trace_begin();
+        retval = weightgraph_parser_stream(parser, chunk, size, 0 == size);
+        main_trace_end("parse", trace_start, size);
+    } while (STATUS_SUCCESS == retval && size > 0);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_input;
+    }
+
+    /* spill the entries that remain. */
+    retval = main_sort_spill(sort);
+    goto cleanup_input;
+
+cleanup_input:
+    main_input_close(&input);
+
+cleanup_chunk:
+    free(chunk);
+
+cleanup_parser:
+    release_retval =
+        resource_release(weightgraph_parser_resource_handle(parser));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_allocator:
+    release_retval = resource_release(allocator_resource_handle(alloc));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Record the beginning average of the log.
+ *
+ * \param context       The sort.
+ * \param average       The initial moving average.
+ *
+ * \returns STATUS_SUCCESS.
+ */
+static status main_sort_average(void* context, double average)
+{
+    ((main_sort*)context)->average = average;
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Add a log entry to the sort buffer, spilling the buffer if full.
+ *
+ * \param context       The sort.
+ * \param date          The date of the entry.
+ * \param weight        The weight of the entry.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_sort_log(void* context, const char* date, double weight)
+{
+    status retval;
+    main_sort* sort = (main_sort*)context;
+    main_sort_record* record;
+    size_t date_size = strlen(date) + 1;
+
+    if (date_size > MAIN_SORT_DATE_SIZE)
+    {
+        return ERROR_XML_PARSE;
+    }
+
+    if (sort->used == sort->capacity)
+    {
+        retval = main_sort_spill(sort);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    /* the unused tail of the date is cleared, as it is written to runs. */
+    record = &sort->records[sort->used++];
+    memset(record, 0, sizeof(*record));
+    memcpy(record->date, date, date_size);
+    record->weight = weight;
+    record->sequence = sort->count;
+
+    /* track the range of weights. */
+    if (0 == sort->count)
+    {
+        sort->min_weight = weight;
+        sort->max_weight = weight;
+    }
+    else
+    {
+        sort->min_weight = fmin(sort->min_weight, weight);
+        sort->max_weight = fmax(sort->max_weight, weight);
+    }
+    ++sort->count;
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Sort the records in the sort buffer, and write them to a new run.
+ *
+ * \param sort          The sort.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_sort_spill(main_sort* sort)
+{
+    status retval;
+    FILE* run;
+    uint64_t trace_start;
+
+    if (0 == sort->used)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    /* grow the run array geometrically. */
+    if (sort->run_count == sort->run_capacity)
+    {
+        size_t capacity =
+            (0 == sort->run_capacity) ? 16 : 2 * sort->run_capacity;
+        main_sort_run* runs =
+            (main_sort_run*)realloc(
+                sort->runs, capacity * sizeof(main_sort_run));
+        if (NULL == runs)
+        {
+            return ERROR_GENERAL_OUT_OF_MEMORY;
+        }
+
+        sort->runs = runs;
+        sort->run_capacity = capacity;
+    }
+
+    retval = main_sort_run_create(&run);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    trace_start = main_trace_begin();
+    qsort(
+        sort->records, sort->used, sizeof(main_sort_record),
+        &main_sort_compare);
+
+    if (sort->used != fwrite(sort->records, sizeof(main_sort_record),
+                             sort->used, run))
+    {
+        fclose(run);
+        return ERROR_OUTPUT_WRITE;
+    }
+    main_trace_end("spill", trace_start, sort->used);
+
+    sort->runs[sort->run_count].file = run;
+    sort->runs[sort->run_count].level = 0;
+    ++sort->run_count;
+    sort->used = 0;
+
+    /* merge each full level of runs into one run of the level above, so
+     * that few runs are open at once, and each record is merged only once
+     * per level. */
+    while (sort->run_count >= MAIN_SORT_FAN_IN)
+    {
+        size_t first = sort->run_count - MAIN_SORT_FAN_IN;
+
+        if (sort->runs[first].level != sort->runs[sort->run_count - 1].level)
+        {
+            break;
+        }
+
+        retval = main_sort_collapse(sort, first);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Merge \ref MAIN_SORT_FAN_IN runs into one, which takes their
+ * place.
+ *
+ * \param sort          The sort.
+ * \param first         The position of the first run to merge.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_sort_collapse(main_sort* sort, size_t first)
+{
+    status retval;
+    main_sort_run* runs = sort->runs + first;
+    size_t level = 0;
+    FILE* run;
+    uint64_t trace_start;
+
+    retval = main_sort_run_create(&run);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    trace_start = main_trace_begin();
+    retval = main_sort_merge(runs, MAIN_SORT_FAN_IN, &main_sort_emit_run, run);
+    if (STATUS_SUCCESS != retval)
+    {
+        fclose(run);
+        return retval;
+    }
+    main_trace_end("merge", trace_start, MAIN_SORT_FAN_IN);
+
+    /* replace the merged runs with the new one. */
+    for (size_t i = 0; i < MAIN_SORT_FAN_IN; ++i)
+    {
+        if (runs[i].level > level)
+        {
+            level = runs[i].level;
+        }
+        fclose(runs[i].file);
+    }
+
+    runs[0].file = run;
+    runs[0].level = level + 1;
+    sort->run_count -= MAIN_SORT_FAN_IN - 1;
+    memmove(
+        runs + 1, runs + MAIN_SORT_FAN_IN,
+        (sort->run_count - first - 1) * sizeof(main_sort_run));
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Create an anonymous temporary file for a run.
+ *
+ * The file is created in TMPDIR, or /tmp, and unlinked at once, so that it
+ * is removed when closed, however the process exits.
+ *
+ * \param run           Pointer to receive the run.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_sort_run_create(FILE** run)
+{
+    const char* dir = getenv("TMPDIR");
+    char* path;
+    int fd;
+
+    if (NULL == dir || 0 == *dir)
+    {
+        dir = "/tmp";
+    }
+
+    path = (char*)malloc(strlen(dir) + sizeof("/weightgraph-XXXXXX"));
+    if (NULL == path)
+    {
+        return ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+    strcpy(path, dir);
+    strcat(path, "/weightgraph-XXXXXX");
+
+    fd = mkstemp(path);
+    if (fd < 0)
+    {
+        free(path);
+        return ERROR_OUTPUT_FILE_OPEN;
+    }
+    unlink(path);
+    free(path);
+
+    *run = fdopen(fd, "w+b");
+    if (NULL == *run)
+    {
+        close(fd);
+        return ERROR_OUTPUT_FILE_OPEN;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Compare two records by date, and then by their position in the log.
+ *
+ * \param lhs           The left-hand record.
+ * \param rhs           The right-hand record.
+ *
+ * \returns less than, equal to, or greater than zero as the left-hand record
+ * comes before, is the same as, or comes after the right-hand record.
+ */
+static int main_sort_compare(const void* lhs, const void* rhs)
+{
+    const main_sort_record* left = (const main_sort_record*)lhs;
+    const main_sort_record* right = (const main_sort_record*)rhs;
+    int order = strcmp(left->date, right->date);
+
+    if (0 != order)
+    {
+        return order;
+    }
+
+    return
+        (left->sequence < right->sequence)
+            ? -1 : (left->sequence > right->sequence);
+}
+
+/**
+ * \brief Merge sorted runs, passing each record to the given function in
+ * date order.
+ *
+ * \param runs          The runs to merge.
+ * \param count         The number of runs.
+ * \param emit          The function to receive each record.
+ * \param context       The context passed to the function.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_sort_merge(
+    main_sort_run* runs, size_t count, main_sort_emit emit, void* context)
+{
+    status retval;
+    main_sort_cursor* heap;
+    size_t size = 0;
+    bool done;
+
+    heap = (main_sort_cursor*)calloc(count, sizeof(main_sort_cursor));
+    if (NULL == heap)
+    {
+        return ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    /* read the first record of each run. */
+    for (size_t i = 0; i < count; ++i)
+    {
+        rewind(runs[i].file);
+        heap[size].run = runs[i].file;
+        retval = main_sort_read(&heap[size], &done);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_heap;
+        }
+        if (!done)
+        {
+            ++size;
+        }
+    }
+    for (size_t i = size / 2; i-- > 0; )
+    {
+        main_sort_sift_down(heap, size, i);
+    }
+
+    while (size > 0)
+    {
+        retval = emit(context, &heap[0].record);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_heap;
+        }
+
+        /* advance this run, dropping it from the heap when done. */
+        retval = main_sort_read(&heap[0], &done);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_heap;
+        }
+        if (done)
+        {
+            heap[0] = heap[--size];
+        }
+        main_sort_sift_down(heap, size, 0);
+    }
+
+    /* success. */
+    retval = STATUS_SUCCESS;
+    goto cleanup_heap;
+
+cleanup_heap:
+    free(heap);
+
+    return retval;
+}
+
+/**
+ * \brief Read the next record of a run.
+ *
+ * \param cursor        The cursor of the run.
+ * \param done          Set to true if the run has no more records.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_sort_read(main_sort_cursor* cursor, bool* done)
+{
+    if (1 != fread(&cursor->record, sizeof(cursor->record), 1, cursor->run))
+    {
+        *done = true;
+        return ferror(cursor->run) ? ERROR_READ_FAILED : STATUS_SUCCESS;
+    }
+
+    *done = false;
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Move a cursor of a heap down to its place.
+ *
+ * \param heap          The heap of cursors.
+ * \param size          The number of cursors in the heap.
+ * \param i             The position of the cursor to move.
+ */
+static void main_sort_sift_down(
+    main_sort_cursor* heap, size_t size, size_t i)
+{
+    for (;;)
+    {
+        size_t least = i;
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+
+        if (left < size
+         && main_sort_compare(&heap[left].record, &heap[least].record) < 0)
+        {
+            least = left;
+        }
+        if (right < size
+         && main_sort_compare(&heap[right].record, &heap[least].record) < 0)
+        {
+            least = right;
+        }
+        if (least == i)
+        {
+            return;
+        }
+
+        main_sort_cursor swap = heap[i];
+        heap[i] = heap[least];
+        heap[least] = swap;
+        i = least;
+    }
+}
+
+/**
+ * \brief Write a merged record to a run.
+ *
+ * \param context       The run.
+ * \param rec           The record.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_sort_emit_run(void* context, const main_sort_record* rec)
+{
+    if (1 != fwrite(rec, sizeof(*rec), 1, (FILE*)context))
+    {
+        return ERROR_OUTPUT_WRITE;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Plot a merged record.
+ *
+ * \param context       The plotter.
+ * \param rec           The record.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_sort_emit_plot(void* context, const main_sort_record* rec)
+{
+    return
+        weightgraph_plotter_push(
+            (weightgraph_plotter*)context, rec->date, rec->weight);
+}
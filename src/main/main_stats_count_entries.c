@@ -0,0 +1,24 @@
+/**
+ * \file main/main_stats_count_entries.c
+ *
+ * \brief Count log entries parsed.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "main_internal.h"
+
+/**
+ * \brief Count log entries parsed.
+ *
+ * \param count         The number of entries parsed.
+ */
+void main_stats_count_entries(size_t count)
+{
+    if (MAIN_STATS_OFF != main_run_stats.format)
+    {
+        atomic_fetch_add_explicit(
+            &main_run_stats.entries, count, memory_order_relaxed);
+    }
+}
@@ -0,0 +1,24 @@
+/**
+ * \file main/main_stats_count_read.c
+ *
+ * \brief Count bytes read from inputs.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "main_internal.h"
+
+/**
+ * \brief Count bytes read from inputs.
+ *
+ * \param size          The number of bytes read.
+ */
+void main_stats_count_read(size_t size)
+{
+    if (MAIN_STATS_OFF != main_run_stats.format)
+    {
+        atomic_fetch_add_explicit(
+            &main_run_stats.bytes_read, size, memory_order_relaxed);
+    }
+}
@@ -0,0 +1,47 @@
+/**
+ * \file main/main_stats_enable.c
+ *
+ * \brief Start gathering statistics for this run.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+#include <time.h>
+
+#include "main_internal.h"
+
+/**
+ * \brief The statistics of this run.
+ */
+main_stats main_run_stats;
+
+/**
+ * \brief Start gathering statistics for this run.
+ *
+ * Until this is called, the statistics functions return at once, so that
+ * a run without --stats pays for a branch and nothing more.  The memory
+ * allocated by the library is counted once this is called, so it must be
+ * called before anything is loaded.
+ *
+ * \param format        How the statistics are reported (MAIN_STATS_*).
+ */
+void main_stats_enable(int format)
+{
+    struct timespec wall, cpu;
+
+    clock_gettime(CLOCK_MONOTONIC, &wall);
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu);
+
+    memset(&main_run_stats, 0, sizeof(main_run_stats));
+    main_run_stats.start_wall_ns =
+        (uint64_t)wall.tv_sec * 1000000000 + (uint64_t)wall.tv_nsec;
+    main_run_stats.start_cpu_ns =
+        (uint64_t)cpu.tv_sec * 1000000000 + (uint64_t)cpu.tv_nsec;
+    main_run_stats.phase = MAIN_STATS_PHASE_NONE;
+    main_run_stats.format = format;
+
+    /* count the memory allocated by the library from here on. */
+    weightgraph_memory_stats_enable();
+}
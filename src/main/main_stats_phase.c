@@ -0,0 +1,51 @@
+/**
+ * \file main/main_stats_phase.c
+ *
+ * \brief Switch the phase of the run being timed.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <time.h>
+
+#include "main_internal.h"
+
+/**
+ * \brief End the current phase of the run, and begin another.
+ *
+ * The wall and CPU time between switches is added to the phase, so a phase
+ * may be entered more than once.  The CPU time is that of the whole
+ * process, including every thread.
+ *
+ * \param phase         The phase to begin (MAIN_STATS_PHASE_*), or
+ *                      MAIN_STATS_PHASE_NONE to end the current phase.
+ */
+void main_stats_phase(int phase)
+{
+    struct timespec wall, cpu;
+    uint64_t wall_ns, cpu_ns;
+
+    if (MAIN_STATS_OFF == main_run_stats.format)
+    {
+        return;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &wall);
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu);
+    wall_ns = (uint64_t)wall.tv_sec * 1000000000 + (uint64_t)wall.tv_nsec;
+    cpu_ns = (uint64_t)cpu.tv_sec * 1000000000 + (uint64_t)cpu.tv_nsec;
+
+    /* charge the time since the last switch to the current phase. */
+    if (MAIN_STATS_PHASE_NONE != main_run_stats.phase)
+    {
+        main_run_stats.wall_ns[main_run_stats.phase] +=
+            wall_ns - main_run_stats.phase_wall_ns;
+        main_run_stats.cpu_ns[main_run_stats.phase] +=
+            cpu_ns - main_run_stats.phase_cpu_ns;
+    }
+
+    main_run_stats.phase = phase;
+    main_run_stats.phase_wall_ns = wall_ns;
+    main_run_stats.phase_cpu_ns = cpu_ns;
+}
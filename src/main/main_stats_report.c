@@ -0,0 +1,130 @@
+/**
+ * \file main/main_stats_report.c
+ *
+ * \brief Report the statistics of this run.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <sys/resource.h>
+#include <time.h>
+
+#include "main_internal.h"
+
+/**
+ * \brief Report the statistics of this run on stderr, if they were
+ * gathered.
+ *
+ * The current phase is ended first.  Besides the time of each phase, the
+ * report gives the total wall and CPU time, the bytes read and written, the
+ * entries parsed and the peak resident set size of the process, and the
+ * allocations made by the library in each memory category.  Both formats
+ * list every phase and memory category, including those left unused, and
+ * give times in nanoseconds.
+ */
+void main_stats_report(void)
+{
+    static const char* names[MAIN_STATS_PHASE_COUNT] = {
+        "read", "parse", "average", "load", "sort", "rollup", "render",
+        "checkpoint" };
+    struct timespec wall, cpu;
+    struct rusage usage;
+    uint64_t wall_ns, cpu_ns;
+    unsigned long long bytes_read, bytes_written, entries;
+    long peak_rss_kb;
+    weightgraph_memory_stats memory;
+    weightgraph_memory_stats total;
+
+    if (MAIN_STATS_OFF == main_run_stats.format)
+    {
+        return;
+    }
+
+    main_stats_phase(MAIN_STATS_PHASE_NONE);
+
+    clock_gettime(CLOCK_MONOTONIC, &wall);
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu);
+    wall_ns =
+        (uint64_t)wall.tv_sec * 1000000000 + (uint64_t)wall.tv_nsec
+            - main_run_stats.start_wall_ns;
+    cpu_ns =
+        (uint64_t)cpu.tv_sec * 1000000000 + (uint64_t)cpu.tv_nsec
+            - main_run_stats.start_cpu_ns;
+
+    /* on Linux, the peak resident set size is given in kilobytes. */
+    peak_rss_kb = (0 == getrusage(RUSAGE_SELF, &usage)) ? usage.ru_maxrss : 0;
+
+    bytes_read = atomic_load(&main_run_stats.bytes_read);
+    bytes_written = atomic_load(&main_run_stats.bytes_written);
+    entries = atomic_load(&main_run_stats.entries);
+    weightgraph_memory_stats_read(&total, WEIGHTGRAPH_MEMORY_CATEGORY_COUNT);
+
+    if (MAIN_STATS_JSON == main_run_stats.format)
+    {
+        fprintf(stderr, "{\"phases\": {");
+        for (int i = 0; i < MAIN_STATS_PHASE_COUNT; ++i)
+        {
+            fprintf(
+                stderr, "%s\"%s\": {\"wall_ns\": %llu, \"cpu_ns\": %llu}",
+                (0 == i) ? "" : ", ", names[i],
+                (unsigned long long)main_run_stats.wall_ns[i],
+                (unsigned long long)main_run_stats.cpu_ns[i]);
+        }
+        fprintf(stderr, "}, \"memory\": {");
+        for (int i = 0; i <= WEIGHTGRAPH_MEMORY_CATEGORY_COUNT; ++i)
+        {
+            weightgraph_memory_stats_read(&memory, i);
+            fprintf(
+                stderr,
+                "%s\"%s\": {\"allocations\": %llu, \"bytes\": %llu, "
+                "\"peak_bytes\": %llu}",
+                (0 == i) ? "" : ", ", weightgraph_memory_category_name(i),
+                (unsigned long long)memory.allocations,
+                (unsigned long long)memory.bytes,
+                (unsigned long long)memory.peak_bytes);
+        }
+        fprintf(
+            stderr,
+            "}, \"wall_ns\": %llu, \"cpu_ns\": %llu, \"bytes_read\": %llu, "
+            "\"bytes_written\": %llu, \"entries\": %llu, "
+            "\"peak_rss_kb\": %ld}\n",
+            (unsigned long long)wall_ns, (unsigned long long)cpu_ns,
+            bytes_read, bytes_written, entries, peak_rss_kb);
+
+        return;
+    }
+
+    /* as in JSON, every phase and memory category is listed, so that runs
+     * report the same lines whichever phases they went through. */
+    for (int i = 0; i < MAIN_STATS_PHASE_COUNT; ++i)
+    {
+        fprintf(
+            stderr, "stats: phase=%s wall_ns=%llu cpu_ns=%llu\n", names[i],
+            (unsigned long long)main_run_stats.wall_ns[i],
+            (unsigned long long)main_run_stats.cpu_ns[i]);
+    }
+
+    for (int i = 0; i < WEIGHTGRAPH_MEMORY_CATEGORY_COUNT; ++i)
+    {
+        weightgraph_memory_stats_read(&memory, i);
+        fprintf(
+            stderr,
+            "stats: memory=%s allocations=%llu bytes=%llu "
+            "peak_bytes=%llu\n",
+            weightgraph_memory_category_name(i),
+            (unsigned long long)memory.allocations,
+            (unsigned long long)memory.bytes,
+            (unsigned long long)memory.peak_bytes);
+    }
+
+    fprintf(
+        stderr,
+        "stats: total wall_ns=%llu cpu_ns=%llu bytes_read=%llu "
+        "bytes_written=%llu entries=%llu peak_rss_kb=%ld allocations=%llu "
+        "allocated_bytes=%llu peak_allocated_bytes=%llu\n",
+        (unsigned long long)wall_ns, (unsigned long long)cpu_ns, bytes_read,
+        bytes_written, entries, peak_rss_kb, (unsigned long long)total.allocations,
+        (unsigned long long)total.bytes,
+        (unsigned long long)total.peak_bytes);
+}
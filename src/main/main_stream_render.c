@@ -0,0 +1,361 @@
+/**
+ * \file main/main_stream_render.c
+ *
+ * \brief Render a sorted log as it is parsed, without holding its entries.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "main_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief The size of each piece of the log that is read and parsed.
+ */
+#define MAIN_STREAM_CHUNK_SIZE 65536
+
+/**
+ * \brief What the first pass learns about a log.
+ */
+typedef struct main_stream_scan main_stream_scan;
+
+struct main_stream_scan
+{
+    double average;
+    size_t count;
+    double min_weight;
+    double max_weight;
+    /* the date of the last entry, grown to fit the longest date. */
+    char* last_date;
+    size_t last_date_capacity;
+};
+
+/* forward decls. */
+static status main_stream_pass(
+    weightgraph_parser* parser, const weightgraph_stream_handler* handler,
+    uint8_t* chunk, const char* filename);
+static status main_stream_scan_average(void* context, double average);
+static status main_stream_scan_log(
+    void* context, const char* date, double weight);
+static status main_stream_plot_average(void* context, double average);
+static status main_stream_plot_log(
+    void* context, const char* date, double weight);
+
+/**
+ * \brief Render a log whose entries are in date order without holding its
+ * entries in memory.
+ *
+ * The log is streamed through the parser twice, a piece at a time.  The
+ * first pass checks the date order and finds the number of entries and the
+ * range of their weights, which lay out the pages and Y-axis of the graph.
+ * The second pass plots each entry as soon as it is parsed.  Only the moving
+ * average window is kept, so memory use does not grow with the log.  Entries
+ * that share a date are plotted in the order of the log.
+ *
+ * \param options       The command-line options.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_OUT_OF_ORDER if the entries are not in date order.
+ *      - a non-zero error code on failure.
+ */
+status main_stream_render(const main_options* options)
+{
+    status retval, release_retval;
+    weightgraph_render_options render_options;
+    weightgraph_stream_handler handler;
+    main_stream_scan scan;
+    main_file_sink file;
+    weightgraph_sink sink;
+    weightgraph_parser* parser;
+    weightgraph_plotter* plotter;
+    allocator* alloc;
+    uint8_t* chunk;
+
+    /* attempt to create the allocator. */
+    retval = malloc_allocator_create(&alloc);
+    if (STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Could not create allocator.\n");
+        goto done;
+    }
+
+    retval = weightgraph_parser_create(&parser, alloc);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_allocator;
+    }
+
+    weightgraph_parser_set_format(
+        parser, weightgraph_input_format_from_name(options->input_file));
+
+    chunk = (uint8_t*)malloc(MAIN_STREAM_CHUNK_SIZE);
+    if (NULL == chunk)
+    {
+        retval = ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_parser;
+    }
+
+    /* scan the log for its layout. */
+    main_stats_phase(MAIN_STATS_PHASE_PARSE);
+    memset(&scan, 0, sizeof(scan));
+    handler.context = &scan;
+    handler.beginning_average = &main_stream_scan_average;
+    handler.log = &main_stream_scan_log;
+    retval = main_stream_pass(parser, &handler, chunk, options->input_file);
+    free(scan.last_date);
+    if (ERROR_OUT_OF_ORDER == retval)
+    {
+        fprintf(stderr, "Error: log entries are not in date order.\n");
+    }
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_chunk;
+    }
+
+    main_stats_count_entries(scan.count);
+
+    /* set up the rendering options. */
+    main_stats_phase(MAIN_STATS_PHASE_RENDER);
+    memset(&render_options, 0, sizeof(render_options));
+    render_options.format = options->output_format;
+    render_options.raster_size = options->raster_size;
+    render_options.page_size = options->page_size;
+    render_options.threads = 1;
+
+    /* start the graph. */
+    main_file_sink_init(&sink, &file, options->output_file);
+    retval =
+        weightgraph_plotter_create(
+            &plotter, alloc, &render_options, &sink, scan.average, scan.count,
+            scan.min_weight, scan.max_weight);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_chunk;
+    }
+
+    /* plot each entry as it is parsed. */
+    handler.context = plotter;
+    handler.beginning_average = &main_stream_plot_average;
+    handler.log = &main_stream_plot_log;
+    retval = main_stream_pass(parser, &handler, chunk, options->input_file);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_plotter;
+    }
+
+    /* a log that changed between passes no longer fits the layout. */
+    retval = weightgraph_plotter_finalize(plotter, NULL);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_plotter;
+    }
+
+    /* output the new moving average. */
+    printf(
+        "Final moving average: %lf\n", weightgraph_plotter_average(plotter));
+
+    /* success. */
+    retval = STATUS_SUCCESS;
+    goto cleanup_plotter;
+
+cleanup_plotter:
+    release_retval =
+        resource_release(weightgraph_plotter_resource_handle(plotter));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_chunk:
+    free(chunk);
+
+cleanup_parser:
+    release_retval =
+        resource_release(weightgraph_parser_resource_handle(parser));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_allocator:
+    release_retval = resource_release(allocator_resource_handle(alloc));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Read and parse the log a piece at a time, passing each element to
+ * the given handler.
+ *
+ * \param parser        The parser.
+ * \param handler       The stream handler.
+ * \param chunk         Buffer of \ref MAIN_STREAM_CHUNK_SIZE bytes.
+ * \param filename      The name of the log.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_stream_pass(
+    weightgraph_parser* parser, const weightgraph_stream_handler* handler,
+    uint8_t* chunk, const char* filename)
+{
+    status retval;
+    main_input input;
+    size_t size;
+    uint64_t trace_start;
+
+    retval = main_input_open(&input, filename);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = weightgraph_parser_stream_begin(parser, handler);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_input;
+    }
+
+    /* parse each piece as soon as it is read. */
+    do
+    {
+        retval = main_input_read(&input, chunk, MAIN_STREAM_CHUNK_SIZE, &size);
+        if (STATUS_SUCCESS != retval)
+        {
+            break;
+        }
+
+        trace_start = main_trace_begin();
+        retval = weightgraph_parser_stream(parser, chunk, size, 0 == size);
+        main_trace_end("parse", trace_start, size);
+    } while (STATUS_SUCCESS == retval && size > 0);
+
+cleanup_input:
+    main_input_close(&input);
+
+    return retval;
+}
+
+/**
+ * \brief Record the beginning average of the log.
+ *
+ * \param context       The scan.
+ * \param average       The initial moving average.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_OUT_OF_ORDER if entries came before the beginning average.
+ */
+static status main_stream_scan_average(void* context, double average)
+{
+    main_stream_scan* scan = (main_stream_scan*)context;
+
+    /* the beginning average must come before the entries. */
+    if (scan->count > 0)
+    {
+        return ERROR_OUT_OF_ORDER;
+    }
+
+    scan->average = average;
+    scan->min_weight = average;
+    scan->max_weight = average;
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Check the date order of a log entry, and track the range of
+ * weights.
+ *
+ * Entries that share a date are allowed, and are plotted in the order of
+ * the log, as the entry tree keeps them.
+ *
+ * \param context       The scan.
+ * \param date          The date of the entry.
+ * \param weight        The weight of the entry.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_OUT_OF_ORDER if the entry comes before the one before it.
+ *      - a non-zero error code on failure.
+ */
+static status main_stream_scan_log(
+    void* context, const char* date, double weight)
+{
+    main_stream_scan* scan = (main_stream_scan*)context;
+    size_t date_size = strlen(date) + 1;
+
+    /* entries can't be sorted without holding them all. */
+    if (scan->count > 0 && strcmp(date, scan->last_date) < 0)
+    {
+        return ERROR_OUT_OF_ORDER;
+    }
+
+    /* dates are short, so the copy rarely needs to grow. */
+    if (date_size > scan->last_date_capacity)
+    {
+        char* last_date = (char*)realloc(scan->last_date, date_size);
+        if (NULL == last_date)
+        {
+            return ERROR_GENERAL_OUT_OF_MEMORY;
+        }
+
+        scan->last_date = last_date;
+        scan->last_date_capacity = date_size;
+    }
+
+    memcpy(scan->last_date, date, date_size);
+    scan->min_weight = fmin(scan->min_weight, weight);
+    scan->max_weight = fmax(scan->max_weight, weight);
+    ++scan->count;
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Skip the beginning average, which was found by the scan.
+ *
+ * \param context       The plotter.
+ * \param average       The initial moving average.
+ *
+ * \returns STATUS_SUCCESS.
+ */
+static status main_stream_plot_average(void* context, double average)
+{
+    (void)context;
+    (void)average;
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Plot a log entry.
+ *
+ * \param context       The plotter.
+ * \param date          The date of the entry.
+ * \param weight        The weight of the entry.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_stream_plot_log(
+    void* context, const char* date, double weight)
+{
+    return
+        weightgraph_plotter_push((weightgraph_plotter*)context, date, weight);
+}
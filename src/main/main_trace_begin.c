@@ -0,0 +1,31 @@
+/**
+ * \file main/main_trace_begin.c
+ *
+ * \brief Begin a span of the trace.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <time.h>
+
+#include "main_internal.h"
+
+/**
+ * \brief Begin a span of the trace.
+ *
+ * \returns the time at which the span began, or zero if tracing is off.
+ */
+uint64_t main_trace_begin(void)
+{
+    struct timespec now;
+
+    if (NULL == main_run_trace.path)
+    {
+        return 0;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000 + (uint64_t)now.tv_nsec;
+}
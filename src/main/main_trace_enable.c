@@ -0,0 +1,46 @@
+/**
+ * \file main/main_trace_enable.c
+ *
+ * \brief Start tracing this run if the environment names a trace file.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "main_internal.h"
+
+/**
+ * \brief The trace of this run.
+ */
+main_trace main_run_trace;
+
+/**
+ * \brief Start tracing this run if \ref MAIN_TRACE_ENV names a file.
+ *
+ * This must be called before any other thread is started.  The calling
+ * thread is named "main" in the trace.
+ */
+void main_trace_enable(void)
+{
+    struct timespec now;
+    const char* path = getenv(MAIN_TRACE_ENV);
+
+    if (NULL == path || 0 == *path)
+    {
+        return;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    memset(&main_run_trace, 0, sizeof(main_run_trace));
+    pthread_mutex_init(&main_run_trace.lock, NULL);
+    main_run_trace.start_ns =
+        (uint64_t)now.tv_sec * 1000000000 + (uint64_t)now.tv_nsec;
+    main_run_trace.path = path;
+
+    main_trace_thread_name("main");
+}
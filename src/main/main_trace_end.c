@@ -0,0 +1,79 @@
+/**
+ * \file main/main_trace_end.c
+ *
+ * \brief End a span of the trace.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <stdlib.h>
+#include <time.h>
+
+#include "main_internal.h"
+
+/**
+ * \brief End a span of the trace, recording it in the calling thread's
+ * buffer.
+ *
+ * \param name          The name of the span, which must be a string
+ *                      constant.
+ * \param start_ns      The time returned by main_trace_begin, or zero, in
+ *                      which case nothing is recorded.
+ * \param count         How much the span processed, such as bytes or
+ *                      entries.
+ */
+void main_trace_end(const char* name, uint64_t start_ns, uint64_t count)
+{
+    struct timespec now;
+    main_trace_buffer* buffer;
+    main_trace_block* block;
+    main_trace_event* event;
+
+    if (0 == start_ns)
+    {
+        return;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    buffer = main_trace_thread_buffer();
+    if (NULL == buffer)
+    {
+        return;
+    }
+
+    /* start a new block when the last one is full. */
+    block = buffer->last;
+    if (NULL == block || MAIN_TRACE_BLOCK_EVENTS == block->count)
+    {
+        block =
+            (MAIN_TRACE_MAX_BLOCKS == buffer->blocks)
+                ? NULL : (main_trace_block*)malloc(sizeof(*block));
+        if (NULL == block)
+        {
+            ++buffer->dropped;
+            return;
+        }
+
+        block->next = NULL;
+        block->count = 0;
+        if (NULL == buffer->last)
+        {
+            buffer->first = block;
+        }
+        else
+        {
+            buffer->last->next = block;
+        }
+        buffer->last = block;
+        ++buffer->blocks;
+    }
+
+    event = &block->events[block->count++];
+    event->name = name;
+    event->start_ns = start_ns;
+    event->duration_ns =
+        (uint64_t)now.tv_sec * 1000000000 + (uint64_t)now.tv_nsec - start_ns;
+    event->count = count;
+}
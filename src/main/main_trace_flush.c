@@ -0,0 +1,125 @@
+/**
+ * \file main/main_trace_flush.c
+ *
+ * \brief Write the trace of this run.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "main_internal.h"
+
+/* forward decls. */
+static bool main_trace_write(FILE* out);
+
+/**
+ * \brief Write the trace, if tracing is on, as Chrome trace-event JSON.
+ *
+ * Every thread that recorded events must have stopped, other than the
+ * caller.  The buffers are released, and tracing is turned off.
+ */
+void main_trace_flush(void)
+{
+    FILE* out;
+    main_trace_buffer* buffer;
+    main_trace_buffer* next_buffer;
+    main_trace_block* block;
+    main_trace_block* next_block;
+
+    if (NULL == main_run_trace.path)
+    {
+        return;
+    }
+
+    /* a trace that can't be written doesn't fail the run. */
+    out = fopen(main_run_trace.path, "w");
+    if (NULL == out || !main_trace_write(out) || 0 != fclose(out))
+    {
+        fprintf(
+            stderr, "Warning: couldn't write trace to %s.\n",
+            main_run_trace.path);
+    }
+
+    for (buffer = main_run_trace.buffers; NULL != buffer; buffer = next_buffer)
+    {
+        next_buffer = buffer->next;
+
+        for (block = buffer->first; NULL != block; block = next_block)
+        {
+            next_block = block->next;
+            free(block);
+        }
+
+        free(buffer);
+    }
+
+    pthread_mutex_destroy(&main_run_trace.lock);
+    main_run_trace.buffers = NULL;
+    main_run_trace.path = NULL;
+}
+
+/**
+ * \brief Write the events of every thread as a JSON trace.
+ *
+ * Each span is a complete event, with its times in microseconds since
+ * tracing began, and each named thread has a thread_name metadata event.
+ *
+ * \param out           The stream to write to.
+ *
+ * \returns true if the trace was written.
+ */
+static bool main_trace_write(FILE* out)
+{
+    const char* separator = "";
+    long pid = (long)getpid();
+
+    fprintf(out, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+
+    for (main_trace_buffer* buffer = main_run_trace.buffers; NULL != buffer;
+         buffer = buffer->next)
+    {
+        if (NULL != buffer->thread_name)
+        {
+            fprintf(
+                out,
+                "%s\n{\"name\": \"thread_name\", \"ph\": \"M\", "
+                "\"pid\": %ld, \"tid\": %u, \"args\": {\"name\": \"%s\"}}",
+                separator, pid, buffer->tid, buffer->thread_name);
+            separator = ",";
+        }
+
+        if (0 != buffer->dropped)
+        {
+            fprintf(
+                stderr, "Warning: %llu trace events were dropped.\n",
+                (unsigned long long)buffer->dropped);
+        }
+
+        for (main_trace_block* block = buffer->first; NULL != block;
+             block = block->next)
+        {
+            for (size_t i = 0; i < block->count; ++i)
+            {
+                const main_trace_event* event = &block->events[i];
+
+                fprintf(
+                    out,
+                    "%s\n{\"name\": \"%s\", \"cat\": \"weightgraph\", "
+                    "\"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, "
+                    "\"pid\": %ld, \"tid\": %u, \"args\": {\"count\": %llu}}",
+                    separator, event->name,
+                    (event->start_ns - main_run_trace.start_ns) / 1e3,
+                    event->duration_ns / 1e3, pid, buffer->tid,
+                    (unsigned long long)event->count);
+                separator = ",";
+            }
+        }
+    }
+
+    fprintf(out, "\n]}\n");
+
+    return !ferror(out);
+}
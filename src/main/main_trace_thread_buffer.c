@@ -0,0 +1,49 @@
+/**
+ * \file main/main_trace_thread_buffer.c
+ *
+ * \brief Get the calling thread's trace buffer.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <stdlib.h>
+
+#include "main_internal.h"
+
+/**
+ * \brief The calling thread's trace buffer, once it has one.
+ */
+static _Thread_local main_trace_buffer* main_trace_local_buffer;
+
+/**
+ * \brief Get the calling thread's trace buffer, creating it on first use.
+ *
+ * \returns the buffer, or NULL if it could not be created.
+ */
+main_trace_buffer* main_trace_thread_buffer(void)
+{
+    main_trace_buffer* buffer = main_trace_local_buffer;
+
+    if (NULL != buffer)
+    {
+        return buffer;
+    }
+
+    buffer = (main_trace_buffer*)calloc(1, sizeof(*buffer));
+    if (NULL == buffer)
+    {
+        return NULL;
+    }
+
+    /* only creating a buffer takes the lock. */
+    pthread_mutex_lock(&main_run_trace.lock);
+    buffer->tid = ++main_run_trace.next_tid;
+    buffer->next = main_run_trace.buffers;
+    main_run_trace.buffers = buffer;
+    pthread_mutex_unlock(&main_run_trace.lock);
+
+    main_trace_local_buffer = buffer;
+
+    return buffer;
+}
@@ -0,0 +1,32 @@
+/**
+ * \file main/main_trace_thread_name.c
+ *
+ * \brief Name the calling thread in the trace.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "main_internal.h"
+
+/**
+ * \brief Name the calling thread in the trace.
+ *
+ * \param name          The name of the thread, which must be a string
+ *                      constant.
+ */
+void main_trace_thread_name(const char* name)
+{
+    main_trace_buffer* buffer;
+
+    if (NULL == main_run_trace.path)
+    {
+        return;
+    }
+
+    buffer = main_trace_thread_buffer();
+    if (NULL != buffer)
+    {
+        buffer->thread_name = name;
+    }
+}
@@ -0,0 +1,569 @@
+/**
+ * \file main/main_watch_run.c
+ *
+ * \brief Update the output whenever the input changes.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "main_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_rbtree;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief How long to wait for a burst of writes to settle, in milliseconds.
+ */
+#define MAIN_WATCH_SETTLE_MS 50
+
+/**
+ * \brief The state of a watched input.
+ */
+typedef struct main_watch main_watch;
+
+struct main_watch
+{
+    const main_options* options;
+    allocator* alloc;
+    weightgraph_parser* parser;
+    weightgraph_session* session;
+    uint8_t* buffer;
+    size_t buffer_capacity;
+    /* the identity of the input when it was last read. */
+    dev_t dev;
+    ino_t ino;
+    /* the offset just past the last record parsed from the input. */
+    off_t offset;
+    /* true if the input is compressed, and so can't be parsed from an
+     * offset. */
+    bool compressed;
+    /* the output, and the point from which it can be extended. */
+    main_file_sink file;
+    weightgraph_sink sink;
+    weightgraph_render_options render_options;
+    weightgraph_render_state state;
+};
+
+/* set by the signal handler to stop watching. */
+static volatile sig_atomic_t main_watch_stop = 0;
+
+/* forward decls. */
+static void main_watch_signal(int sig);
+static status main_watch_load(main_watch* watch);
+static status main_watch_update(main_watch* watch);
+static status main_watch_append(main_watch* watch, bool* appended);
+static bool main_watch_in_order(
+    const weightgraph_session* session, weightgraph* graph);
+static status main_watch_render(main_watch* watch, bool resume);
+static void main_watch_settle(int fd, char* events, size_t size);
+static bool main_watch_matches(
+    const char* events, ssize_t size, const char* name);
+
+/**
+ * \brief Render the input, then update the output whenever it changes.
+ *
+ * Records appended to the input are parsed on their own, from the end of
+ * the last record parsed, and only they are drawn onto the graph.  The input
+ * is parsed and rendered again in full if it is replaced, shrinks, or has a
+ * record appended out of date order.
+ *
+ * \param options       The command-line options.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status main_watch_run(const main_options* options)
+{
+    status retval;
+    main_watch watch;
+    struct sigaction action;
+    char events[4096]
+        __attribute__((aligned(__alignof__(struct inotify_event))));
+    char* dir;
+    const char* name;
+    char* slash;
+    ssize_t size;
+    int fd;
+
+    memset(&watch, 0, sizeof(watch));
+    watch.options = options;
+
+    /* watch the directory, so that an input replaced by a rename is seen. */
+    dir = strdup(options->input_file);
+    if (NULL == dir)
+    {
+        retval = ERROR_GENERAL_OUT_OF_MEMORY;
+        goto done;
+    }
+
+    slash = strrchr(dir, '/');
+    if (NULL == slash)
+    {
+        name = options->input_file;
+        strcpy(dir, ".");
+    }
+    else
+    {
+        name = options->input_file + (slash - dir) + 1;
+        *slash = 0;
+        if (slash == dir)
+        {
+            strcpy(dir, "/");
+        }
+    }
+
+    fd = inotify_init1(IN_CLOEXEC);
+    if (fd < 0
+     || inotify_add_watch(
+            fd, dir, IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0)
+    {
+        fprintf(stderr, "Error watching %s.\n", dir);
+        retval = ERROR_OPEN_FAILED;
+        goto cleanup_fd;
+    }
+
+    /* create the state kept while watching. */
+    retval = malloc_allocator_create(&watch.alloc);
+    if (STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Could not create allocator.\n");
+        goto cleanup_fd;
+    }
+
+    retval = weightgraph_parser_create(&watch.parser, watch.alloc);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_allocator;
+    }
+
+    weightgraph_parser_set_format(
+        watch.parser, weightgraph_input_format_from_name(options->input_file));
+
+    retval =
+        main_session_create(&watch.session, watch.alloc, 0.0, options);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_parser;
+    }
+
+    /* the output is extended as records are appended. */
+    watch.render_options.format = options->output_format;
+    watch.render_options.raster_size = options->raster_size;
+    watch.render_options.page_size = options->page_size;
+    watch.render_options.threads = options->threads;
+    watch.render_options.appendable = true;
+    main_file_sink_init(&watch.sink, &watch.file, options->output_file);
+
+    /* render the input as it is now. */
+    retval = main_watch_load(&watch);
+    if (STATUS_SUCCESS == retval)
+    {
+        retval = main_watch_render(&watch, false);
+    }
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_session;
+    }
+
+    /* stop cleanly on a signal. */
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = &main_watch_signal;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    while (!main_watch_stop)
+    {
+        size = read(fd, events, sizeof(events));
+        if (size < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+
+            retval = ERROR_READ_FAILED;
+            break;
+        }
+
+        /* other files in the directory are of no interest. */
+        if (!main_watch_matches(events, size, name))
+        {
+            continue;
+        }
+
+        /* wait for the writer to finish before reading the input. */
+        main_watch_settle(fd, events, sizeof(events));
+
+        /* an update that fails is retried on the next change. */
+        status update_retval = main_watch_update(&watch);
+        if (STATUS_SUCCESS != update_retval)
+        {
+            fprintf(
+                stderr, "Error updating %s (status %d).\n",
+                options->output_file, update_retval);
+        }
+    }
+
+    goto cleanup_session;
+
+cleanup_session:
+    free(watch.buffer);
+    resource_release(weightgraph_session_resource_handle(watch.session));
+
+cleanup_parser:
+    resource_release(weightgraph_parser_resource_handle(watch.parser));
+
+cleanup_allocator:
+    resource_release(allocator_resource_handle(watch.alloc));
+
+cleanup_fd:
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+
+    free(dir);
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Stop watching.
+ *
+ * \param sig           The signal.
+ */
+static void main_watch_signal(int sig)
+{
+    (void)sig;
+
+    main_watch_stop = 1;
+}
+
+/**
+ * \brief Read and parse the whole input, replacing the entries in the
+ * session.
+ *
+ * \param watch         The watch state.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_watch_load(main_watch* watch)
+{
+    status retval, release_retval;
+    struct stat st;
+    main_input input;
+    weightgraph* graph;
+    size_t size;
+    uint64_t trace_start;
+
+    if (0 != stat(watch->options->input_file, &st))
+    {
+        return ERROR_STAT_FAILED;
+    }
+
+    retval = main_input_open(&input, watch->options->input_file);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+    watch->compressed = input.compressed;
+    main_input_close(&input);
+
+    retval =
+        main_read_file_buffer(
+            &watch->buffer, &watch->buffer_capacity, &size,
+            watch->options->input_file);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    trace_start = main_trace_begin();
+    retval =
+        weightgraph_parser_parse(watch->parser, &graph, watch->buffer, size);
+    main_trace_end("build", trace_start, size);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    weightgraph_session_reset(watch->session, graph->initial_average);
+    retval = main_push_entries(watch->session, graph);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_graph;
+    }
+
+    /* appended records are parsed from the end of the last record. */
+    watch->dev = st.st_dev;
+    watch->ino = st.st_ino;
+    watch->offset = weightgraph_parser_log_end(watch->parser);
+    retval = STATUS_SUCCESS;
+    goto cleanup_graph;
+
+cleanup_graph:
+    release_retval = resource_release(&graph->hdr);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Bring the output up to date with the input.
+ *
+ * \param watch         The watch state.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_watch_update(main_watch* watch)
+{
+    status retval;
+    struct stat st;
+    bool appended = false;
+
+    if (0 != stat(watch->options->input_file, &st))
+    {
+        return ERROR_STAT_FAILED;
+    }
+
+    /* records appended in place are parsed on their own. */
+    if (!watch->compressed
+     && st.st_dev == watch->dev && st.st_ino == watch->ino
+     && st.st_size >= watch->offset)
+    {
+        retval = main_watch_append(watch, &appended);
+        if (STATUS_SUCCESS == retval)
+        {
+            return appended ? main_watch_render(watch, true) : STATUS_SUCCESS;
+        }
+    }
+
+    /* otherwise, start over. */
+    retval = main_watch_load(watch);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    return main_watch_render(watch, false);
+}
+
+/**
+ * \brief Parse the records appended to the input, and push them onto the
+ * session.
+ *
+ * \param watch         The watch state.
+ * \param appended      Set to true if any records were appended.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_XML_PARSE if the records can't be appended to the session.
+ *      - a non-zero error code on failure.
+ */
+static status main_watch_append(main_watch* watch, bool* appended)
+{
+    status retval, release_retval;
+    weightgraph* graph;
+    size_t size;
+    uint64_t trace_start;
+
+    retval =
+        main_read_file_range(
+            &watch->buffer, &watch->buffer_capacity, &size,
+            watch->options->input_file, watch->offset);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    trace_start = main_trace_begin();
+    retval =
+        weightgraph_parser_parse_records(
+            watch->parser, &graph, watch->buffer, size);
+    main_trace_end("build", trace_start, size);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* nothing to do until a whole record has been written. */
+    if (0 == graph->entry_count)
+    {
+        retval = STATUS_SUCCESS;
+        goto cleanup_graph;
+    }
+
+    /* records that land before the last entry change the whole graph. */
+    if (!main_watch_in_order(watch->session, graph))
+    {
+        retval = ERROR_XML_PARSE;
+        goto cleanup_graph;
+    }
+
+    retval = main_push_entries(watch->session, graph);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_graph;
+    }
+
+    watch->offset += weightgraph_parser_log_end(watch->parser);
+    *appended = true;
+    goto cleanup_graph;
+
+cleanup_graph:
+    release_retval = resource_release(&graph->hdr);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Determine whether the records of a graph all follow the entries
+ * already in the session.
+ *
+ * \param session       The session.
+ * \param graph         The appended records.
+ *
+ * \returns true if the records can be pushed onto the session.
+ */
+static bool main_watch_in_order(
+    const weightgraph_session* session, weightgraph* graph)
+{
+    size_t count = weightgraph_session_count(session);
+    weightgraph_sample last;
+    weightgraph_entry* first;
+    rbtree_node* node;
+
+    if (0 == count)
+    {
+        return true;
+    }
+
+    weightgraph_session_sample(session, count - 1, &last);
+    node =
+        rbtree_minimum_node(graph->entries, rbtree_root_node(graph->entries));
+    first = (weightgraph_entry*)rbtree_node_value(graph->entries, node);
+
+    return strcmp(first->date, last.date) > 0;
+}
+
+/**
+ * \brief Render the session to the output.
+ *
+ * \param watch         The watch state.
+ * \param resume        true to draw only the entries added since the last
+ *                      render.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status main_watch_render(main_watch* watch, bool resume)
+{
+    status retval;
+    weightgraph_render_state state;
+    uint64_t trace_start = main_trace_begin();
+
+    watch->render_options.resume = resume ? &watch->state : NULL;
+    retval =
+        weightgraph_session_render(
+            watch->session, &watch->render_options, &watch->sink, &state);
+    if (ERROR_CHECKPOINT_STALE == retval)
+    {
+        /* the new entries moved the Y-axis, so render the whole graph. */
+        watch->render_options.resume = NULL;
+        retval =
+            weightgraph_session_render(
+                watch->session, &watch->render_options, &watch->sink,
+                &state);
+    }
+    main_trace_end(
+        "render", trace_start, weightgraph_session_count(watch->session));
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    watch->state = state;
+
+    printf(
+        "Moving average: %lf (%zu entries)\n",
+        weightgraph_session_average(watch->session),
+        weightgraph_session_count(watch->session));
+    fflush(stdout);
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Drain events until none arrive for a moment.
+ *
+ * \param fd            The inotify descriptor.
+ * \param events        The event buffer.
+ * \param size          The size of the event buffer.
+ */
+static void main_watch_settle(int fd, char* events, size_t size)
+{
+    struct pollfd pfd;
+
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+
+    while (1 == poll(&pfd, 1, MAIN_WATCH_SETTLE_MS))
+    {
+        if (read(fd, events, size) <= 0)
+        {
+            break;
+        }
+    }
+}
+
+/**
+ * \brief Determine whether any event in a buffer concerns the input.
+ *
+ * \param events        The event buffer.
+ * \param size          The number of bytes of events.
+ * \param name          The name of the input within its directory.
+ *
+ * \returns true if an event names the input.
+ */
+static bool main_watch_matches(
+    const char* events, ssize_t size, const char* name)
+{
+    const struct inotify_event* event;
+
+    for (const char* ptr = events; ptr < events + size;
+         ptr += sizeof(struct inotify_event) + event->len)
+    {
+        event = (const struct inotify_event*)ptr;
+        if (event->len > 0 && !strcmp(event->name, name))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
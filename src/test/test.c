@@ -0,0 +1,134 @@
+/**
+ * \file test/test.c
+ *
+ * \brief Main entry point for the weightgraph unit tests.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "test_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief A unit test, by name.
+ */
+typedef struct test_case test_case;
+
+struct test_case
+{
+    const char* name;
+    status (*run)(allocator* alloc);
+};
+
+static const test_case test_cases[] = {
+    { "archive_round_trip", &test_archive_round_trip },
+    { "archive_damaged", &test_archive_damaged },
+    { "filter_rejection", &test_filter_rejection },
+};
+
+#define TEST_CASE_COUNT (sizeof(test_cases) / sizeof(test_cases[0]))
+
+/* forward decls. */
+static status test_run(const test_case* test);
+
+/**
+ * \brief Run the tests named on the command line, or every test.
+ *
+ * \param argc          The number of command-line arguments.
+ * \param argv          The command-line arguments.
+ *
+ * \returns 0 if every test passed, or the status of the last that failed.
+ */
+int main(int argc, char* argv[])
+{
+    status retval = STATUS_SUCCESS, test_retval;
+
+    if (argc < 2)
+    {
+        for (size_t i = 0; i < TEST_CASE_COUNT; ++i)
+        {
+            test_retval = test_run(&test_cases[i]);
+            if (STATUS_SUCCESS != test_retval)
+            {
+                retval = test_retval;
+            }
+        }
+
+        return (int)retval;
+    }
+
+    for (int arg = 1; arg < argc; ++arg)
+    {
+        size_t i;
+
+        for (i = 0; i < TEST_CASE_COUNT; ++i)
+        {
+            if (!strcmp(argv[arg], test_cases[i].name))
+            {
+                break;
+            }
+        }
+
+        if (TEST_CASE_COUNT == i)
+        {
+            fprintf(stderr, "Error: no test named %s.\n", argv[arg]);
+            retval = ERROR_BAD_ARGUMENTS;
+            continue;
+        }
+
+        test_retval = test_run(&test_cases[i]);
+        if (STATUS_SUCCESS != test_retval)
+        {
+            retval = test_retval;
+        }
+    }
+
+    return (int)retval;
+}
+
+/**
+ * \brief Run a test with its own allocator, and report its result.
+ *
+ * \param test          The test.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS if the test passed.
+ *      - ERROR_TEST_FAILED if a check of the test failed.
+ *      - a non-zero error code on failure.
+ */
+static status test_run(const test_case* test)
+{
+    status retval, release_retval;
+    allocator* alloc;
+
+    retval = malloc_allocator_create(&alloc);
+    if (STATUS_SUCCESS != retval)
+    {
+        fprintf(stderr, "Could not create allocator.\n");
+        return retval;
+    }
+
+    retval = test->run(alloc);
+
+    release_retval = resource_release(allocator_resource_handle(alloc));
+    if (STATUS_SUCCESS == retval)
+    {
+        retval = release_retval;
+    }
+
+    if (STATUS_SUCCESS == retval)
+    {
+        printf("%s: passed.\n", test->name);
+    }
+    else
+    {
+        printf("%s: FAILED (status %d).\n", test->name, (int)retval);
+    }
+
+    return retval;
+}
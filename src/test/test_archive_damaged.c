@@ -0,0 +1,228 @@
+/**
+ * \file test/test_archive_damaged.c
+ *
+ * \brief Check that truncated and damaged archives are rejected.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "test_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief The number of entries in the log, enough to fill a few blocks.
+ */
+#define TEST_DAMAGED_ENTRIES (2 * WEIGHTGRAPH_ARCHIVE_BLOCK_ENTRIES + 10)
+
+/**
+ * \brief The size of the pieces in which an archive is streamed.
+ */
+#define TEST_DAMAGED_PIECE_SIZE 509
+
+/**
+ * \brief The size of the trailer of an archive.
+ */
+#define TEST_DAMAGE_TRAILER_SIZE 24
+
+/**
+ * \brief The parts of an archive from which a damaged byte is found.
+ */
+enum test_damage_base
+{
+    TEST_DAMAGE_START,
+    TEST_DAMAGE_END_RECORD,
+    TEST_DAMAGE_TRAILER,
+};
+
+/**
+ * \brief A byte of an archive to damage.
+ */
+typedef struct test_damage test_damage;
+
+struct test_damage
+{
+    const char* part;
+    int base;
+    size_t offset;
+    /* true if a parser, which skips the index and trailer, rejects it too. */
+    bool streamed;
+};
+
+/* the archive holds its header, an average record, then the first block;
+ * the end record and block count of the index are followed by the index,
+ * then the trailer. */
+static const test_damage test_damages[] = {
+    { "header magic", TEST_DAMAGE_START, 0, true },
+    { "header version", TEST_DAMAGE_START, 4, true },
+    { "header date style", TEST_DAMAGE_START, 5, true },
+    { "average record type", TEST_DAMAGE_START, 8, true },
+    { "block record type", TEST_DAMAGE_START, 17, true },
+    { "block entry count", TEST_DAMAGE_START, 19, true },
+    { "end record type", TEST_DAMAGE_END_RECORD, 0, true },
+    { "index block count", TEST_DAMAGE_END_RECORD, 1, true },
+    { "index block offset", TEST_DAMAGE_END_RECORD, 5 + 7, false },
+    { "trailer entry count", TEST_DAMAGE_TRAILER, 0, false },
+    { "trailer end offset", TEST_DAMAGE_TRAILER, 8 + 7, false },
+    { "trailer magic", TEST_DAMAGE_TRAILER, 23, false },
+};
+
+#define TEST_DAMAGE_COUNT (sizeof(test_damages) / sizeof(test_damages[0]))
+
+/**
+ * \brief Check that every truncation of an archive, and damage to each part
+ * of its structure, is rejected.
+ *
+ * Only the structure of an archive is checked: a damaged delta in a block
+ * decodes to another weight, as there is no checksum.
+ *
+ * \param alloc         The allocator to use.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_TEST_FAILED if a check fails.
+ *      - a non-zero error code on failure.
+ */
+status test_archive_damaged(allocator* alloc)
+{
+    status retval, release_retval, result = STATUS_SUCCESS;
+    weightgraph_session* session;
+    test_buffer archive;
+    test_log log;
+    uint8_t* damaged;
+    size_t end_offset = 0, offset;
+
+    retval = test_log_generate(&log, TEST_DAMAGED_ENTRIES, 0xda3a9ed);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    memset(&archive, 0, sizeof(archive));
+    retval = test_archive_encode(&archive, alloc, &log);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_log;
+    }
+
+    damaged = (uint8_t*)malloc(archive.size);
+    if (NULL == damaged)
+    {
+        retval = ERROR_GENERAL_OUT_OF_MEMORY;
+        goto cleanup_archive;
+    }
+
+    retval = weightgraph_session_create(&session, alloc, 0.0);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_damaged;
+    }
+
+    /* the whole archive is accepted both ways. */
+    TEST_EXPECT(
+        result,
+        STATUS_SUCCESS
+            == weightgraph_archive_load(
+                session, archive.data, archive.size, NULL));
+    TEST_EXPECT(
+        result,
+        STATUS_SUCCESS
+            == test_stream_session(
+                session, alloc, WEIGHTGRAPH_INPUT_ARCHIVE, archive.data,
+                archive.size, TEST_DAMAGED_PIECE_SIZE));
+
+    /* every truncation is rejected both ways. */
+    for (size_t size = 0; size < archive.size; ++size)
+    {
+        if (!TEST_EXPECT(
+                result,
+                ERROR_ARCHIVE_FORMAT
+                    == weightgraph_archive_load(
+                        session, archive.data, size, NULL))
+         || !TEST_EXPECT(
+                result,
+                ERROR_ARCHIVE_FORMAT
+                    == test_stream_session(
+                        session, alloc, WEIGHTGRAPH_INPUT_ARCHIVE,
+                        archive.data, size, TEST_DAMAGED_PIECE_SIZE)))
+        {
+            fprintf(
+                stderr, "  truncated to %zu of %zu bytes.\n", size,
+                archive.size);
+            break;
+        }
+    }
+
+    /* the offset of the end record is the second field of the trailer. */
+    for (int i = 7; i >= 0; --i)
+    {
+        end_offset =
+            (end_offset << 8)
+          | archive.data[archive.size - TEST_DAMAGE_TRAILER_SIZE + 8 + i];
+    }
+
+    for (size_t i = 0; i < TEST_DAMAGE_COUNT; ++i)
+    {
+        const test_damage* damage = &test_damages[i];
+
+        switch (damage->base)
+        {
+            case TEST_DAMAGE_END_RECORD:
+                offset = end_offset + damage->offset;
+                break;
+
+            case TEST_DAMAGE_TRAILER:
+                offset =
+                    archive.size - TEST_DAMAGE_TRAILER_SIZE + damage->offset;
+                break;
+
+            default:
+                offset = damage->offset;
+                break;
+        }
+
+        memcpy(damaged, archive.data, archive.size);
+        damaged[offset] ^= 0x40;
+
+        if (!TEST_EXPECT(
+                result,
+                ERROR_ARCHIVE_FORMAT
+                    == weightgraph_archive_load(
+                        session, damaged, archive.size, NULL))
+         || (damage->streamed
+          && !TEST_EXPECT(
+                result,
+                ERROR_ARCHIVE_FORMAT
+                    == test_stream_session(
+                        session, alloc, WEIGHTGRAPH_INPUT_ARCHIVE, damaged,
+                        archive.size, TEST_DAMAGED_PIECE_SIZE))))
+        {
+            fprintf(stderr, "  with a damaged %s.\n", damage->part);
+        }
+    }
+
+    retval = result;
+
+    release_retval =
+        resource_release(weightgraph_session_resource_handle(session));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_damaged:
+    free(damaged);
+
+cleanup_archive:
+    free(archive.data);
+
+cleanup_log:
+    test_log_release(&log);
+
+    return retval;
+}
@@ -0,0 +1,143 @@
+/**
+ * \file test/test_archive_encode.c
+ *
+ * \brief Encode a generated log as an archive.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "test_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief The size of the pieces in which the log is streamed.
+ */
+#define TEST_ARCHIVE_PIECE_SIZE 4096
+
+/* forward decls. */
+static status test_archive_average(void* context, double average);
+static status test_archive_log(void* context, const char* date, double weight);
+
+/**
+ * \brief Encode a generated log as an archive, as "weightgraph -a" does, by
+ * streaming its CSV text through a parser into an archive writer.
+ *
+ * \param archive       The buffer to receive the archive, which must be
+ *                      zeroed, and whose data is released with free.
+ * \param alloc         The allocator to use.
+ * \param log           The log.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status test_archive_encode(
+    test_buffer* archive, allocator* alloc, const test_log* log)
+{
+    status retval, release_retval;
+    weightgraph_stream_handler handler;
+    weightgraph_archive_writer* writer;
+    weightgraph_parser* parser;
+    weightgraph_sink sink;
+    size_t offset = 0, size;
+
+    retval = weightgraph_parser_create(&parser, alloc);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    weightgraph_parser_set_format(parser, WEIGHTGRAPH_INPUT_CSV);
+
+    test_buffer_sink_init(&sink, archive);
+    retval = weightgraph_archive_writer_create(&writer, alloc, &sink);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_parser;
+    }
+
+    handler.context = writer;
+    handler.beginning_average = &test_archive_average;
+    handler.log = &test_archive_log;
+    retval = weightgraph_parser_stream_begin(parser, &handler);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_writer;
+    }
+
+    do
+    {
+        size = log->csv_size - offset;
+        if (size > TEST_ARCHIVE_PIECE_SIZE)
+        {
+            size = TEST_ARCHIVE_PIECE_SIZE;
+        }
+
+        retval =
+            weightgraph_parser_stream(
+                parser, (const uint8_t*)log->csv + offset, size, 0 == size);
+        offset += size;
+    } while (STATUS_SUCCESS == retval && size > 0);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_writer;
+    }
+
+    retval = weightgraph_archive_writer_finish(writer);
+
+cleanup_writer:
+    release_retval =
+        resource_release(weightgraph_archive_writer_resource_handle(writer));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_parser:
+    release_retval =
+        resource_release(weightgraph_parser_resource_handle(parser));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Record the beginning average of the log in the archive.
+ *
+ * \param context       The archive writer.
+ * \param average       The initial moving average.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status test_archive_average(void* context, double average)
+{
+    return
+        weightgraph_archive_writer_average(
+            (weightgraph_archive_writer*)context, average);
+}
+
+/**
+ * \brief Add a log entry to the archive.
+ *
+ * \param context       The archive writer.
+ * \param date          The date of the entry.
+ * \param weight        The weight of the entry.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status test_archive_log(void* context, const char* date, double weight)
+{
+    return
+        weightgraph_archive_writer_push(
+            (weightgraph_archive_writer*)context, date, weight);
+}
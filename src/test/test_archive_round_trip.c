@@ -0,0 +1,171 @@
+/**
+ * \file test/test_archive_round_trip.c
+ *
+ * \brief Check that an archive decodes to the log it was encoded from.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "test_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief The number of entries in the log, enough to fill several blocks.
+ */
+#define TEST_ROUND_TRIP_ENTRIES (4 * WEIGHTGRAPH_ARCHIVE_BLOCK_ENTRIES + 123)
+
+/**
+ * \brief The size of the pieces in which the archive is streamed, small
+ * enough that most records are split between pieces.
+ */
+#define TEST_ROUND_TRIP_PIECE_SIZE 61
+
+/* forward decls. */
+static void test_round_trip_compare(
+    status* result, const weightgraph_session* session,
+    const weightgraph_session* expected, const test_log* log);
+
+/**
+ * \brief Check that a log encoded as an archive decodes to the same entries,
+ * both when loaded whole and when streamed through a parser.
+ *
+ * \param alloc         The allocator to use.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_TEST_FAILED if a check fails.
+ *      - a non-zero error code on failure.
+ */
+status test_archive_round_trip(allocator* alloc)
+{
+    status retval, release_retval, result = STATUS_SUCCESS;
+    weightgraph_session* expected;
+    weightgraph_session* session;
+    test_buffer archive;
+    test_log log;
+
+    retval = test_log_generate(&log, TEST_ROUND_TRIP_ENTRIES, 0x5eed);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    memset(&archive, 0, sizeof(archive));
+    retval = test_archive_encode(&archive, alloc, &log);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_log;
+    }
+
+    /* the log as the parser reads it gives the expected moving averages. */
+    retval = weightgraph_session_create(&expected, alloc, 0.0);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_archive;
+    }
+
+    retval =
+        test_stream_session(
+            expected, alloc, WEIGHTGRAPH_INPUT_CSV, (const uint8_t*)log.csv,
+            log.csv_size, log.csv_size);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_expected;
+    }
+
+    retval = weightgraph_session_create(&session, alloc, 0.0);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_expected;
+    }
+
+    /* load the archive whole. */
+    retval =
+        weightgraph_archive_load(session, archive.data, archive.size, NULL);
+    if (TEST_EXPECT(result, STATUS_SUCCESS == retval))
+    {
+        test_round_trip_compare(&result, session, expected, &log);
+    }
+
+    /* stream the archive through a parser. */
+    retval =
+        test_stream_session(
+            session, alloc, WEIGHTGRAPH_INPUT_ARCHIVE, archive.data,
+            archive.size, TEST_ROUND_TRIP_PIECE_SIZE);
+    if (TEST_EXPECT(result, STATUS_SUCCESS == retval))
+    {
+        test_round_trip_compare(&result, session, expected, &log);
+    }
+
+    retval = result;
+
+    release_retval =
+        resource_release(weightgraph_session_resource_handle(session));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_expected:
+    release_retval =
+        resource_release(weightgraph_session_resource_handle(expected));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_archive:
+    free(archive.data);
+
+cleanup_log:
+    test_log_release(&log);
+
+    return retval;
+}
+
+/**
+ * \brief Check that a session holds the entries of a log, with the same
+ * moving averages as a session read from the log itself.
+ *
+ * \param result        The status of the test.
+ * \param session       The session decoded from the archive.
+ * \param expected      The session read from the log.
+ * \param log           The log.
+ */
+static void test_round_trip_compare(
+    status* result, const weightgraph_session* session,
+    const weightgraph_session* expected, const test_log* log)
+{
+    weightgraph_sample sample, expected_sample;
+
+    TEST_EXPECT(
+        *result,
+        weightgraph_session_initial_average(session) == log->average);
+    if (!TEST_EXPECT(*result, weightgraph_session_count(session) == log->count))
+    {
+        return;
+    }
+
+    /* stop at the first entry that differs, rather than report them all. */
+    for (size_t i = 0; i < log->count; ++i)
+    {
+        weightgraph_session_sample(session, i, &sample);
+        weightgraph_session_sample(expected, i, &expected_sample);
+
+        if (!TEST_EXPECT(*result, !strcmp(sample.date, log->entries[i].date))
+         || !TEST_EXPECT(*result, sample.weight == log->entries[i].weight)
+         || !TEST_EXPECT(
+                *result,
+                sample.moving_average == expected_sample.moving_average))
+        {
+            fprintf(stderr, "  at entry %zu.\n", i);
+            return;
+        }
+    }
+}
@@ -0,0 +1,107 @@
+/**
+ * \file test/test_buffer_sink_init.c
+ *
+ * \brief Initialize a sink that appends everything written to a buffer.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "test_internal.h"
+
+/* forward decls. */
+static status test_buffer_open(void* context, size_t page, long offset);
+static status test_buffer_write(void* context, const void* data, size_t size);
+static status test_buffer_close(void* context);
+
+/**
+ * \brief Initialize a sink that appends everything written to a buffer.
+ *
+ * \param sink          The sink to initialize.
+ * \param buffer        The buffer, which must be zeroed, and whose data is
+ *                      released with free.
+ */
+void test_buffer_sink_init(weightgraph_sink* sink, test_buffer* buffer)
+{
+    sink->context = buffer;
+    sink->open = &test_buffer_open;
+    sink->write = &test_buffer_write;
+    sink->close = &test_buffer_close;
+}
+
+/**
+ * \brief Open the buffer sink, which has no effect.
+ *
+ * \param context       The buffer.
+ * \param page          The page being opened.
+ * \param offset        The offset from which to continue.
+ *
+ * \returns STATUS_SUCCESS.
+ */
+static status test_buffer_open(void* context, size_t page, long offset)
+{
+    (void)context;
+    (void)page;
+    (void)offset;
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Append data to the buffer.
+ *
+ * \param context       The buffer.
+ * \param data          The data to append.
+ * \param size          The size of the data.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_GENERAL_OUT_OF_MEMORY if the buffer can't grow.
+ */
+static status test_buffer_write(void* context, const void* data, size_t size)
+{
+    test_buffer* buffer = (test_buffer*)context;
+
+    /* grow the buffer geometrically. */
+    if (buffer->size + size > buffer->capacity)
+    {
+        size_t capacity = (0 == buffer->capacity) ? 4096 : buffer->capacity;
+        uint8_t* data_new;
+
+        while (capacity < buffer->size + size)
+        {
+            capacity *= 2;
+        }
+
+        data_new = (uint8_t*)realloc(buffer->data, capacity);
+        if (NULL == data_new)
+        {
+            return ERROR_GENERAL_OUT_OF_MEMORY;
+        }
+
+        buffer->data = data_new;
+        buffer->capacity = capacity;
+    }
+
+    memcpy(buffer->data + buffer->size, data, size);
+    buffer->size += size;
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Close the buffer sink, which has no effect.
+ *
+ * \param context       The buffer.
+ *
+ * \returns STATUS_SUCCESS.
+ */
+static status test_buffer_close(void* context)
+{
+    (void)context;
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,35 @@
+/**
+ * \file test/test_expect.c
+ *
+ * \brief Report a failed condition of a test.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "test_internal.h"
+
+/**
+ * \brief Report a failed condition of a test.
+ *
+ * \param result        The status of the test, set to ERROR_TEST_FAILED if
+ *                      the condition fails.
+ * \param condition     The condition.
+ * \param file          The file of the check.
+ * \param line          The line of the check.
+ * \param text          The text of the condition.
+ *
+ * \returns the condition.
+ */
+bool test_expect(
+    status* result, bool condition, const char* file, int line,
+    const char* text)
+{
+    if (!condition)
+    {
+        fprintf(stderr, "%s:%d: expected %s.\n", file, line, text);
+        *result = ERROR_TEST_FAILED;
+    }
+
+    return condition;
+}
@@ -0,0 +1,133 @@
+/**
+ * \file test/test_filter_rejection.c
+ *
+ * \brief Check which weights the outlier filter rejects.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "test_internal.h"
+
+RCPR_IMPORT_allocator;
+
+/**
+ * \brief The most weights in a series.
+ */
+#define TEST_FILTER_MAX_WEIGHTS 32
+
+/**
+ * \brief A series of weights, and which of them the filter rejects.
+ */
+typedef struct test_filter_case test_filter_case;
+
+struct test_filter_case
+{
+    const char* name;
+    const double* weights;
+    const bool* rejected;
+    size_t count;
+};
+
+#define TEST_FILTER_CASE(name, weights, rejected) \
+    { name, weights, rejected, sizeof(weights) / sizeof(weights[0]) }
+
+/* outliers while the window fills are kept, and join it; the same outlier
+ * is rejected once the window is full. */
+static const double test_filling_weights[] = {
+    180.2, 72.2, 180.0, 179.6, 180.4, 179.8, 281.0, 180.2, 72.2, 180.0 };
+static const bool test_filling_rejected[] = {
+    false, false, false, false, false, false, false, false, true, false };
+
+/* 172.2 typed as 72.2 amid weights that wander by up to a pound. */
+static const double test_mistyped_weights[] = {
+    173.4, 173.0, 172.6, 173.2, 172.8, 172.4, 173.0, 172.6, 172.2, 172.8,
+    172.4, 172.0, 72.2, 172.6, 171.8, 172.2, 171.6, 172.0, 171.4, 171.8 };
+static const bool test_mistyped_rejected[] = {
+    false, false, false, false, false, false, false, false, false, false,
+    false, false, true, false, false, false, false, false, false, false };
+
+/* the median of 100.0 to 106.0 is 103.0, and their median absolute
+ * deviation 2.0, so a weight is kept within 3 * 1.4826 * 2.0 = 8.8956 of
+ * the median.  111.8 is kept; the window then has a median of 104.0 and the
+ * same deviation, so 112.9 is rejected. */
+static const double test_deviation_weights[] = {
+    100.0, 101.0, 102.0, 103.0, 104.0, 105.0, 106.0, 111.8, 112.9 };
+static const bool test_deviation_rejected[] = {
+    false, false, false, false, false, false, false, false, true };
+
+/* the median absolute deviation of equal weights is 0, so the smallest
+ * spread, half of one percent of the median of 200.0, keeps a weight within
+ * three pounds of it. */
+static const double test_spread_weights[] = {
+    200.0, 200.0, 200.0, 200.0, 200.0, 200.0, 200.0, 200.0, 202.8, 197.2,
+    203.2, 196.8, 200.0 };
+static const bool test_spread_rejected[] = {
+    false, false, false, false, false, false, false, false, false, false,
+    true, true, false };
+
+static const test_filter_case test_filter_cases[] = {
+    TEST_FILTER_CASE(
+        "window filling", test_filling_weights, test_filling_rejected),
+    TEST_FILTER_CASE(
+        "mistyped weight", test_mistyped_weights, test_mistyped_rejected),
+    TEST_FILTER_CASE(
+        "median absolute deviation", test_deviation_weights,
+        test_deviation_rejected),
+    TEST_FILTER_CASE(
+        "smallest spread", test_spread_weights, test_spread_rejected),
+};
+
+#define TEST_FILTER_CASE_COUNT \
+    (sizeof(test_filter_cases) / sizeof(test_filter_cases[0]))
+
+/**
+ * \brief Check that the outlier filter rejects exactly the expected weights
+ * of each series, and that a rejected weight leaves the moving average as
+ * it was.
+ *
+ * \param alloc         The allocator to use.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_TEST_FAILED if a check fails.
+ *      - a non-zero error code on failure.
+ */
+status test_filter_rejection(allocator* alloc)
+{
+    status retval, result = STATUS_SUCCESS;
+    bool rejected[TEST_FILTER_MAX_WEIGHTS];
+    double averages[TEST_FILTER_MAX_WEIGHTS];
+
+    for (size_t i = 0; i < TEST_FILTER_CASE_COUNT; ++i)
+    {
+        const test_filter_case* test = &test_filter_cases[i];
+
+        if (!TEST_EXPECT(result, test->count <= TEST_FILTER_MAX_WEIGHTS))
+        {
+            continue;
+        }
+
+        retval =
+            test_filter_series(
+                alloc, test->weights, test->count, rejected, averages);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        for (size_t j = 0; j < test->count; ++j)
+        {
+            if (!TEST_EXPECT(result, rejected[j] == test->rejected[j])
+             || (rejected[j] && j > 0
+              && !TEST_EXPECT(result, averages[j] == averages[j - 1])))
+            {
+                fprintf(
+                    stderr, "  for %s, weight %zu, %.1f.\n", test->name, j,
+                    test->weights[j]);
+            }
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,83 @@
+/**
+ * \file test/test_filter_series.c
+ *
+ * \brief Push a series of daily weights onto a filtered session.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "test_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Push a series of daily weights onto a session filtered with the
+ * default window and threshold.
+ *
+ * The series starts on 2022-01-01, and its initial moving average is its
+ * first weight.
+ *
+ * \param alloc         The allocator to use.
+ * \param weights       The weights.
+ * \param count         The number of weights, at most 336.
+ * \param rejected      Array to receive whether each weight was rejected.
+ * \param averages      Array to receive the moving average after each
+ *                      weight.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status test_filter_series(
+    allocator* alloc, const double* weights, size_t count, bool* rejected,
+    double* averages)
+{
+    status retval, release_retval;
+    weightgraph_session* session;
+    weightgraph_sample sample;
+    char date[TEST_DATE_SIZE];
+
+    retval = weightgraph_session_create(&session, alloc, weights[0]);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval =
+        weightgraph_session_filter(
+            session, WEIGHTGRAPH_FILTER_WINDOW, WEIGHTGRAPH_FILTER_THRESHOLD);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_session;
+    }
+
+    /* every month is taken to have 28 days. */
+    for (size_t i = 0; i < count; ++i)
+    {
+        snprintf(
+            date, sizeof(date), "2022-%02u-%02u",
+            (unsigned)(1 + i / 28) % 100, (unsigned)(1 + i % 28) % 100);
+
+        retval = weightgraph_session_push(session, date, weights[i]);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_session;
+        }
+
+        weightgraph_session_sample(session, i, &sample);
+        rejected[i] = sample.rejected;
+        averages[i] = sample.moving_average;
+    }
+
+cleanup_session:
+    release_retval =
+        resource_release(weightgraph_session_resource_handle(session));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
@@ -0,0 +1,228 @@
+/**
+ * \file test/test_internal.h
+ *
+ * \brief Helpers for the weightgraph unit tests.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <weightgraph/archive.h>
+#include <weightgraph/session.h>
+#include <weightgraph/status_codes.h>
+#include <weightgraph/weightgraph.h>
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+extern "C" {
+# endif /*__cplusplus*/
+
+/**
+ * \brief The size of a date of a generated log, including its terminator.
+ */
+#define TEST_DATE_SIZE 11
+
+/**
+ * \brief Check a condition of a test, reporting it on stderr if it fails.
+ *
+ * \param result        The status of the test, set to ERROR_TEST_FAILED if
+ *                      the condition fails.
+ * \param condition     The condition.
+ */
+#define TEST_EXPECT(result, condition) \
+    test_expect(&(result), (condition), __FILE__, __LINE__, #condition)
+
+/**
+ * \brief An entry of a generated log.
+ */
+typedef struct test_entry test_entry;
+
+struct test_entry
+{
+    char date[TEST_DATE_SIZE];
+    double weight;
+};
+
+/**
+ * \brief A generated log, with its entries and its text as CSV.
+ */
+typedef struct test_log test_log;
+
+struct test_log
+{
+    double average;
+    test_entry* entries;
+    size_t count;
+    char* csv;
+    size_t csv_size;
+};
+
+/**
+ * \brief A buffer into which a sink writes.
+ */
+typedef struct test_buffer test_buffer;
+
+struct test_buffer
+{
+    uint8_t* data;
+    size_t size;
+    size_t capacity;
+};
+
+/**
+ * \brief Report a failed condition of a test.
+ *
+ * \param result        The status of the test, set to ERROR_TEST_FAILED if
+ *                      the condition fails.
+ * \param condition     The condition.
+ * \param file          The file of the check.
+ * \param line          The line of the check.
+ * \param text          The text of the condition.
+ *
+ * \returns the condition.
+ */
+bool test_expect(
+    status* result, bool condition, const char* file, int line,
+    const char* text);
+
+/**
+ * \brief Generate a log.
+ *
+ * Entries start on 1999-12-25, so that the log crosses the leap day of
+ * 2000, and skip up to three days between them.  Weights follow a random
+ * walk in tenths around 180.0.  The same count and seed always produce the
+ * same log.
+ *
+ * \param log           The log to populate, released with
+ *                      \ref test_log_release.
+ * \param count         The number of entries.
+ * \param seed          The seed of the generator, which must not be 0.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status test_log_generate(test_log* log, size_t count, uint64_t seed);
+
+/**
+ * \brief Release the entries and text of a generated log.
+ *
+ * \param log           The log.
+ */
+void test_log_release(test_log* log);
+
+/**
+ * \brief Initialize a sink that appends everything written to a buffer.
+ *
+ * \param sink          The sink to initialize.
+ * \param buffer        The buffer, which must be zeroed, and whose data is
+ *                      released with free.
+ */
+void test_buffer_sink_init(weightgraph_sink* sink, test_buffer* buffer);
+
+/**
+ * \brief Stream a log through a parser onto a session.
+ *
+ * \param session       The session, which is reset to the initial moving
+ *                      average of the log.
+ * \param alloc         The allocator to use for the parser.
+ * \param format        The format of the log (WEIGHTGRAPH_INPUT_*).
+ * \param buffer        The log.
+ * \param buffer_size   The size of the log.
+ * \param piece_size    The size of the pieces in which the log is streamed.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status test_stream_session(
+    weightgraph_session* session, RCPR_SYM(allocator)* alloc, int format,
+    const uint8_t* buffer, size_t buffer_size, size_t piece_size);
+
+/**
+ * \brief Encode a generated log as an archive, as "weightgraph -a" does, by
+ * streaming its CSV text through a parser into an archive writer.
+ *
+ * \param archive       The buffer to receive the archive, which must be
+ *                      zeroed, and whose data is released with free.
+ * \param alloc         The allocator to use.
+ * \param log           The log.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status test_archive_encode(
+    test_buffer* archive, RCPR_SYM(allocator)* alloc, const test_log* log);
+
+/**
+ * \brief Check that a log encoded as an archive decodes to the same entries,
+ * both when loaded whole and when streamed through a parser.
+ *
+ * \param alloc         The allocator to use.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_TEST_FAILED if a check fails.
+ *      - a non-zero error code on failure.
+ */
+status test_archive_round_trip(RCPR_SYM(allocator)* alloc);
+
+/**
+ * \brief Check that every truncation of an archive, and damage to each part
+ * of its structure, is rejected.
+ *
+ * \param alloc         The allocator to use.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_TEST_FAILED if a check fails.
+ *      - a non-zero error code on failure.
+ */
+status test_archive_damaged(RCPR_SYM(allocator)* alloc);
+
+/**
+ * \brief Push a series of daily weights onto a session filtered with the
+ * default window and threshold.
+ *
+ * The series starts on 2022-01-01, and its initial moving average is its
+ * first weight.
+ *
+ * \param alloc         The allocator to use.
+ * \param weights       The weights.
+ * \param count         The number of weights, at most 336.
+ * \param rejected      Array to receive whether each weight was rejected.
+ * \param averages      Array to receive the moving average after each
+ *                      weight.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status test_filter_series(
+    RCPR_SYM(allocator)* alloc, const double* weights, size_t count,
+    bool* rejected, double* averages);
+
+/**
+ * \brief Check that the outlier filter rejects exactly the expected weights
+ * of each series, and that a rejected weight leaves the moving average as
+ * it was.
+ *
+ * \param alloc         The allocator to use.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_TEST_FAILED if a check fails.
+ *      - a non-zero error code on failure.
+ */
+status test_filter_rejection(RCPR_SYM(allocator)* alloc);
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+}
+# endif /*__cplusplus*/
@@ -0,0 +1,127 @@
+/**
+ * \file test/test_log_generate.c
+ *
+ * \brief Generate a log.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <stdlib.h>
+
+#include "test_internal.h"
+
+/**
+ * \brief The longest line of the CSV text of a generated log.
+ */
+#define TEST_LOG_LINE_SIZE 32
+
+/* forward decls. */
+static uint64_t test_log_next(uint64_t* state);
+static int test_log_month_days(int year, int month);
+
+/**
+ * \brief Generate a log.
+ *
+ * Entries start on 1999-12-25, so that the log crosses the leap day of
+ * 2000, and skip up to three days between them.  Weights follow a random
+ * walk in tenths around 180.0.  The same count and seed always produce the
+ * same log.
+ *
+ * \param log           The log to populate, released with
+ *                      \ref test_log_release.
+ * \param count         The number of entries.
+ * \param seed          The seed of the generator, which must not be 0.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status test_log_generate(test_log* log, size_t count, uint64_t seed)
+{
+    int year = 1999, month = 12, day = 25;
+    long tenths = 1800;
+    size_t capacity = (count + 2) * TEST_LOG_LINE_SIZE;
+    uint64_t state = seed;
+
+    log->average = 180.0;
+    log->count = count;
+    log->entries = (test_entry*)malloc(count * sizeof(*log->entries));
+    log->csv = (char*)malloc(capacity);
+    if (NULL == log->entries || NULL == log->csv)
+    {
+        test_log_release(log);
+        return ERROR_GENERAL_OUT_OF_MEMORY;
+    }
+
+    log->csv_size =
+        (size_t)snprintf(
+            log->csv, capacity, "date,weight\nmoving-average,%.1f\n",
+            log->average);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        test_entry* entry = &log->entries[i];
+        uint64_t random = test_log_next(&state);
+
+        /* drift back toward 180.0, by up to a pound a day. */
+        tenths += (long)(random % 21) - 10 + (tenths < 1800 ? 1 : -1);
+
+        snprintf(
+            entry->date, sizeof(entry->date), "%04u-%02u-%02u",
+            (unsigned)year % 10000, (unsigned)month % 100,
+            (unsigned)day % 100);
+        entry->weight = (double)tenths / 10.0;
+        log->csv_size +=
+            (size_t)snprintf(
+                log->csv + log->csv_size, capacity - log->csv_size,
+                "%s,%ld.%ld\n", entry->date, tenths / 10, tenths % 10);
+
+        /* skip ahead one to three days. */
+        day += 1 + (int)((random >> 32) % 3);
+        while (day > test_log_month_days(year, month))
+        {
+            day -= test_log_month_days(year, month);
+            if (++month > 12)
+            {
+                month = 1;
+                ++year;
+            }
+        }
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Step the generator.
+ *
+ * \param state         The state of the generator.
+ *
+ * \returns the next random number.
+ */
+static uint64_t test_log_next(uint64_t* state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+
+    return *state;
+}
+
+/**
+ * \brief Get the number of days in a month.
+ *
+ * \param year          The year.
+ * \param month         The month, from 1.
+ *
+ * \returns the number of days.
+ */
+static int test_log_month_days(int year, int month)
+{
+    static const int days[] = {
+        31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    bool leap = (0 == year % 4 && 0 != year % 100) || 0 == year % 400;
+
+    return days[month - 1] + ((2 == month && leap) ? 1 : 0);
+}
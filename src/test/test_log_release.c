@@ -0,0 +1,27 @@
+/**
+ * \file test/test_log_release.c
+ *
+ * \brief Release the entries and text of a generated log.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <stdlib.h>
+
+#include "test_internal.h"
+
+/**
+ * \brief Release the entries and text of a generated log.
+ *
+ * \param log           The log.
+ */
+void test_log_release(test_log* log)
+{
+    free(log->entries);
+    free(log->csv);
+    log->entries = NULL;
+    log->csv = NULL;
+    log->count = 0;
+    log->csv_size = 0;
+}
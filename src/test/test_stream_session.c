@@ -0,0 +1,116 @@
+/**
+ * \file test/test_stream_session.c
+ *
+ * \brief Stream a log through a parser onto a session.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "test_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/* forward decls. */
+static status test_stream_average(void* context, double average);
+static status test_stream_log(void* context, const char* date, double weight);
+
+/**
+ * \brief Stream a log through a parser onto a session.
+ *
+ * \param session       The session, which is reset to the initial moving
+ *                      average of the log.
+ * \param alloc         The allocator to use for the parser.
+ * \param format        The format of the log (WEIGHTGRAPH_INPUT_*).
+ * \param buffer        The log.
+ * \param buffer_size   The size of the log.
+ * \param piece_size    The size of the pieces in which the log is streamed.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status test_stream_session(
+    weightgraph_session* session, allocator* alloc, int format,
+    const uint8_t* buffer, size_t buffer_size, size_t piece_size)
+{
+    status retval, release_retval;
+    weightgraph_stream_handler handler;
+    weightgraph_parser* parser;
+    size_t offset = 0, size;
+
+    retval = weightgraph_parser_create(&parser, alloc);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    weightgraph_parser_set_format(parser, format);
+    weightgraph_session_reset(session, 0.0);
+
+    handler.context = session;
+    handler.beginning_average = &test_stream_average;
+    handler.log = &test_stream_log;
+    retval = weightgraph_parser_stream_begin(parser, &handler);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_parser;
+    }
+
+    /* the last piece is empty, as when a file is read to its end. */
+    do
+    {
+        size = buffer_size - offset;
+        if (size > piece_size)
+        {
+            size = piece_size;
+        }
+
+        retval =
+            weightgraph_parser_stream(parser, buffer + offset, size, 0 == size);
+        offset += size;
+    } while (STATUS_SUCCESS == retval && size > 0);
+
+cleanup_parser:
+    release_retval =
+        resource_release(weightgraph_parser_resource_handle(parser));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Reset the session to the initial moving average of the log.
+ *
+ * \param context       The session.
+ * \param average       The initial moving average.
+ *
+ * \returns STATUS_SUCCESS.
+ */
+static status test_stream_average(void* context, double average)
+{
+    weightgraph_session_reset((weightgraph_session*)context, average);
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Push an entry of the log onto the session.
+ *
+ * \param context       The session.
+ * \param date          The date of the entry.
+ * \param weight        The weight of the entry.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status test_stream_log(void* context, const char* date, double weight)
+{
+    return
+        weightgraph_session_push((weightgraph_session*)context, date, weight);
+}
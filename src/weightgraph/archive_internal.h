@@ -0,0 +1,339 @@
+/**
+ * \file weightgraph/archive_internal.h
+ *
+ * \brief Internal declarations for the encoding of weight log archives.
+ *
+ * An archive starts with an eight byte header: the magic, the version, the
+ * style of its dates, the number of digits in their years, and a reserved
+ * byte.  A sequence of records follows, each starting with its type:
+ *
+ *      'A', then the initial moving average, as the eight bytes of a double.
+ *      'B', then a block of entries:
+ *          u16 count       the number of entries, from 1.
+ *          u8  day width   the width, in bits, of each packed day delta.
+ *          u8  weight width    the width of each packed weight delta.
+ *          i32 first day   the day number of the first entry.
+ *          i32 first weight    the weight of the first entry, in hundredths.
+ *          i32 day base    the smallest day delta of the block.
+ *          i32 weight base     the smallest weight delta of the block.
+ *          the count - 1 day deltas, less the day base, packed at the day
+ *          width, then padded to a byte, then the weight deltas, likewise.
+ *      'E', which ends the records.
+ *
+ * The end record is followed by the index, a u32 count of blocks and, for
+ * each block, the u64 offset of its record, the u64 number of entries before
+ * it, its i32 first day and its u32 count.  The archive ends with a trailer:
+ * the u64 number of entries, the u64 offset of the end record, a flags byte,
+ * three reserved bytes and the end magic.  Every field is little-endian.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <weightgraph/archive.h>
+#include <weightgraph/session.h>
+#include <weightgraph/status_codes.h>
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+extern "C" {
+# endif /*__cplusplus*/
+
+/**
+ * \brief The magic at the start of an archive, and its size.
+ */
+#define WEIGHTGRAPH_ARCHIVE_MAGIC "WGAR"
+#define WEIGHTGRAPH_ARCHIVE_MAGIC_SIZE 4
+
+/**
+ * \brief The magic at the end of an archive.
+ */
+#define WEIGHTGRAPH_ARCHIVE_END_MAGIC "WGAE"
+
+/**
+ * \brief The version of the archive format.
+ */
+#define WEIGHTGRAPH_ARCHIVE_VERSION 1
+
+/**
+ * \brief The sizes of the header, the fixed part of each record, an index
+ * entry and the trailer.
+ */
+#define WEIGHTGRAPH_ARCHIVE_HEADER_SIZE 8
+#define WEIGHTGRAPH_ARCHIVE_AVERAGE_SIZE 9
+#define WEIGHTGRAPH_ARCHIVE_BLOCK_HEADER_SIZE 21
+#define WEIGHTGRAPH_ARCHIVE_INDEX_ENTRY_SIZE 24
+#define WEIGHTGRAPH_ARCHIVE_TRAILER_SIZE 24
+
+/**
+ * \brief The size of the scratch space in which a writer encodes a block:
+ * its header, and two streams of deltas of at most 32 bits.
+ */
+#define WEIGHTGRAPH_ARCHIVE_SCRATCH_SIZE \
+    (WEIGHTGRAPH_ARCHIVE_BLOCK_HEADER_SIZE \
+        + 2 * 4 * WEIGHTGRAPH_ARCHIVE_BLOCK_ENTRIES)
+
+/**
+ * \brief The record types.
+ */
+#define WEIGHTGRAPH_ARCHIVE_RECORD_AVERAGE 'A'
+#define WEIGHTGRAPH_ARCHIVE_RECORD_BLOCK 'B'
+#define WEIGHTGRAPH_ARCHIVE_RECORD_END 'E'
+
+/**
+ * \brief The trailer flag set when every entry comes after the one before.
+ */
+#define WEIGHTGRAPH_ARCHIVE_FLAG_ORDERED 0x01
+
+/**
+ * \brief Weights are stored in fixed point, in units of one over this, as a
+ * session holds them.
+ */
+#define WEIGHTGRAPH_ARCHIVE_WEIGHT_SCALE WEIGHTGRAPH_FIXED_SCALE
+
+/**
+ * \brief The largest magnitude of a day number or a fixed-point weight, so
+ * that the difference of any two fits in 32 bits.
+ */
+#define WEIGHTGRAPH_ARCHIVE_VALUE_MAX 0x3fffffff
+
+/**
+ * \brief The year in which "MM/DD" dates are counted, a leap year so that
+ * the 29th of February has a day number.
+ */
+#define WEIGHTGRAPH_ARCHIVE_MONTH_DAY_YEAR 2000
+
+/**
+ * \brief The longest date an archive decodes, including its terminator.
+ */
+#define WEIGHTGRAPH_ARCHIVE_DATE_SIZE 32
+
+/**
+ * \brief The styles of date an archive can hold.
+ */
+enum weightgraph_archive_date_style
+{
+    /* no date has been seen yet. */
+    WEIGHTGRAPH_ARCHIVE_DATE_NONE,
+    /* "YYYY-MM-DD", as days since 0000-03-01. */
+    WEIGHTGRAPH_ARCHIVE_DATE_ISO,
+    /* "MM/DD", as days since the first of January of a leap year. */
+    WEIGHTGRAPH_ARCHIVE_DATE_MONTH_DAY,
+};
+
+/**
+ * \brief The entry of the block index for a block.
+ */
+typedef struct weightgraph_archive_index_entry
+    weightgraph_archive_index_entry;
+
+struct weightgraph_archive_index_entry
+{
+    uint64_t offset;
+    uint64_t first_entry;
+    int32_t first_day;
+    uint32_t count;
+};
+
+/**
+ * \brief A decoded block of entries.
+ */
+typedef struct weightgraph_archive_block weightgraph_archive_block;
+
+struct weightgraph_archive_block
+{
+    size_t count;
+    int32_t days[WEIGHTGRAPH_ARCHIVE_BLOCK_ENTRIES];
+    int32_t weights[WEIGHTGRAPH_ARCHIVE_BLOCK_ENTRIES];
+};
+
+/**
+ * \brief An archive writer.
+ */
+struct weightgraph_archive_writer
+{
+    RCPR_SYM(resource) hdr;
+    RCPR_SYM(allocator)* alloc;
+    const weightgraph_sink* sink;
+    /* true while the sink is open. */
+    bool sink_open;
+    /* the number of bytes written to the sink. */
+    uint64_t offset;
+    /* the style of the dates, and the digits in their years. */
+    int date_style;
+    int year_width;
+    /* an initial average not yet written, which waits for the header. */
+    bool average_pending;
+    double average;
+    /* the entries of the block being gathered. */
+    weightgraph_archive_block block;
+    /* the number of entries written, and whether they are in order. */
+    uint64_t entry_count;
+    bool ordered;
+    int32_t last_day;
+    /* the index of the blocks written. */
+    weightgraph_archive_index_entry* index;
+    size_t index_count;
+    size_t index_capacity;
+    /* scratch space for encoding a block. */
+    uint8_t* scratch;
+};
+
+/**
+ * \brief Convert a date to a day number.
+ *
+ * The first date sets the style of the dates of an archive, and the number
+ * of digits in their years; every later date must match.  A date is only
+ * accepted if formatting its day number gives back the same date.
+ *
+ * \param date          The date.
+ * \param date_style    The style of the dates, set by the first date.
+ * \param year_width    The digits in each year, set by the first date.
+ * \param day           Pointer to receive the day number.
+ *
+ * \returns true if the date can be stored as a day number.
+ */
+bool weightgraph_archive_date_encode(
+    const char* date, int* date_style, int* year_width, int32_t* day);
+
+/**
+ * \brief Format a day number as a date.
+ *
+ * \param date          Buffer of \ref WEIGHTGRAPH_ARCHIVE_DATE_SIZE bytes to
+ *                      receive the date.
+ * \param date_style    The style of the date.
+ * \param year_width    The digits in the year.
+ * \param day           The day number.
+ *
+ * \returns false if the day number can't be formatted in this style.
+ */
+bool weightgraph_archive_date_format(
+    char* date, int date_style, int year_width, int32_t day);
+
+/**
+ * \brief Count the days from 0000-03-01 to a date in the proleptic Gregorian
+ * calendar.
+ *
+ * \param year          The year, from 0.
+ * \param month         The month, from 1.
+ * \param mday          The day of the month, from 1.
+ *
+ * \returns the number of days, which is negative for dates before 0000-03-01.
+ */
+long weightgraph_archive_days_from_civil(long year, long month, long mday);
+
+/**
+ * \brief Convert a count of days since 0000-03-01 to a date in the proleptic
+ * Gregorian calendar.
+ *
+ * \param day           The day number, from 0.
+ * \param year          Pointer to receive the year.
+ * \param month         Pointer to receive the month, from 1.
+ * \param mday          Pointer to receive the day of the month, from 1.
+ */
+void weightgraph_archive_civil_from_days(
+    int32_t day, long* year, int* month, int* mday);
+
+/**
+ * \brief Pack values at a fixed width in bits, least significant bit first.
+ *
+ * \param out           The buffer to receive the packed values, of at least
+ *                      (count * width + 7) / 8 bytes.
+ * \param values        The values, which must each fit in the width.
+ * \param count         The number of values.
+ * \param width         The width of each value, from 0 to 32.
+ *
+ * \returns the number of bytes written.
+ */
+size_t weightgraph_archive_pack(
+    uint8_t* out, const uint32_t* values, size_t count, unsigned width);
+
+/**
+ * \brief Decode a block record.
+ *
+ * Deltas are unpacked a 64-bit word at a time, without branches, and a block
+ * whose deltas are all the same, such as the days of a daily log, has
+ * nothing to unpack.  The deltas are then summed into day numbers and
+ * weights.
+ *
+ * \param block         The block to receive the entries.
+ * \param buffer        The record, starting with its type byte.
+ * \param buffer_size   The size of the record.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_ARCHIVE_FORMAT if the record is malformed or truncated.
+ */
+status weightgraph_archive_block_decode(
+    weightgraph_archive_block* block, const uint8_t* buffer,
+    size_t buffer_size);
+
+/**
+ * \brief Get the size of the record at the start of a buffer.
+ *
+ * \param buffer        The buffer, starting with the type byte of a record.
+ * \param buffer_size   The number of bytes available in the buffer.
+ * \param record_size   Pointer to receive the size of the record, including
+ *                      its type byte, which is known even if the buffer holds
+ *                      only part of the record, or 0 if the buffer is too
+ *                      short to tell.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_ARCHIVE_FORMAT if the record type is unknown, or the block
+ *        header is malformed.
+ */
+status weightgraph_archive_record_size(
+    const uint8_t* buffer, size_t buffer_size, size_t* record_size);
+
+/**
+ * \brief Write the pending block of an archive writer, and its header and
+ * initial average if they haven't been written yet.
+ *
+ * \param writer        The writer.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_archive_writer_flush(weightgraph_archive_writer* writer);
+
+/**
+ * \brief Release an archive writer resource.
+ *
+ * \param r         The resource to release.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_archive_writer_resource_release(RCPR_SYM(resource)* r);
+
+/**
+ * \brief Read a little-endian field of an archive.
+ *
+ * \param buffer        The field.
+ * \param size          The size of the field, from 1 to 8 bytes.
+ *
+ * \returns the value of the field.
+ */
+uint64_t weightgraph_archive_field_read(const uint8_t* buffer, size_t size);
+
+/**
+ * \brief Write a little-endian field of an archive.
+ *
+ * \param buffer        The field.
+ * \param value         The value of the field.
+ * \param size          The size of the field, from 1 to 8 bytes.
+ */
+void weightgraph_archive_field_write(
+    uint8_t* buffer, uint64_t value, size_t size);
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+}
+# endif /*__cplusplus*/
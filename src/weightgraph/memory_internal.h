@@ -0,0 +1,123 @@
+/**
+ * \file weightgraph/memory_internal.h
+ *
+ * \brief Internal declarations for the memory accounting of the library.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#pragma once
+
+#include <rcpr/allocator.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <weightgraph/memory.h>
+#include <weightgraph/status_codes.h>
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+extern "C" {
+# endif /*__cplusplus*/
+
+/**
+ * \brief The memory counted for a category.
+ */
+typedef struct weightgraph_memory_counters weightgraph_memory_counters;
+
+struct weightgraph_memory_counters
+{
+    atomic_uint_fast64_t allocations;
+    atomic_uint_fast64_t reclaims;
+    atomic_uint_fast64_t bytes;
+    atomic_int_fast64_t live_bytes;
+    atomic_int_fast64_t peak_bytes;
+};
+
+/**
+ * \brief The memory accounting of the library.
+ */
+typedef struct weightgraph_memory_accounting weightgraph_memory_accounting;
+
+struct weightgraph_memory_accounting
+{
+    atomic_bool enabled;
+    /* one set of counters per category, followed by the total. */
+    weightgraph_memory_counters
+        counters[WEIGHTGRAPH_MEMORY_CATEGORY_COUNT + 1];
+};
+
+/**
+ * \brief The memory accounting of the library, zeroed until enabled.
+ */
+extern weightgraph_memory_accounting weightgraph_memory;
+
+/**
+ * \brief Count a change in the size of a block of memory.
+ *
+ * A block is allocated when its old size is zero, and reclaimed when its new
+ * size is zero.  Nothing is counted unless accounting is enabled.
+ *
+ * \param category      The category of the block.
+ * \param old_size      The size of the block before the change.
+ * \param size          The size of the block after the change.
+ */
+void weightgraph_memory_track(int category, size_t old_size, size_t size);
+
+/**
+ * \brief Allocate memory, counting it against a category.
+ *
+ * \param alloc         The allocator to use, or NULL for the C heap, which
+ *                      may be used from any thread.
+ * \param category      The category of the allocation.
+ * \param mem           Pointer to receive the memory.
+ * \param size          The size of the allocation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_memory_allocate(
+    RCPR_SYM(allocator)* alloc, int category, void** mem, size_t size);
+
+/**
+ * \brief Grow or shrink memory, counting it against a category.
+ *
+ * If the memory is NULL, it is allocated.
+ *
+ * \param alloc         The allocator to use, or NULL for the C heap.
+ * \param category      The category of the allocation.
+ * \param mem           Pointer to the memory, updated on success.
+ * \param old_size      The current size of the memory.
+ * \param size          The new size of the memory.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_memory_reallocate(
+    RCPR_SYM(allocator)* alloc, int category, void** mem, size_t old_size,
+    size_t size);
+
+/**
+ * \brief Reclaim memory, counting it against a category.
+ *
+ * Reclaiming NULL has no effect.
+ *
+ * \param alloc         The allocator the memory came from, or NULL for the C
+ *                      heap.
+ * \param category      The category of the allocation.
+ * \param mem           The memory to reclaim.
+ * \param size          The size the memory was allocated with.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_memory_reclaim(
+    RCPR_SYM(allocator)* alloc, int category, void* mem, size_t size);
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+}
+# endif /*__cplusplus*/
@@ -0,0 +1,213 @@
+/**
+ * \file weightgraph/output_graph_begin_page.c
+ *
+ * \brief Start a new page of the graph.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <math.h>
+
+#include "weightgraph_internal.h"
+
+/* forward decls. */
+static status output_graph_open_raster_page(output_graph_file* out);
+static void output_graph_eps_frame(output_graph_file* out);
+static status output_graph_raster_frame(output_graph_file* out);
+static status output_graph_ticks(output_graph_file* out);
+
+/**
+ * \brief Start a new page of the graph, drawing its boundaries and axes.
+ *
+ * The plotted line on the new page starts at the left edge of the graph,
+ * at the moving average carried over from the previous page.
+ *
+ * \param out               Output file pointer.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status output_graph_begin_page(output_graph_file* out)
+{
+    status retval;
+
+    /* advance to the next page. */
+    ++out->page;
+    out->page_entries = 0;
+    out->page_open = true;
+    out->prevx = 50;
+    out->page_prevy = out->prevy;
+
+    if (WEIGHTGRAPH_FORMAT_EPS == out->format)
+    {
+        /* start page. */
+        output_graph_printf(out, "%%%%Page: %zu %zu\n", out->page, out->page);
+        output_graph_printf(out, "%%%%PageBoundingBox: 0 0 1200 1200\n");
+
+        /* isolate the graphics state of each page in a document. */
+        if (out->page_count > 1 || out->appendable)
+        {
+            output_graph_printf(out, "%%%%BeginPageSetup\n");
+            output_graph_printf(out, "/pagesave save def\n");
+            output_graph_printf(out, "%%%%EndPageSetup\n");
+        }
+
+        output_graph_eps_frame(out);
+    }
+    else
+    {
+        /* each raster page is written to its own image. */
+        retval = output_graph_open_raster_page(out);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        raster_canvas_clear(out->canvas);
+
+        retval = output_graph_raster_frame(out);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    /* create ticks on Y-axis. */
+    return output_graph_ticks(out);
+}
+
+/**
+ * \brief Open the sink output for the current raster page.
+ *
+ * A single page is opened as page 0, so that it can be written under the
+ * output name as-is.  Otherwise, or if later renders may append pages, each
+ * page is opened with its page number.
+ *
+ * \param out           The output graph file.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status output_graph_open_raster_page(output_graph_file* out)
+{
+    status retval;
+    size_t page = out->page;
+
+    /* a single page is not numbered. */
+    if (1 == out->page_count && !out->appendable)
+    {
+        page = 0;
+    }
+
+    retval = out->sink->open(out->sink->context, page, 0);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    out->sink_open = true;
+    out->offset = 0;
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Draw the graph boundaries in EPS.
+ *
+ * \param out           The output graph file.
+ */
+static void output_graph_eps_frame(output_graph_file* out)
+{
+    /* draw graph boundaries. */
+    output_graph_printf(out, "newpath\n");
+    output_graph_printf(out, "50 50 moveto\n");
+    output_graph_printf(out, "0 1100 rlineto\n");
+    output_graph_printf(out, "1100 0 rlineto\n");
+    output_graph_printf(out, "0 -1100 rlineto\n");
+    output_graph_printf(out, "-1100 0 rlineto\n");
+    output_graph_printf(out, "closepath\n");
+    output_graph_printf(out, "0 0 0 setrgbcolor\n");
+    output_graph_printf(out, "stroke\n");
+}
+
+/**
+ * \brief Draw the graph boundaries on the raster canvas.
+ *
+ * \param out           The output graph file.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status output_graph_raster_frame(output_graph_file* out)
+{
+    status retval;
+    static const output_graph_color black = { 0.0, 0.0, 0.0 };
+    static const double frame[5][2] = {
+        { 50.0, 50.0 }, { 50.0, 1150.0 }, { 1150.0, 1150.0 },
+        { 1150.0, 50.0 }, { 50.0, 50.0 } };
+
+    /* draw graph boundaries. */
+    for (int i = 0; i < 4; ++i)
+    {
+        retval =
+            output_graph_draw_line(
+                out, frame[i][0], frame[i][1], frame[i + 1][0],
+                frame[i + 1][1], &black);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Draw the ticks and labels on the Y-axis.
+ *
+ * \param out           The output graph file.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status output_graph_ticks(output_graph_file* out)
+{
+    status retval;
+    static const output_graph_color black = { 0.0, 0.0, 0.0 };
+    int ticks = (int)lround((out->axis_max - out->axis_min) / out->tick_step);
+    int precision = (int)fmax(0.0, -floor(log10(out->tick_step)));
+    char text[32];
+
+    /* draw a tick every half step, and label every step. */
+    for (int i = 1; i <= 2 * ticks; ++i)
+    {
+        double value = out->axis_min + out->tick_step * i / 2.0;
+        double y = value * out->yscale + out->yoffset;
+
+        retval = output_graph_draw_line(out, 50.0, y, 55.0, y, &black);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        if (0 == (i % 2))
+        {
+            snprintf(text, sizeof(text), "%.*f", precision, value);
+            retval =
+                output_graph_draw_label(
+                    out, OUTPUT_GRAPH_FONT_BOLD, 15, text, 45.0, y,
+                    OUTPUT_GRAPH_LABEL_RIGHT, NULL);
+            if (STATUS_SUCCESS != retval)
+            {
+                return retval;
+            }
+        }
+    }
+
+    return STATUS_SUCCESS;
+}
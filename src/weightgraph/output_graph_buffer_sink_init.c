@@ -0,0 +1,118 @@
+/**
+ * \file weightgraph/output_graph_buffer_sink_init.c
+ *
+ * \brief Initialize a sink that appends everything written to a buffer.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "weightgraph_internal.h"
+
+/* forward decls. */
+static status output_graph_buffer_open(
+    void* context, size_t page, long offset);
+static status output_graph_buffer_write(
+    void* context, const void* data, size_t size);
+static status output_graph_buffer_close(void* context);
+
+/**
+ * \brief Initialize a sink that appends everything written to a buffer.
+ *
+ * Opening and closing the sink has no effect.  The buffer data is allocated
+ * from the C heap, and must be released with weightgraph_memory_reclaim as
+ * WEIGHTGRAPH_MEMORY_OUTPUT memory of its capacity.
+ *
+ * \param sink              The sink to initialize.
+ * \param buffer            The buffer, which must be zeroed.
+ */
+void output_graph_buffer_sink_init(
+    weightgraph_sink* sink, output_graph_buffer* buffer)
+{
+    sink->context = buffer;
+    sink->open = &output_graph_buffer_open;
+    sink->write = &output_graph_buffer_write;
+    sink->close = &output_graph_buffer_close;
+}
+
+/**
+ * \brief Open the buffer sink, which has no effect.
+ *
+ * \param context           The buffer.
+ * \param page              The page being opened.
+ * \param offset            The offset from which to continue.
+ *
+ * \returns STATUS_SUCCESS.
+ */
+static status output_graph_buffer_open(
+    void* context, size_t page, long offset)
+{
+    (void)context;
+    (void)page;
+    (void)offset;
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Append data to the buffer.
+ *
+ * \param context           The buffer.
+ * \param data              The data to append.
+ * \param size              The size of the data.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status output_graph_buffer_write(
+    void* context, const void* data, size_t size)
+{
+    output_graph_buffer* buffer = (output_graph_buffer*)context;
+
+    /* grow the buffer geometrically. */
+    if (buffer->size + size > buffer->capacity)
+    {
+        size_t capacity = (0 == buffer->capacity) ? 4096 : buffer->capacity;
+        void* data_new = buffer->data;
+        status retval;
+
+        while (capacity < buffer->size + size)
+        {
+            capacity *= 2;
+        }
+
+        retval =
+            weightgraph_memory_reallocate(
+                NULL, WEIGHTGRAPH_MEMORY_OUTPUT, &data_new, buffer->capacity,
+                capacity);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        buffer->data = (char*)data_new;
+        buffer->capacity = capacity;
+    }
+
+    memcpy(buffer->data + buffer->size, data, size);
+    buffer->size += size;
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Close the buffer sink, which has no effect.
+ *
+ * \param context           The buffer.
+ *
+ * \returns STATUS_SUCCESS.
+ */
+static status output_graph_buffer_close(void* context)
+{
+    (void)context;
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,240 @@
+/**
+ * \file weightgraph/output_graph_create.c
+ *
+ * \brief Create an output graph file and write the preamble.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "weightgraph_internal.h"
+
+RCPR_IMPORT_resource;
+
+/**
+ * \brief The approximate number of labeled ticks on the Y-axis.
+ */
+#define OUTPUT_GRAPH_TARGET_TICKS 10
+
+/* forward decls. */
+static void output_graph_scale_axis(
+    output_graph_file* out, double min_value, double max_value);
+static void output_graph_eps_preamble(output_graph_file* out);
+
+/**
+ * \brief Create an output graph file, and write the preamble.
+ *
+ * When resume state is given, rendering continues from that state instead.
+ * An EPS document is reopened at the recorded offset so that new entries are
+ * written in place of the old epilogue.  If the state was recorded for a
+ * graph with a different Y-axis, ERROR_CHECKPOINT_STALE is returned.
+ *
+ * \param fp            Pointer to receive the file pointer.
+ * \param alloc         Allocator to use for this operation.
+ * \param sink          The sink to which output is written.
+ * \param options       The rendering options for this graph.
+ * \param old_average   The previous average.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status output_graph_create(
+    output_graph_file** fp, RCPR_SYM(allocator)* alloc,
+    const weightgraph_sink* sink, const output_graph_options* options,
+    double old_average)
+{
+    status retval, release_retval;
+    output_graph_file* tmp;
+
+    /* allocate memory for the output file. */
+    retval =
+        weightgraph_memory_allocate(
+            alloc, WEIGHTGRAPH_MEMORY_OUTPUT, (void**)&tmp, sizeof(*tmp));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* clear memory. */
+    memset(tmp, 0, sizeof(*tmp));
+
+    /* set initial values. */
+    resource_init(&tmp->hdr, &output_graph_resource_release);
+    tmp->alloc = alloc;
+    tmp->sink = sink;
+    tmp->write_status = STATUS_SUCCESS;
+    tmp->format = options->format;
+    tmp->page_size = options->page_size;
+    tmp->page_count = options->page_count;
+    tmp->appendable = options->appendable;
+    tmp->xskip = (1100.0 - 20.0) / (double)tmp->page_size;
+    output_graph_scale_axis(tmp, options->min_value, options->max_value);
+    tmp->prevx = 50;
+    tmp->prevy = old_average * tmp->yscale;
+
+    /* a resumed graph must share the axis with which it was started. */
+    if (NULL != options->resume)
+    {
+        if (options->resume->axis_min != tmp->axis_min
+         || options->resume->axis_max != tmp->axis_max
+         || options->resume->tick_step != tmp->tick_step)
+        {
+            retval = ERROR_CHECKPOINT_STALE;
+            goto cleanup_tmp;
+        }
+
+        tmp->prevx = options->resume->prevx;
+        tmp->prevy = options->resume->prevy;
+        tmp->page = options->resume->page;
+        tmp->page_entries = options->resume->page_entries;
+        tmp->page_open = options->resume->page_open;
+        tmp->page_prevy = tmp->prevy;
+    }
+
+    /* write the preamble for this format. */
+    if (WEIGHTGRAPH_FORMAT_EPS == tmp->format)
+    {
+        /* a resumed document picks up where the previous one left off. */
+        if (NULL != options->resume)
+        {
+            tmp->offset = options->resume->offset;
+        }
+
+        /* open the document. */
+        retval = sink->open(sink->context, 0, tmp->offset);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_tmp;
+        }
+        tmp->sink_open = true;
+
+        if (NULL == options->resume)
+        {
+            output_graph_eps_preamble(tmp);
+        }
+    }
+    else
+    {
+        /* the page is 1200 points square. */
+        tmp->raster_scale = (double)options->raster_size / 1200.0;
+
+        /* create the canvas. */
+        retval =
+            raster_canvas_create(
+                &tmp->canvas, alloc, options->raster_size,
+                options->raster_size);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_tmp;
+        }
+    }
+
+    /* success. */
+    *fp = tmp;
+    retval = STATUS_SUCCESS;
+    goto done;
+
+cleanup_tmp:
+    release_retval = resource_release(&tmp->hdr);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Choose the Y-axis range and tick spacing for the plotted values.
+ *
+ * Labeled ticks fall on multiples of 1, 2 or 5 times a power of ten, and
+ * the axis is padded by one tick on either side so that labels above and
+ * below the extreme points remain on the page.
+ *
+ * \param out           The output graph file.
+ * \param min_value     The smallest value to be plotted.
+ * \param max_value     The largest value to be plotted.
+ */
+static void output_graph_scale_axis(
+    output_graph_file* out, double min_value, double max_value)
+{
+    double span = fmax(max_value - min_value, 1.0);
+    double rough = span / OUTPUT_GRAPH_TARGET_TICKS;
+    double magnitude = pow(10.0, floor(log10(rough)));
+    double fraction = rough / magnitude;
+
+    /* round the rough step up to a readable step. */
+    if (fraction <= 1.0)
+    {
+        out->tick_step = magnitude;
+    }
+    else if (fraction <= 2.0)
+    {
+        out->tick_step = 2.0 * magnitude;
+    }
+    else if (fraction <= 5.0)
+    {
+        out->tick_step = 5.0 * magnitude;
+    }
+    else
+    {
+        out->tick_step = 10.0 * magnitude;
+    }
+
+    /* snap the axis to whole ticks, with one tick of padding. */
+    out->axis_min =
+        (floor(min_value / out->tick_step) - 1.0) * out->tick_step;
+    out->axis_max =
+        (ceil(max_value / out->tick_step) + 1.0) * out->tick_step;
+
+    /* the axis spans the 1100 point height of the graph. */
+    out->yscale = 1100.0 / (out->axis_max - out->axis_min);
+    out->yoffset = 50.0 - out->axis_min * out->yscale;
+}
+
+/**
+ * \brief Write the EPS document front matter.
+ *
+ * A graph that fits on a single page is written as encapsulated PostScript.
+ * Longer graphs are written as a multi-page PostScript document.  The page
+ * count of an appendable graph is deferred to the trailer, which is
+ * rewritten each time pages are appended.
+ *
+ * \param out           The output graph file.
+ */
+static void output_graph_eps_preamble(output_graph_file* out)
+{
+    /* front matter. */
+    if (1 == out->page_count && !out->appendable)
+    {
+        output_graph_printf(out, "%%!PS-Adobe-3.0 EPSF-3.0\n");
+    }
+    else
+    {
+        output_graph_printf(out, "%%!PS-Adobe-3.0\n");
+    }
+    output_graph_printf(out, "%%%%Creator: (weightgraph)\n");
+    output_graph_printf(out, "%%%%Title: (weight-graph.eps)\n");
+    output_graph_printf(out, "%%%%BoundingBox: 0 0 1200 1200\n");
+    output_graph_printf(out, "%%%%DocumentData: Clean7Bit\n");
+    output_graph_printf(out, "%%%%LanguageLevel: 1\n");
+    if (out->appendable)
+    {
+        output_graph_printf(out, "%%%%Pages: (atend)\n");
+    }
+    else
+    {
+        output_graph_printf(out, "%%%%Pages: %zu\n", out->page_count);
+    }
+    output_graph_printf(out, "%%%%EndComments\n\n");
+    output_graph_printf(out, "%%%%BeginDefaults\n");
+    output_graph_printf(out, "%%%%PageOrientation: Portrait\n");
+    output_graph_printf(out, "%%%%EndDefaults\n\n");
+    output_graph_printf(out, "%%%%BeginProlog\n");
+    output_graph_printf(out, "%%%%EndProlog\n");
+}
@@ -0,0 +1,76 @@
+/**
+ * \file weightgraph/output_graph_draw_circle.c
+ *
+ * \brief Fill a circle on the graph.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <math.h>
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief The number of segments used to approximate a raster circle.
+ */
+#define OUTPUT_GRAPH_CIRCLE_SEGMENTS 32
+
+/**
+ * \brief Fill a circle on the graph.
+ *
+ * \param out               Output file pointer.
+ * \param x                 The x coordinate of the center, in points.
+ * \param y                 The y coordinate of the center, in points.
+ * \param radius            The radius, in points.
+ * \param color             The fill color.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status output_graph_draw_circle(
+    output_graph_file* out, double x, double y, double radius,
+    const output_graph_color* color)
+{
+    out->color = *color;
+
+    if (WEIGHTGRAPH_FORMAT_EPS == out->format)
+    {
+        output_graph_printf(out, "newpath\n");
+        output_graph_printf(
+            out, "%lf %lf %g 0 360 arc closepath\n", x, y, radius);
+        output_graph_printf(
+            out, "%g %g %g setrgbcolor\n", color->red, color->green,
+            color->blue);
+        output_graph_printf(out, "fill\n");
+    }
+    else
+    {
+        double prevx = x + radius;
+        double prevy = y;
+
+        /* approximate the circle with a polygon. */
+        for (int i = 1; i <= OUTPUT_GRAPH_CIRCLE_SEGMENTS; ++i)
+        {
+            double angle = 2.0 * M_PI * i / OUTPUT_GRAPH_CIRCLE_SEGMENTS;
+            double nextx = x + radius * cos(angle);
+            double nexty = y + radius * sin(angle);
+
+            /* close the outline exactly where it started. */
+            if (OUTPUT_GRAPH_CIRCLE_SEGMENTS == i)
+            {
+                nextx = x + radius;
+                nexty = y;
+            }
+
+            output_graph_raster_edge(out, prevx, prevy, nextx, nexty);
+            prevx = nextx;
+            prevy = nexty;
+        }
+
+        raster_canvas_fill(out->canvas, color->red, color->green, color->blue);
+    }
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,214 @@
+/**
+ * \file weightgraph/output_graph_draw_label.c
+ *
+ * \brief Draw a text label on the graph.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "weightgraph_internal.h"
+
+/* forward decls. */
+static void output_graph_eps_string(output_graph_file* out, const char* text);
+static void output_graph_raster_label(
+    output_graph_file* out, int font, int size, const char* text, double x,
+    double y, int style);
+
+/**
+ * \brief Draw a text label on the graph.
+ *
+ * \param out               Output file pointer.
+ * \param font              The font (OUTPUT_GRAPH_FONT_*).
+ * \param size              The font size, in points.
+ * \param text              The text to draw.
+ * \param x                 The x coordinate of the anchor, in points.
+ * \param y                 The y coordinate of the anchor, in points.
+ * \param style             The label style (OUTPUT_GRAPH_LABEL_*).
+ * \param color             The text color, or NULL to use the most recently
+ *                          used color.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status output_graph_draw_label(
+    output_graph_file* out, int font, int size, const char* text, double x,
+    double y, int style, const output_graph_color* color)
+{
+    if (NULL != color)
+    {
+        out->color = *color;
+    }
+
+    if (WEIGHTGRAPH_FORMAT_EPS == out->format)
+    {
+        /* set the color, if one is given. */
+        if (NULL != color)
+        {
+            output_graph_printf(
+                out, "%g %g %g setrgbcolor\n", color->red, color->green,
+                color->blue);
+        }
+
+        /* select the font. */
+        output_graph_printf(
+            out, "/%s findfont %d scalefont setfont\n",
+            (OUTPUT_GRAPH_FONT_BOLD == font) ? "Courier-Bold" : "Courier",
+            size);
+
+        /* measure the string. */
+        output_graph_eps_string(out, text);
+        output_graph_printf(out, " dup stringwidth pop\n");
+
+        /* position and show the string. */
+        switch (style)
+        {
+            case OUTPUT_GRAPH_LABEL_CENTER:
+                output_graph_printf(
+                    out, "2 div %lf exch sub %lf moveto show\n", x, y);
+                break;
+
+            case OUTPUT_GRAPH_LABEL_RIGHT:
+                output_graph_printf(out, "%g exch sub\n", x);
+                output_graph_printf(out, "%lf moveto show\n", y);
+                break;
+
+            default:
+                output_graph_printf(out, "%g exch sub\n", y);
+                output_graph_printf(
+                    out,
+                    "%lf exch moveto gsave 90 rotate show grestore\n", x);
+                break;
+        }
+    }
+    else
+    {
+        output_graph_raster_label(out, font, size, text, x, y, style);
+        raster_canvas_fill(
+            out->canvas, out->color.red, out->color.green, out->color.blue);
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Write a PostScript string literal.
+ *
+ * \param out               The output graph file.
+ * \param text              The text of the string.
+ */
+static void output_graph_eps_string(output_graph_file* out, const char* text)
+{
+    const char* run = text;
+
+    output_graph_write(out, "(", 1);
+    for (const char* ch = text; 0 != *ch; ++ch)
+    {
+        /* escape characters that are special in a string literal. */
+        if ('(' == *ch || ')' == *ch || '\\' == *ch)
+        {
+            output_graph_write(out, run, (size_t)(ch - run));
+            output_graph_write(out, "\\", 1);
+            run = ch;
+        }
+    }
+    output_graph_write(out, run, strlen(run));
+    output_graph_write(out, ")", 1);
+}
+
+/**
+ * \brief Add the outlines of a label to the raster canvas.
+ *
+ * Glyphs are laid out on the same fixed advance as Courier, so that labels
+ * line up with their EPS counterparts.
+ *
+ * \param out               Output file pointer.
+ * \param font              The font (OUTPUT_GRAPH_FONT_*).
+ * \param size              The font size, in points.
+ * \param text              The text to draw.
+ * \param x                 The x coordinate of the anchor, in points.
+ * \param y                 The y coordinate of the anchor, in points.
+ * \param style             The label style (OUTPUT_GRAPH_LABEL_*).
+ */
+static void output_graph_raster_label(
+    output_graph_file* out, int font, int size, const char* text, double x,
+    double y, int style)
+{
+    /* one font pixel; glyph cells are six font pixels wide. */
+    double pixel = 0.1 * size;
+    double advance = 6.0 * pixel;
+    double width = advance * (double)strlen(text);
+    double stroke = (OUTPUT_GRAPH_FONT_BOLD == font) ? 1.5 * pixel : pixel;
+    double originx, originy;
+    bool vertical = false;
+
+    /* find the start of the baseline. */
+    switch (style)
+    {
+        case OUTPUT_GRAPH_LABEL_CENTER:
+            originx = x - width / 2.0;
+            originy = y;
+            break;
+
+        case OUTPUT_GRAPH_LABEL_RIGHT:
+            originx = x - width;
+            originy = y;
+            break;
+
+        default:
+            originx = x;
+            originy = y - width;
+            vertical = true;
+            break;
+    }
+
+    /* add a box for each set font pixel. */
+    for (size_t i = 0; 0 != text[i]; ++i)
+    {
+        const uint8_t* glyph = raster_font_glyph(text[i]);
+
+        for (int col = 0; col < RASTER_FONT_GLYPH_WIDTH; ++col)
+        {
+            for (int row = 0; row < RASTER_FONT_GLYPH_HEIGHT; ++row)
+            {
+                if (0 == (glyph[col] & (1 << row)))
+                {
+                    continue;
+                }
+
+                /* the box in text space: u along the baseline, v up. */
+                double u0 = advance * i + pixel * (col + 0.5);
+                double u1 = u0 + stroke;
+                double v0 = pixel * (RASTER_FONT_GLYPH_HEIGHT - 1 - row);
+                double v1 = v0 + pixel;
+                double bx[4] = { u0, u1, u1, u0 };
+                double by[4] = { v0, v0, v1, v1 };
+                double px[4], py[4];
+
+                /* map the box into user space. */
+                for (int k = 0; k < 4; ++k)
+                {
+                    if (vertical)
+                    {
+                        px[k] = originx - by[k];
+                        py[k] = originy + bx[k];
+                    }
+                    else
+                    {
+                        px[k] = originx + bx[k];
+                        py[k] = originy + by[k];
+                    }
+                }
+
+                for (int k = 0; k < 4; ++k)
+                {
+                    output_graph_raster_edge(
+                        out, px[k], py[k], px[(k + 1) % 4], py[(k + 1) % 4]);
+                }
+            }
+        }
+    }
+}
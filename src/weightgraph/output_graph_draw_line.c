@@ -0,0 +1,70 @@
+/**
+ * \file weightgraph/output_graph_draw_line.c
+ *
+ * \brief Stroke a line on the graph.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <math.h>
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Stroke a line on the graph.
+ *
+ * \param out               Output file pointer.
+ * \param x0                The starting x coordinate, in points.
+ * \param y0                The starting y coordinate, in points.
+ * \param x1                The ending x coordinate, in points.
+ * \param y1                The ending y coordinate, in points.
+ * \param color             The color of the line.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status output_graph_draw_line(
+    output_graph_file* out, double x0, double y0, double x1, double y1,
+    const output_graph_color* color)
+{
+    out->color = *color;
+
+    if (WEIGHTGRAPH_FORMAT_EPS == out->format)
+    {
+        output_graph_printf(out, "newpath\n");
+        output_graph_printf(out, "%lf %lf moveto\n", x0, y0);
+        output_graph_printf(out, "%lf %lf lineto\n", x1, y1);
+        output_graph_printf(out, "closepath\n");
+        output_graph_printf(
+            out, "%g %g %g setrgbcolor\n", color->red, color->green,
+            color->blue);
+        output_graph_printf(out, "stroke\n");
+    }
+    else
+    {
+        double dx = x1 - x0;
+        double dy = y1 - y0;
+        double length = sqrt(dx * dx + dy * dy);
+
+        /* a zero-length line with butt caps paints nothing. */
+        if (0.0 == length)
+        {
+            return STATUS_SUCCESS;
+        }
+
+        /* stroke a line one point wide, but never thinner than a pixel. */
+        double half_width = 0.5 * fmax(1.0, 1.0 / out->raster_scale);
+        double nx = -dy / length * half_width;
+        double ny = dx / length * half_width;
+
+        output_graph_raster_edge(out, x0 + nx, y0 + ny, x1 + nx, y1 + ny);
+        output_graph_raster_edge(out, x1 + nx, y1 + ny, x1 - nx, y1 - ny);
+        output_graph_raster_edge(out, x1 - nx, y1 - ny, x0 - nx, y0 - ny);
+        output_graph_raster_edge(out, x0 - nx, y0 - ny, x0 + nx, y0 + ny);
+        raster_canvas_fill(out->canvas, color->red, color->green, color->blue);
+    }
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,56 @@
+/**
+ * \file weightgraph/output_graph_draw_triangle.c
+ *
+ * \brief Fill a triangle on the graph.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Fill a triangle on the graph.
+ *
+ * \param out               Output file pointer.
+ * \param x0                The x coordinate of the first vertex, in points.
+ * \param y0                The y coordinate of the first vertex, in points.
+ * \param x1                The x coordinate of the second vertex, in points.
+ * \param y1                The y coordinate of the second vertex, in points.
+ * \param x2                The x coordinate of the third vertex, in points.
+ * \param y2                The y coordinate of the third vertex, in points.
+ * \param color             The fill color.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status output_graph_draw_triangle(
+    output_graph_file* out, double x0, double y0, double x1, double y1,
+    double x2, double y2, const output_graph_color* color)
+{
+    out->color = *color;
+
+    if (WEIGHTGRAPH_FORMAT_EPS == out->format)
+    {
+        output_graph_printf(out, "newpath\n");
+        output_graph_printf(out, "%lf %lf moveto\n", x0, y0);
+        output_graph_printf(out, "%lf %lf lineto\n", x1, y1);
+        output_graph_printf(out, "%lf %lf lineto\n", x2, y2);
+        output_graph_printf(out, "%lf %lf lineto\n", x0, y0);
+        output_graph_printf(out, "closepath\n");
+        output_graph_printf(
+            out, "%g %g %g setrgbcolor\n", color->red, color->green,
+            color->blue);
+        output_graph_printf(out, "fill\n");
+    }
+    else
+    {
+        output_graph_raster_edge(out, x0, y0, x1, y1);
+        output_graph_raster_edge(out, x1, y1, x2, y2);
+        output_graph_raster_edge(out, x2, y2, x0, y0);
+        raster_canvas_fill(out->canvas, color->red, color->green, color->blue);
+    }
+
+    return STATUS_SUCCESS;
+}
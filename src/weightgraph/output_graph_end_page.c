@@ -0,0 +1,52 @@
+/**
+ * \file weightgraph/output_graph_end_page.c
+ *
+ * \brief Finish the current page of the graph.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Finish the current page of the graph.
+ *
+ * \param out               Output file pointer.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status output_graph_end_page(output_graph_file* out)
+{
+    status retval, release_retval;
+
+    out->page_open = false;
+
+    /* raster pages are encoded and closed once complete. */
+    if (WEIGHTGRAPH_FORMAT_PNG == out->format)
+    {
+        retval = raster_canvas_write_png(out->canvas, out->sink);
+
+        out->sink_open = false;
+        release_retval = out->sink->close(out->sink->context);
+        if (STATUS_SUCCESS == retval)
+        {
+            retval = release_retval;
+        }
+
+        return retval;
+    }
+
+    /* restore the graphics state of a document page and emit it. */
+    if (out->page_count > 1 || out->appendable)
+    {
+        output_graph_printf(out, "pagesave restore\n");
+        output_graph_printf(out, "showpage\n");
+    }
+
+    output_graph_printf(out, "%%%%PageTrailer\n");
+
+    return out->write_status;
+}
@@ -0,0 +1,98 @@
+/**
+ * \file weightgraph/output_graph_finalize.c
+ *
+ * \brief Write the epilogue for the graph.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Write the epilogue for the graph.
+ *
+ * The point from which a later run could append to this graph is recorded
+ * in the resume field of the output graph file.  For EPS, this is the end of
+ * the last entry plotted.  A raster page is a complete image, so a raster
+ * graph resumes from the start of its last page, which is then redrawn.
+ *
+ * \param out               Output file pointer.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status output_graph_finalize(output_graph_file* out)
+{
+    status retval, release_retval;
+
+    /* even an empty graph has a page. */
+    if (0 == out->page)
+    {
+        retval = output_graph_begin_page(out);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    /* record the resume point. */
+    out->resume.axis_min = out->axis_min;
+    out->resume.axis_max = out->axis_max;
+    out->resume.tick_step = out->tick_step;
+    if (WEIGHTGRAPH_FORMAT_EPS == out->format)
+    {
+        out->resume.prevx = out->prevx;
+        out->resume.prevy = out->prevy;
+        out->resume.page = out->page;
+        out->resume.page_entries = out->page_entries;
+        out->resume.page_open = true;
+        out->resume.offset = out->offset;
+        out->resume.count =
+            (out->page - 1) * out->page_size + out->page_entries;
+    }
+    else
+    {
+        out->resume.prevx = 50;
+        out->resume.prevy = out->page_prevy;
+        out->resume.page = out->page - 1;
+        out->resume.page_entries = 0;
+        out->resume.page_open = false;
+        out->resume.offset = 0;
+        out->resume.count = out->resume.page * out->page_size;
+    }
+
+    /* finish the last page. */
+    if (out->page_open)
+    {
+        retval = output_graph_end_page(out);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    /* raster formats have no document trailer. */
+    if (WEIGHTGRAPH_FORMAT_PNG == out->format)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    output_graph_printf(out, "%%%%Trailer\n");
+    if (out->appendable)
+    {
+        output_graph_printf(out, "%%%%Pages: %zu\n", out->page);
+    }
+    output_graph_printf(out, "%%%%EOF\n");
+
+    /* close the document. */
+    out->sink_open = false;
+    release_retval = out->sink->close(out->sink->context);
+    if (STATUS_SUCCESS != out->write_status)
+    {
+        return out->write_status;
+    }
+
+    return release_retval;
+}
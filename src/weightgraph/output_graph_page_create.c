@@ -0,0 +1,92 @@
+/**
+ * \file weightgraph/output_graph_page_create.c
+ *
+ * \brief Create a graph that renders a single page of another graph.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "weightgraph_internal.h"
+
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Create a graph that renders a single page of another graph.
+ *
+ * The page graph shares the scale and format of the parent, but has its
+ * own sink and canvas.
+ *
+ * \param page              Pointer to receive the page graph.
+ * \param parent            The graph to which the page belongs.
+ * \param number            The page number, starting at 1.
+ * \param prevy             The scaled moving average at the start of the
+ *                          page.
+ * \param sink              The sink to which the page is written.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status output_graph_page_create(
+    output_graph_file** page, output_graph_file* parent, size_t number,
+    double prevy, const weightgraph_sink* sink)
+{
+    status retval, release_retval;
+    output_graph_file* tmp;
+
+    /* allocate memory for the page graph. */
+    retval =
+        weightgraph_memory_allocate(
+            parent->alloc, WEIGHTGRAPH_MEMORY_OUTPUT, (void**)&tmp,
+            sizeof(*tmp));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* start with the settings of the parent, but none of its resources. */
+    memcpy(tmp, parent, sizeof(*tmp));
+    resource_init(&tmp->hdr, &output_graph_resource_release);
+    tmp->sink = sink;
+    tmp->sink_open = false;
+    tmp->offset = 0;
+    tmp->write_status = STATUS_SUCCESS;
+    tmp->canvas = NULL;
+
+    /* the next page started is the requested page. */
+    tmp->page = number - 1;
+    tmp->page_entries = 0;
+    tmp->page_open = false;
+    tmp->prevy = prevy;
+
+    /* raster pages are drawn on their own canvas. */
+    if (WEIGHTGRAPH_FORMAT_PNG == tmp->format)
+    {
+        retval =
+            raster_canvas_create(
+                &tmp->canvas, tmp->alloc, parent->canvas->width,
+                parent->canvas->height);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_tmp;
+        }
+    }
+
+    /* success. */
+    *page = tmp;
+    retval = STATUS_SUCCESS;
+    goto done;
+
+cleanup_tmp:
+    release_retval = resource_release(&tmp->hdr);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+done:
+    return retval;
+}
@@ -0,0 +1,290 @@
+/**
+ * \file weightgraph/output_graph_plot.c
+ *
+ * \brief Plot a weight on the graph.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <math.h>
+
+#include "weightgraph_internal.h"
+
+/* forward decls. */
+static status output_graph_plot_rejected(
+    output_graph_file* out, double x, double average_y, double weight,
+    double moving_average, const char* average_text, const char* weight_text);
+
+/**
+ * \brief Plot a weight on the graph.
+ *
+ * \param out               Output file pointer.
+ * \param date              The date for this entry.
+ * \param weight            The weight for this entry.
+ * \param moving_average    The moving average for this entry.
+ * \param rejected          true if the outlier filter rejected the weight.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status output_graph_plot(
+    output_graph_file* out, const char* date, double weight,
+    double moving_average, bool rejected)
+{
+    status retval;
+    static const output_graph_color black = { 0.0, 0.0, 0.0 };
+    static const output_graph_color blue = { 0.0, 0.0, 1.0 };
+    static const output_graph_color red = { 1.0, 0.0, 0.0 };
+    double x, average_y, weight_y;
+    char average_text[32];
+    char weight_text[32];
+
+    /* finish the current page when it is full. */
+    if (out->page_open && out->page_entries >= out->page_size)
+    {
+        retval = output_graph_end_page(out);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto done;
+        }
+    }
+
+    /* start a new page if needed. */
+    if (!out->page_open)
+    {
+        retval = output_graph_begin_page(out);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto done;
+        }
+    }
+
+    x = out->xskip + out->prevx;
+    average_y = moving_average * out->yscale + out->yoffset;
+    weight_y = weight * out->yscale + out->yoffset;
+
+    snprintf(average_text, sizeof(average_text), "%3.1lf", moving_average);
+    snprintf(weight_text, sizeof(weight_text), "%3.1lf", weight);
+
+    /* draw a line from the previous average to this one. */
+    retval =
+        output_graph_draw_line(
+            out, out->prevx, out->prevy + out->yoffset, x, average_y, &black);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* a rejected weight is crossed out, whichever side of the average it
+     * lies. */
+    if (rejected)
+    {
+        retval =
+            output_graph_plot_rejected(
+                out, x, average_y, weight, moving_average, average_text,
+                weight_text);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto done;
+        }
+    }
+    /* if the weight is less than the average, draw a sinker. */
+    else if (weight < moving_average)
+    {
+        /* draw a line in blue from the average to the weight. */
+        retval =
+            output_graph_draw_line(
+                out, x, average_y, x, weight_y, &blue);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto done;
+        }
+
+        /* a sinker triangle points down and is centered on the weight. */
+        retval =
+            output_graph_draw_triangle(
+                out,
+                x - 4.0, weight * out->yscale + 4.0 + out->yoffset,
+                x + 4.0, weight * out->yscale + 4.0 + out->yoffset,
+                x, weight * out->yscale - 4.0 + out->yoffset,
+                &blue);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto done;
+        }
+
+        /* print the moving average above the point. */
+        retval =
+            output_graph_draw_label(
+                out, OUTPUT_GRAPH_FONT_REGULAR, 8, average_text, x,
+                average_y + 15.0, OUTPUT_GRAPH_LABEL_CENTER, &black);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto done;
+        }
+
+        /* print the weight below the sinker. */
+        retval =
+            output_graph_draw_label(
+                out, OUTPUT_GRAPH_FONT_REGULAR, 8, weight_text, x,
+                weight_y - 15.0, OUTPUT_GRAPH_LABEL_CENTER, &blue);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto done;
+        }
+    }
+    /* otherwise, draw a floater. */
+    else
+    {
+        /* draw a line in red from the average to the weight. */
+        retval =
+            output_graph_draw_line(
+                out, x, average_y, x, weight_y, &red);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto done;
+        }
+
+        /* a floater triangle points up and is centered on the weight. */
+        retval =
+            output_graph_draw_triangle(
+                out,
+                x - 4.0, weight * out->yscale - 4.0 + out->yoffset,
+                x + 4.0, weight * out->yscale - 4.0 + out->yoffset,
+                x, weight * out->yscale + 4.0 + out->yoffset,
+                &red);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto done;
+        }
+
+        /* print the moving average below the point. */
+        retval =
+            output_graph_draw_label(
+                out, OUTPUT_GRAPH_FONT_REGULAR, 8, average_text, x,
+                average_y - 15.0, OUTPUT_GRAPH_LABEL_CENTER, &black);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto done;
+        }
+
+        /* print the weight above the floater. */
+        retval =
+            output_graph_draw_label(
+                out, OUTPUT_GRAPH_FONT_REGULAR, 8, weight_text, x,
+                weight_y + 15.0, OUTPUT_GRAPH_LABEL_CENTER, &red);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto done;
+        }
+    }
+
+    /* draw a circle where the plot point is. */
+    retval = output_graph_draw_circle(out, x, average_y, 5.0, &black);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* add the date to the bottom. */
+    retval =
+        output_graph_draw_label(
+            out, OUTPUT_GRAPH_FONT_BOLD, 15, date, x, 45.0,
+            OUTPUT_GRAPH_LABEL_VERTICAL, NULL);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* adjust the x and y values. */
+    out->prevx += out->xskip;
+    out->prevy = moving_average * out->yscale;
+    ++out->page_entries;
+
+    /* success. */
+    retval = STATUS_SUCCESS;
+    goto done;
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Draw a weight rejected by the outlier filter.
+ *
+ * The weight is drawn in gray, and crossed out.  As it was left out of the
+ * range of the weights, it may lie beyond the Y-axis, in which case it is
+ * drawn at the end of the axis, and only its label gives its value.
+ *
+ * \param out               Output file pointer.
+ * \param x                 The x coordinate of the entry, in points.
+ * \param average_y         The y coordinate of the moving average, in points.
+ * \param weight            The weight for this entry.
+ * \param moving_average    The moving average for this entry.
+ * \param average_text      The label of the moving average.
+ * \param weight_text       The label of the weight.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status output_graph_plot_rejected(
+    output_graph_file* out, double x, double average_y, double weight,
+    double moving_average, const char* average_text, const char* weight_text)
+{
+    status retval;
+    static const output_graph_color black = { 0.0, 0.0, 0.0 };
+    static const output_graph_color gray = { 0.6, 0.6, 0.6 };
+    double clamped = fmin(fmax(weight, out->axis_min), out->axis_max);
+    double weight_y = clamped * out->yscale + out->yoffset;
+    double side = (weight < moving_average) ? -1.0 : 1.0;
+
+    /* draw a line in gray from the average to the weight. */
+    retval =
+        output_graph_draw_line(out, x, average_y, x, weight_y, &gray);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* cross out the weight. */
+    retval =
+        output_graph_draw_line(
+            out, x - 4.0, weight_y - 4.0, x + 4.0, weight_y + 4.0, &gray);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval =
+        output_graph_draw_line(
+            out, x - 4.0, weight_y + 4.0, x + 4.0, weight_y - 4.0, &gray);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* print the moving average on the other side of the point. */
+    retval =
+        output_graph_draw_label(
+            out, OUTPUT_GRAPH_FONT_REGULAR, 8, average_text, x,
+            average_y - side * 15.0, OUTPUT_GRAPH_LABEL_CENTER, &black);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* print the weight beyond the cross, or inside it at the end of the
+     * axis. */
+    if (clamped != weight)
+    {
+        side = -side;
+    }
+
+    return
+        output_graph_draw_label(
+            out, OUTPUT_GRAPH_FONT_REGULAR, 8, weight_text, x,
+            weight_y + side * 15.0, OUTPUT_GRAPH_LABEL_CENTER, &gray);
+}
@@ -0,0 +1,399 @@
+/**
+ * \file weightgraph/output_graph_plot_pages.c
+ *
+ * \brief Plot a series of samples, rendering pages in parallel.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#include "weightgraph_internal.h"
+
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Shared state for the page rendering threads.
+ */
+typedef struct output_graph_page_job output_graph_page_job;
+
+struct output_graph_page_job
+{
+    output_graph_file* out;
+    const weightgraph_session* session;
+    size_t count;
+    /* the number of pages rendered by the threads. */
+    size_t pages;
+    /* the next page to be claimed by a thread, starting at 0. */
+    atomic_size_t next_page;
+    /* the rendered output for each page. */
+    output_graph_buffer* buffers;
+    /* the status of each page. */
+    status* results;
+};
+
+/* forward decls. */
+static status output_graph_plot_range(
+    output_graph_file* out, const weightgraph_session* session, size_t first,
+    size_t last);
+static status output_graph_write_page(
+    output_graph_file* out, size_t number, const output_graph_buffer* buffer);
+static void* output_graph_page_thread(void* context);
+static status output_graph_render_page(
+    output_graph_page_job* job, size_t index);
+
+/**
+ * \brief Plot a series of samples on the graph, rendering pages in parallel.
+ *
+ * Each page is rendered independently, starting from the moving average of
+ * the sample before it, into its own buffer.  The buffers are then written
+ * to the output in page order, so the result is identical to plotting each
+ * sample in turn with \ref output_graph_plot.  The last page is plotted in
+ * place, leaving it open as a serial plot would.  Only the calling thread
+ * writes to the sink of the graph.  The graph must not have had any samples
+ * plotted on it yet.
+ *
+ * \param out               Output file pointer.
+ * \param session           The session holding the samples to plot.
+ * \param threads           The number of threads to use.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status output_graph_plot_pages(
+    output_graph_file* out, const weightgraph_session* session,
+    size_t threads)
+{
+    status retval, release_retval;
+    weightgraph_sample sample;
+    size_t count = session->count;
+    output_graph_page_job job;
+    pthread_t* workers;
+    size_t started = 0;
+    size_t pages = out->page_count - 1;
+    size_t first;
+
+    /* a single page or thread is plotted in place. */
+    if (threads <= 1 || out->page_count <= 1)
+    {
+        return output_graph_plot_range(out, session, 0, count);
+    }
+
+    /* there is no use for more threads than pages. */
+    if (threads > pages)
+    {
+        threads = pages;
+    }
+
+    /* set up the job. */
+    memset(&job, 0, sizeof(job));
+    job.out = out;
+    job.session = session;
+    job.count = count;
+    job.pages = pages;
+    atomic_init(&job.next_page, 0);
+
+    /* allocate the per-page results. */
+    retval =
+        weightgraph_memory_allocate(
+            out->alloc, WEIGHTGRAPH_MEMORY_OUTPUT, (void**)&job.buffers,
+            pages * sizeof(output_graph_buffer));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+    memset(job.buffers, 0, pages * sizeof(output_graph_buffer));
+
+    retval =
+        weightgraph_memory_allocate(
+            out->alloc, WEIGHTGRAPH_MEMORY_OUTPUT, (void**)&job.results,
+            pages * sizeof(status));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_buffers;
+    }
+    memset(job.results, 0, pages * sizeof(status));
+
+    retval =
+        weightgraph_memory_allocate(
+            out->alloc, WEIGHTGRAPH_MEMORY_OUTPUT, (void**)&workers,
+            threads * sizeof(pthread_t));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_results;
+    }
+
+    /* start the threads. */
+    for (started = 0; started < threads; ++started)
+    {
+        if (0 !=
+            pthread_create(
+                &workers[started], NULL, &output_graph_page_thread, &job))
+        {
+            break;
+        }
+    }
+
+    /* if no thread could be started, render the pages on this one. */
+    if (0 == started)
+    {
+        output_graph_page_thread(&job);
+    }
+
+    /* wait for every page to be rendered. */
+    for (size_t i = 0; i < started; ++i)
+    {
+        pthread_join(workers[i], NULL);
+    }
+
+    /* write the pages in order. */
+    retval = STATUS_SUCCESS;
+    for (size_t i = 0; i < pages; ++i)
+    {
+        if (STATUS_SUCCESS != job.results[i])
+        {
+            retval = job.results[i];
+            break;
+        }
+
+        retval = output_graph_write_page(out, i + 1, &job.buffers[i]);
+        if (STATUS_SUCCESS != retval)
+        {
+            break;
+        }
+    }
+
+    /* plot the last page in place, from where the rendered pages end. */
+    if (STATUS_SUCCESS == retval)
+    {
+        first = pages * out->page_size;
+        out->page = pages;
+        out->page_open = false;
+        weightgraph_session_sample(session, first - 1, &sample);
+        out->prevy = sample.moving_average * out->yscale;
+
+        retval = output_graph_plot_range(out, session, first, count);
+    }
+
+    goto cleanup_workers;
+
+cleanup_workers:
+    release_retval =
+        weightgraph_memory_reclaim(
+            out->alloc, WEIGHTGRAPH_MEMORY_OUTPUT, workers,
+            threads * sizeof(pthread_t));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_results:
+    release_retval =
+        weightgraph_memory_reclaim(
+            out->alloc, WEIGHTGRAPH_MEMORY_OUTPUT, job.results,
+            pages * sizeof(status));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_buffers:
+    /* page buffer data is allocated from the C heap. */
+    for (size_t i = 0; i < pages; ++i)
+    {
+        weightgraph_memory_reclaim(
+            NULL, WEIGHTGRAPH_MEMORY_OUTPUT, job.buffers[i].data,
+            job.buffers[i].capacity);
+    }
+
+    release_retval =
+        weightgraph_memory_reclaim(
+            out->alloc, WEIGHTGRAPH_MEMORY_OUTPUT, job.buffers,
+            pages * sizeof(output_graph_buffer));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Plot a range of samples in place, in order.
+ *
+ * \param out               Output file pointer.
+ * \param session           The session holding the samples.
+ * \param first             The index of the first sample to plot.
+ * \param last              One past the index of the last sample to plot.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status output_graph_plot_range(
+    output_graph_file* out, const weightgraph_session* session, size_t first,
+    size_t last)
+{
+    status retval;
+    weightgraph_sample sample;
+
+    for (size_t i = first; i < last; ++i)
+    {
+        weightgraph_session_sample(session, i, &sample);
+        retval =
+            output_graph_plot(
+                out, sample.date, sample.weight, sample.moving_average,
+                sample.rejected);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Write a page rendered into memory to the output of the graph.
+ *
+ * EPS pages are part of the open document.  Each raster page is a separate
+ * image, written to its own sink output.
+ *
+ * \param out               Output file pointer.
+ * \param number            The page number, starting at 1.
+ * \param buffer            The rendered page.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status output_graph_write_page(
+    output_graph_file* out, size_t number, const output_graph_buffer* buffer)
+{
+    status retval, release_retval;
+
+    if (WEIGHTGRAPH_FORMAT_EPS == out->format)
+    {
+        output_graph_write(out, buffer->data, buffer->size);
+
+        return out->write_status;
+    }
+
+    retval = out->sink->open(out->sink->context, number, 0);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = out->sink->write(out->sink->context, buffer->data, buffer->size);
+
+    release_retval = out->sink->close(out->sink->context);
+    if (STATUS_SUCCESS == retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Render pages until none remain.
+ *
+ * \param context           The page job.
+ *
+ * \returns NULL.
+ */
+static void* output_graph_page_thread(void* context)
+{
+    output_graph_page_job* job = (output_graph_page_job*)context;
+    size_t index;
+
+    while (
+        (index = atomic_fetch_add(&job->next_page, 1)) < job->pages)
+    {
+        job->results[index] = output_graph_render_page(job, index);
+    }
+
+    return NULL;
+}
+
+/**
+ * \brief Render a single page.
+ *
+ * \param job               The page job.
+ * \param index             The index of the page, starting at 0.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status output_graph_render_page(
+    output_graph_page_job* job, size_t index)
+{
+    status retval, release_retval;
+    output_graph_file* page;
+    output_graph_file* out = job->out;
+    size_t first = index * out->page_size;
+    size_t last = first + out->page_size;
+    double prevy = out->prevy;
+    weightgraph_sample sample;
+    weightgraph_sink sink;
+
+    /* the page starts at the moving average of the sample before it. */
+    if (first > 0)
+    {
+        weightgraph_session_sample(job->session, first - 1, &sample);
+        prevy = sample.moving_average * out->yscale;
+    }
+
+    if (last > job->count)
+    {
+        last = job->count;
+    }
+
+    /* create the page graph, which is rendered into memory. */
+    output_graph_buffer_sink_init(&sink, &job->buffers[index]);
+    retval = output_graph_page_create(&page, out, index + 1, prevy, &sink);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* render the page. */
+    retval = output_graph_begin_page(page);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_page;
+    }
+
+    for (size_t i = first; i < last; ++i)
+    {
+        weightgraph_session_sample(job->session, i, &sample);
+        retval =
+            output_graph_plot(
+                page, sample.date, sample.weight, sample.moving_average,
+                sample.rejected);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_page;
+        }
+    }
+
+    retval = output_graph_end_page(page);
+    goto cleanup_page;
+
+cleanup_page:
+    release_retval = resource_release(&page->hdr);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+done:
+    return retval;
+}
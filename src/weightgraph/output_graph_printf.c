@@ -0,0 +1,65 @@
+/**
+ * \file weightgraph/output_graph_printf.c
+ *
+ * \brief Write formatted text to the current output of the graph.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <stdarg.h>
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Write formatted text to the current output of the graph.
+ *
+ * Errors are recorded in the write status of the graph, and checked when
+ * the output is closed.
+ *
+ * \param out               Output file pointer.
+ * \param format            The printf-style format string.
+ */
+void output_graph_printf(output_graph_file* out, const char* format, ...)
+{
+    va_list args;
+    char line[256];
+    char* text = line;
+    int length;
+
+    /* most lines fit in the stack buffer. */
+    va_start(args, format);
+    length = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (length < 0)
+    {
+        out->write_status = ERROR_OUTPUT_WRITE;
+        return;
+    }
+
+    /* longer lines, such as long labels, are formatted on the heap. */
+    if ((size_t)length >= sizeof(line))
+    {
+        status retval =
+            weightgraph_memory_allocate(
+                NULL, WEIGHTGRAPH_MEMORY_OUTPUT, (void**)&text,
+                (size_t)length + 1);
+        if (STATUS_SUCCESS != retval)
+        {
+            out->write_status = retval;
+            return;
+        }
+
+        va_start(args, format);
+        vsnprintf(text, (size_t)length + 1, format, args);
+        va_end(args);
+    }
+
+    output_graph_write(out, text, (size_t)length);
+
+    if (text != line)
+    {
+        weightgraph_memory_reclaim(
+            NULL, WEIGHTGRAPH_MEMORY_OUTPUT, text, (size_t)length + 1);
+    }
+}
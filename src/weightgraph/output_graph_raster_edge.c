@@ -0,0 +1,30 @@
+/**
+ * \file weightgraph/output_graph_raster_edge.c
+ *
+ * \brief Add an edge to the raster canvas of an output graph.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Add an edge, in points, to the raster canvas of this graph.
+ *
+ * \param out               Output file pointer.
+ * \param x0                The starting x coordinate, in points.
+ * \param y0                The starting y coordinate, in points.
+ * \param x1                The ending x coordinate, in points.
+ * \param y1                The ending y coordinate, in points.
+ */
+void output_graph_raster_edge(
+    output_graph_file* out, double x0, double y0, double x1, double y1)
+{
+    double height = (double)out->canvas->height;
+
+    /* points have their origin at the bottom-left; pixels at the top-left. */
+    raster_canvas_edge(
+        out->canvas, x0 * out->raster_scale, height - y0 * out->raster_scale,
+        x1 * out->raster_scale, height - y1 * out->raster_scale);
+}
@@ -0,0 +1,59 @@
+/**
+ * \file weightgraph/output_graph_resource_release.c
+ *
+ * \brief Release an output graph resource.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Release an output graph file resource.
+ *
+ * \param r         The resource to release.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status output_graph_resource_release(RCPR_SYM(resource)* r)
+{
+    status canvas_retval = STATUS_SUCCESS;
+    status reclaim_retval;
+    output_graph_file* out = (output_graph_file*)r;
+
+    /* cache allocator. */
+    allocator* alloc = out->alloc;
+
+    /* release the raster canvas if set. */
+    if (NULL != out->canvas)
+    {
+        canvas_retval = resource_release(&out->canvas->hdr);
+    }
+
+    /* close the sink output if it is still open. */
+    if (out->sink_open)
+    {
+        out->sink->close(out->sink->context);
+    }
+
+    /* reclaim memory. */
+    reclaim_retval =
+        weightgraph_memory_reclaim(
+            alloc, WEIGHTGRAPH_MEMORY_OUTPUT, out, sizeof(*out));
+
+    /* decode response. */
+    if (STATUS_SUCCESS != canvas_retval)
+    {
+        return canvas_retval;
+    }
+    else
+    {
+        return reclaim_retval;
+    }
+}
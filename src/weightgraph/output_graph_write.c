@@ -0,0 +1,40 @@
+/**
+ * \file weightgraph/output_graph_write.c
+ *
+ * \brief Write data to the current output of the graph.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Write data to the current output of the graph.
+ *
+ * Errors are recorded in the write status of the graph, and checked when
+ * the output is closed.
+ *
+ * \param out               Output file pointer.
+ * \param data              The data to write.
+ * \param size              The size of the data.
+ */
+void output_graph_write(output_graph_file* out, const void* data, size_t size)
+{
+    status retval;
+
+    /* once a write fails, the output is abandoned. */
+    if (STATUS_SUCCESS != out->write_status || 0 == size)
+    {
+        return;
+    }
+
+    retval = out->sink->write(out->sink->context, data, size);
+    if (STATUS_SUCCESS != retval)
+    {
+        out->write_status = retval;
+        return;
+    }
+
+    out->offset += (long)size;
+}
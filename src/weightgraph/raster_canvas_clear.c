@@ -0,0 +1,22 @@
+/**
+ * \file weightgraph/raster_canvas_clear.c
+ *
+ * \brief Clear a raster canvas.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "raster_internal.h"
+
+/**
+ * \brief Clear a raster canvas to opaque white.
+ *
+ * \param canvas        The canvas to clear.
+ */
+void raster_canvas_clear(raster_canvas* canvas)
+{
+    memset(canvas->pixels, 0xff, canvas->width * canvas->height * 4);
+}
@@ -0,0 +1,94 @@
+/**
+ * \file weightgraph/raster_canvas_create.c
+ *
+ * \brief Create a raster canvas.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "raster_internal.h"
+
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Create a raster canvas, cleared to opaque white.
+ *
+ * \param canvas        Pointer to receive the canvas.
+ * \param alloc         The allocator to use for this operation.
+ * \param width         The width of the canvas, in pixels.
+ * \param height        The height of the canvas, in pixels.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status raster_canvas_create(
+    raster_canvas** canvas, RCPR_SYM(allocator)* alloc, size_t width,
+    size_t height)
+{
+    status retval, release_retval;
+    raster_canvas* tmp;
+
+    /* allocate memory for the canvas. */
+    retval =
+        weightgraph_memory_allocate(
+            alloc, WEIGHTGRAPH_MEMORY_RASTER, (void**)&tmp, sizeof(*tmp));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* clear memory. */
+    memset(tmp, 0, sizeof(*tmp));
+
+    /* set initial values. */
+    resource_init(&tmp->hdr, &raster_canvas_resource_release);
+    tmp->alloc = alloc;
+    tmp->width = width;
+    tmp->height = height;
+    tmp->dirty_x0 = tmp->dirty_y0 = SIZE_MAX;
+
+    /* allocate the pixel buffer. */
+    retval =
+        weightgraph_memory_allocate(
+            alloc, WEIGHTGRAPH_MEMORY_RASTER, (void**)&tmp->pixels,
+            width * height * 4);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_tmp;
+    }
+
+    /* start with an opaque white background. */
+    raster_canvas_clear(tmp);
+
+    /* allocate the accumulation buffer. */
+    retval =
+        weightgraph_memory_allocate(
+            alloc, WEIGHTGRAPH_MEMORY_RASTER, (void**)&tmp->accum,
+            (width + 2) * height * sizeof(float));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_tmp;
+    }
+
+    /* the accumulation buffer starts empty. */
+    memset(tmp->accum, 0, (width + 2) * height * sizeof(float));
+
+    /* success. */
+    *canvas = tmp;
+    retval = STATUS_SUCCESS;
+    goto done;
+
+cleanup_tmp:
+    release_retval = resource_release(&tmp->hdr);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+done:
+    return retval;
+}
@@ -0,0 +1,239 @@
+/**
+ * \file weightgraph/raster_canvas_edge.c
+ *
+ * \brief Add an outline edge to the canvas accumulation buffer.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <math.h>
+
+#include "raster_internal.h"
+
+/* forward decls. */
+static void raster_canvas_accumulate(
+    raster_canvas* canvas, double x0, double y0, double x1, double y1);
+
+/**
+ * \brief Add an outline edge to the canvas accumulation buffer.
+ *
+ * Coordinates are in device pixels, with the origin at the top-left corner.
+ * The outline of a shape must be closed before \ref raster_canvas_fill is
+ * called.
+ *
+ * \param canvas        The canvas.
+ * \param x0            The starting x coordinate.
+ * \param y0            The starting y coordinate.
+ * \param x1            The ending x coordinate.
+ * \param y1            The ending y coordinate.
+ */
+void raster_canvas_edge(
+    raster_canvas* canvas, double x0, double y0, double x1, double y1)
+{
+    double width = (double)canvas->width;
+    double splits[4];
+    int split_count = 0;
+
+    /* horizontal edges contribute no area. */
+    if (y0 == y1)
+    {
+        return;
+    }
+
+    /* find where this edge crosses the left and right canvas boundaries. */
+    splits[split_count++] = 0.0;
+    if (x0 != x1)
+    {
+        double tleft = (0.0 - x0) / (x1 - x0);
+        double tright = (width - x0) / (x1 - x0);
+
+        if (tleft > 0.0 && tleft < 1.0)
+        {
+            splits[split_count++] = tleft;
+        }
+
+        if (tright > 0.0 && tright < 1.0)
+        {
+            splits[split_count++] = tright;
+        }
+
+        /* keep the split points in order. */
+        if (3 == split_count && splits[1] > splits[2])
+        {
+            double t = splits[1];
+            splits[1] = splits[2];
+            splits[2] = t;
+        }
+    }
+    splits[split_count++] = 1.0;
+
+    /* accumulate each piece, projecting off-canvas pieces onto the edge. */
+    for (int i = 0; i + 1 < split_count; ++i)
+    {
+        double ta = splits[i];
+        double tb = splits[i + 1];
+        double xa = x0 + (x1 - x0) * ta;
+        double ya = y0 + (y1 - y0) * ta;
+        double xb = x0 + (x1 - x0) * tb;
+        double yb = y0 + (y1 - y0) * tb;
+        double xmid = 0.5 * (xa + xb);
+
+        if (xmid < 0.0)
+        {
+            /* area left of the canvas covers every visible pixel. */
+            xa = xb = 0.0;
+        }
+        else if (xmid > width)
+        {
+            /* area right of the canvas covers no visible pixel. */
+            xa = xb = width;
+        }
+        else
+        {
+            xa = fmin(fmax(xa, 0.0), width);
+            xb = fmin(fmax(xb, 0.0), width);
+        }
+
+        raster_canvas_accumulate(canvas, xa, ya, xb, yb);
+    }
+}
+
+/**
+ * \brief Accumulate the signed area of an edge that lies within the
+ * horizontal bounds of the canvas.
+ *
+ * \param canvas        The canvas.
+ * \param x0            The starting x coordinate.
+ * \param y0            The starting y coordinate.
+ * \param x1            The ending x coordinate.
+ * \param y1            The ending y coordinate.
+ */
+static void raster_canvas_accumulate(
+    raster_canvas* canvas, double x0, double y0, double x1, double y1)
+{
+    size_t stride = canvas->width + 2;
+    size_t ystart, yend, xmin, xmax;
+    double dir, dxdy, x;
+
+    /* walk the edge from top to bottom, remembering its winding. */
+    if (y0 < y1)
+    {
+        dir = 1.0;
+    }
+    else
+    {
+        double t;
+        dir = -1.0;
+        t = x0;
+        x0 = x1;
+        x1 = t;
+        t = y0;
+        y0 = y1;
+        y1 = t;
+    }
+
+    /* skip edges that lie entirely above or below the canvas. */
+    if (y1 <= 0.0 || y0 >= (double)canvas->height)
+    {
+        return;
+    }
+
+    dxdy = (x1 - x0) / (y1 - y0);
+    x = x0;
+
+    /* clip the top of the edge to the canvas. */
+    if (y0 < 0.0)
+    {
+        x -= y0 * dxdy;
+        ystart = 0;
+    }
+    else
+    {
+        ystart = (size_t)y0;
+    }
+
+    /* clip the bottom of the edge to the canvas. */
+    yend = (size_t)ceil(y1);
+    if (yend > canvas->height)
+    {
+        yend = canvas->height;
+    }
+
+    /* grow the dirty region. */
+    xmin = (size_t)floor(fmin(x0, x1));
+    xmax = (size_t)ceil(fmax(x0, x1)) + 1;
+    if (xmin < canvas->dirty_x0)
+    {
+        canvas->dirty_x0 = xmin;
+    }
+    if (xmax > canvas->width + 1)
+    {
+        xmax = canvas->width + 1;
+    }
+    if (xmax > canvas->dirty_x1)
+    {
+        canvas->dirty_x1 = xmax;
+    }
+    if (ystart < canvas->dirty_y0)
+    {
+        canvas->dirty_y0 = ystart;
+    }
+    if (yend > canvas->dirty_y1)
+    {
+        canvas->dirty_y1 = yend;
+    }
+
+    /* accumulate the area covered on each scanline. */
+    for (size_t y = ystart; y < yend; ++y)
+    {
+        float* row = canvas->accum + y * stride;
+        double dy = fmin((double)(y + 1), y1) - fmax((double)y, y0);
+        double xnext = x + dxdy * dy;
+        double d = dy * dir;
+        double xa = fmin(x, xnext);
+        double xb = fmax(x, xnext);
+        double xafloor = floor(xa);
+        double xbceil = ceil(xb);
+        size_t xai = (size_t)xafloor;
+        size_t xbi = (size_t)xbceil;
+
+        if (xbi <= xai + 1)
+        {
+            /* the edge stays within a single pixel on this scanline. */
+            double xmf = 0.5 * (x + xnext) - xafloor;
+            row[xai] += d - d * xmf;
+            row[xai + 1] += d * xmf;
+        }
+        else
+        {
+            /* the edge spans several pixels on this scanline. */
+            double s = 1.0 / (xb - xa);
+            double xaf = xa - xafloor;
+            double a0 = 0.5 * s * (1.0 - xaf) * (1.0 - xaf);
+            double xbf = xb - xbceil + 1.0;
+            double am = 0.5 * s * xbf * xbf;
+
+            row[xai] += d * a0;
+            if (xbi == xai + 2)
+            {
+                row[xai + 1] += d * (1.0 - a0 - am);
+            }
+            else
+            {
+                double a1 = s * (1.5 - xaf);
+                double a2 = a1 + (double)(xbi - xai - 3) * s;
+
+                row[xai + 1] += d * (a1 - a0);
+                for (size_t xi = xai + 2; xi < xbi - 1; ++xi)
+                {
+                    row[xi] += d * s;
+                }
+                row[xbi - 1] += d * (1.0 - a2 - am);
+            }
+            row[xbi] += d * am;
+        }
+
+        x = xnext;
+    }
+}
@@ -0,0 +1,59 @@
+/**
+ * \file weightgraph/raster_canvas_fill.c
+ *
+ * \brief Fill the accumulated outlines on a raster canvas.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <math.h>
+
+#include "raster_internal.h"
+
+/**
+ * \brief Fill the outlines accumulated since the last fill with the given
+ * color, and clear the accumulation buffer.
+ *
+ * \param canvas        The canvas.
+ * \param red           The red component, from 0.0 to 1.0.
+ * \param green         The green component, from 0.0 to 1.0.
+ * \param blue          The blue component, from 0.0 to 1.0.
+ */
+void raster_canvas_fill(
+    raster_canvas* canvas, double red, double green, double blue)
+{
+    size_t stride = canvas->width + 2;
+    double color[3] = { red * 255.0, green * 255.0, blue * 255.0 };
+
+    /* integrate the coverage across each touched scanline. */
+    for (size_t y = canvas->dirty_y0; y < canvas->dirty_y1; ++y)
+    {
+        float* row = canvas->accum + y * stride;
+        uint8_t* pixel = canvas->pixels + (y * canvas->width) * 4;
+        double area = 0.0;
+
+        for (size_t x = canvas->dirty_x0; x <= canvas->dirty_x1; ++x)
+        {
+            area += row[x];
+            row[x] = 0.0f;
+
+            /* blend the covered fraction of this pixel. */
+            double coverage = fmin(fabs(area), 1.0);
+            if (x < canvas->width && coverage > 0.0)
+            {
+                uint8_t* p = pixel + x * 4;
+                for (int c = 0; c < 3; ++c)
+                {
+                    p[c] =
+                        (uint8_t)lround(
+                            p[c] + (color[c] - p[c]) * coverage);
+                }
+            }
+        }
+    }
+
+    /* the accumulation buffer is now empty. */
+    canvas->dirty_x0 = canvas->dirty_y0 = SIZE_MAX;
+    canvas->dirty_x1 = canvas->dirty_y1 = 0;
+}
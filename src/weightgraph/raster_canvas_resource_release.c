@@ -0,0 +1,70 @@
+/**
+ * \file weightgraph/raster_canvas_resource_release.c
+ *
+ * \brief Release a raster canvas resource.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "raster_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Release a raster canvas resource.
+ *
+ * \param r         The resource to release.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status raster_canvas_resource_release(RCPR_SYM(resource)* r)
+{
+    status pixels_retval = STATUS_SUCCESS;
+    status accum_retval = STATUS_SUCCESS;
+    status reclaim_retval;
+    raster_canvas* canvas = (raster_canvas*)r;
+
+    /* cache allocator. */
+    allocator* alloc = canvas->alloc;
+
+    /* reclaim the pixel buffer if set. */
+    if (NULL != canvas->pixels)
+    {
+        pixels_retval =
+            weightgraph_memory_reclaim(
+                alloc, WEIGHTGRAPH_MEMORY_RASTER, canvas->pixels,
+                canvas->width * canvas->height * 4);
+    }
+
+    /* reclaim the accumulation buffer if set. */
+    if (NULL != canvas->accum)
+    {
+        accum_retval =
+            weightgraph_memory_reclaim(
+                alloc, WEIGHTGRAPH_MEMORY_RASTER, canvas->accum,
+                (canvas->width + 2) * canvas->height * sizeof(float));
+    }
+
+    /* reclaim memory. */
+    reclaim_retval =
+        weightgraph_memory_reclaim(
+            alloc, WEIGHTGRAPH_MEMORY_RASTER, canvas, sizeof(*canvas));
+
+    /* decode response. */
+    if (STATUS_SUCCESS != pixels_retval)
+    {
+        return pixels_retval;
+    }
+    else if (STATUS_SUCCESS != accum_retval)
+    {
+        return accum_retval;
+    }
+    else
+    {
+        return reclaim_retval;
+    }
+}
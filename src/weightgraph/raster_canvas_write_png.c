@@ -0,0 +1,210 @@
+/**
+ * \file weightgraph/raster_canvas_write_png.c
+ *
+ * \brief Encode a raster canvas as a PNG image.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+#include <zlib.h>
+
+#include "raster_internal.h"
+
+/* forward decls. */
+static status raster_png_chunk(
+    const weightgraph_sink* sink, const char* type, const uint8_t* data,
+    size_t size);
+static void raster_png_be32(uint8_t* out, uint32_t value);
+
+/**
+ * \brief Encode the canvas as a PNG image and write it to the given sink.
+ *
+ * \param canvas        The canvas to encode.
+ * \param sink          The sink to which the image is written.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status raster_canvas_write_png(
+    raster_canvas* canvas, const weightgraph_sink* sink)
+{
+    status retval, release_retval;
+    static const uint8_t signature[8] =
+        { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    uint8_t header[13];
+    size_t row_size = canvas->width * 4 + 1;
+    size_t raw_size = row_size * canvas->height;
+    uLong compressed_capacity = compressBound(raw_size);
+    uLongf compressed_size = compressed_capacity;
+    uint8_t* raw;
+    uint8_t* compressed;
+
+    /* allocate the filtered scanline buffer. */
+    retval =
+        weightgraph_memory_allocate(
+            canvas->alloc, WEIGHTGRAPH_MEMORY_RASTER, (void**)&raw, raw_size);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* allocate the compressed data buffer. */
+    retval =
+        weightgraph_memory_allocate(
+            canvas->alloc, WEIGHTGRAPH_MEMORY_RASTER, (void**)&compressed,
+            compressed_capacity);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_raw;
+    }
+
+    /* each scanline is prefixed with a filter type of None. */
+    for (size_t y = 0; y < canvas->height; ++y)
+    {
+        raw[y * row_size] = 0;
+        memcpy(
+            raw + y * row_size + 1, canvas->pixels + y * canvas->width * 4,
+            canvas->width * 4);
+    }
+
+    /* compress the image data. */
+    if (Z_OK != compress(compressed, &compressed_size, raw, raw_size))
+    {
+        retval = ERROR_PNG_ENCODE;
+        goto cleanup_compressed;
+    }
+
+    /* write the signature. */
+    retval = sink->write(sink->context, signature, sizeof(signature));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_compressed;
+    }
+
+    /* 8-bit RGBA, deflate, adaptive filtering, no interlace. */
+    raster_png_be32(header, (uint32_t)canvas->width);
+    raster_png_be32(header + 4, (uint32_t)canvas->height);
+    header[8] = 8;
+    header[9] = 6;
+    header[10] = 0;
+    header[11] = 0;
+    header[12] = 0;
+
+    /* write the chunks. */
+    retval = raster_png_chunk(sink, "IHDR", header, sizeof(header));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_compressed;
+    }
+
+    retval = raster_png_chunk(sink, "IDAT", compressed, compressed_size);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_compressed;
+    }
+
+    retval = raster_png_chunk(sink, "IEND", NULL, 0);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_compressed;
+    }
+
+    /* success. */
+    retval = STATUS_SUCCESS;
+    goto cleanup_compressed;
+
+cleanup_compressed:
+    release_retval =
+        weightgraph_memory_reclaim(
+            canvas->alloc, WEIGHTGRAPH_MEMORY_RASTER, compressed,
+            compressed_capacity);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_raw:
+    release_retval =
+        weightgraph_memory_reclaim(
+            canvas->alloc, WEIGHTGRAPH_MEMORY_RASTER, raw, raw_size);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Write a PNG chunk.
+ *
+ * \param sink          The sink to which the chunk is written.
+ * \param type          The four character chunk type.
+ * \param data          The chunk data.
+ * \param size          The size of the chunk data.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status raster_png_chunk(
+    const weightgraph_sink* sink, const char* type, const uint8_t* data,
+    size_t size)
+{
+    status retval;
+    uint8_t length[4];
+    uint8_t crc[4];
+    uLong checksum;
+
+    /* the checksum covers the type and the data. */
+    checksum = crc32(0L, (const Bytef*)type, 4);
+    if (size > 0)
+    {
+        checksum = crc32(checksum, data, size);
+    }
+
+    raster_png_be32(length, (uint32_t)size);
+    raster_png_be32(crc, (uint32_t)checksum);
+
+    /* write the length, type, data, and checksum. */
+    retval = sink->write(sink->context, length, 4);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    retval = sink->write(sink->context, type, 4);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    if (size > 0)
+    {
+        retval = sink->write(sink->context, data, size);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    return sink->write(sink->context, crc, 4);
+}
+
+/**
+ * \brief Write a 32-bit value in network byte order.
+ *
+ * \param out           The output buffer.
+ * \param value         The value to write.
+ */
+static void raster_png_be32(uint8_t* out, uint32_t value)
+{
+    out[0] = (uint8_t)(value >> 24);
+    out[1] = (uint8_t)(value >> 16);
+    out[2] = (uint8_t)(value >> 8);
+    out[3] = (uint8_t)value;
+}
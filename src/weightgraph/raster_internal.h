@@ -0,0 +1,150 @@
+/**
+ * \file weightgraph/raster_internal.h
+ *
+ * \brief Software rasterizer used to render graphs directly to PNG.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <weightgraph/session.h>
+#include <weightgraph/status_codes.h>
+#include <weightgraph/weightgraph.h>
+
+#include "memory_internal.h"
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+extern "C" {
+# endif /*__cplusplus*/
+
+/**
+ * \brief The width of a glyph in the embedded bitmap font, in font pixels.
+ */
+#define RASTER_FONT_GLYPH_WIDTH     5
+
+/**
+ * \brief The height of a glyph in the embedded bitmap font, in font pixels.
+ */
+#define RASTER_FONT_GLYPH_HEIGHT    7
+
+/**
+ * \brief An RGBA raster canvas.
+ *
+ * Shapes are rendered by adding their outline edges to a signed-area
+ * accumulation buffer, then filling.  The fill walks each scanline of the
+ * touched region, integrating the accumulated area into an anti-aliased
+ * coverage value that is blended into the pixel buffer.
+ */
+typedef struct raster_canvas raster_canvas;
+
+struct raster_canvas
+{
+    RCPR_SYM(resource) hdr;
+    RCPR_SYM(allocator)* alloc;
+    size_t width;
+    size_t height;
+    /* RGBA pixels, top row first. */
+    uint8_t* pixels;
+    /* signed area accumulation, (width + 2) entries per row. */
+    float* accum;
+    /* the region of the accumulation buffer touched since the last fill. */
+    size_t dirty_x0;
+    size_t dirty_x1;
+    size_t dirty_y0;
+    size_t dirty_y1;
+};
+
+/**
+ * \brief Create a raster canvas, cleared to opaque white.
+ *
+ * \param canvas        Pointer to receive the canvas.
+ * \param alloc         The allocator to use for this operation.
+ * \param width         The width of the canvas, in pixels.
+ * \param height        The height of the canvas, in pixels.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status raster_canvas_create(
+    raster_canvas** canvas, RCPR_SYM(allocator)* alloc, size_t width,
+    size_t height);
+
+/**
+ * \brief Clear a raster canvas to opaque white.
+ *
+ * \param canvas        The canvas to clear.
+ */
+void raster_canvas_clear(raster_canvas* canvas);
+
+/**
+ * \brief Add an outline edge to the canvas accumulation buffer.
+ *
+ * Coordinates are in device pixels, with the origin at the top-left corner.
+ * The outline of a shape must be closed before \ref raster_canvas_fill is
+ * called.
+ *
+ * \param canvas        The canvas.
+ * \param x0            The starting x coordinate.
+ * \param y0            The starting y coordinate.
+ * \param x1            The ending x coordinate.
+ * \param y1            The ending y coordinate.
+ */
+void raster_canvas_edge(
+    raster_canvas* canvas, double x0, double y0, double x1, double y1);
+
+/**
+ * \brief Fill the outlines accumulated since the last fill with the given
+ * color, and clear the accumulation buffer.
+ *
+ * \param canvas        The canvas.
+ * \param red           The red component, from 0.0 to 1.0.
+ * \param green         The green component, from 0.0 to 1.0.
+ * \param blue          The blue component, from 0.0 to 1.0.
+ */
+void raster_canvas_fill(
+    raster_canvas* canvas, double red, double green, double blue);
+
+/**
+ * \brief Encode the canvas as a PNG image and write it to the given sink.
+ *
+ * \param canvas        The canvas to encode.
+ * \param sink          The sink to which the image is written.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status raster_canvas_write_png(
+    raster_canvas* canvas, const weightgraph_sink* sink);
+
+/**
+ * \brief Release a raster canvas resource.
+ *
+ * \param r         The resource to release.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status raster_canvas_resource_release(RCPR_SYM(resource)* r);
+
+/**
+ * \brief Look up a glyph in the embedded bitmap font.
+ *
+ * \param ch        The character to look up.
+ *
+ * \returns an array of \ref RASTER_FONT_GLYPH_WIDTH columns, top row in the
+ * least significant bit.  Characters outside of printable ASCII map to a
+ * blank glyph.
+ */
+const uint8_t* raster_font_glyph(char ch);
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+}
+# endif /*__cplusplus*/
@@ -0,0 +1,153 @@
+/**
+ * \file weightgraph/weightgraph_archive_block_decode.c
+ *
+ * \brief Decode a block record of an archive.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "weightgraph_internal.h"
+
+/* forward decls. */
+static void weightgraph_archive_unpack(
+    int32_t* values, const uint8_t* packed, size_t packed_size, size_t count,
+    unsigned width, uint32_t base);
+static void weightgraph_archive_sum(int32_t* values, size_t count);
+
+/**
+ * \brief Decode a block record.
+ *
+ * Deltas are unpacked a 64-bit word at a time, without branches, and a block
+ * whose deltas are all the same, such as the days of a daily log, has
+ * nothing to unpack.  The deltas are then summed into day numbers and
+ * weights.
+ *
+ * \param block         The block to receive the entries.
+ * \param buffer        The record, starting with its type byte.
+ * \param buffer_size   The size of the record.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_ARCHIVE_FORMAT if the record is malformed or truncated.
+ */
+status weightgraph_archive_block_decode(
+    weightgraph_archive_block* block, const uint8_t* buffer,
+    size_t buffer_size)
+{
+    status retval;
+    size_t record_size, count, day_size, weight_size;
+    unsigned day_width, weight_width;
+    const uint8_t* packed;
+
+    retval = weightgraph_archive_record_size(buffer, buffer_size, &record_size);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    if (WEIGHTGRAPH_ARCHIVE_RECORD_BLOCK != buffer[0]
+     || 0 == record_size || record_size > buffer_size)
+    {
+        return ERROR_ARCHIVE_FORMAT;
+    }
+
+    count = (size_t)weightgraph_archive_field_read(buffer + 1, 2);
+    day_width = buffer[3];
+    weight_width = buffer[4];
+    day_size = ((count - 1) * day_width + 7) / 8;
+    weight_size = ((count - 1) * weight_width + 7) / 8;
+    packed = buffer + WEIGHTGRAPH_ARCHIVE_BLOCK_HEADER_SIZE;
+
+    /* the first entry is stored whole, and each after it as a delta. */
+    block->count = count;
+    block->days[0] = (int32_t)weightgraph_archive_field_read(buffer + 5, 4);
+    block->weights[0] =
+        (int32_t)weightgraph_archive_field_read(buffer + 9, 4);
+
+    weightgraph_archive_unpack(
+        block->days + 1, packed, day_size, count - 1, day_width,
+        (uint32_t)weightgraph_archive_field_read(buffer + 13, 4));
+    weightgraph_archive_unpack(
+        block->weights + 1, packed + day_size, weight_size, count - 1,
+        weight_width,
+        (uint32_t)weightgraph_archive_field_read(buffer + 17, 4));
+
+    weightgraph_archive_sum(block->days, count);
+    weightgraph_archive_sum(block->weights, count);
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Unpack deltas, adding the base back to each.
+ *
+ * \param values        Array to receive the deltas.
+ * \param packed        The packed deltas.
+ * \param packed_size   The size of the packed deltas.
+ * \param count         The number of deltas.
+ * \param width         The width of each packed delta, in bits.
+ * \param base          The base added to each delta.
+ */
+static void weightgraph_archive_unpack(
+    int32_t* values, const uint8_t* packed, size_t packed_size, size_t count,
+    unsigned width, uint32_t base)
+{
+    uint64_t mask = (UINT64_C(1) << width) - 1;
+    size_t i = 0;
+
+    /* equal deltas take no space at all. */
+    if (0 == width)
+    {
+        for (; i < count; ++i)
+        {
+            values[i] = (int32_t)base;
+        }
+
+        return;
+    }
+
+    /* while a whole word can be loaded, each delta is a load, a shift and a
+     * mask, at an offset that doesn't depend on the delta before it. */
+    for (; i < count && (i * width) / 8 + 8 <= packed_size; ++i)
+    {
+        size_t bit = i * width;
+        uint64_t word;
+
+        memcpy(&word, packed + bit / 8, sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        word = __builtin_bswap64(word);
+#endif
+
+        values[i] = (int32_t)((uint32_t)((word >> (bit % 8)) & mask) + base);
+    }
+
+    /* the last few deltas are read a byte at a time. */
+    for (; i < count; ++i)
+    {
+        size_t bit = i * width;
+        size_t size = (bit % 8 + width + 7) / 8;
+        uint64_t word = weightgraph_archive_field_read(packed + bit / 8, size);
+
+        values[i] = (int32_t)((uint32_t)((word >> (bit % 8)) & mask) + base);
+    }
+}
+
+/**
+ * \brief Turn an entry followed by deltas into a run of entries.
+ *
+ * \param values        The first entry, followed by the deltas.
+ * \param count         The number of entries.
+ */
+static void weightgraph_archive_sum(int32_t* values, size_t count)
+{
+    uint32_t value = (uint32_t)values[0];
+
+    for (size_t i = 1; i < count; ++i)
+    {
+        value += (uint32_t)values[i];
+        values[i] = (int32_t)value;
+    }
+}
@@ -0,0 +1,33 @@
+/**
+ * \file weightgraph/weightgraph_archive_civil_from_days.c
+ *
+ * \brief Convert a day number to a civil date.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Convert a count of days since 0000-03-01 to a date in the proleptic
+ * Gregorian calendar.
+ *
+ * \param day           The day number, from 0.
+ * \param year          Pointer to receive the year.
+ * \param month         Pointer to receive the month, from 1.
+ * \param mday          Pointer to receive the day of the month, from 1.
+ */
+void weightgraph_archive_civil_from_days(
+    int32_t day, long* year, int* month, int* mday)
+{
+    long era = day / 146097;
+    long doe = day - era * 146097;
+    long yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    long doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    long mp = (5 * doy + 2) / 153;
+
+    *mday = (int)(doy - (153 * mp + 2) / 5 + 1);
+    *month = (int)(mp < 10 ? mp + 3 : mp - 9);
+    *year = yoe + era * 400 + (*month <= 2 ? 1 : 0);
+}
@@ -0,0 +1,125 @@
+/**
+ * \file weightgraph/weightgraph_archive_date_encode.c
+ *
+ * \brief Convert a date to a day number.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief The most digits in the year of a date.
+ */
+#define WEIGHTGRAPH_ARCHIVE_YEAR_WIDTH_MAX 6
+
+/* forward decls. */
+static size_t weightgraph_archive_digits(
+    const char* text, size_t max, long* value);
+
+/**
+ * \brief Convert a date to a day number.
+ *
+ * The first date sets the style of the dates of an archive, and the number
+ * of digits in their years; every later date must match.  A date is only
+ * accepted if formatting its day number gives back the same date.
+ *
+ * \param date          The date.
+ * \param date_style    The style of the dates, set by the first date.
+ * \param year_width    The digits in each year, set by the first date.
+ * \param day           Pointer to receive the day number.
+ *
+ * \returns true if the date can be stored as a day number.
+ */
+bool weightgraph_archive_date_encode(
+    const char* date, int* date_style, int* year_width, int32_t* day)
+{
+    char formatted[WEIGHTGRAPH_ARCHIVE_DATE_SIZE];
+    int style, width = 0;
+    long year, month, mday, days;
+    size_t digits;
+
+    /* "MM/DD" is told apart from "YYYY-MM-DD" by its third character. */
+    if (2 == weightgraph_archive_digits(date, 2, &month) && '/' == date[2])
+    {
+        style = WEIGHTGRAPH_ARCHIVE_DATE_MONTH_DAY;
+        year = WEIGHTGRAPH_ARCHIVE_MONTH_DAY_YEAR;
+        if (2 != weightgraph_archive_digits(date + 3, 2, &mday))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        style = WEIGHTGRAPH_ARCHIVE_DATE_ISO;
+        digits =
+            weightgraph_archive_digits(
+                date, WEIGHTGRAPH_ARCHIVE_YEAR_WIDTH_MAX, &year);
+        if (digits < 4 || '-' != date[digits]
+         || 2 != weightgraph_archive_digits(date + digits + 1, 2, &month)
+         || '-' != date[digits + 3]
+         || 2 != weightgraph_archive_digits(date + digits + 4, 2, &mday))
+        {
+            return false;
+        }
+        width = (int)digits;
+    }
+
+    /* every date of an archive is written the same way. */
+    if (WEIGHTGRAPH_ARCHIVE_DATE_NONE != *date_style
+     && (style != *date_style || width != *year_width))
+    {
+        return false;
+    }
+
+    if (month < 1 || month > 12 || mday < 1 || mday > 31)
+    {
+        return false;
+    }
+
+    days = weightgraph_archive_days_from_civil(year, month, mday);
+    if (days > WEIGHTGRAPH_ARCHIVE_VALUE_MAX)
+    {
+        return false;
+    }
+
+    /* the date must survive the round trip, which rules out 02/30 and the
+     * like, and anything after the day. */
+    if (!weightgraph_archive_date_format(formatted, style, width, (int32_t)days)
+     || strcmp(formatted, date))
+    {
+        return false;
+    }
+
+    *date_style = style;
+    *year_width = width;
+    *day = (int32_t)days;
+
+    return true;
+}
+
+/**
+ * \brief Parse a run of decimal digits.
+ *
+ * \param text          The text.
+ * \param max           The most digits to parse.
+ * \param value         Pointer to receive the value of the digits.
+ *
+ * \returns the number of digits parsed.
+ */
+static size_t weightgraph_archive_digits(
+    const char* text, size_t max, long* value)
+{
+    size_t i;
+
+    *value = 0;
+    for (i = 0; i < max && text[i] >= '0' && text[i] <= '9'; ++i)
+    {
+        *value = *value * 10 + (text[i] - '0');
+    }
+
+    return i;
+}
@@ -0,0 +1,73 @@
+/**
+ * \file weightgraph/weightgraph_archive_date_format.c
+ *
+ * \brief Format a day number as a date.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Format a day number as a date.
+ *
+ * \param date          Buffer of \ref WEIGHTGRAPH_ARCHIVE_DATE_SIZE bytes to
+ *                      receive the date.
+ * \param date_style    The style of the date.
+ * \param year_width    The digits in the year.
+ * \param day           The day number.
+ *
+ * \returns false if the day number can't be formatted in this style.
+ */
+bool weightgraph_archive_date_format(
+    char* date, int date_style, int year_width, int32_t day)
+{
+    long year;
+    int month, mday;
+    char* out = date;
+
+    if (day < 0)
+    {
+        return false;
+    }
+
+    weightgraph_archive_civil_from_days(day, &year, &month, &mday);
+
+    /* the digits are written by hand, as this runs for every entry. */
+    if (WEIGHTGRAPH_ARCHIVE_DATE_ISO == date_style)
+    {
+        if (year_width < 4 || year_width > WEIGHTGRAPH_ARCHIVE_DATE_SIZE - 7)
+        {
+            return false;
+        }
+
+        for (int i = year_width - 1; i >= 0; --i)
+        {
+            out[i] = (char)('0' + year % 10);
+            year /= 10;
+        }
+
+        /* a year too long for the width of the archive is corrupt. */
+        if (0 != year)
+        {
+            return false;
+        }
+
+        out += year_width;
+        *out++ = '-';
+    }
+    else if (WEIGHTGRAPH_ARCHIVE_DATE_MONTH_DAY != date_style)
+    {
+        return false;
+    }
+
+    *out++ = (char)('0' + month / 10);
+    *out++ = (char)('0' + month % 10);
+    *out++ = (WEIGHTGRAPH_ARCHIVE_DATE_ISO == date_style) ? '-' : '/';
+    *out++ = (char)('0' + mday / 10);
+    *out++ = (char)('0' + mday % 10);
+    *out = 0;
+
+    return true;
+}
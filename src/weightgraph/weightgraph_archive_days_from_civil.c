@@ -0,0 +1,31 @@
+/**
+ * \file weightgraph/weightgraph_archive_days_from_civil.c
+ *
+ * \brief Count the days from 0000-03-01 to a civil date.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Count the days from 0000-03-01 to a date in the proleptic Gregorian
+ * calendar.
+ *
+ * \param year          The year, from 0.
+ * \param month         The month, from 1.
+ * \param mday          The day of the month, from 1.
+ *
+ * \returns the number of days, which is negative for dates before 0000-03-01.
+ */
+long weightgraph_archive_days_from_civil(long year, long month, long mday)
+{
+    long y = (month <= 2) ? year - 1 : year;
+    long era = ((y >= 0) ? y : y - 399) / 400;
+    long yoe = y - era * 400;
+    long doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + mday - 1;
+    long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+    return era * 146097 + doe;
+}
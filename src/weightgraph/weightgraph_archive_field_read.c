@@ -0,0 +1,30 @@
+/**
+ * \file weightgraph/weightgraph_archive_field_read.c
+ *
+ * \brief Read a little-endian field of an archive.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Read a little-endian field of an archive.
+ *
+ * \param buffer        The field.
+ * \param size          The size of the field, from 1 to 8 bytes.
+ *
+ * \returns the value of the field.
+ */
+uint64_t weightgraph_archive_field_read(const uint8_t* buffer, size_t size)
+{
+    uint64_t value = 0;
+
+    for (size_t i = size; i > 0; --i)
+    {
+        value = (value << 8) | buffer[i - 1];
+    }
+
+    return value;
+}
@@ -0,0 +1,26 @@
+/**
+ * \file weightgraph/weightgraph_archive_field_write.c
+ *
+ * \brief Write a little-endian field of an archive.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Write a little-endian field of an archive.
+ *
+ * \param buffer        The field.
+ * \param value         The value of the field.
+ * \param size          The size of the field, from 1 to 8 bytes.
+ */
+void weightgraph_archive_field_write(
+    uint8_t* buffer, uint64_t value, size_t size)
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        buffer[i] = (uint8_t)(value >> (8 * i));
+    }
+}
@@ -0,0 +1,302 @@
+/**
+ * \file weightgraph/weightgraph_archive_load.c
+ *
+ * \brief Decode an archive straight onto a session.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "weightgraph_internal.h"
+
+/* forward decls. */
+static status weightgraph_archive_load_check(
+    const uint8_t* buffer, size_t buffer_size, uint64_t* end_offset,
+    size_t* block_count, double* average);
+static uint64_t weightgraph_archive_load_seek(
+    const uint8_t* index, size_t block_count, int32_t since_day);
+
+/**
+ * \brief Decode an archive straight onto a session.
+ *
+ * The session is reset to the initial moving average of the archive, and
+ * each block is decoded and pushed onto it, without parsing dates or
+ * building an entry tree.  Entries before a given date are skipped by
+ * searching the block index, without decoding the blocks that hold them.
+ *
+ * \param session       The session.
+ * \param buffer        The archive.
+ * \param buffer_size   The size of the archive.
+ * \param since         The first date to push, in the style of the dates of
+ *                      the archive, or NULL to push every entry.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_OUT_OF_ORDER if the entries of the archive aren't in strictly
+ *        increasing date order, in which case it must be parsed instead.
+ *      - ERROR_ARCHIVE_FORMAT if the archive is malformed.
+ *      - ERROR_BAD_ARGUMENTS if the since date isn't in the style of the
+ *        archive.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_archive_load(
+    weightgraph_session* session, const uint8_t* buffer, size_t buffer_size,
+    const char* since)
+{
+    status retval, reclaim_retval;
+    uint64_t end_offset, entry;
+    size_t block_count;
+    double average;
+    int date_style, year_width;
+    int32_t since_day = INT32_MIN, last_day = INT32_MIN;
+    const uint8_t* index;
+    weightgraph_archive_block* block;
+    char date[WEIGHTGRAPH_ARCHIVE_DATE_SIZE];
+
+    retval =
+        weightgraph_archive_load_check(
+            buffer, buffer_size, &end_offset, &block_count, &average);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    date_style = buffer[5];
+    year_width = buffer[6];
+    index = buffer + end_offset + 5;
+
+    /* the since date must be in the style of the archive. */
+    if (NULL != since
+     && WEIGHTGRAPH_ARCHIVE_DATE_NONE != date_style
+     && (!weightgraph_archive_date_encode(
+            since, &date_style, &year_width, &since_day)
+      || date_style != buffer[5] || year_width != buffer[6]))
+    {
+        return ERROR_BAD_ARGUMENTS;
+    }
+
+    retval =
+        weightgraph_memory_allocate(
+            session->alloc, WEIGHTGRAPH_MEMORY_ARCHIVE, (void**)&block,
+            sizeof(*block));
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    weightgraph_session_reset(session, average);
+
+    /* decode from the last block starting on or before the since date. */
+    for (
+        entry = weightgraph_archive_load_seek(index, block_count, since_day);
+        entry < block_count; ++entry)
+    {
+        const uint8_t* field =
+            index + entry * WEIGHTGRAPH_ARCHIVE_INDEX_ENTRY_SIZE;
+        uint64_t offset = weightgraph_archive_field_read(field, 8);
+
+        if (offset < WEIGHTGRAPH_ARCHIVE_HEADER_SIZE || offset >= end_offset)
+        {
+            retval = ERROR_ARCHIVE_FORMAT;
+            goto cleanup_block;
+        }
+
+        retval =
+            weightgraph_archive_block_decode(
+                block, buffer + offset, end_offset - offset);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_block;
+        }
+
+        for (size_t i = 0; i < block->count; ++i)
+        {
+            /* the ordered flag is only trusted as far as it holds. */
+            if (block->days[i] <= last_day)
+            {
+                retval = ERROR_ARCHIVE_FORMAT;
+                goto cleanup_block;
+            }
+            last_day = block->days[i];
+
+            if (block->days[i] < since_day)
+            {
+                continue;
+            }
+
+            if (!weightgraph_archive_date_format(
+                    date, date_style, year_width, block->days[i]))
+            {
+                retval = ERROR_ARCHIVE_FORMAT;
+                goto cleanup_block;
+            }
+
+            retval =
+                weightgraph_session_push(
+                    session, date,
+                    (double)block->weights[i]
+                        / WEIGHTGRAPH_ARCHIVE_WEIGHT_SCALE);
+            if (STATUS_SUCCESS != retval)
+            {
+                goto cleanup_block;
+            }
+        }
+    }
+
+    retval = STATUS_SUCCESS;
+
+cleanup_block:
+    reclaim_retval =
+        weightgraph_memory_reclaim(
+            session->alloc, WEIGHTGRAPH_MEMORY_ARCHIVE, block,
+            sizeof(*block));
+    if (STATUS_SUCCESS != reclaim_retval)
+    {
+        retval = reclaim_retval;
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Check the header, records, index and trailer of an archive.
+ *
+ * The records are walked by their sizes alone, so no block is decoded.
+ *
+ * \param buffer        The archive.
+ * \param buffer_size   The size of the archive.
+ * \param end_offset    Pointer to receive the offset of the end record.
+ * \param block_count   Pointer to receive the number of blocks.
+ * \param average       Pointer to receive the initial moving average, which
+ *                      is that of the last average record, or 0.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_OUT_OF_ORDER if the archive isn't marked as ordered.
+ *      - ERROR_ARCHIVE_FORMAT if the archive is malformed.
+ */
+static status weightgraph_archive_load_check(
+    const uint8_t* buffer, size_t buffer_size, uint64_t* end_offset,
+    size_t* block_count, double* average)
+{
+    status retval;
+    const uint8_t* trailer;
+    uint64_t offset, bits, blocks = 0, entries = 0;
+    size_t record_size;
+
+    if (buffer_size
+            < WEIGHTGRAPH_ARCHIVE_HEADER_SIZE
+                + 5 + WEIGHTGRAPH_ARCHIVE_TRAILER_SIZE
+     || memcmp(
+            buffer, WEIGHTGRAPH_ARCHIVE_MAGIC, WEIGHTGRAPH_ARCHIVE_MAGIC_SIZE)
+     || WEIGHTGRAPH_ARCHIVE_VERSION != buffer[4]
+     || buffer[5] > WEIGHTGRAPH_ARCHIVE_DATE_MONTH_DAY)
+    {
+        return ERROR_ARCHIVE_FORMAT;
+    }
+
+    trailer = buffer + buffer_size - WEIGHTGRAPH_ARCHIVE_TRAILER_SIZE;
+    *end_offset = weightgraph_archive_field_read(trailer + 8, 8);
+    if (memcmp(
+            trailer + 20, WEIGHTGRAPH_ARCHIVE_END_MAGIC,
+            WEIGHTGRAPH_ARCHIVE_MAGIC_SIZE)
+     || *end_offset < WEIGHTGRAPH_ARCHIVE_HEADER_SIZE
+     || *end_offset + 5 > (uint64_t)(trailer - buffer)
+     || WEIGHTGRAPH_ARCHIVE_RECORD_END != buffer[*end_offset])
+    {
+        return ERROR_ARCHIVE_FORMAT;
+    }
+
+    /* the index must fill the space between the end record and trailer. */
+    *block_count =
+        (size_t)weightgraph_archive_field_read(buffer + *end_offset + 1, 4);
+    if ((uint64_t)(trailer - buffer) - *end_offset - 5
+            != (uint64_t)*block_count * WEIGHTGRAPH_ARCHIVE_INDEX_ENTRY_SIZE)
+    {
+        return ERROR_ARCHIVE_FORMAT;
+    }
+
+    if (!(trailer[16] & WEIGHTGRAPH_ARCHIVE_FLAG_ORDERED))
+    {
+        return ERROR_OUT_OF_ORDER;
+    }
+
+    /* walk the records up to the end record. */
+    *average = 0.0;
+    for (
+        offset = WEIGHTGRAPH_ARCHIVE_HEADER_SIZE; offset < *end_offset;
+        offset += record_size)
+    {
+        retval =
+            weightgraph_archive_record_size(
+                buffer + offset, *end_offset - offset, &record_size);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        if (0 == record_size || record_size > *end_offset - offset
+         || WEIGHTGRAPH_ARCHIVE_RECORD_END == buffer[offset])
+        {
+            return ERROR_ARCHIVE_FORMAT;
+        }
+
+        if (WEIGHTGRAPH_ARCHIVE_RECORD_AVERAGE == buffer[offset])
+        {
+            bits = weightgraph_archive_field_read(buffer + offset + 1, 8);
+            memcpy(average, &bits, sizeof(*average));
+        }
+        else
+        {
+            ++blocks;
+            entries += weightgraph_archive_field_read(buffer + offset + 1, 2);
+        }
+    }
+
+    if (blocks != *block_count
+     || entries != weightgraph_archive_field_read(trailer, 8))
+    {
+        return ERROR_ARCHIVE_FORMAT;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Find the last block that starts on or before a day, by binary search
+ * of the block index.
+ *
+ * \param index         The index entries.
+ * \param block_count   The number of blocks.
+ * \param since_day     The day.
+ *
+ * \returns the position of the block in the index, or 0 if every block
+ * starts after the day.
+ */
+static uint64_t weightgraph_archive_load_seek(
+    const uint8_t* index, size_t block_count, int32_t since_day)
+{
+    size_t low = 0, high = block_count;
+
+    /* find the first block that starts after the day. */
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+        int32_t first_day =
+            (int32_t)weightgraph_archive_field_read(
+                index + mid * WEIGHTGRAPH_ARCHIVE_INDEX_ENTRY_SIZE + 16, 4);
+
+        if (first_day <= since_day)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    return (0 == low) ? 0 : low - 1;
+}
@@ -0,0 +1,56 @@
+/**
+ * \file weightgraph/weightgraph_archive_pack.c
+ *
+ * \brief Pack values at a fixed width in bits.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Pack values at a fixed width in bits, least significant bit first.
+ *
+ * \param out           The buffer to receive the packed values, of at least
+ *                      (count * width + 7) / 8 bytes.
+ * \param values        The values, which must each fit in the width.
+ * \param count         The number of values.
+ * \param width         The width of each value, from 0 to 32.
+ *
+ * \returns the number of bytes written.
+ */
+size_t weightgraph_archive_pack(
+    uint8_t* out, const uint32_t* values, size_t count, unsigned width)
+{
+    uint64_t bits = 0;
+    unsigned bit_count = 0;
+    size_t size = 0;
+
+    if (0 == width)
+    {
+        return 0;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        bits |= (uint64_t)values[i] << bit_count;
+        bit_count += width;
+
+        /* write out each byte as soon as it is full. */
+        while (bit_count >= 8)
+        {
+            out[size++] = (uint8_t)bits;
+            bits >>= 8;
+            bit_count -= 8;
+        }
+    }
+
+    /* the last byte is padded with zeroes. */
+    if (bit_count > 0)
+    {
+        out[size++] = (uint8_t)bits;
+    }
+
+    return size;
+}
@@ -0,0 +1,78 @@
+/**
+ * \file weightgraph/weightgraph_archive_record_size.c
+ *
+ * \brief Get the size of the record at the start of a buffer.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Get the size of the record at the start of a buffer.
+ *
+ * \param buffer        The buffer, starting with the type byte of a record.
+ * \param buffer_size   The number of bytes available in the buffer.
+ * \param record_size   Pointer to receive the size of the record, including
+ *                      its type byte, which is known even if the buffer holds
+ *                      only part of the record, or 0 if the buffer is too
+ *                      short to tell.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_ARCHIVE_FORMAT if the record type is unknown, or the block
+ *        header is malformed.
+ */
+status weightgraph_archive_record_size(
+    const uint8_t* buffer, size_t buffer_size, size_t* record_size)
+{
+    size_t count, day_width, weight_width;
+
+    *record_size = 0;
+    if (0 == buffer_size)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    switch (buffer[0])
+    {
+        case WEIGHTGRAPH_ARCHIVE_RECORD_AVERAGE:
+            *record_size = WEIGHTGRAPH_ARCHIVE_AVERAGE_SIZE;
+            return STATUS_SUCCESS;
+
+        /* the end record is taken with the block count of the index after
+         * it, which gives the size of the rest of the archive. */
+        case WEIGHTGRAPH_ARCHIVE_RECORD_END:
+            *record_size = 5;
+            return STATUS_SUCCESS;
+
+        case WEIGHTGRAPH_ARCHIVE_RECORD_BLOCK:
+            break;
+
+        default:
+            return ERROR_ARCHIVE_FORMAT;
+    }
+
+    /* the size of a block follows from its count and widths. */
+    if (buffer_size < 5)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    count = (size_t)weightgraph_archive_field_read(buffer + 1, 2);
+    day_width = buffer[3];
+    weight_width = buffer[4];
+    if (count < 1 || count > WEIGHTGRAPH_ARCHIVE_BLOCK_ENTRIES
+     || day_width > 32 || weight_width > 32)
+    {
+        return ERROR_ARCHIVE_FORMAT;
+    }
+
+    *record_size =
+        WEIGHTGRAPH_ARCHIVE_BLOCK_HEADER_SIZE
+      + ((count - 1) * day_width + 7) / 8
+      + ((count - 1) * weight_width + 7) / 8;
+
+    return STATUS_SUCCESS;
+}
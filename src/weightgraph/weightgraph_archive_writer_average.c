@@ -0,0 +1,41 @@
+/**
+ * \file weightgraph/weightgraph_archive_writer_average.c
+ *
+ * \brief Record the initial moving average of a log in an archive.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Record the initial moving average of the log in the archive.
+ *
+ * \param writer        The writer.
+ * \param average       The initial moving average.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_archive_writer_average(
+    weightgraph_archive_writer* writer, double average)
+{
+    status retval;
+
+    /* an average after some entries follows them in the archive. */
+    if (writer->block.count > 0 || writer->average_pending)
+    {
+        retval = weightgraph_archive_writer_flush(writer);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    writer->average_pending = true;
+    writer->average = average;
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,71 @@
+/**
+ * \file weightgraph/weightgraph_archive_writer_create.c
+ *
+ * \brief Create a writer that encodes a log as an archive.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "weightgraph_internal.h"
+
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Create a writer that encodes a log as an archive.
+ *
+ * The archive is written to page 0 of the sink, a block at a time, so only
+ * the current block and the index are held in memory.
+ *
+ * \param writer        Pointer to receive the new writer.
+ * \param alloc         The allocator to use for this writer.
+ * \param sink          The sink to which the archive is written, which must
+ *                      outlive the writer.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_archive_writer_create(
+    weightgraph_archive_writer** writer, RCPR_SYM(allocator)* alloc,
+    const weightgraph_sink* sink)
+{
+    status retval;
+    weightgraph_archive_writer* tmp;
+
+    /* allocate memory for the writer. */
+    retval =
+        weightgraph_memory_allocate(
+            alloc, WEIGHTGRAPH_MEMORY_ARCHIVE, (void**)&tmp, sizeof(*tmp));
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* clear memory. */
+    memset(tmp, 0, sizeof(*tmp));
+
+    /* set initial values. */
+    resource_init(&tmp->hdr, &weightgraph_archive_writer_resource_release);
+    tmp->alloc = alloc;
+    tmp->sink = sink;
+    tmp->ordered = true;
+
+    /* allocate the scratch space for encoding blocks. */
+    retval =
+        weightgraph_memory_allocate(
+            alloc, WEIGHTGRAPH_MEMORY_ARCHIVE, (void**)&tmp->scratch,
+            WEIGHTGRAPH_ARCHIVE_SCRATCH_SIZE);
+    if (STATUS_SUCCESS != retval)
+    {
+        weightgraph_memory_reclaim(
+            alloc, WEIGHTGRAPH_MEMORY_ARCHIVE, tmp, sizeof(*tmp));
+        return retval;
+    }
+
+    /* success. */
+    *writer = tmp;
+    return STATUS_SUCCESS;
+}
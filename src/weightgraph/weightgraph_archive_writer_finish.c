@@ -0,0 +1,104 @@
+/**
+ * \file weightgraph/weightgraph_archive_writer_finish.c
+ *
+ * \brief Write the last block and the index of an archive, and close it.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Write the last block and the index, and close the archive.
+ *
+ * \param writer        The writer.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_archive_writer_finish(weightgraph_archive_writer* writer)
+{
+    status retval;
+    uint8_t* out = writer->scratch;
+    uint64_t end_offset;
+    size_t size = 0;
+
+    /* write the last block, or, for an empty log, the header. */
+    retval = weightgraph_archive_writer_flush(writer);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    end_offset = writer->offset;
+
+    /* the end record and the index, written through the scratch space. */
+    out[size++] = WEIGHTGRAPH_ARCHIVE_RECORD_END;
+    weightgraph_archive_field_write(out + size, writer->index_count, 4);
+    size += 4;
+
+    for (size_t i = 0; i < writer->index_count; ++i)
+    {
+        const weightgraph_archive_index_entry* entry = &writer->index[i];
+
+        if (size + WEIGHTGRAPH_ARCHIVE_INDEX_ENTRY_SIZE
+                > WEIGHTGRAPH_ARCHIVE_SCRATCH_SIZE)
+        {
+            retval = writer->sink->write(writer->sink->context, out, size);
+            if (STATUS_SUCCESS != retval)
+            {
+                return retval;
+            }
+
+            writer->offset += size;
+            size = 0;
+        }
+
+        weightgraph_archive_field_write(out + size, entry->offset, 8);
+        weightgraph_archive_field_write(out + size + 8, entry->first_entry, 8);
+        weightgraph_archive_field_write(
+            out + size + 16, (uint32_t)entry->first_day, 4);
+        weightgraph_archive_field_write(out + size + 20, entry->count, 4);
+        size += WEIGHTGRAPH_ARCHIVE_INDEX_ENTRY_SIZE;
+    }
+
+    /* the trailer. */
+    if (size + WEIGHTGRAPH_ARCHIVE_TRAILER_SIZE
+            > WEIGHTGRAPH_ARCHIVE_SCRATCH_SIZE)
+    {
+        retval = writer->sink->write(writer->sink->context, out, size);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        writer->offset += size;
+        size = 0;
+    }
+
+    weightgraph_archive_field_write(out + size, writer->entry_count, 8);
+    weightgraph_archive_field_write(out + size + 8, end_offset, 8);
+    out[size + 16] = writer->ordered ? WEIGHTGRAPH_ARCHIVE_FLAG_ORDERED : 0;
+    memset(out + size + 17, 0, 3);
+    memcpy(
+        out + size + 20, WEIGHTGRAPH_ARCHIVE_END_MAGIC,
+        WEIGHTGRAPH_ARCHIVE_MAGIC_SIZE);
+    size += WEIGHTGRAPH_ARCHIVE_TRAILER_SIZE;
+
+    retval = writer->sink->write(writer->sink->context, out, size);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    writer->offset += size;
+
+    /* close the archive. */
+    writer->sink_open = false;
+
+    return writer->sink->close(writer->sink->context);
+}
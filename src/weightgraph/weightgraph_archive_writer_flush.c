@@ -0,0 +1,242 @@
+/**
+ * \file weightgraph/weightgraph_archive_writer_flush.c
+ *
+ * \brief Write the pending records of an archive writer.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "weightgraph_internal.h"
+
+/* forward decls. */
+static status weightgraph_archive_writer_emit(
+    weightgraph_archive_writer* writer, const void* data, size_t size);
+static status weightgraph_archive_writer_index_block(
+    weightgraph_archive_writer* writer);
+static size_t weightgraph_archive_encode_deltas(
+    uint8_t* width_field, uint8_t* base_field, uint8_t* out,
+    const int32_t* values, size_t count);
+
+/**
+ * \brief Write the pending block of an archive writer, and its header and
+ * initial average if they haven't been written yet.
+ *
+ * \param writer        The writer.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_archive_writer_flush(weightgraph_archive_writer* writer)
+{
+    status retval;
+    weightgraph_archive_block* block = &writer->block;
+    uint8_t record[WEIGHTGRAPH_ARCHIVE_AVERAGE_SIZE];
+    uint64_t bits;
+    uint8_t* out;
+    size_t size;
+
+    /* the header waits for the first date, which sets the date style. */
+    if (!writer->sink_open)
+    {
+        retval = writer->sink->open(writer->sink->context, 0, 0);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+        writer->sink_open = true;
+
+        memcpy(
+            record, WEIGHTGRAPH_ARCHIVE_MAGIC, WEIGHTGRAPH_ARCHIVE_MAGIC_SIZE);
+        record[4] = WEIGHTGRAPH_ARCHIVE_VERSION;
+        record[5] = (uint8_t)writer->date_style;
+        record[6] = (uint8_t)writer->year_width;
+        record[7] = 0;
+
+        retval =
+            weightgraph_archive_writer_emit(
+                writer, record, WEIGHTGRAPH_ARCHIVE_HEADER_SIZE);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    if (writer->average_pending)
+    {
+        memcpy(&bits, &writer->average, sizeof(bits));
+        record[0] = WEIGHTGRAPH_ARCHIVE_RECORD_AVERAGE;
+        weightgraph_archive_field_write(record + 1, bits, 8);
+
+        retval =
+            weightgraph_archive_writer_emit(
+                writer, record, WEIGHTGRAPH_ARCHIVE_AVERAGE_SIZE);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+        writer->average_pending = false;
+    }
+
+    if (0 == block->count)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    retval = weightgraph_archive_writer_index_block(writer);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* the block header, followed by each stream of deltas. */
+    out = writer->scratch;
+    out[0] = WEIGHTGRAPH_ARCHIVE_RECORD_BLOCK;
+    weightgraph_archive_field_write(out + 1, block->count, 2);
+    weightgraph_archive_field_write(out + 5, (uint32_t)block->days[0], 4);
+    weightgraph_archive_field_write(out + 9, (uint32_t)block->weights[0], 4);
+
+    size = WEIGHTGRAPH_ARCHIVE_BLOCK_HEADER_SIZE;
+    size +=
+        weightgraph_archive_encode_deltas(
+            out + 3, out + 13, out + size, block->days, block->count);
+    size +=
+        weightgraph_archive_encode_deltas(
+            out + 4, out + 17, out + size, block->weights, block->count);
+
+    retval = weightgraph_archive_writer_emit(writer, out, size);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    writer->entry_count += block->count;
+    block->count = 0;
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Write data to the sink of an archive writer.
+ *
+ * \param writer        The writer.
+ * \param data          The data.
+ * \param size          The size of the data.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status weightgraph_archive_writer_emit(
+    weightgraph_archive_writer* writer, const void* data, size_t size)
+{
+    status retval;
+
+    retval = writer->sink->write(writer->sink->context, data, size);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    writer->offset += size;
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Add the pending block to the index.
+ *
+ * \param writer        The writer.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status weightgraph_archive_writer_index_block(
+    weightgraph_archive_writer* writer)
+{
+    status retval;
+    weightgraph_archive_index_entry* entry;
+
+    /* grow the index geometrically. */
+    if (writer->index_count == writer->index_capacity)
+    {
+        size_t capacity =
+            (0 == writer->index_capacity) ? 64 : 2 * writer->index_capacity;
+        void* index = writer->index;
+
+        retval =
+            weightgraph_memory_reallocate(
+                writer->alloc, WEIGHTGRAPH_MEMORY_ARCHIVE, &index,
+                writer->index_capacity * sizeof(*entry),
+                capacity * sizeof(*entry));
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        writer->index = (weightgraph_archive_index_entry*)index;
+        writer->index_capacity = capacity;
+    }
+
+    entry = &writer->index[writer->index_count++];
+    entry->offset = writer->offset;
+    entry->first_entry = writer->entry_count;
+    entry->first_day = writer->block.days[0];
+    entry->count = (uint32_t)writer->block.count;
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Encode the deltas between a run of values, less their smallest, at
+ * the narrowest width that holds them all.
+ *
+ * \param width_field   The block header field to receive the width.
+ * \param base_field    The block header field to receive the smallest delta.
+ * \param out           The buffer to receive the packed deltas.
+ * \param values        The values, of which the first is stored whole.
+ * \param count         The number of values.
+ *
+ * \returns the number of bytes of packed deltas.
+ */
+static size_t weightgraph_archive_encode_deltas(
+    uint8_t* width_field, uint8_t* base_field, uint8_t* out,
+    const int32_t* values, size_t count)
+{
+    uint32_t deltas[WEIGHTGRAPH_ARCHIVE_BLOCK_ENTRIES];
+    int64_t base = 0;
+    uint32_t largest = 0;
+    unsigned width = 0;
+
+    /* values are bounded so that every delta fits in 32 bits. */
+    for (size_t i = 1; i < count; ++i)
+    {
+        int64_t delta = (int64_t)values[i] - values[i - 1];
+
+        if (1 == i || delta < base)
+        {
+            base = delta;
+        }
+    }
+
+    for (size_t i = 1; i < count; ++i)
+    {
+        deltas[i - 1] =
+            (uint32_t)((int64_t)values[i] - values[i - 1] - base);
+        largest |= deltas[i - 1];
+    }
+
+    while (width < 32 && (largest >> width) != 0)
+    {
+        ++width;
+    }
+
+    *width_field = (uint8_t)width;
+    weightgraph_archive_field_write(base_field, (uint32_t)base, 4);
+
+    return weightgraph_archive_pack(out, deltas, count - 1, width);
+}
@@ -0,0 +1,66 @@
+/**
+ * \file weightgraph/weightgraph_archive_writer_push.c
+ *
+ * \brief Add an entry to an archive.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Add an entry to the archive.
+ *
+ * Entries are kept in the order they are added.  Dates must all be written
+ * as "YYYY-MM-DD", with the same number of digits in each year, or all as
+ * "MM/DD".  Weights must be whole hundredths.
+ *
+ * \param writer        The writer.
+ * \param date          The date of the entry.
+ * \param weight        The weight of the entry.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_ARCHIVE_ENCODE if the entry can't be stored exactly.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_archive_writer_push(
+    weightgraph_archive_writer* writer, const char* date, double weight)
+{
+    weightgraph_archive_block* block = &writer->block;
+    int32_t fixed;
+    int32_t day;
+
+    if (!weightgraph_archive_date_encode(
+            date, &writer->date_style, &writer->year_width, &day))
+    {
+        return ERROR_ARCHIVE_ENCODE;
+    }
+
+    /* the weight is stored in the fixed point of a session. */
+    if (!weightgraph_weight_to_fixed(weight, &fixed))
+    {
+        return ERROR_ARCHIVE_ENCODE;
+    }
+
+    /* note whether the entries are still in order. */
+    if ((writer->entry_count > 0 || block->count > 0)
+     && day <= writer->last_day)
+    {
+        writer->ordered = false;
+    }
+    writer->last_day = day;
+
+    block->days[block->count] = day;
+    block->weights[block->count] = fixed;
+    ++block->count;
+
+    /* write each block as soon as it is full. */
+    if (WEIGHTGRAPH_ARCHIVE_BLOCK_ENTRIES == block->count)
+    {
+        return weightgraph_archive_writer_flush(writer);
+    }
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,23 @@
+/**
+ * \file weightgraph/weightgraph_archive_writer_resource_handle.c
+ *
+ * \brief Get the resource handle for an archive writer.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Get the resource handle for an archive writer.
+ *
+ * \param writer        The writer.
+ *
+ * \returns the resource handle, which is used to release the writer.
+ */
+RCPR_SYM(resource)* weightgraph_archive_writer_resource_handle(
+    weightgraph_archive_writer* writer)
+{
+    return &writer->hdr;
+}
@@ -0,0 +1,64 @@
+/**
+ * \file weightgraph/weightgraph_archive_writer_resource_release.c
+ *
+ * \brief Release an archive writer resource.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Release an archive writer resource.
+ *
+ * \param r         The resource to release.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_archive_writer_resource_release(RCPR_SYM(resource)* r)
+{
+    status close_retval = STATUS_SUCCESS, reclaim_retval;
+    weightgraph_archive_writer* writer = (weightgraph_archive_writer*)r;
+
+    /* cache allocator. */
+    allocator* alloc = writer->alloc;
+
+    /* close the sink of an unfinished archive. */
+    if (writer->sink_open)
+    {
+        close_retval = writer->sink->close(writer->sink->context);
+    }
+
+    /* reclaim the index and the scratch space. */
+    if (NULL != writer->index)
+    {
+        weightgraph_memory_reclaim(
+            alloc, WEIGHTGRAPH_MEMORY_ARCHIVE, writer->index,
+            writer->index_capacity * sizeof(*writer->index));
+    }
+
+    weightgraph_memory_reclaim(
+        alloc, WEIGHTGRAPH_MEMORY_ARCHIVE, writer->scratch,
+        WEIGHTGRAPH_ARCHIVE_SCRATCH_SIZE);
+
+    /* reclaim memory. */
+    reclaim_retval =
+        weightgraph_memory_reclaim(
+            alloc, WEIGHTGRAPH_MEMORY_ARCHIVE, writer, sizeof(*writer));
+
+    /* decode response. */
+    if (STATUS_SUCCESS != close_retval)
+    {
+        return close_retval;
+    }
+    else
+    {
+        return reclaim_retval;
+    }
+}
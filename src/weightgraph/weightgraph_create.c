@@ -10,7 +10,8 @@
 #include <string.h>
 #include <weightgraph/weightgraph.h>
 
-RCPR_IMPORT_allocator;
+#include "memory_internal.h"
+
 RCPR_IMPORT_rbtree;
 RCPR_IMPORT_resource;
 
@@ -32,7 +33,9 @@ status weightgraph_create(
     weightgraph* tmp;
 
     /* allocate memory for this AST instance. */
-    retval = allocator_allocate(alloc, (void**)&tmp, sizeof(*tmp));
+    retval =
+        weightgraph_memory_allocate(
+            alloc, WEIGHTGRAPH_MEMORY_GRAPH, (void**)&tmp, sizeof(*tmp));
     if (STATUS_SUCCESS != retval)
     {
         goto done;
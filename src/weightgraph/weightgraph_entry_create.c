@@ -10,7 +10,8 @@
 #include <string.h>
 #include <weightgraph/weightgraph.h>
 
-RCPR_IMPORT_allocator;
+#include "memory_internal.h"
+
 RCPR_IMPORT_resource;
 
 /**
@@ -31,9 +32,12 @@ status weightgraph_entry_create(
 {
     status retval, release_retval;
     weightgraph_entry* tmp;
+    size_t date_size = strlen(date) + 1;
 
     /* allocate a weightgraph entry. */
-    retval = allocator_allocate(alloc, (void**)&tmp, sizeof(*tmp));
+    retval =
+        weightgraph_memory_allocate(
+            alloc, WEIGHTGRAPH_MEMORY_ENTRY, (void**)&tmp, sizeof(*tmp));
     if (STATUS_SUCCESS != retval)
     {
         goto done;
@@ -48,12 +52,14 @@ status weightgraph_entry_create(
     resource_init(&tmp->hdr, &weightgraph_entry_resource_release);
 
     /* copy the date. */
-    tmp->date = strdup(date);
-    if (NULL == tmp->date)
+    retval =
+        weightgraph_memory_allocate(
+            alloc, WEIGHTGRAPH_MEMORY_DATE, (void**)&tmp->date, date_size);
+    if (STATUS_SUCCESS != retval)
     {
-        retval = ERROR_GENERAL_OUT_OF_MEMORY;
         goto cleanup_tmp;
     }
+    memcpy(tmp->date, date, date_size);
 
     /* success. */
     *entry = tmp;
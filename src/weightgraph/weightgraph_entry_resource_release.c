@@ -7,10 +7,11 @@
  * distribution for the license terms under which this software is distributed.
  */
 
-#include <stdlib.h>
 #include <string.h>
 #include <weightgraph/weightgraph.h>
 
+#include "memory_internal.h"
+
 RCPR_IMPORT_allocator;
 RCPR_IMPORT_resource;
 
@@ -25,6 +26,8 @@ RCPR_IMPORT_resource;
  */
 status weightgraph_entry_resource_release(RCPR_SYM(resource)* r)
 {
+    status date_retval = STATUS_SUCCESS;
+    status reclaim_retval;
     weightgraph_entry* entry = (weightgraph_entry*)r;
 
     /* cache the allocator. */
@@ -33,10 +36,24 @@ status weightgraph_entry_resource_release(RCPR_SYM(resource)* r)
     /* clean up the date if set. */
     if (NULL != entry->date)
     {
-        free(entry->date);
+        date_retval =
+            weightgraph_memory_reclaim(
+                alloc, WEIGHTGRAPH_MEMORY_DATE, entry->date,
+                strlen(entry->date) + 1);
     }
 
     /* reclaim memory. */
-    return
-        allocator_reclaim(alloc, entry);
+    reclaim_retval =
+        weightgraph_memory_reclaim(
+            alloc, WEIGHTGRAPH_MEMORY_ENTRY, entry, sizeof(*entry));
+
+    /* decode response. */
+    if (STATUS_SUCCESS != date_retval)
+    {
+        return date_retval;
+    }
+    else
+    {
+        return reclaim_retval;
+    }
 }
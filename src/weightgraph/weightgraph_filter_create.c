@@ -0,0 +1,57 @@
+/**
+ * \file weightgraph/weightgraph_filter_create.c
+ *
+ * \brief Create an outlier filter.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Create an outlier filter.
+ *
+ * \param filter        Pointer to receive the filter.
+ * \param alloc         The allocator to use for this operation.
+ * \param window        The number of earlier weights against which each
+ *                      weight is judged.
+ * \param threshold     The number of scaled median absolute deviations from
+ *                      the median beyond which a weight is rejected.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_filter_create(
+    weightgraph_filter** filter, RCPR_SYM(allocator)* alloc, size_t window,
+    double threshold)
+{
+    status retval;
+    weightgraph_filter* tmp;
+    size_t size = sizeof(*tmp) + window * sizeof(weightgraph_filter_node);
+
+    /* allocate memory for the filter and its nodes. */
+    retval =
+        weightgraph_memory_allocate(
+            alloc, WEIGHTGRAPH_MEMORY_FILTER, (void**)&tmp, size);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* clear memory. */
+    memset(tmp, 0, size);
+
+    /* set initial values. */
+    tmp->alloc = alloc;
+    tmp->window = (uint32_t)window;
+    tmp->threshold = threshold;
+    weightgraph_filter_reset(tmp);
+
+    /* success. */
+    *filter = tmp;
+    return STATUS_SUCCESS;
+}
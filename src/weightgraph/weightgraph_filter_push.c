@@ -0,0 +1,330 @@
+/**
+ * \file weightgraph/weightgraph_filter_push.c
+ *
+ * \brief Judge a weight with an outlier filter, and add it to the window.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <math.h>
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief The factor scaling a median absolute deviation to the standard
+ * deviation of normally distributed weights.
+ */
+#define WEIGHTGRAPH_FILTER_MAD_SCALE 1.4826
+
+/**
+ * \brief The smallest scaled deviation, as a fraction of the median, so that
+ * a run of equal weights doesn't reject every weight that differs from them.
+ */
+#define WEIGHTGRAPH_FILTER_MIN_SPREAD 0.005
+
+/* forward decls. */
+static bool weightgraph_filter_judge(
+    const weightgraph_filter* filter, double weight);
+static double weightgraph_filter_select(
+    const weightgraph_filter* filter, uint32_t rank);
+static double weightgraph_filter_deviation(
+    const weightgraph_filter* filter, double median, uint32_t rank);
+static void weightgraph_filter_split(
+    weightgraph_filter_node* nodes, uint32_t tree, double weight,
+    uint32_t index, uint32_t* left, uint32_t* right);
+static uint32_t weightgraph_filter_merge(
+    weightgraph_filter_node* nodes, uint32_t left, uint32_t right);
+static void weightgraph_filter_update(
+    weightgraph_filter_node* nodes, uint32_t node);
+
+/**
+ * \brief Judge a weight against the window of an outlier filter, then add
+ * it to the window in place of the oldest.
+ *
+ * \param filter        The filter.
+ * \param weight        The weight.
+ *
+ * \returns true if the weight is rejected.
+ */
+bool weightgraph_filter_push(weightgraph_filter* filter, double weight)
+{
+    weightgraph_filter_node* nodes = filter->nodes;
+    uint32_t slot = (uint32_t)(filter->pushed % filter->window);
+    uint32_t left, middle, right;
+    bool rejected = false;
+
+    /* a weight that can't be ordered is rejected, and never joins the
+     * window. */
+    if (!isfinite(weight))
+    {
+        return true;
+    }
+
+    /* weights are judged once the window is full. */
+    if (filter->pushed >= filter->window)
+    {
+        rejected = weightgraph_filter_judge(filter, weight);
+
+        /* take the oldest weight, which holds this slot, out of the tree. */
+        weightgraph_filter_split(
+            nodes, filter->root, nodes[slot].weight, slot, &left, &right);
+        weightgraph_filter_split(
+            nodes, right, nodes[slot].weight, slot + 1, &middle, &right);
+        filter->root = weightgraph_filter_merge(nodes, left, right);
+    }
+
+    /* a rejected weight joins the window as well, so that a lasting change
+     * of weight is soon accepted. */
+    filter->seed ^= filter->seed << 13;
+    filter->seed ^= filter->seed >> 17;
+    filter->seed ^= filter->seed << 5;
+    nodes[slot].weight = weight;
+    nodes[slot].priority = filter->seed;
+    nodes[slot].size = 1;
+    nodes[slot].left = WEIGHTGRAPH_FILTER_NIL;
+    nodes[slot].right = WEIGHTGRAPH_FILTER_NIL;
+
+    weightgraph_filter_split(nodes, filter->root, weight, slot, &left, &right);
+    filter->root =
+        weightgraph_filter_merge(
+            nodes, weightgraph_filter_merge(nodes, left, slot), right);
+
+    ++filter->pushed;
+
+    return rejected;
+}
+
+/**
+ * \brief Decide whether a weight is an outlier of a full window.
+ *
+ * The median absolute deviation is the median of two sorted runs: the
+ * distances of the weights below the median, and of those above it.  Each
+ * deviation is found by a binary search over the split between the runs, so
+ * the weight is judged in O(log^2 w) time.
+ *
+ * \param filter        The filter, whose window is full.
+ * \param weight        The weight.
+ *
+ * \returns true if the weight is rejected.
+ */
+static bool weightgraph_filter_judge(
+    const weightgraph_filter* filter, double weight)
+{
+    uint32_t count = filter->window;
+    double median, deviation, scale;
+
+    /* an even window has two middle values, of which the mean is taken. */
+    median = weightgraph_filter_select(filter, count / 2);
+    if (0 == count % 2)
+    {
+        median =
+            (median + weightgraph_filter_select(filter, count / 2 - 1)) / 2.0;
+    }
+
+    deviation = weightgraph_filter_deviation(filter, median, count / 2);
+    if (0 == count % 2)
+    {
+        deviation =
+            (deviation
+             + weightgraph_filter_deviation(filter, median, count / 2 - 1))
+                / 2.0;
+    }
+
+    scale = WEIGHTGRAPH_FILTER_MAD_SCALE * deviation;
+    scale = fmax(scale, WEIGHTGRAPH_FILTER_MIN_SPREAD * fabs(median));
+
+    return fabs(weight - median) > filter->threshold * scale;
+}
+
+/**
+ * \brief Select the weight of a given rank in the window.
+ *
+ * \param filter        The filter.
+ * \param rank          The rank, starting at 0, of a weight in the window.
+ *
+ * \returns the weight.
+ */
+static double weightgraph_filter_select(
+    const weightgraph_filter* filter, uint32_t rank)
+{
+    const weightgraph_filter_node* nodes = filter->nodes;
+    uint32_t node = filter->root;
+
+    for (;;)
+    {
+        uint32_t left_size =
+            (WEIGHTGRAPH_FILTER_NIL == nodes[node].left)
+                ? 0 : nodes[nodes[node].left].size;
+
+        if (rank < left_size)
+        {
+            node = nodes[node].left;
+        }
+        else if (rank == left_size)
+        {
+            return nodes[node].weight;
+        }
+        else
+        {
+            rank -= left_size + 1;
+            node = nodes[node].right;
+        }
+    }
+}
+
+/**
+ * \brief Select the absolute deviation from the median of a given rank.
+ *
+ * \param filter        The filter, whose window is full.
+ * \param median        The median of the window.
+ * \param rank          The rank, starting at 0, of a deviation.
+ *
+ * \returns the deviation.
+ */
+static double weightgraph_filter_deviation(
+    const weightgraph_filter* filter, double median, uint32_t rank)
+{
+    /* the weights of rank below this lie at or below the median. */
+    uint32_t below = (filter->window + 1) / 2;
+    uint32_t above = filter->window - below;
+    uint32_t lo = (rank + 1 > above) ? rank + 1 - above : 0;
+    uint32_t hi = (rank + 1 < below) ? rank + 1 : below;
+    uint32_t taken;
+    double deviation = 0.0;
+
+    /* find how many of the rank + 1 smallest deviations are of weights at or
+     * below the median, the rest being of weights above it. */
+    while (lo < hi)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        double lower =
+            median - weightgraph_filter_select(filter, below - 1 - mid);
+        double upper =
+            weightgraph_filter_select(filter, below + rank - mid) - median;
+
+        if (lower < upper)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    /* the deviation is the larger of the last taken from either run. */
+    taken = rank + 1 - lo;
+    if (lo > 0)
+    {
+        deviation = median - weightgraph_filter_select(filter, below - lo);
+    }
+    if (taken > 0)
+    {
+        deviation =
+            fmax(
+                deviation,
+                weightgraph_filter_select(filter, below + taken - 1) - median);
+    }
+
+    return deviation;
+}
+
+/**
+ * \brief Split a tree into the nodes ordered before a weight and index, and
+ * the rest.
+ *
+ * \param nodes         The nodes of the filter.
+ * \param tree          The root of the tree to split.
+ * \param weight        The weight at which to split.
+ * \param index         The index at which to split, among equal weights.
+ * \param left          Pointer to receive the tree of the earlier nodes.
+ * \param right         Pointer to receive the tree of the rest.
+ */
+static void weightgraph_filter_split(
+    weightgraph_filter_node* nodes, uint32_t tree, double weight,
+    uint32_t index, uint32_t* left, uint32_t* right)
+{
+    if (WEIGHTGRAPH_FILTER_NIL == tree)
+    {
+        *left = WEIGHTGRAPH_FILTER_NIL;
+        *right = WEIGHTGRAPH_FILTER_NIL;
+        return;
+    }
+
+    if (nodes[tree].weight < weight
+     || (nodes[tree].weight == weight && tree < index))
+    {
+        weightgraph_filter_split(
+            nodes, nodes[tree].right, weight, index, &nodes[tree].right,
+            right);
+        *left = tree;
+    }
+    else
+    {
+        weightgraph_filter_split(
+            nodes, nodes[tree].left, weight, index, left, &nodes[tree].left);
+        *right = tree;
+    }
+
+    weightgraph_filter_update(nodes, tree);
+}
+
+/**
+ * \brief Merge two trees, every node of the first ordered before every node
+ * of the second.
+ *
+ * \param nodes         The nodes of the filter.
+ * \param left          The root of the first tree.
+ * \param right         The root of the second tree.
+ *
+ * \returns the root of the merged tree.
+ */
+static uint32_t weightgraph_filter_merge(
+    weightgraph_filter_node* nodes, uint32_t left, uint32_t right)
+{
+    if (WEIGHTGRAPH_FILTER_NIL == left)
+    {
+        return right;
+    }
+    else if (WEIGHTGRAPH_FILTER_NIL == right)
+    {
+        return left;
+    }
+    else if (nodes[left].priority > nodes[right].priority)
+    {
+        nodes[left].right =
+            weightgraph_filter_merge(nodes, nodes[left].right, right);
+        weightgraph_filter_update(nodes, left);
+        return left;
+    }
+    else
+    {
+        nodes[right].left =
+            weightgraph_filter_merge(nodes, left, nodes[right].left);
+        weightgraph_filter_update(nodes, right);
+        return right;
+    }
+}
+
+/**
+ * \brief Recompute the size of the subtree rooted at a node.
+ *
+ * \param nodes         The nodes of the filter.
+ * \param node          The node.
+ */
+static void weightgraph_filter_update(
+    weightgraph_filter_node* nodes, uint32_t node)
+{
+    nodes[node].size = 1;
+
+    if (WEIGHTGRAPH_FILTER_NIL != nodes[node].left)
+    {
+        nodes[node].size += nodes[nodes[node].left].size;
+    }
+
+    if (WEIGHTGRAPH_FILTER_NIL != nodes[node].right)
+    {
+        nodes[node].size += nodes[nodes[node].right].size;
+    }
+}
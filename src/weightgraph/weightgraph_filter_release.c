@@ -0,0 +1,29 @@
+/**
+ * \file weightgraph/weightgraph_filter_release.c
+ *
+ * \brief Release an outlier filter.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Release an outlier filter, and its marks.
+ *
+ * \param filter        The filter.
+ */
+void weightgraph_filter_release(weightgraph_filter* filter)
+{
+    if (NULL != filter->marks)
+    {
+        weightgraph_memory_reclaim(
+            filter->alloc, WEIGHTGRAPH_MEMORY_FILTER, filter->marks,
+            filter->mark_words * sizeof(uint64_t));
+    }
+
+    weightgraph_memory_reclaim(
+        filter->alloc, WEIGHTGRAPH_MEMORY_FILTER, filter,
+        sizeof(*filter) + filter->window * sizeof(weightgraph_filter_node));
+}
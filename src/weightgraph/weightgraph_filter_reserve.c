@@ -0,0 +1,55 @@
+/**
+ * \file weightgraph/weightgraph_filter_reserve.c
+ *
+ * \brief Grow the marks of an outlier filter.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Grow the marks of an outlier filter to cover a number of samples.
+ *
+ * \param filter        The filter.
+ * \param count         The number of samples to cover.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_filter_reserve(weightgraph_filter* filter, size_t count)
+{
+    status retval;
+    size_t words = (count + 63) / 64;
+    size_t capacity;
+    void* marks = filter->marks;
+
+    if (words <= filter->mark_words)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    /* grow the marks geometrically, like the samples they cover. */
+    capacity = (0 == filter->mark_words) ? 1 : 2 * filter->mark_words;
+    if (capacity < words)
+    {
+        capacity = words;
+    }
+
+    retval =
+        weightgraph_memory_reallocate(
+            filter->alloc, WEIGHTGRAPH_MEMORY_FILTER, &marks,
+            filter->mark_words * sizeof(uint64_t),
+            capacity * sizeof(uint64_t));
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    filter->marks = (uint64_t*)marks;
+    filter->mark_words = capacity;
+
+    return STATUS_SUCCESS;
+}
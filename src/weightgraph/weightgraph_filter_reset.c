@@ -0,0 +1,25 @@
+/**
+ * \file weightgraph/weightgraph_filter_reset.c
+ *
+ * \brief Empty the window of an outlier filter.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Empty the window of an outlier filter.
+ *
+ * \param filter        The filter.
+ */
+void weightgraph_filter_reset(weightgraph_filter* filter)
+{
+    filter->pushed = 0;
+    filter->root = WEIGHTGRAPH_FILTER_NIL;
+
+    /* the same priorities are drawn for every graph, so that a log is always
+     * filtered alike. */
+    filter->seed = 0x9e3779b9;
+}
@@ -0,0 +1,60 @@
+/**
+ * \file weightgraph/weightgraph_input_format_from_name.c
+ *
+ * \brief Select the format of a log by the extension of its name.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+#include <strings.h>
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Select the format of a log by the extension of its name.
+ *
+ * A ".gz" suffix is ignored, so that "log.csv.gz" is a CSV log.
+ *
+ * \param filename      The name of the log.
+ *
+ * \returns the format (WEIGHTGRAPH_INPUT_*), or WEIGHTGRAPH_INPUT_AUTO if the
+ * extension is not recognized.
+ */
+int weightgraph_input_format_from_name(const char* filename)
+{
+    static const struct
+    {
+        const char* extension;
+        int format;
+    } extensions[] = {
+        { ".xml", WEIGHTGRAPH_INPUT_XML },
+        { ".csv", WEIGHTGRAPH_INPUT_CSV },
+        { ".ndjson", WEIGHTGRAPH_INPUT_NDJSON },
+        { ".jsonl", WEIGHTGRAPH_INPUT_NDJSON },
+        { ".wga", WEIGHTGRAPH_INPUT_ARCHIVE },
+    };
+    size_t size = strlen(filename);
+
+    /* look past the compression suffix. */
+    if (size > 3 && !strcasecmp(filename + size - 3, ".gz"))
+    {
+        size -= 3;
+    }
+
+    for (size_t i = 0; i < sizeof(extensions) / sizeof(extensions[0]); ++i)
+    {
+        size_t extension_size = strlen(extensions[i].extension);
+
+        if (size > extension_size
+         && !strncasecmp(
+                filename + size - extension_size, extensions[i].extension,
+                extension_size))
+        {
+            return extensions[i].format;
+        }
+    }
+
+    return WEIGHTGRAPH_INPUT_AUTO;
+}
@@ -0,0 +1,68 @@
+/**
+ * \file weightgraph/weightgraph_input_format_sniff.c
+ *
+ * \brief Detect the format of a log from its first bytes.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Detect the format of a log from its first bytes.
+ *
+ * A log starting with the archive magic is an archive.  Otherwise, a log
+ * starting with '<' is XML, and one starting with '{' is NDJSON; anything
+ * else is CSV.  Leading whitespace and a byte order mark are skipped.
+ *
+ * \param buffer        The start of the log.
+ * \param buffer_size   The size of the buffer.
+ *
+ * \returns the format (WEIGHTGRAPH_INPUT_*), or WEIGHTGRAPH_INPUT_AUTO if the
+ * buffer holds only whitespace.
+ */
+int weightgraph_input_format_sniff(const uint8_t* buffer, size_t buffer_size)
+{
+    size_t i = 0;
+
+    /* an archive starts with its magic, with nothing before it. */
+    if (buffer_size >= WEIGHTGRAPH_ARCHIVE_MAGIC_SIZE
+     && !memcmp(
+            buffer, WEIGHTGRAPH_ARCHIVE_MAGIC, WEIGHTGRAPH_ARCHIVE_MAGIC_SIZE))
+    {
+        return WEIGHTGRAPH_INPUT_ARCHIVE;
+    }
+
+    /* skip a UTF-8 byte order mark. */
+    if (buffer_size >= 3
+     && 0xef == buffer[0] && 0xbb == buffer[1] && 0xbf == buffer[2])
+    {
+        i = 3;
+    }
+
+    for (; i < buffer_size; ++i)
+    {
+        switch (buffer[i])
+        {
+            case ' ':
+            case '\t':
+            case '\r':
+            case '\n':
+                break;
+
+            case '<':
+                return WEIGHTGRAPH_INPUT_XML;
+
+            case '{':
+                return WEIGHTGRAPH_INPUT_NDJSON;
+
+            default:
+                return WEIGHTGRAPH_INPUT_CSV;
+        }
+    }
+
+    return WEIGHTGRAPH_INPUT_AUTO;
+}
@@ -0,0 +1,867 @@
+/**
+ * \file weightgraph/weightgraph_internal.h
+ *
+ * \brief Internal declarations for the weightgraph library.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#pragma once
+
+#include <expat.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <weightgraph/session.h>
+#include <weightgraph/status_codes.h>
+#include <weightgraph/weightgraph.h>
+
+#include "archive_internal.h"
+#include "memory_internal.h"
+#include "raster_internal.h"
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+extern "C" {
+# endif /*__cplusplus*/
+
+/**
+ * \brief Weights are held in fixed point, in units of one over this, while
+ * every weight is a whole number of them.
+ */
+#define WEIGHTGRAPH_FIXED_SCALE 100
+
+/**
+ * \brief The largest magnitude of a weight held in fixed point, so that the
+ * sum of a full window fits in 32 bits.
+ */
+#define WEIGHTGRAPH_FIXED_MAX 100000000
+
+/**
+ * \brief A moving average window.
+ *
+ * While every weight pushed, and the initial average, is a whole number of
+ * hundredths, the window also holds them in fixed point, with their exact
+ * running sum, so that each average is computed exactly, with a single
+ * rounding, whatever came before it.
+ */
+typedef struct weightgraph_window weightgraph_window;
+
+struct weightgraph_window
+{
+    /* the weights, and the slot replaced by the next weight. */
+    double weights[WEIGHTGRAPH_AVERAGE_WINDOW];
+    int index;
+    /* true while the weights are held in fixed point as well. */
+    bool fixed;
+    int32_t fixed_weights[WEIGHTGRAPH_AVERAGE_WINDOW];
+    int64_t fixed_sum;
+};
+
+/**
+ * \brief A sample held in fixed point.
+ */
+typedef struct weightgraph_fixed_sample weightgraph_fixed_sample;
+
+struct weightgraph_fixed_sample
+{
+    const char* date;
+    /* the weight, in units of one over WEIGHTGRAPH_FIXED_SCALE. */
+    int32_t weight;
+    /* the moving average, as the sum of the fixed-point window. */
+    int32_t moving_average;
+};
+
+/**
+ * \brief The aggregates of a period of a rollup that its sample doesn't hold.
+ */
+typedef struct weightgraph_rollup_period weightgraph_rollup_period;
+
+struct weightgraph_rollup_period
+{
+    size_t count;
+    double min_weight;
+    double max_weight;
+    /* true if every sample in the period was rejected. */
+    bool rejected;
+};
+
+/**
+ * \brief The index standing for no node in an outlier filter.
+ */
+#define WEIGHTGRAPH_FILTER_NIL UINT32_MAX
+
+/**
+ * \brief A node of the order-statistic tree of an outlier filter.
+ *
+ * Nodes are ordered by weight, and then by index, so that equal weights can
+ * be told apart.
+ */
+typedef struct weightgraph_filter_node weightgraph_filter_node;
+
+struct weightgraph_filter_node
+{
+    double weight;
+    /* the heap priority of the node in the treap. */
+    uint32_t priority;
+    /* the number of nodes in the subtree rooted at this node. */
+    uint32_t size;
+    uint32_t left;
+    uint32_t right;
+};
+
+/**
+ * \brief A streaming Hampel outlier filter.
+ *
+ * The window of earlier weights is a treap in a fixed pool of nodes, one per
+ * slot of the window, so adding a weight, removing the oldest and selecting
+ * the weight of a given rank each take logarithmic time, and nothing is
+ * allocated once the filter is created.
+ */
+typedef struct weightgraph_filter weightgraph_filter;
+
+struct weightgraph_filter
+{
+    RCPR_SYM(allocator)* alloc;
+    /* the number of earlier weights against which a weight is judged. */
+    uint32_t window;
+    double threshold;
+    /* the number of weights pushed since the filter was last reset. */
+    size_t pushed;
+    /* the root of the treap, and the state of its priority generator. */
+    uint32_t root;
+    uint32_t seed;
+    /* a bit per sample of the session, set if the sample was rejected. */
+    uint64_t* marks;
+    size_t mark_words;
+    /* the node holding the weight in each slot of the window. */
+    weightgraph_filter_node nodes[];
+};
+
+/**
+ * \brief Create an outlier filter.
+ *
+ * \param filter        Pointer to receive the filter.
+ * \param alloc         The allocator to use for this operation.
+ * \param window        The number of earlier weights against which each
+ *                      weight is judged.
+ * \param threshold     The number of scaled median absolute deviations from
+ *                      the median beyond which a weight is rejected.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_filter_create(
+    weightgraph_filter** filter, RCPR_SYM(allocator)* alloc, size_t window,
+    double threshold);
+
+/**
+ * \brief Release an outlier filter, and its marks.
+ *
+ * \param filter        The filter.
+ */
+void weightgraph_filter_release(weightgraph_filter* filter);
+
+/**
+ * \brief Empty the window of an outlier filter.
+ *
+ * \param filter        The filter.
+ */
+void weightgraph_filter_reset(weightgraph_filter* filter);
+
+/**
+ * \brief Grow the marks of an outlier filter to cover a number of samples.
+ *
+ * \param filter        The filter.
+ * \param count         The number of samples to cover.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_filter_reserve(weightgraph_filter* filter, size_t count);
+
+/**
+ * \brief Judge a weight against the window of an outlier filter, then add
+ * it to the window in place of the oldest.
+ *
+ * \param filter        The filter.
+ * \param weight        The weight.
+ *
+ * \returns true if the weight is rejected.
+ */
+bool weightgraph_filter_push(weightgraph_filter* filter, double weight);
+
+/**
+ * \brief A weight graph session.
+ */
+struct weightgraph_session
+{
+    RCPR_SYM(resource) hdr;
+    RCPR_SYM(allocator)* alloc;
+    double initial_average;
+    /* the samples pushed so far, with their moving averages, in fixed point
+     * while the window is, or otherwise as doubles; the other is NULL. */
+    weightgraph_fixed_sample* fixed_samples;
+    weightgraph_sample* samples;
+    size_t count;
+    size_t capacity;
+    /* the moving average window. */
+    weightgraph_window window;
+    double moving_average;
+    /* the range of the weights pushed so far. */
+    double min_weight;
+    double max_weight;
+    /* for a rollup, the rest of the aggregates of each sample, or NULL. */
+    weightgraph_rollup_period* periods;
+    /* the outlier filter, or NULL if no weight is rejected. */
+    weightgraph_filter* filter;
+};
+
+/**
+ * \brief Release a weight graph session resource.
+ *
+ * \param r         The resource to release.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_session_resource_release(RCPR_SYM(resource)* r);
+
+/**
+ * \brief Convert the samples of a session from fixed point to doubles, for a
+ * weight that can't be held in fixed point.
+ *
+ * \param session       The session.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_session_widen(weightgraph_session* session);
+
+/**
+ * \brief Convert a weight to fixed point.
+ *
+ * \param weight        The weight.
+ * \param fixed         Pointer to receive the weight in fixed point.
+ *
+ * \returns true if the weight is a whole number of hundredths, no larger
+ * than \ref WEIGHTGRAPH_FIXED_MAX of them, and so converts back exactly.
+ */
+bool weightgraph_weight_to_fixed(double weight, int32_t* fixed);
+
+/**
+ * \brief Start a moving average window full of the initial average.
+ *
+ * \param window        The window.
+ * \param average       The initial moving average.
+ */
+void weightgraph_window_init(weightgraph_window* window, double average);
+
+/**
+ * \brief Add a weight to a moving average window.
+ *
+ * In fixed point, the weight replaces the oldest in the running sum, which
+ * is then divided once.  A weight that can't be held in fixed point drops
+ * the window back to summing its doubles for good.
+ *
+ * \param window        The window.
+ * \param weight        The weight to add.
+ *
+ * \returns the moving average of the window after adding the weight.
+ */
+double weightgraph_window_push(weightgraph_window* window, double weight);
+
+/**
+ * \brief A reusable weight log parser.
+ */
+struct weightgraph_parser
+{
+    RCPR_SYM(resource) hdr;
+    RCPR_SYM(allocator)* alloc;
+    XML_Parser parser;
+    /* true once the parser has parsed a document and must be reset. */
+    bool used;
+    /* the AST being built by the current run. */
+    weightgraph* graph;
+    /* the end of the last log element parsed, in bytes. */
+    size_t log_end;
+    /* the handler for a streamed document, or NULL to build an AST. */
+    const weightgraph_stream_handler* handler;
+    /* the first failure returned by the stream handler. */
+    status stream_status;
+    /* the format of each log (WEIGHTGRAPH_INPUT_*), and of this one. */
+    int format;
+    int document_format;
+    /* true once a record line of this log has been seen. */
+    bool text_started;
+    /* the start of a text line split across streamed pieces. */
+    uint8_t* carry;
+    size_t carry_size;
+    size_t carry_capacity;
+    /* the date style of an archive, once its header has been read. */
+    bool archive_started;
+    int archive_date_style;
+    int archive_year_width;
+    /* true once the end record of an archive has been read, and the number
+     * of bytes of its index and trailer still to come. */
+    bool archive_ended;
+    uint64_t archive_tail;
+    /* the block being decoded from an archive, allocated on first use. */
+    weightgraph_archive_block* archive_block;
+};
+
+/**
+ * \brief Add a log entry to the AST being built by the parser, or pass it
+ * to the stream handler.
+ *
+ * An entry that can't be added to the AST, such as one with a date that is
+ * already present, is dropped.
+ *
+ * \param parser        The parser.
+ * \param date          The date of the entry.
+ * \param weight        The weight of the entry.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - the failure returned by the stream handler.
+ */
+status weightgraph_parser_entry(
+    weightgraph_parser* parser, const char* date, double weight);
+
+/**
+ * \brief Set the initial average of the AST being built by the parser, or
+ * pass it to the stream handler.
+ *
+ * \param parser        The parser.
+ * \param average       The initial moving average.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - the failure returned by the stream handler.
+ */
+status weightgraph_parser_average(weightgraph_parser* parser, double average);
+
+/**
+ * \brief Parse the complete lines of a CSV or NDJSON log.
+ *
+ * Lines are found with memchr, which the C library vectorizes, and each
+ * record is scanned in place, without copying the line.
+ *
+ * \param parser        The parser.
+ * \param buffer        The buffer to parse.
+ * \param buffer_size   The size of the buffer.
+ * \param final         true if the buffer ends the log, in which case a last
+ *                      line without a newline is parsed as well.
+ * \param consumed      Pointer to receive the number of bytes parsed, up to
+ *                      the end of the last complete line.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_RECORD_PARSE if a record is malformed.
+ *      - the failure returned by the stream handler.
+ */
+status weightgraph_parser_scan_text(
+    weightgraph_parser* parser, const uint8_t* buffer, size_t buffer_size,
+    bool final, size_t* consumed);
+
+/**
+ * \brief Decode the complete records of an archive.
+ *
+ * The header is checked first, and each block is decoded in one pass and
+ * its entries passed on, a formatted date at a time.  Everything after the
+ * end record is ignored.
+ *
+ * \param parser        The parser.
+ * \param buffer        The buffer to decode.
+ * \param buffer_size   The size of the buffer.
+ * \param final         true if the buffer ends the archive, in which case the
+ *                      archive must be complete.
+ * \param consumed      Pointer to receive the number of bytes decoded, up to
+ *                      the end of the last complete record.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_ARCHIVE_FORMAT if the archive is malformed or truncated.
+ *      - the failure returned by the stream handler.
+ */
+status weightgraph_parser_scan_archive(
+    weightgraph_parser* parser, const uint8_t* buffer, size_t buffer_size,
+    bool final, size_t* consumed);
+
+/**
+ * \brief Reset a parser for a new document, and install its handlers.
+ *
+ * Without a stream handler, the elements of the document are added to the
+ * AST set in the parser.  With one, each element is passed to the handler
+ * as soon as it is parsed, and no AST is built.
+ *
+ * \param parser        The parser.
+ * \param handler       The stream handler, or NULL.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_parser_reset(
+    weightgraph_parser* parser, const weightgraph_stream_handler* handler);
+
+/**
+ * \brief Release a weightgraph parser resource.
+ *
+ * \param r         The resource to release.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_parser_resource_release(RCPR_SYM(resource)* r);
+
+/**
+ * \brief Run the parser over a buffer, creating a weightgraph AST.
+ *
+ * The parser is reset before each run.  The prefix, if any, is parsed
+ * before the buffer, so that a fragment of a document can be given the
+ * outer element it lacks.  A run that is not final accepts a buffer that
+ * ends part way through an element, which is then ignored.  The end of the
+ * last complete log element in the buffer is recorded in the parser.
+ *
+ * \param parser        The parser.
+ * \param graph         Pointer to receive the AST.
+ * \param prefix        Text to parse before the buffer, or NULL.
+ * \param buffer        The buffer to parse.
+ * \param buffer_size   The size of the buffer to parse.
+ * \param final         true if the buffer ends the document.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_parser_run(
+    weightgraph_parser* parser, weightgraph** graph, const char* prefix,
+    const uint8_t* buffer, size_t buffer_size, bool final);
+
+/**
+ * \brief Options controlling how an output graph is rendered.
+ */
+typedef struct output_graph_options output_graph_options;
+
+struct output_graph_options
+{
+    /* the output format (WEIGHTGRAPH_FORMAT_*). */
+    int format;
+    /* the width and height, in pixels, of raster output. */
+    size_t raster_size;
+    /* the range of values plotted, used to scale the Y-axis. */
+    double min_value;
+    double max_value;
+    /* the number of entries plotted on each page. */
+    size_t page_size;
+    /* the total number of pages in the graph. */
+    size_t page_count;
+    /* true if later runs may append pages to this graph. */
+    bool appendable;
+    /* the state from which to resume rendering, or NULL to start afresh. */
+    const weightgraph_render_state* resume;
+};
+
+/**
+ * \brief An RGB color, with each component ranging from 0.0 to 1.0.
+ */
+typedef struct output_graph_color output_graph_color;
+
+struct output_graph_color
+{
+    double red;
+    double green;
+    double blue;
+};
+
+/**
+ * \brief Fonts available for graph labels.
+ */
+enum output_graph_font
+{
+    OUTPUT_GRAPH_FONT_REGULAR,
+    OUTPUT_GRAPH_FONT_BOLD,
+};
+
+/**
+ * \brief How a label is positioned relative to its anchor point.
+ */
+enum output_graph_label_style
+{
+    /* horizontal text, centered on the anchor. */
+    OUTPUT_GRAPH_LABEL_CENTER,
+    /* horizontal text, ending at the anchor. */
+    OUTPUT_GRAPH_LABEL_RIGHT,
+    /* text rotated 90 degrees counter-clockwise, ending at the anchor. */
+    OUTPUT_GRAPH_LABEL_VERTICAL,
+};
+
+/**
+ * \brief An output graph file.
+ */
+typedef struct output_graph_file output_graph_file;
+
+struct output_graph_file
+{
+    RCPR_SYM(resource) hdr;
+    RCPR_SYM(allocator)* alloc;
+    /* the sink to which output is written. */
+    const weightgraph_sink* sink;
+    /* true while an output of the sink is open. */
+    bool sink_open;
+    /* the number of bytes written to the current output. */
+    long offset;
+    /* the first error raised while writing output. */
+    status write_status;
+    /* the output format (WEIGHTGRAPH_FORMAT_*). */
+    int format;
+    /* the number of entries plotted on each page. */
+    size_t page_size;
+    /* the total number of pages in the graph. */
+    size_t page_count;
+    /* the current page, starting at 1. */
+    size_t page;
+    /* the number of entries plotted on the current page. */
+    size_t page_entries;
+    /* true while the current page has been started but not finished. */
+    bool page_open;
+    /* true if later runs may append pages to this graph. */
+    bool appendable;
+    /* the scaled moving average at the start of the current page. */
+    double page_prevy;
+    /* the resume point recorded when the graph was finalized. */
+    weightgraph_render_state resume;
+    /* the canvas for raster output formats. */
+    raster_canvas* canvas;
+    /* device pixels per point for raster output formats. */
+    double raster_scale;
+    /* the most recently used color, inherited by uncolored labels. */
+    output_graph_color color;
+    /* the skip per x plot. */
+    double xskip;
+    /* how much to scale the weight. */
+    double yscale;
+    /* how much to add to the weight to correct the graph to zero. */
+    double yoffset;
+    /* the values at the bottom and top of the Y-axis. */
+    double axis_min;
+    double axis_max;
+    /* the distance between labeled ticks on the Y-axis. */
+    double tick_step;
+    double prevx;
+    double prevy;
+};
+
+/**
+ * \brief Create an output graph file, and write the preamble.
+ *
+ * When resume state is given, rendering continues from that state instead.
+ * An EPS document is reopened at the recorded offset so that new entries are
+ * written in place of the old epilogue.  If the state was recorded for a
+ * graph with a different Y-axis, ERROR_CHECKPOINT_STALE is returned.
+ *
+ * \param fp            Pointer to receive the file pointer.
+ * \param alloc         Allocator to use for this operation.
+ * \param sink          The sink to which output is written.
+ * \param options       The rendering options for this graph.
+ * \param old_average   The previous average.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status output_graph_create(
+    output_graph_file** fp, RCPR_SYM(allocator)* alloc,
+    const weightgraph_sink* sink, const output_graph_options* options,
+    double old_average);
+
+/**
+ * \brief Start a new page of the graph, drawing its boundaries and axes.
+ *
+ * The plotted line on the new page starts at the left edge of the graph,
+ * at the moving average carried over from the previous page.
+ *
+ * \param out               Output file pointer.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status output_graph_begin_page(output_graph_file* out);
+
+/**
+ * \brief Finish the current page of the graph.
+ *
+ * \param out               Output file pointer.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status output_graph_end_page(output_graph_file* out);
+
+/**
+ * \brief Plot a weight on the graph.
+ *
+ * \param out               Output file pointer.
+ * \param date              The date for this entry.
+ * \param weight            The weight for this entry.
+ * \param moving_average    The moving average for this entry.
+ * \param rejected          true if the outlier filter rejected the weight.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status output_graph_plot(
+    output_graph_file* out, const char* date, double weight,
+    double moving_average, bool rejected);
+
+/**
+ * \brief Plot a series of samples on the graph, rendering pages in parallel.
+ *
+ * Each page is rendered independently, starting from the moving average of
+ * the sample before it, into its own buffer.  The buffers are then written
+ * to the output in page order, so the result is identical to plotting each
+ * sample in turn with \ref output_graph_plot.  The last page is plotted in
+ * place, leaving it open as a serial plot would.  Only the calling thread
+ * writes to the sink of the graph.  The graph must not have had any samples
+ * plotted on it yet.
+ *
+ * \param out               Output file pointer.
+ * \param session           The session holding the samples to plot.
+ * \param threads           The number of threads to use.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status output_graph_plot_pages(
+    output_graph_file* out, const weightgraph_session* session,
+    size_t threads);
+
+/**
+ * \brief Create a graph that renders a single page of another graph.
+ *
+ * The page graph shares the scale and format of the parent, but has its
+ * own sink and canvas.
+ *
+ * \param page              Pointer to receive the page graph.
+ * \param parent            The graph to which the page belongs.
+ * \param number            The page number, starting at 1.
+ * \param prevy             The scaled moving average at the start of the
+ *                          page.
+ * \param sink              The sink to which the page is written.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status output_graph_page_create(
+    output_graph_file** page, output_graph_file* parent, size_t number,
+    double prevy, const weightgraph_sink* sink);
+
+/**
+ * \brief Stroke a line on the graph.
+ *
+ * \param out               Output file pointer.
+ * \param x0                The starting x coordinate, in points.
+ * \param y0                The starting y coordinate, in points.
+ * \param x1                The ending x coordinate, in points.
+ * \param y1                The ending y coordinate, in points.
+ * \param color             The color of the line.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status output_graph_draw_line(
+    output_graph_file* out, double x0, double y0, double x1, double y1,
+    const output_graph_color* color);
+
+/**
+ * \brief Fill a triangle on the graph.
+ *
+ * \param out               Output file pointer.
+ * \param x0                The x coordinate of the first vertex, in points.
+ * \param y0                The y coordinate of the first vertex, in points.
+ * \param x1                The x coordinate of the second vertex, in points.
+ * \param y1                The y coordinate of the second vertex, in points.
+ * \param x2                The x coordinate of the third vertex, in points.
+ * \param y2                The y coordinate of the third vertex, in points.
+ * \param color             The fill color.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status output_graph_draw_triangle(
+    output_graph_file* out, double x0, double y0, double x1, double y1,
+    double x2, double y2, const output_graph_color* color);
+
+/**
+ * \brief Fill a circle on the graph.
+ *
+ * \param out               Output file pointer.
+ * \param x                 The x coordinate of the center, in points.
+ * \param y                 The y coordinate of the center, in points.
+ * \param radius            The radius, in points.
+ * \param color             The fill color.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status output_graph_draw_circle(
+    output_graph_file* out, double x, double y, double radius,
+    const output_graph_color* color);
+
+/**
+ * \brief Draw a text label on the graph.
+ *
+ * \param out               Output file pointer.
+ * \param font              The font (OUTPUT_GRAPH_FONT_*).
+ * \param size              The font size, in points.
+ * \param text              The text to draw.
+ * \param x                 The x coordinate of the anchor, in points.
+ * \param y                 The y coordinate of the anchor, in points.
+ * \param style             The label style (OUTPUT_GRAPH_LABEL_*).
+ * \param color             The text color, or NULL to use the most recently
+ *                          used color.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status output_graph_draw_label(
+    output_graph_file* out, int font, int size, const char* text, double x,
+    double y, int style, const output_graph_color* color);
+
+/**
+ * \brief Add an edge, in points, to the raster canvas of this graph.
+ *
+ * \param out               Output file pointer.
+ * \param x0                The starting x coordinate, in points.
+ * \param y0                The starting y coordinate, in points.
+ * \param x1                The ending x coordinate, in points.
+ * \param y1                The ending y coordinate, in points.
+ */
+void output_graph_raster_edge(
+    output_graph_file* out, double x0, double y0, double x1, double y1);
+
+/**
+ * \brief Write data to the current output of the graph.
+ *
+ * Errors are recorded in the write status of the graph, and checked when
+ * the output is closed.
+ *
+ * \param out               Output file pointer.
+ * \param data              The data to write.
+ * \param size              The size of the data.
+ */
+void output_graph_write(output_graph_file* out, const void* data, size_t size);
+
+/**
+ * \brief Write formatted text to the current output of the graph.
+ *
+ * Errors are recorded in the write status of the graph, and checked when
+ * the output is closed.
+ *
+ * \param out               Output file pointer.
+ * \param format            The printf-style format string.
+ */
+void output_graph_printf(output_graph_file* out, const char* format, ...);
+
+/**
+ * \brief A growable in-memory buffer that can be used as a sink.
+ */
+typedef struct output_graph_buffer output_graph_buffer;
+
+struct output_graph_buffer
+{
+    char* data;
+    size_t size;
+    size_t capacity;
+};
+
+/**
+ * \brief Initialize a sink that appends everything written to a buffer.
+ *
+ * Opening and closing the sink has no effect.  The buffer data is allocated
+ * from the C heap, and must be released with weightgraph_memory_reclaim as
+ * WEIGHTGRAPH_MEMORY_OUTPUT memory of its capacity.
+ *
+ * \param sink              The sink to initialize.
+ * \param buffer            The buffer, which must be zeroed.
+ */
+void output_graph_buffer_sink_init(
+    weightgraph_sink* sink, output_graph_buffer* buffer);
+
+/**
+ * \brief Write the epilogue for the graph.
+ *
+ * The point from which a later run could append to this graph is recorded
+ * in the resume field of the output graph file.  For EPS, this is the end of
+ * the last entry plotted.  A raster page is a complete image, so a raster
+ * graph resumes from the start of its last page, which is then redrawn.
+ *
+ * \param out               Output file pointer.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status output_graph_finalize(output_graph_file* out);
+
+/**
+ * \brief Release an output graph file resource.
+ *
+ * \param r         The resource to release.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status output_graph_resource_release(RCPR_SYM(resource)* r);
+
+/**
+ * \brief A plotter, rendering samples as they arrive.
+ */
+struct weightgraph_plotter
+{
+    RCPR_SYM(resource) hdr;
+    RCPR_SYM(allocator)* alloc;
+    output_graph_file* out;
+    /* the number of samples the graph was laid out for, and plotted so far. */
+    size_t count;
+    size_t plotted;
+    /* the range of weights that the Y-axis covers. */
+    double min_weight;
+    double max_weight;
+    /* the moving average window. */
+    weightgraph_window window;
+    double moving_average;
+};
+
+/**
+ * \brief Release a plotter resource.
+ *
+ * \param r         The resource to release.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_plotter_resource_release(RCPR_SYM(resource)* r);
+
+/* C++ compatibility. */
+# ifdef   __cplusplus
+}
+# endif /*__cplusplus*/
@@ -0,0 +1,50 @@
+/**
+ * \file weightgraph/weightgraph_memory_allocate.c
+ *
+ * \brief Allocate memory, counting it against a category.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <stdlib.h>
+
+#include "weightgraph_internal.h"
+
+RCPR_IMPORT_allocator;
+
+/**
+ * \brief Allocate memory, counting it against a category.
+ *
+ * \param alloc         The allocator to use, or NULL for the C heap, which
+ *                      may be used from any thread.
+ * \param category      The category of the allocation.
+ * \param mem           Pointer to receive the memory.
+ * \param size          The size of the allocation.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_memory_allocate(
+    RCPR_SYM(allocator)* alloc, int category, void** mem, size_t size)
+{
+    status retval;
+
+    if (NULL == alloc)
+    {
+        *mem = malloc(size);
+        retval = (NULL == *mem) ? ERROR_GENERAL_OUT_OF_MEMORY : STATUS_SUCCESS;
+    }
+    else
+    {
+        retval = allocator_allocate(alloc, mem, size);
+    }
+
+    if (STATUS_SUCCESS == retval)
+    {
+        weightgraph_memory_track(category, 0, size);
+    }
+
+    return retval;
+}
@@ -0,0 +1,32 @@
+/**
+ * \file weightgraph/weightgraph_memory_category_name.c
+ *
+ * \brief Get the name of a memory category.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Get the name of a memory category.
+ *
+ * \param category      The category, or
+ *                      \ref WEIGHTGRAPH_MEMORY_CATEGORY_COUNT for the total.
+ *
+ * \returns the name of the category, such as "entry", or "total".
+ */
+const char* weightgraph_memory_category_name(int category)
+{
+    static const char* names[WEIGHTGRAPH_MEMORY_CATEGORY_COUNT + 1] = {
+        "graph", "entry", "date", "parser", "expat", "session", "plotter",
+        "output", "raster", "archive", "rollup", "filter", "total" };
+
+    if (category < 0 || category > WEIGHTGRAPH_MEMORY_CATEGORY_COUNT)
+    {
+        return "unknown";
+    }
+
+    return names[category];
+}
@@ -0,0 +1,65 @@
+/**
+ * \file weightgraph/weightgraph_memory_reallocate.c
+ *
+ * \brief Grow or shrink memory, counting it against a category.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <stdlib.h>
+
+#include "weightgraph_internal.h"
+
+RCPR_IMPORT_allocator;
+
+/**
+ * \brief Grow or shrink memory, counting it against a category.
+ *
+ * If the memory is NULL, it is allocated.
+ *
+ * \param alloc         The allocator to use, or NULL for the C heap.
+ * \param category      The category of the allocation.
+ * \param mem           Pointer to the memory, updated on success.
+ * \param old_size      The current size of the memory.
+ * \param size          The new size of the memory.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_memory_reallocate(
+    RCPR_SYM(allocator)* alloc, int category, void** mem, size_t old_size,
+    size_t size)
+{
+    status retval;
+    void* tmp;
+
+    if (NULL == *mem)
+    {
+        return weightgraph_memory_allocate(alloc, category, mem, size);
+    }
+
+    if (NULL == alloc)
+    {
+        tmp = realloc(*mem, size);
+        if (NULL == tmp)
+        {
+            return ERROR_GENERAL_OUT_OF_MEMORY;
+        }
+
+        *mem = tmp;
+        retval = STATUS_SUCCESS;
+    }
+    else
+    {
+        retval = allocator_reallocate(alloc, mem, size);
+    }
+
+    if (STATUS_SUCCESS == retval)
+    {
+        weightgraph_memory_track(category, old_size, size);
+    }
+
+    return retval;
+}
@@ -0,0 +1,48 @@
+/**
+ * \file weightgraph/weightgraph_memory_reclaim.c
+ *
+ * \brief Reclaim memory, counting it against a category.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <stdlib.h>
+
+#include "weightgraph_internal.h"
+
+RCPR_IMPORT_allocator;
+
+/**
+ * \brief Reclaim memory, counting it against a category.
+ *
+ * Reclaiming NULL has no effect.
+ *
+ * \param alloc         The allocator the memory came from, or NULL for the C
+ *                      heap.
+ * \param category      The category of the allocation.
+ * \param mem           The memory to reclaim.
+ * \param size          The size the memory was allocated with.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_memory_reclaim(
+    RCPR_SYM(allocator)* alloc, int category, void* mem, size_t size)
+{
+    if (NULL == mem)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    weightgraph_memory_track(category, size, 0);
+
+    if (NULL == alloc)
+    {
+        free(mem);
+        return STATUS_SUCCESS;
+    }
+
+    return allocator_reclaim(alloc, mem);
+}
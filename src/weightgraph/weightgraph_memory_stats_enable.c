@@ -0,0 +1,28 @@
+/**
+ * \file weightgraph/weightgraph_memory_stats_enable.c
+ *
+ * \brief Start counting the memory allocated by the library.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief The memory accounting of the library, zeroed until enabled.
+ */
+weightgraph_memory_accounting weightgraph_memory;
+
+/**
+ * \brief Start counting the memory allocated by the library.
+ *
+ * Counting is off by default, so that allocations only cost a branch.  It
+ * should be enabled before the library allocates anything, as blocks
+ * allocated before it is enabled are not counted when they are reclaimed.
+ * Counting can't be turned off again.
+ */
+void weightgraph_memory_stats_enable(void)
+{
+    atomic_store(&weightgraph_memory.enabled, true);
+}
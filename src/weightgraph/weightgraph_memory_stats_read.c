@@ -0,0 +1,46 @@
+/**
+ * \file weightgraph/weightgraph_memory_stats_read.c
+ *
+ * \brief Read the memory counted for a category.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Read the memory counted for a category.
+ *
+ * The counters are updated independently, so a snapshot taken while other
+ * threads allocate may be slightly inconsistent.
+ *
+ * \param stats         The snapshot to fill in.
+ * \param category      The category to read, or
+ *                      \ref WEIGHTGRAPH_MEMORY_CATEGORY_COUNT for the total
+ *                      of all categories.
+ */
+void weightgraph_memory_stats_read(
+    weightgraph_memory_stats* stats, int category)
+{
+    weightgraph_memory_counters* counters;
+    int_fast64_t live;
+
+    memset(stats, 0, sizeof(*stats));
+    if (category < 0 || category > WEIGHTGRAPH_MEMORY_CATEGORY_COUNT)
+    {
+        return;
+    }
+
+    counters = &weightgraph_memory.counters[category];
+    stats->allocations = atomic_load(&counters->allocations);
+    stats->reclaims = atomic_load(&counters->reclaims);
+    stats->bytes = atomic_load(&counters->bytes);
+    stats->peak_bytes = (uint64_t)atomic_load(&counters->peak_bytes);
+
+    /* blocks allocated before counting began can drive this negative. */
+    live = atomic_load(&counters->live_bytes);
+    stats->live_bytes = (live > 0) ? (uint64_t)live : 0;
+}
@@ -0,0 +1,29 @@
+/**
+ * \file weightgraph/weightgraph_memory_stats_reset_peak.c
+ *
+ * \brief Start a new high-water mark of the memory counted.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Start a new high-water mark of the memory counted.
+ *
+ * The peak of each category, and of the total, is lowered to the bytes that
+ * are live now, so that the peak read afterwards is the most allocated at
+ * once since the reset.  This lets the peak of each phase of a program be
+ * measured in turn.
+ */
+void weightgraph_memory_stats_reset_peak(void)
+{
+    for (int i = 0; i <= WEIGHTGRAPH_MEMORY_CATEGORY_COUNT; ++i)
+    {
+        weightgraph_memory_counters* counters = &weightgraph_memory.counters[i];
+        int_fast64_t live = atomic_load(&counters->live_bytes);
+
+        atomic_store(&counters->peak_bytes, (live > 0) ? live : 0);
+    }
+}
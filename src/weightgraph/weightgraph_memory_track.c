@@ -0,0 +1,83 @@
+/**
+ * \file weightgraph/weightgraph_memory_track.c
+ *
+ * \brief Count a change in the size of a block of memory.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/* forward decls. */
+static void weightgraph_memory_count(
+    weightgraph_memory_counters* counters, size_t old_size, size_t size);
+
+/**
+ * \brief Count a change in the size of a block of memory.
+ *
+ * A block is allocated when its old size is zero, and reclaimed when its new
+ * size is zero.  Nothing is counted unless accounting is enabled.
+ *
+ * \param category      The category of the block.
+ * \param old_size      The size of the block before the change.
+ * \param size          The size of the block after the change.
+ */
+void weightgraph_memory_track(int category, size_t old_size, size_t size)
+{
+    if (!atomic_load_explicit(
+            &weightgraph_memory.enabled, memory_order_relaxed))
+    {
+        return;
+    }
+
+    weightgraph_memory_count(
+        &weightgraph_memory.counters[category], old_size, size);
+    weightgraph_memory_count(
+        &weightgraph_memory.counters[WEIGHTGRAPH_MEMORY_CATEGORY_COUNT],
+        old_size, size);
+}
+
+/**
+ * \brief Update a set of counters for a change in the size of a block.
+ *
+ * \param counters      The counters to update.
+ * \param old_size      The size of the block before the change.
+ * \param size          The size of the block after the change.
+ */
+static void weightgraph_memory_count(
+    weightgraph_memory_counters* counters, size_t old_size, size_t size)
+{
+    int_fast64_t live, peak;
+
+    if (0 == size)
+    {
+        atomic_fetch_add_explicit(
+            &counters->reclaims, 1, memory_order_relaxed);
+    }
+    else
+    {
+        atomic_fetch_add_explicit(
+            &counters->allocations, 1, memory_order_relaxed);
+        if (size > old_size)
+        {
+            atomic_fetch_add_explicit(
+                &counters->bytes, size - old_size, memory_order_relaxed);
+        }
+    }
+
+    live =
+        atomic_fetch_add_explicit(
+            &counters->live_bytes,
+            (int_fast64_t)size - (int_fast64_t)old_size, memory_order_relaxed)
+        + (int_fast64_t)size - (int_fast64_t)old_size;
+
+    /* raise the high-water mark if this block set a new one. */
+    peak = atomic_load_explicit(&counters->peak_bytes, memory_order_relaxed);
+    while (live > peak
+        && !atomic_compare_exchange_weak_explicit(
+                &counters->peak_bytes, &peak, live, memory_order_relaxed,
+                memory_order_relaxed))
+    {
+    }
+}
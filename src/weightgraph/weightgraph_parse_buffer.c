@@ -0,0 +1,52 @@
+/**
+ * \file weightgraph/weightgraph_parse_buffer.c
+ *
+ * \brief Parse an XML file in a buffer.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Parse the given buffer, creating a weightgraph AST.
+ *
+ * \param graph         Pointer to receive the AST.
+ * \param alloc         The allocator to use.
+ * \param buffer        The buffer to parse.
+ * \param buffer_size   The size of the buffer to parse.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_parse_buffer(
+    weightgraph** graph, RCPR_SYM(allocator)* alloc,
+    const uint8_t* buffer, size_t buffer_size)
+{
+    status retval, release_retval;
+    weightgraph_parser* parser;
+
+    /* create a parser for this document. */
+    retval = weightgraph_parser_create(&parser, alloc);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* parse the document. */
+    retval = weightgraph_parser_parse(parser, graph, buffer, buffer_size);
+
+    /* release the parser. */
+    release_retval =
+        resource_release(weightgraph_parser_resource_handle(parser));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
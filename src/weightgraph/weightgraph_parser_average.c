@@ -0,0 +1,35 @@
+/**
+ * \file weightgraph/weightgraph_parser_average.c
+ *
+ * \brief Set the parsed initial average.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Set the initial average of the AST being built by the parser, or
+ * pass it to the stream handler.
+ *
+ * \param parser        The parser.
+ * \param average       The initial moving average.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - the failure returned by the stream handler.
+ */
+status weightgraph_parser_average(weightgraph_parser* parser, double average)
+{
+    if (NULL != parser->handler)
+    {
+        return
+            parser->handler->beginning_average(
+                parser->handler->context, average);
+    }
+
+    parser->graph->initial_average = average;
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,170 @@
+/**
+ * \file weightgraph/weightgraph_parser_create.c
+ *
+ * \brief Create a reusable weightgraph parser.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "weightgraph_internal.h"
+
+RCPR_IMPORT_resource;
+
+/**
+ * \brief The size of the header recording the size of an expat block, which
+ * keeps the block suitably aligned.
+ */
+#define WEIGHTGRAPH_EXPAT_HEADER_SIZE sizeof(max_align_t)
+
+/* forward decls. */
+static void* weightgraph_expat_malloc(size_t size);
+static void* weightgraph_expat_realloc(void* ptr, size_t size);
+static void weightgraph_expat_free(void* ptr);
+
+/**
+ * \brief The memory functions given to expat, so that its memory is counted.
+ */
+static const XML_Memory_Handling_Suite weightgraph_expat_memory = {
+    &weightgraph_expat_malloc, &weightgraph_expat_realloc,
+    &weightgraph_expat_free };
+
+/**
+ * \brief Create a parser that can be reused to parse many documents.
+ *
+ * \param parser        Pointer to receive the new parser.
+ * \param alloc         The allocator to use for this parser and the ASTs it
+ *                      creates.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_parser_create(
+    weightgraph_parser** parser, RCPR_SYM(allocator)* alloc)
+{
+    status retval, release_retval;
+    weightgraph_parser* tmp;
+
+    /* allocate memory for the parser. */
+    retval =
+        weightgraph_memory_allocate(
+            alloc, WEIGHTGRAPH_MEMORY_PARSER, (void**)&tmp, sizeof(*tmp));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* clear memory. */
+    memset(tmp, 0, sizeof(*tmp));
+
+    /* set initial values. */
+    resource_init(&tmp->hdr, &weightgraph_parser_resource_release);
+    tmp->alloc = alloc;
+
+    /* create the expat parser. */
+    tmp->parser = XML_ParserCreate_MM(NULL, &weightgraph_expat_memory, NULL);
+    if (NULL == tmp->parser)
+    {
+        retval = ERROR_PARSER_CREATE;
+        goto cleanup_tmp;
+    }
+
+    /* success. */
+    *parser = tmp;
+    retval = STATUS_SUCCESS;
+    goto done;
+
+cleanup_tmp:
+    release_retval = resource_release(&tmp->hdr);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Allocate memory for expat.
+ *
+ * Expat doesn't give the size of a block when freeing it, so the size is
+ * recorded in a header before the block.
+ *
+ * \param size          The size of the block.
+ *
+ * \returns the block, or NULL on failure.
+ */
+static void* weightgraph_expat_malloc(size_t size)
+{
+    uint8_t* block = (uint8_t*)malloc(WEIGHTGRAPH_EXPAT_HEADER_SIZE + size);
+    if (NULL == block)
+    {
+        return NULL;
+    }
+
+    memcpy(block, &size, sizeof(size));
+    weightgraph_memory_track(WEIGHTGRAPH_MEMORY_EXPAT, 0, size);
+
+    return block + WEIGHTGRAPH_EXPAT_HEADER_SIZE;
+}
+
+/**
+ * \brief Resize memory for expat.
+ *
+ * \param ptr           The block to resize, or NULL to allocate one.
+ * \param size          The new size of the block.
+ *
+ * \returns the resized block, or NULL on failure.
+ */
+static void* weightgraph_expat_realloc(void* ptr, size_t size)
+{
+    uint8_t* block;
+    size_t old_size;
+
+    if (NULL == ptr)
+    {
+        return weightgraph_expat_malloc(size);
+    }
+
+    block = (uint8_t*)ptr - WEIGHTGRAPH_EXPAT_HEADER_SIZE;
+    memcpy(&old_size, block, sizeof(old_size));
+
+    block = (uint8_t*)realloc(block, WEIGHTGRAPH_EXPAT_HEADER_SIZE + size);
+    if (NULL == block)
+    {
+        return NULL;
+    }
+
+    memcpy(block, &size, sizeof(size));
+    weightgraph_memory_track(WEIGHTGRAPH_MEMORY_EXPAT, old_size, size);
+
+    return block + WEIGHTGRAPH_EXPAT_HEADER_SIZE;
+}
+
+/**
+ * \brief Free memory allocated for expat.
+ *
+ * \param ptr           The block to free, or NULL.
+ */
+static void weightgraph_expat_free(void* ptr)
+{
+    uint8_t* block;
+    size_t size;
+
+    if (NULL == ptr)
+    {
+        return;
+    }
+
+    block = (uint8_t*)ptr - WEIGHTGRAPH_EXPAT_HEADER_SIZE;
+    memcpy(&size, block, sizeof(size));
+    weightgraph_memory_track(WEIGHTGRAPH_MEMORY_EXPAT, size, 0);
+
+    free(block);
+}
@@ -0,0 +1,76 @@
+/**
+ * \file weightgraph/weightgraph_parser_entry.c
+ *
+ * \brief Add a parsed log entry.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+RCPR_IMPORT_rbtree;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Add a log entry to the AST being built by the parser, or pass it
+ * to the stream handler.
+ *
+ * An entry that can't be added to the AST, such as one with a date that is
+ * already present, is dropped.
+ *
+ * \param parser        The parser.
+ * \param date          The date of the entry.
+ * \param weight        The weight of the entry.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - the failure returned by the stream handler.
+ */
+status weightgraph_parser_entry(
+    weightgraph_parser* parser, const char* date, double weight)
+{
+    weightgraph* graph = parser->graph;
+    status retval;
+    weightgraph_entry* entry;
+
+    /* pass the entry to the stream handler, if streaming. */
+    if (NULL != parser->handler)
+    {
+        return parser->handler->log(parser->handler->context, date, weight);
+    }
+
+    /* create a new entry. */
+    retval = weightgraph_entry_create(&entry, graph->alloc, date, weight);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* add this entry to the graph. */
+    retval = rbtree_insert(graph->entries, &entry->hdr);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_entry;
+    }
+
+    /* track the range of weights as they are ingested. */
+    if (0 == graph->entry_count || entry->weight < graph->min_weight)
+    {
+        graph->min_weight = entry->weight;
+    }
+    if (0 == graph->entry_count || entry->weight > graph->max_weight)
+    {
+        graph->max_weight = entry->weight;
+    }
+    ++graph->entry_count;
+
+    /* success. */
+    goto done;
+
+cleanup_entry:
+    resource_release(&entry->hdr);
+
+done:
+    return STATUS_SUCCESS;
+}
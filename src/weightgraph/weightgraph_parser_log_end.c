@@ -0,0 +1,24 @@
+/**
+ * \file weightgraph/weightgraph_parser_log_end.c
+ *
+ * \brief Get the end of the last log record parsed.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Get the offset just past the last log record in the last buffer
+ * parsed.
+ *
+ * \param parser        The parser.
+ *
+ * \returns the offset in the buffer just past the last log element, or 0 if
+ * the buffer held no complete log element.
+ */
+size_t weightgraph_parser_log_end(const weightgraph_parser* parser)
+{
+    return parser->log_end;
+}
@@ -0,0 +1,35 @@
+/**
+ * \file weightgraph/weightgraph_parser_parse.c
+ *
+ * \brief Parse an XML file in a buffer with a reusable parser.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Parse the given buffer with a reusable parser, creating a
+ * weightgraph AST.
+ *
+ * The parser is reset before each document, so a single parser can parse
+ * any number of documents without being recreated.
+ *
+ * \param parser        The parser.
+ * \param graph         Pointer to receive the AST.
+ * \param buffer        The buffer to parse.
+ * \param buffer_size   The size of the buffer to parse.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_parser_parse(
+    weightgraph_parser* parser, weightgraph** graph, const uint8_t* buffer,
+    size_t buffer_size)
+{
+    return
+        weightgraph_parser_run(
+            parser, graph, NULL, buffer, buffer_size, true);
+}
@@ -0,0 +1,38 @@
+/**
+ * \file weightgraph/weightgraph_parser_parse_records.c
+ *
+ * \brief Parse log records appended to a weight log.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Parse the log records appended to a weight log, creating a
+ * weightgraph AST of just those records.
+ *
+ * The buffer holds the part of the log after the last record that was
+ * parsed, as given by \ref weightgraph_parser_log_end.  It may end with the
+ * closing tag of the log, or part way through a record that is still being
+ * written, which is left for the next call.
+ *
+ * \param parser        The parser.
+ * \param graph         Pointer to receive the AST.
+ * \param buffer        The buffer to parse.
+ * \param buffer_size   The size of the buffer to parse.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_parser_parse_records(
+    weightgraph_parser* parser, weightgraph** graph, const uint8_t* buffer,
+    size_t buffer_size)
+{
+    /* the records are parsed inside of a log element of their own. */
+    return
+        weightgraph_parser_run(
+            parser, graph, "<weight-log>", buffer, buffer_size, false);
+}
@@ -0,0 +1,209 @@
+/**
+ * \file weightgraph/weightgraph_parser_reset.c
+ *
+ * \brief Reset a reusable parser for a new document.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <expat.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "weightgraph_internal.h"
+
+/* forward decls. */
+static void weightgraph_parse_start(
+    void* data, const char* element, const char** attr);
+static void weightgraph_parse_end(
+    void* data, const char* element);
+static void weightgraph_parse_beginning_averages(
+    weightgraph_parser* parser, const char** attr);
+static void weightgraph_parse_log(
+    weightgraph_parser* parser, const char** attr);
+static void weightgraph_parse_stream_status(
+    weightgraph_parser* parser, status retval);
+
+/**
+ * \brief Reset a parser for a new document, and install its handlers.
+ *
+ * Without a stream handler, the elements of the document are added to the
+ * AST set in the parser.  With one, each element is passed to the handler
+ * as soon as it is parsed, and no AST is built.
+ *
+ * \param parser        The parser.
+ * \param handler       The stream handler, or NULL.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_parser_reset(
+    weightgraph_parser* parser, const weightgraph_stream_handler* handler)
+{
+    /* reset the parser state left over from the previous document. */
+    if (parser->used && XML_TRUE != XML_ParserReset(parser->parser, NULL))
+    {
+        return ERROR_PARSER_CREATE;
+    }
+
+    parser->used = true;
+    parser->graph = NULL;
+    parser->log_end = 0;
+    parser->handler = handler;
+    parser->stream_status = STATUS_SUCCESS;
+    parser->document_format = parser->format;
+    parser->text_started = false;
+    parser->carry_size = 0;
+    parser->archive_started = false;
+    parser->archive_ended = false;
+    parser->archive_tail = 0;
+
+    /* the handlers find the AST or stream handler through the parser. */
+    XML_SetUserData(parser->parser, parser);
+    XML_SetElementHandler(
+        parser->parser, &weightgraph_parse_start, &weightgraph_parse_end);
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Parse a start element.
+ *
+ * \param data          Opaque pointer to the parser.
+ * \param element       The element name.
+ * \param attr          The attribute array.
+ */
+static void weightgraph_parse_start(
+    void* data, const char* element, const char** attr)
+{
+    weightgraph_parser* parser = (weightgraph_parser*)data;
+    weightgraph* graph = parser->graph;
+
+    /* is this the beginning averages element? */
+    if (!strcmp(element, "beginning-averages"))
+    {
+        /* parse this element. */
+        weightgraph_parse_beginning_averages(parser, attr);
+    }
+    else if (!strcmp(element, "log"))
+    {
+        /* parse this element. */
+        weightgraph_parse_log(parser, attr);
+    }
+    else if (!strcmp(element, "weight-log"))
+    {
+        /* ignore the weight-log outer tag. */
+    }
+    else if (NULL != graph)
+    {
+        /* otherwise, indicate an error. */
+        graph->error = true;
+    }
+}
+
+/**
+ * \brief Parse an end element.
+ *
+ * The end of each log element is recorded, so that a log that is appended
+ * to can be parsed again from there.
+ *
+ * \param data          Opaque pointer to the parser.
+ * \param element       The element name.
+ */
+static void weightgraph_parse_end(
+    void* data, const char* element)
+{
+    weightgraph_parser* parser = (weightgraph_parser*)data;
+
+    if (!strcmp(element, "log"))
+    {
+        parser->log_end =
+            XML_GetCurrentByteIndex(parser->parser)
+                + XML_GetCurrentByteCount(parser->parser);
+    }
+}
+
+/**
+ * \brief Parse a log entry.
+ *
+ * \param parser        The parser.
+ * \param attrs         The element attributes.
+ */
+static void weightgraph_parse_log(
+    weightgraph_parser* parser, const char** attr)
+{
+    status retval;
+    const char* date = NULL;
+    const char* weight = NULL;
+
+    /* loop through the attributes. */
+    for (int i = 0; 0 != attr[i]; i += 2)
+    {
+        if (!strcmp(attr[i], "date"))
+        {
+            date = attr[i + 1];
+        }
+        else if (!strcmp(attr[i], "weight"))
+        {
+            weight = attr[i + 1];
+        }
+    }
+
+    /* verify that both fields are set. */
+    if (NULL == date || NULL == weight)
+    {
+        if (NULL != parser->handler)
+        {
+            weightgraph_parse_stream_status(parser, ERROR_XML_PARSE);
+        }
+        else
+        {
+            parser->graph->error = true;
+        }
+
+        return;
+    }
+
+    /* add the entry to the AST, or pass it to the stream handler. */
+    retval = weightgraph_parser_entry(parser, date, atof(weight));
+    weightgraph_parse_stream_status(parser, retval);
+}
+
+/**
+ * \brief Parse a beginning averages element.
+ *
+ * \param parser        The parser.
+ * \param attrs         The element attributes.
+ */
+static void weightgraph_parse_beginning_averages(
+    weightgraph_parser* parser, const char** attr)
+{
+    /* loop through the attributes. */
+    for (int i = 0; 0 != attr[i]; i += 2)
+    {
+        if (!strcmp(attr[i], "moving-average"))
+        {
+            weightgraph_parse_stream_status(
+                parser, weightgraph_parser_average(parser, atof(attr[i + 1])));
+        }
+    }
+}
+
+/**
+ * \brief Record the status of a stream handler, stopping the parse on the
+ * first failure.
+ *
+ * \param parser        The parser.
+ * \param retval        The status returned by the stream handler.
+ */
+static void weightgraph_parse_stream_status(
+    weightgraph_parser* parser, status retval)
+{
+    if (STATUS_SUCCESS != retval && STATUS_SUCCESS == parser->stream_status)
+    {
+        parser->stream_status = retval;
+        XML_StopParser(parser->parser, XML_FALSE);
+    }
+}
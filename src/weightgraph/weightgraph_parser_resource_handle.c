@@ -0,0 +1,23 @@
+/**
+ * \file weightgraph/weightgraph_parser_resource_handle.c
+ *
+ * \brief Get the resource handle for a weightgraph parser.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Get the resource handle for a weightgraph parser.
+ *
+ * \param parser        The parser.
+ *
+ * \returns the resource handle, which is used to release the parser.
+ */
+RCPR_SYM(resource)* weightgraph_parser_resource_handle(
+    weightgraph_parser* parser)
+{
+    return &parser->hdr;
+}
@@ -0,0 +1,65 @@
+/**
+ * \file weightgraph/weightgraph_parser_resource_release.c
+ *
+ * \brief Release a weightgraph parser resource.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Release a weightgraph parser resource.
+ *
+ * \param r         The resource to release.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_parser_resource_release(RCPR_SYM(resource)* r)
+{
+    status retval, release_retval;
+    weightgraph_parser* parser = (weightgraph_parser*)r;
+
+    /* free the expat parser if created. */
+    if (NULL != parser->parser)
+    {
+        XML_ParserFree(parser->parser);
+    }
+
+    /* reclaim the text line carry buffer if allocated. */
+    retval = STATUS_SUCCESS;
+    if (NULL != parser->carry)
+    {
+        retval =
+            weightgraph_memory_reclaim(
+                parser->alloc, WEIGHTGRAPH_MEMORY_PARSER, parser->carry,
+                parser->carry_capacity);
+    }
+
+    /* reclaim the archive block if allocated. */
+    if (NULL != parser->archive_block)
+    {
+        release_retval =
+            weightgraph_memory_reclaim(
+                parser->alloc, WEIGHTGRAPH_MEMORY_ARCHIVE,
+                parser->archive_block, sizeof(*parser->archive_block));
+        if (STATUS_SUCCESS != release_retval)
+        {
+            retval = release_retval;
+        }
+    }
+
+    /* reclaim memory. */
+    release_retval =
+        weightgraph_memory_reclaim(
+            parser->alloc, WEIGHTGRAPH_MEMORY_PARSER, parser, sizeof(*parser));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
@@ -0,0 +1,150 @@
+/**
+ * \file weightgraph/weightgraph_parser_run.c
+ *
+ * \brief Run a reusable parser over a buffer.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <expat.h>
+#include <string.h>
+
+#include "weightgraph_internal.h"
+
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Run the parser over a buffer, creating a weightgraph AST.
+ *
+ * The parser is reset before each run.  The prefix, if any, is parsed
+ * before the buffer, so that a fragment of a document can be given the
+ * outer element it lacks.  A run that is not final accepts a buffer that
+ * ends part way through an element, which is then ignored.  The end of the
+ * last complete log element in the buffer is recorded in the parser.
+ *
+ * A CSV or NDJSON log is parsed a line at a time instead, without the
+ * prefix, and a run that is not final ignores a last line without a newline.
+ * An archive is decoded a record at a time, and can't be given a prefix.
+ *
+ * \param parser        The parser.
+ * \param graph         Pointer to receive the AST.
+ * \param prefix        Text to parse before the buffer, or NULL.
+ * \param buffer        The buffer to parse.
+ * \param buffer_size   The size of the buffer to parse.
+ * \param final         true if the buffer ends the document.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_parser_run(
+    weightgraph_parser* parser, weightgraph** graph, const char* prefix,
+    const uint8_t* buffer, size_t buffer_size, bool final)
+{
+    status retval, release_retval;
+    weightgraph* tmp;
+    size_t prefix_size = (NULL == prefix) ? 0 : strlen(prefix);
+    size_t consumed;
+
+    /* create the initial AST. */
+    retval = weightgraph_create(&tmp, parser->alloc, 0.0);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* reset the parser state left over from the previous document. */
+    retval = weightgraph_parser_reset(parser, NULL);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_weightgraph;
+    }
+
+    /* the handlers build the AST through the parser. */
+    parser->graph = tmp;
+    parser->log_end = prefix_size;
+
+    /* detect the format of this document if it isn't known. */
+    if (WEIGHTGRAPH_INPUT_AUTO == parser->document_format)
+    {
+        parser->document_format =
+            weightgraph_input_format_sniff(buffer, buffer_size);
+    }
+
+    /* text logs are scanned a line at a time. */
+    if (WEIGHTGRAPH_INPUT_CSV == parser->document_format
+     || WEIGHTGRAPH_INPUT_NDJSON == parser->document_format)
+    {
+        retval =
+            weightgraph_parser_scan_text(
+                parser, buffer, buffer_size, final, &consumed);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_weightgraph;
+        }
+
+        parser->log_end = consumed;
+        goto success;
+    }
+
+    /* archives are decoded a record at a time, and have no fragments. */
+    if (WEIGHTGRAPH_INPUT_ARCHIVE == parser->document_format)
+    {
+        if (prefix_size > 0)
+        {
+            retval = ERROR_ARCHIVE_FORMAT;
+            goto cleanup_weightgraph;
+        }
+
+        retval =
+            weightgraph_parser_scan_archive(
+                parser, buffer, buffer_size, final, &consumed);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_weightgraph;
+        }
+
+        parser->log_end = consumed;
+        goto success;
+    }
+
+    /* parse the prefix. */
+    if (prefix_size > 0
+     && XML_STATUS_OK !=
+            XML_Parse(parser->parser, prefix, prefix_size, XML_FALSE))
+    {
+        retval = ERROR_XML_PARSE;
+        goto cleanup_weightgraph;
+    }
+
+    /* parse the document. */
+    if (XML_STATUS_OK !=
+        XML_Parse(
+            parser->parser, (const char*)buffer, buffer_size,
+            final ? XML_TRUE : XML_FALSE))
+    {
+        retval = ERROR_XML_PARSE;
+        goto cleanup_weightgraph;
+    }
+
+    /* the end of the last log is relative to the buffer. */
+    parser->log_end -= prefix_size;
+
+success:
+    /* success. Return the AST to the caller. */
+    *graph = tmp;
+    retval = STATUS_SUCCESS;
+    goto done;
+
+cleanup_weightgraph:
+    release_retval = resource_release(&tmp->hdr);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+done:
+    parser->graph = NULL;
+    return retval;
+}
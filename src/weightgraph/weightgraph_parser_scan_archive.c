@@ -0,0 +1,203 @@
+/**
+ * \file weightgraph/weightgraph_parser_scan_archive.c
+ *
+ * \brief Decode the complete records of an archive.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "weightgraph_internal.h"
+
+/* forward decls. */
+static status weightgraph_parser_archive_block(
+    weightgraph_parser* parser, const uint8_t* record, size_t record_size);
+
+/**
+ * \brief Decode the complete records of an archive.
+ *
+ * The header is checked first, and each block is decoded in one pass and
+ * its entries passed on, a formatted date at a time.  The index and trailer
+ * after the end record are skipped, but must be whole, so that a truncated
+ * archive is rejected.
+ *
+ * \param parser        The parser.
+ * \param buffer        The buffer to decode.
+ * \param buffer_size   The size of the buffer.
+ * \param final         true if the buffer ends the archive, in which case the
+ *                      archive must be complete.
+ * \param consumed      Pointer to receive the number of bytes decoded, up to
+ *                      the end of the last complete record.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_ARCHIVE_FORMAT if the archive is malformed or truncated.
+ *      - the failure returned by the stream handler.
+ */
+status weightgraph_parser_scan_archive(
+    weightgraph_parser* parser, const uint8_t* buffer, size_t buffer_size,
+    bool final, size_t* consumed)
+{
+    status retval;
+    size_t offset = 0, record_size;
+    uint64_t bits;
+    double average;
+
+    *consumed = 0;
+
+    /* the header sets the style of the dates. */
+    if (!parser->archive_started)
+    {
+        if (buffer_size < WEIGHTGRAPH_ARCHIVE_HEADER_SIZE)
+        {
+            return final ? ERROR_ARCHIVE_FORMAT : STATUS_SUCCESS;
+        }
+
+        if (memcmp(
+                buffer, WEIGHTGRAPH_ARCHIVE_MAGIC,
+                WEIGHTGRAPH_ARCHIVE_MAGIC_SIZE)
+         || WEIGHTGRAPH_ARCHIVE_VERSION != buffer[4]
+         || buffer[5] > WEIGHTGRAPH_ARCHIVE_DATE_MONTH_DAY)
+        {
+            return ERROR_ARCHIVE_FORMAT;
+        }
+
+        parser->archive_started = true;
+        parser->archive_date_style = buffer[5];
+        parser->archive_year_width = buffer[6];
+        offset = WEIGHTGRAPH_ARCHIVE_HEADER_SIZE;
+    }
+
+    while (!parser->archive_ended && offset < buffer_size)
+    {
+        retval =
+            weightgraph_archive_record_size(
+                buffer + offset, buffer_size - offset, &record_size);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        /* a record split across pieces waits for the rest. */
+        if (0 == record_size || record_size > buffer_size - offset)
+        {
+            break;
+        }
+
+        switch (buffer[offset])
+        {
+            case WEIGHTGRAPH_ARCHIVE_RECORD_AVERAGE:
+                bits = weightgraph_archive_field_read(buffer + offset + 1, 8);
+                memcpy(&average, &bits, sizeof(average));
+                retval = weightgraph_parser_average(parser, average);
+                break;
+
+            case WEIGHTGRAPH_ARCHIVE_RECORD_BLOCK:
+                retval =
+                    weightgraph_parser_archive_block(
+                        parser, buffer + offset, record_size);
+                break;
+
+            default:
+                parser->archive_ended = true;
+                parser->archive_tail =
+                    weightgraph_archive_field_read(buffer + offset + 1, 4)
+                        * WEIGHTGRAPH_ARCHIVE_INDEX_ENTRY_SIZE
+                  + WEIGHTGRAPH_ARCHIVE_TRAILER_SIZE;
+                break;
+        }
+
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        offset += record_size;
+    }
+
+    /* the index and trailer are only needed to seek, so they are counted
+     * off without being read. */
+    if (parser->archive_ended)
+    {
+        if (buffer_size - offset > parser->archive_tail)
+        {
+            return ERROR_ARCHIVE_FORMAT;
+        }
+
+        parser->archive_tail -= buffer_size - offset;
+        offset = buffer_size;
+    }
+
+    if (final && (!parser->archive_ended || parser->archive_tail > 0))
+    {
+        return ERROR_ARCHIVE_FORMAT;
+    }
+
+    *consumed = offset;
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Decode a block record, and pass on each of its entries.
+ *
+ * \param parser        The parser.
+ * \param record        The block record.
+ * \param record_size   The size of the record.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_ARCHIVE_FORMAT if the block is malformed.
+ *      - the failure returned by the stream handler.
+ */
+static status weightgraph_parser_archive_block(
+    weightgraph_parser* parser, const uint8_t* record, size_t record_size)
+{
+    status retval;
+    weightgraph_archive_block* block;
+    char date[WEIGHTGRAPH_ARCHIVE_DATE_SIZE];
+
+    /* the block is kept from one archive to the next. */
+    if (NULL == parser->archive_block)
+    {
+        retval =
+            weightgraph_memory_allocate(
+                parser->alloc, WEIGHTGRAPH_MEMORY_ARCHIVE,
+                (void**)&parser->archive_block,
+                sizeof(*parser->archive_block));
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    block = parser->archive_block;
+    retval = weightgraph_archive_block_decode(block, record, record_size);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    for (size_t i = 0; i < block->count; ++i)
+    {
+        if (!weightgraph_archive_date_format(
+                date, parser->archive_date_style, parser->archive_year_width,
+                block->days[i]))
+        {
+            return ERROR_ARCHIVE_FORMAT;
+        }
+
+        retval =
+            weightgraph_parser_entry(
+                parser, date,
+                (double)block->weights[i] / WEIGHTGRAPH_ARCHIVE_WEIGHT_SCALE);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    return STATUS_SUCCESS;
+}
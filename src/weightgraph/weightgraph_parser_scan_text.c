@@ -0,0 +1,743 @@
+/**
+ * \file weightgraph/weightgraph_parser_scan_text.c
+ *
+ * \brief Parse the lines of a CSV or NDJSON log.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief The longest date or number, including its terminator, in a record.
+ */
+#define WEIGHTGRAPH_FIELD_SIZE 64
+
+/**
+ * \brief A field of a record, which points into the line.
+ */
+typedef struct weightgraph_field weightgraph_field;
+
+struct weightgraph_field
+{
+    const char* data;
+    size_t size;
+    /* true if the field is a JSON string holding escapes. */
+    bool escaped;
+};
+
+/* forward decls. */
+static status weightgraph_scan_line(
+    weightgraph_parser* parser, const char* line, size_t size);
+static status weightgraph_scan_csv(
+    weightgraph_parser* parser, const char* line, const char* end);
+static status weightgraph_scan_ndjson(
+    weightgraph_parser* parser, const char* line, const char* end);
+static status weightgraph_scan_record(
+    weightgraph_parser* parser, const weightgraph_field* date,
+    const weightgraph_field* weight, const weightgraph_field* average);
+static const char* weightgraph_scan_space(const char* p, const char* end);
+static const char* weightgraph_scan_string(
+    const char* p, const char* end, weightgraph_field* field);
+static void weightgraph_field_trim(weightgraph_field* field);
+static bool weightgraph_field_copy(
+    const weightgraph_field* field, char* out);
+static bool weightgraph_field_unescape(
+    const weightgraph_field* field, char* out);
+static uint32_t weightgraph_field_hex(const char* p);
+static bool weightgraph_field_number(
+    const weightgraph_field* field, double* value);
+static bool weightgraph_field_equals(
+    const weightgraph_field* field, const char* text);
+
+/**
+ * \brief Parse the complete lines of a CSV or NDJSON log.
+ *
+ * Lines are found with memchr, which the C library vectorizes, and each
+ * record is scanned in place, without copying the line.
+ *
+ * \param parser        The parser.
+ * \param buffer        The buffer to parse.
+ * \param buffer_size   The size of the buffer.
+ * \param final         true if the buffer ends the log, in which case a last
+ *                      line without a newline is parsed as well.
+ * \param consumed      Pointer to receive the number of bytes parsed, up to
+ *                      the end of the last complete line.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_RECORD_PARSE if a record is malformed.
+ *      - the failure returned by the stream handler.
+ */
+status weightgraph_parser_scan_text(
+    weightgraph_parser* parser, const uint8_t* buffer, size_t buffer_size,
+    bool final, size_t* consumed)
+{
+    status retval;
+    const char* line = (const char*)buffer;
+    const char* end = line + buffer_size;
+    const char* newline;
+
+    while (line < end
+        && NULL != (newline = (const char*)memchr(line, '\n', end - line)))
+    {
+        retval = weightgraph_scan_line(parser, line, newline - line);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        line = newline + 1;
+    }
+
+    /* the last line is only complete at the end of the log. */
+    if (final && line < end)
+    {
+        retval = weightgraph_scan_line(parser, line, end - line);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        line = end;
+    }
+
+    *consumed = line - (const char*)buffer;
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Parse a single line of a CSV or NDJSON log.
+ *
+ * \param parser        The parser.
+ * \param line          The line, without its newline.
+ * \param size          The size of the line.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_RECORD_PARSE if the record is malformed.
+ *      - the failure returned by the stream handler.
+ */
+static status weightgraph_scan_line(
+    weightgraph_parser* parser, const char* line, size_t size)
+{
+    const char* end = line + size;
+
+    /* skip a byte order mark before the first record. */
+    if (!parser->text_started && size >= 3
+     && !memcmp(line, "\xef\xbb\xbf", 3))
+    {
+        line += 3;
+    }
+
+    /* blank lines are skipped. */
+    line = weightgraph_scan_space(line, end);
+    if (line == end)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    if (WEIGHTGRAPH_INPUT_NDJSON == parser->document_format)
+    {
+        return weightgraph_scan_ndjson(parser, line, end);
+    }
+    else
+    {
+        return weightgraph_scan_csv(parser, line, end);
+    }
+}
+
+/**
+ * \brief Parse a "date,weight" CSV record.
+ *
+ * Further columns are ignored, and fields may be quoted.  A header line is
+ * skipped if it is the first record of the log.
+ *
+ * \param parser        The parser.
+ * \param line          The start of the record.
+ * \param end           The end of the line.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_RECORD_PARSE if the record is malformed.
+ *      - the failure returned by the stream handler.
+ */
+static status weightgraph_scan_csv(
+    weightgraph_parser* parser, const char* line, const char* end)
+{
+    weightgraph_field first, second;
+    const char* comma;
+    double value;
+    bool started = parser->text_started;
+
+    /* comments are skipped. */
+    if ('#' == *line)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    parser->text_started = true;
+
+    /* split the first two columns. */
+    comma = (const char*)memchr(line, ',', end - line);
+    if (NULL == comma)
+    {
+        return ERROR_RECORD_PARSE;
+    }
+
+    first.data = line;
+    first.size = comma - line;
+    first.escaped = false;
+    second.data = comma + 1;
+    second.escaped = false;
+    comma = (const char*)memchr(second.data, ',', end - second.data);
+    second.size = ((NULL == comma) ? end : comma) - second.data;
+
+    weightgraph_field_trim(&first);
+    weightgraph_field_trim(&second);
+
+    /* a header names its columns, rather than giving a weight. */
+    if (!weightgraph_field_number(&second, &value))
+    {
+        return started ? ERROR_RECORD_PARSE : STATUS_SUCCESS;
+    }
+
+    if (weightgraph_field_equals(&first, "moving-average"))
+    {
+        return weightgraph_scan_record(parser, NULL, NULL, &second);
+    }
+
+    return weightgraph_scan_record(parser, &first, &second, NULL);
+}
+
+/**
+ * \brief Parse an NDJSON record, a flat object on a single line.
+ *
+ * Keys other than "date", "weight" and "moving-average" are ignored, as long
+ * as their values are strings, numbers or literals.  Keys and strings may
+ * hold the standard JSON escapes, which are decoded, with "\\u" escapes
+ * becoming UTF-8.
+ *
+ * \param parser        The parser.
+ * \param line          The start of the record.
+ * \param end           The end of the line.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_RECORD_PARSE if the record is malformed.
+ *      - the failure returned by the stream handler.
+ */
+static status weightgraph_scan_ndjson(
+    weightgraph_parser* parser, const char* line, const char* end)
+{
+    weightgraph_field key, value;
+    weightgraph_field date = { NULL, 0, false };
+    weightgraph_field weight = { NULL, 0, false };
+    weightgraph_field average = { NULL, 0, false };
+    const char* p = line;
+
+    parser->text_started = true;
+
+    if ('{' != *p++)
+    {
+        return ERROR_RECORD_PARSE;
+    }
+
+    p = weightgraph_scan_space(p, end);
+    if (p < end && '}' == *p)
+    {
+        ++p;
+        goto trailer;
+    }
+
+    for (;;)
+    {
+        bool string;
+
+        /* read the key. */
+        if (p == end || '"' != *p++)
+        {
+            return ERROR_RECORD_PARSE;
+        }
+        p = weightgraph_scan_string(p, end, &key);
+        if (NULL == p)
+        {
+            return ERROR_RECORD_PARSE;
+        }
+
+        p = weightgraph_scan_space(p, end);
+        if (p == end || ':' != *p++)
+        {
+            return ERROR_RECORD_PARSE;
+        }
+        p = weightgraph_scan_space(p, end);
+        if (p == end)
+        {
+            return ERROR_RECORD_PARSE;
+        }
+
+        /* read a string, or a number or literal. */
+        string = ('"' == *p);
+        if (string)
+        {
+            p = weightgraph_scan_string(p + 1, end, &value);
+            if (NULL == p)
+            {
+                return ERROR_RECORD_PARSE;
+            }
+        }
+        else
+        {
+            value.data = p;
+            value.escaped = false;
+            while (p < end && ',' != *p && '}' != *p
+                && ' ' != *p && '\t' != *p && '\r' != *p)
+            {
+                if ('{' == *p || '[' == *p || '"' == *p)
+                {
+                    return ERROR_RECORD_PARSE;
+                }
+                ++p;
+            }
+            value.size = p - value.data;
+            if (0 == value.size)
+            {
+                return ERROR_RECORD_PARSE;
+            }
+        }
+
+        /* keep the fields of interest. */
+        if (weightgraph_field_equals(&key, "date") && string)
+        {
+            date = value;
+        }
+        else if (weightgraph_field_equals(&key, "weight") && !string)
+        {
+            weight = value;
+        }
+        else if (weightgraph_field_equals(&key, "moving-average") && !string)
+        {
+            average = value;
+        }
+
+        p = weightgraph_scan_space(p, end);
+        if (p == end)
+        {
+            return ERROR_RECORD_PARSE;
+        }
+        if ('}' == *p++)
+        {
+            break;
+        }
+        if (',' != p[-1])
+        {
+            return ERROR_RECORD_PARSE;
+        }
+        p = weightgraph_scan_space(p, end);
+    }
+
+trailer:
+    /* nothing may follow the object. */
+    if (weightgraph_scan_space(p, end) != end)
+    {
+        return ERROR_RECORD_PARSE;
+    }
+
+    return
+        weightgraph_scan_record(
+            parser, (NULL == date.data) ? NULL : &date,
+            (NULL == weight.data) ? NULL : &weight,
+            (NULL == average.data) ? NULL : &average);
+}
+
+/**
+ * \brief Pass the fields of a record to the parser.
+ *
+ * \param parser        The parser.
+ * \param date          The date field, or NULL.
+ * \param weight        The weight field, or NULL.
+ * \param average       The moving average field, or NULL.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_RECORD_PARSE if the record is malformed.
+ *      - the failure returned by the stream handler.
+ */
+static status weightgraph_scan_record(
+    weightgraph_parser* parser, const weightgraph_field* date,
+    const weightgraph_field* weight, const weightgraph_field* average)
+{
+    status retval;
+    char date_text[WEIGHTGRAPH_FIELD_SIZE];
+    double value;
+
+    /* an entry needs both a date and a weight. */
+    if ((NULL == date) != (NULL == weight))
+    {
+        return ERROR_RECORD_PARSE;
+    }
+
+    if (NULL != average)
+    {
+        if (!weightgraph_field_number(average, &value))
+        {
+            return ERROR_RECORD_PARSE;
+        }
+
+        retval = weightgraph_parser_average(parser, value);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    if (NULL != date)
+    {
+        if (0 == date->size
+         || !weightgraph_field_copy(date, date_text)
+         || !weightgraph_field_number(weight, &value))
+        {
+            return ERROR_RECORD_PARSE;
+        }
+
+        return weightgraph_parser_entry(parser, date_text, value);
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Skip whitespace.
+ *
+ * \param p             The position from which to skip.
+ * \param end           The end of the line.
+ *
+ * \returns the first position that is not whitespace, or the end.
+ */
+static const char* weightgraph_scan_space(const char* p, const char* end)
+{
+    while (p < end && (' ' == *p || '\t' == *p || '\r' == *p))
+    {
+        ++p;
+    }
+
+    return p;
+}
+
+/**
+ * \brief Find the end of a JSON string, checking its escapes.
+ *
+ * \param p             The position just after the opening quote.
+ * \param end           The end of the line.
+ * \param field         The field to receive the string, without its quotes.
+ *
+ * \returns the position just after the closing quote, or NULL if the string
+ * is unterminated or holds an invalid escape.
+ */
+static const char* weightgraph_scan_string(
+    const char* p, const char* end, weightgraph_field* field)
+{
+    field->data = p;
+    field->escaped = false;
+
+    while (p < end && '"' != *p)
+    {
+        if ('\\' == *p)
+        {
+            field->escaped = true;
+            if (++p == end || 0 == *p || NULL == strchr("\"\\/bfnrtu", *p))
+            {
+                return NULL;
+            }
+
+            /* a unicode escape is followed by four hex digits. */
+            if ('u' == *p)
+            {
+                for (int i = 0; i < 4; ++i)
+                {
+                    if (++p == end || !isxdigit((unsigned char)*p))
+                    {
+                        return NULL;
+                    }
+                }
+            }
+        }
+
+        ++p;
+    }
+
+    if (p == end)
+    {
+        return NULL;
+    }
+
+    field->size = p - field->data;
+
+    return p + 1;
+}
+
+/**
+ * \brief Trim whitespace and surrounding quotes from a CSV field.
+ *
+ * \param field         The field.
+ */
+static void weightgraph_field_trim(weightgraph_field* field)
+{
+    while (field->size > 0
+        && (' ' == field->data[0] || '\t' == field->data[0]))
+    {
+        ++field->data;
+        --field->size;
+    }
+
+    while (field->size > 0
+        && (' ' == field->data[field->size - 1]
+         || '\t' == field->data[field->size - 1]
+         || '\r' == field->data[field->size - 1]))
+    {
+        --field->size;
+    }
+
+    if (field->size >= 2
+     && '"' == field->data[0] && '"' == field->data[field->size - 1])
+    {
+        ++field->data;
+        field->size -= 2;
+    }
+}
+
+/**
+ * \brief Copy a field into a terminated string.
+ *
+ * \param field         The field.
+ * \param out           Buffer of \ref WEIGHTGRAPH_FIELD_SIZE bytes.
+ *
+ * \returns true if the field fits.
+ */
+static bool weightgraph_field_copy(
+    const weightgraph_field* field, char* out)
+{
+    if (field->escaped)
+    {
+        return weightgraph_field_unescape(field, out);
+    }
+
+    if (field->size >= WEIGHTGRAPH_FIELD_SIZE)
+    {
+        return false;
+    }
+
+    memcpy(out, field->data, field->size);
+    out[field->size] = 0;
+
+    return true;
+}
+
+/**
+ * \brief Decode the escapes of a JSON string into a terminated string.
+ *
+ * The escapes were checked when the string was scanned.  A "\\u" escape is
+ * written as UTF-8, and a surrogate pair as the single character it
+ * encodes.
+ *
+ * \param field         The field.
+ * \param out           Buffer of \ref WEIGHTGRAPH_FIELD_SIZE bytes.
+ *
+ * \returns true if the decoded field fits, and holds neither a NUL nor an
+ * unpaired surrogate.
+ */
+static bool weightgraph_field_unescape(
+    const weightgraph_field* field, char* out)
+{
+    const char* p = field->data;
+    const char* end = p + field->size;
+    size_t size = 0;
+
+    while (p < end)
+    {
+        char bytes[4];
+        size_t count = 1;
+        uint32_t code;
+
+        if ('\\' != *p)
+        {
+            bytes[0] = *p++;
+        }
+        else
+        {
+            p += 2;
+            switch (p[-1])
+            {
+                case 'b':
+                    bytes[0] = '\b';
+                    break;
+
+                case 'f':
+                    bytes[0] = '\f';
+                    break;
+
+                case 'n':
+                    bytes[0] = '\n';
+                    break;
+
+                case 'r':
+                    bytes[0] = '\r';
+                    break;
+
+                case 't':
+                    bytes[0] = '\t';
+                    break;
+
+                case 'u':
+                    code = weightgraph_field_hex(p);
+                    p += 4;
+
+                    /* a high surrogate must be followed by a low one. */
+                    if (code >= 0xd800 && code < 0xdc00)
+                    {
+                        uint32_t low;
+
+                        if (end - p < 6 || '\\' != p[0] || 'u' != p[1])
+                        {
+                            return false;
+                        }
+
+                        low = weightgraph_field_hex(p + 2);
+                        if (low < 0xdc00 || low >= 0xe000)
+                        {
+                            return false;
+                        }
+
+                        code = 0x10000 + ((code - 0xd800) << 10) + low - 0xdc00;
+                        p += 6;
+                    }
+                    else if (0 == code || (code >= 0xdc00 && code < 0xe000))
+                    {
+                        return false;
+                    }
+
+                    /* encode the character as UTF-8. */
+                    if (code < 0x80)
+                    {
+                        bytes[0] = (char)code;
+                    }
+                    else if (code < 0x800)
+                    {
+                        bytes[0] = (char)(0xc0 | (code >> 6));
+                        bytes[1] = (char)(0x80 | (code & 0x3f));
+                        count = 2;
+                    }
+                    else if (code < 0x10000)
+                    {
+                        bytes[0] = (char)(0xe0 | (code >> 12));
+                        bytes[1] = (char)(0x80 | ((code >> 6) & 0x3f));
+                        bytes[2] = (char)(0x80 | (code & 0x3f));
+                        count = 3;
+                    }
+                    else
+                    {
+                        bytes[0] = (char)(0xf0 | (code >> 18));
+                        bytes[1] = (char)(0x80 | ((code >> 12) & 0x3f));
+                        bytes[2] = (char)(0x80 | ((code >> 6) & 0x3f));
+                        bytes[3] = (char)(0x80 | (code & 0x3f));
+                        count = 4;
+                    }
+                    break;
+
+                /* a quote, backslash or slash stands for itself. */
+                default:
+                    bytes[0] = p[-1];
+                    break;
+            }
+        }
+
+        if (size + count >= WEIGHTGRAPH_FIELD_SIZE)
+        {
+            return false;
+        }
+
+        memcpy(out + size, bytes, count);
+        size += count;
+    }
+
+    out[size] = 0;
+
+    return true;
+}
+
+/**
+ * \brief Read the four hex digits of a unicode escape.
+ *
+ * \param p             The first digit.
+ *
+ * \returns the value of the digits.
+ */
+static uint32_t weightgraph_field_hex(const char* p)
+{
+    uint32_t value = 0;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        int digit = tolower((unsigned char)p[i]);
+
+        value = (value << 4)
+              | (uint32_t)(isdigit(digit) ? digit - '0' : digit - 'a' + 10);
+    }
+
+    return value;
+}
+
+/**
+ * \brief Convert a field to a number.
+ *
+ * \param field         The field.
+ * \param value         Pointer to receive the number.
+ *
+ * \returns true if the whole field is a number.
+ */
+static bool weightgraph_field_number(
+    const weightgraph_field* field, double* value)
+{
+    char text[WEIGHTGRAPH_FIELD_SIZE];
+    char* number_end;
+
+    if (0 == field->size || !weightgraph_field_copy(field, text))
+    {
+        return false;
+    }
+
+    *value = strtod(text, &number_end);
+
+    return 0 == *number_end;
+}
+
+/**
+ * \brief Compare a field with a string.
+ *
+ * \param field         The field.
+ * \param text          The string.
+ *
+ * \returns true if they are the same.
+ */
+static bool weightgraph_field_equals(
+    const weightgraph_field* field, const char* text)
+{
+    char decoded[WEIGHTGRAPH_FIELD_SIZE];
+
+    /* an escaped key is compared once decoded. */
+    if (field->escaped)
+    {
+        return
+            weightgraph_field_unescape(field, decoded)
+         && !strcmp(decoded, text);
+    }
+
+    return
+        strlen(text) == field->size && !memcmp(field->data, text, field->size);
+}
@@ -0,0 +1,23 @@
+/**
+ * \file weightgraph/weightgraph_parser_set_format.c
+ *
+ * \brief Set the format of the logs parsed by a parser.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Set the format of the logs parsed by a parser.
+ *
+ * A new parser detects the format of each log it parses.
+ *
+ * \param parser        The parser.
+ * \param format        The format (WEIGHTGRAPH_INPUT_*).
+ */
+void weightgraph_parser_set_format(weightgraph_parser* parser, int format)
+{
+    parser->format = format;
+}
@@ -0,0 +1,306 @@
+/**
+ * \file weightgraph/weightgraph_parser_stream.c
+ *
+ * \brief Stream the next piece of a document through a parser.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "weightgraph_internal.h"
+
+/* forward decls. */
+static status weightgraph_parser_stream_text(
+    weightgraph_parser* parser, const uint8_t* buffer, size_t buffer_size,
+    bool final);
+static status weightgraph_parser_stream_archive(
+    weightgraph_parser* parser, const uint8_t* buffer, size_t buffer_size,
+    bool final);
+static status weightgraph_parser_carry(
+    weightgraph_parser* parser, const uint8_t* buffer, size_t buffer_size);
+
+/**
+ * \brief Stream the next piece of a document through the parser.
+ *
+ * \param parser        The parser.
+ * \param buffer        The next piece of the document.
+ * \param buffer_size   The size of the piece.
+ * \param final         true if this piece ends the document.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - the failure returned by a handler callback.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_parser_stream(
+    weightgraph_parser* parser, const uint8_t* buffer, size_t buffer_size,
+    bool final)
+{
+    /* detect the format of this document from its first piece. */
+    if (WEIGHTGRAPH_INPUT_AUTO == parser->document_format)
+    {
+        parser->document_format =
+            weightgraph_input_format_sniff(buffer, buffer_size);
+
+        /* leading whitespace doesn't tell, so wait for the next piece. */
+        if (WEIGHTGRAPH_INPUT_AUTO == parser->document_format)
+        {
+            if (!final)
+            {
+                return STATUS_SUCCESS;
+            }
+
+            parser->document_format = WEIGHTGRAPH_INPUT_XML;
+        }
+    }
+
+    /* text logs are scanned a line at a time. */
+    if (WEIGHTGRAPH_INPUT_CSV == parser->document_format
+     || WEIGHTGRAPH_INPUT_NDJSON == parser->document_format)
+    {
+        return
+            weightgraph_parser_stream_text(parser, buffer, buffer_size, final);
+    }
+
+    /* archives are decoded a record at a time. */
+    if (WEIGHTGRAPH_INPUT_ARCHIVE == parser->document_format)
+    {
+        return
+            weightgraph_parser_stream_archive(
+                parser, buffer, buffer_size, final);
+    }
+
+    if (XML_STATUS_OK !=
+        XML_Parse(
+            parser->parser, (const char*)buffer, buffer_size,
+            final ? XML_TRUE : XML_FALSE))
+    {
+        /* a handler failure stops the parse, and explains it. */
+        if (STATUS_SUCCESS != parser->stream_status)
+        {
+            return parser->stream_status;
+        }
+
+        return ERROR_XML_PARSE;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Stream the next piece of a CSV or NDJSON log through the parser.
+ *
+ * A line split across pieces is carried over until its newline arrives.
+ *
+ * \param parser        The parser.
+ * \param buffer        The next piece of the log.
+ * \param buffer_size   The size of the piece.
+ * \param final         true if this piece ends the log.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - the failure returned by a handler callback.
+ *      - a non-zero error code on failure.
+ */
+static status weightgraph_parser_stream_text(
+    weightgraph_parser* parser, const uint8_t* buffer, size_t buffer_size,
+    bool final)
+{
+    status retval;
+    const uint8_t* newline;
+    size_t head_size, consumed;
+
+    /* complete the line carried over from the last piece. */
+    if (parser->carry_size > 0)
+    {
+        newline = (const uint8_t*)memchr(buffer, '\n', buffer_size);
+        head_size =
+            (NULL == newline) ? buffer_size : (size_t)(newline - buffer) + 1;
+
+        retval = weightgraph_parser_carry(parser, buffer, head_size);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        buffer += head_size;
+        buffer_size -= head_size;
+
+        /* wait for the rest of the line. */
+        if (NULL == newline && !final)
+        {
+            return STATUS_SUCCESS;
+        }
+
+        retval =
+            weightgraph_parser_scan_text(
+                parser, parser->carry, parser->carry_size, true, &consumed);
+        parser->carry_size = 0;
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    /* scan the complete lines of this piece. */
+    retval =
+        weightgraph_parser_scan_text(
+            parser, buffer, buffer_size, final, &consumed);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* carry over the start of the last line. */
+    return
+        weightgraph_parser_carry(
+            parser, buffer + consumed, buffer_size - consumed);
+}
+
+/**
+ * \brief Stream the next piece of an archive through the parser.
+ *
+ * A record split across pieces is carried over, a piece of it at a time,
+ * until it is complete, so only that record is copied.
+ *
+ * \param parser        The parser.
+ * \param buffer        The next piece of the archive.
+ * \param buffer_size   The size of the piece.
+ * \param final         true if this piece ends the archive.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - the failure returned by a handler callback.
+ *      - a non-zero error code on failure.
+ */
+static status weightgraph_parser_stream_archive(
+    weightgraph_parser* parser, const uint8_t* buffer, size_t buffer_size,
+    bool final)
+{
+    status retval;
+    size_t needed, head_size, consumed;
+
+    /* complete the header or record carried over from the last piece. */
+    while (parser->carry_size > 0 && buffer_size > 0)
+    {
+        /* the size of a block is known from the first five bytes. */
+        needed = WEIGHTGRAPH_ARCHIVE_HEADER_SIZE;
+        if (parser->archive_started)
+        {
+            retval =
+                weightgraph_archive_record_size(
+                    parser->carry, parser->carry_size, &needed);
+            if (STATUS_SUCCESS != retval)
+            {
+                return retval;
+            }
+
+            if (0 == needed)
+            {
+                needed = 5;
+            }
+        }
+
+        head_size = needed - parser->carry_size;
+        if (head_size > buffer_size)
+        {
+            head_size = buffer_size;
+        }
+
+        retval = weightgraph_parser_carry(parser, buffer, head_size);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        buffer += head_size;
+        buffer_size -= head_size;
+
+        retval =
+            weightgraph_parser_scan_archive(
+                parser, parser->carry, parser->carry_size, false, &consumed);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        if (consumed > 0)
+        {
+            parser->carry_size = 0;
+        }
+    }
+
+    /* a piece that ends in the carried record must not be the last. */
+    if (parser->carry_size > 0)
+    {
+        return final ? ERROR_ARCHIVE_FORMAT : STATUS_SUCCESS;
+    }
+
+    /* decode the complete records of this piece. */
+    retval =
+        weightgraph_parser_scan_archive(
+            parser, buffer, buffer_size, final, &consumed);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* carry over the start of the last record. */
+    return
+        weightgraph_parser_carry(
+            parser, buffer + consumed, buffer_size - consumed);
+}
+
+/**
+ * \brief Append to the line carried over between pieces.
+ *
+ * \param parser        The parser.
+ * \param buffer        The bytes to append.
+ * \param buffer_size   The number of bytes to append.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+static status weightgraph_parser_carry(
+    weightgraph_parser* parser, const uint8_t* buffer, size_t buffer_size)
+{
+    status retval;
+
+    if (0 == buffer_size)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    /* grow the carry buffer as needed. */
+    if (parser->carry_size + buffer_size > parser->carry_capacity)
+    {
+        size_t capacity =
+            (0 == parser->carry_capacity) ? 256 : 2 * parser->carry_capacity;
+        void* carry = parser->carry;
+
+        while (capacity < parser->carry_size + buffer_size)
+        {
+            capacity *= 2;
+        }
+
+        retval =
+            weightgraph_memory_reallocate(
+                parser->alloc, WEIGHTGRAPH_MEMORY_PARSER, &carry,
+                parser->carry_capacity, capacity);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        parser->carry = (uint8_t*)carry;
+        parser->carry_capacity = capacity;
+    }
+
+    memcpy(parser->carry + parser->carry_size, buffer, buffer_size);
+    parser->carry_size += buffer_size;
+
+    return STATUS_SUCCESS;
+}
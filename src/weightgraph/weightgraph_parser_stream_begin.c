@@ -0,0 +1,30 @@
+/**
+ * \file weightgraph/weightgraph_parser_stream_begin.c
+ *
+ * \brief Begin streaming a document through a reusable parser.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Begin streaming a document through a reusable parser.
+ *
+ * Each element is passed to the handler as soon as it has been parsed,
+ * without building an AST, so the document can be parsed a piece at a time
+ * as it is read.
+ *
+ * \param parser        The parser.
+ * \param handler       The handler, which must outlive the document.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_parser_stream_begin(
+    weightgraph_parser* parser, const weightgraph_stream_handler* handler)
+{
+    return weightgraph_parser_reset(parser, handler);
+}
@@ -0,0 +1,37 @@
+/**
+ * \file weightgraph/weightgraph_period_from_name.c
+ *
+ * \brief Select a calendar period by name.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Select a calendar period by name.
+ *
+ * \param name          The name: "day", "week", "month" or "year".
+ * \param period        Pointer to receive the period (WEIGHTGRAPH_PERIOD_*).
+ *
+ * \returns true if the name is known.
+ */
+bool weightgraph_period_from_name(const char* name, int* period)
+{
+    static const char* names[WEIGHTGRAPH_PERIOD_COUNT] = {
+        "day", "week", "month", "year" };
+
+    for (int i = 0; i < WEIGHTGRAPH_PERIOD_COUNT; ++i)
+    {
+        if (!strcmp(name, names[i]))
+        {
+            *period = i;
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,22 @@
+/**
+ * \file weightgraph/weightgraph_plotter_average.c
+ *
+ * \brief Get the current moving average of a plotter.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Get the moving average after the most recently pushed sample.
+ *
+ * \param plotter       The plotter.
+ *
+ * \returns the current moving average.
+ */
+double weightgraph_plotter_average(const weightgraph_plotter* plotter)
+{
+    return plotter->moving_average;
+}
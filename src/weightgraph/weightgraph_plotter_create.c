@@ -0,0 +1,112 @@
+/**
+ * \file weightgraph/weightgraph_plotter_create.c
+ *
+ * \brief Create a plotter.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "weightgraph_internal.h"
+
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Create a plotter, starting the graph on the given sink.
+ *
+ * The Y-axis covers the range of weights and the initial average.  Resuming
+ * from a previous render is not supported.
+ *
+ * \param plotter       Pointer to receive the new plotter.
+ * \param alloc         The allocator to use for this operation.
+ * \param options       The rendering options.
+ * \param sink          The sink to which output is written.
+ * \param average       The initial moving average.
+ * \param count         The number of samples that will be pushed.
+ * \param min_weight    The lowest weight that will be pushed.
+ * \param max_weight    The highest weight that will be pushed.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_plotter_create(
+    weightgraph_plotter** plotter, RCPR_SYM(allocator)* alloc,
+    const weightgraph_render_options* options, const weightgraph_sink* sink,
+    double average, size_t count, double min_weight, double max_weight)
+{
+    status retval, release_retval;
+    output_graph_options graph_options;
+    weightgraph_plotter* tmp;
+
+    if (NULL != options->resume)
+    {
+        return ERROR_BAD_ARGUMENTS;
+    }
+
+    /* allocate memory for the plotter. */
+    retval =
+        weightgraph_memory_allocate(
+            alloc, WEIGHTGRAPH_MEMORY_PLOTTER, (void**)&tmp, sizeof(*tmp));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* clear memory. */
+    memset(tmp, 0, sizeof(*tmp));
+
+    /* set initial values. */
+    resource_init(&tmp->hdr, &weightgraph_plotter_resource_release);
+    tmp->alloc = alloc;
+    tmp->count = count;
+    tmp->min_weight = fmin(average, min_weight);
+    tmp->max_weight = fmax(average, max_weight);
+    tmp->moving_average = average;
+
+    /* the window starts full of the initial average. */
+    weightgraph_window_init(&tmp->window, average);
+
+    /* lay out the graph as a session render would. */
+    graph_options.format = options->format;
+    graph_options.raster_size = options->raster_size;
+    graph_options.page_size = options->page_size;
+    graph_options.page_count =
+        (count + options->page_size - 1) / options->page_size;
+    if (0 == graph_options.page_count)
+    {
+        graph_options.page_count = 1;
+    }
+    graph_options.min_value = tmp->min_weight;
+    graph_options.max_value = tmp->max_weight;
+    graph_options.appendable = options->appendable;
+    graph_options.resume = NULL;
+
+    /* create the output graph, and write the initial values. */
+    retval =
+        output_graph_create(&tmp->out, alloc, sink, &graph_options, average);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_plotter;
+    }
+
+    /* success. */
+    *plotter = tmp;
+    retval = STATUS_SUCCESS;
+    goto done;
+
+cleanup_plotter:
+    release_retval =
+        weightgraph_memory_reclaim(
+            alloc, WEIGHTGRAPH_MEMORY_PLOTTER, tmp, sizeof(*tmp));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+done:
+    return retval;
+}
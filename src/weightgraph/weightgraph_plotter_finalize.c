@@ -0,0 +1,50 @@
+/**
+ * \file weightgraph/weightgraph_plotter_finalize.c
+ *
+ * \brief Finish the graph of a plotter.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Finish the graph once every sample has been pushed.
+ *
+ * \param plotter       The plotter.
+ * \param state         Optional pointer to receive the point from which a
+ *                      later render could resume, or NULL.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_BAD_ARGUMENTS if fewer samples were pushed than the count
+ *        given when the plotter was created.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_plotter_finalize(
+    weightgraph_plotter* plotter, weightgraph_render_state* state)
+{
+    status retval;
+
+    /* a short graph would not match the pages it announced. */
+    if (plotter->plotted != plotter->count)
+    {
+        return ERROR_BAD_ARGUMENTS;
+    }
+
+    /* write the final data to the graph. */
+    retval = output_graph_finalize(plotter->out);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* return the resume point to the caller. */
+    if (NULL != state)
+    {
+        *state = plotter->out->resume;
+    }
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,55 @@
+/**
+ * \file weightgraph/weightgraph_plotter_push.c
+ *
+ * \brief Push a sample onto a plotter.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Push a sample onto the plotter, updating the moving average and
+ * plotting the sample.
+ *
+ * Samples must be pushed in date order.  The date is not kept.
+ *
+ * \param plotter       The plotter.
+ * \param date          The date of the sample.
+ * \param weight        The weight of the sample.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_BAD_ARGUMENTS if the sample is beyond the count or range
+ *        given when the plotter was created.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_plotter_push(
+    weightgraph_plotter* plotter, const char* date, double weight)
+{
+    status retval;
+
+    /* the pages and axis were laid out for the samples given up front. */
+    if (plotter->plotted >= plotter->count
+     || weight < plotter->min_weight || weight > plotter->max_weight)
+    {
+        return ERROR_BAD_ARGUMENTS;
+    }
+
+    /* compute the updated moving average. */
+    plotter->moving_average = weightgraph_window_push(&plotter->window, weight);
+
+    /* plot the sample. */
+    retval =
+        output_graph_plot(
+            plotter->out, date, weight, plotter->moving_average, false);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    ++plotter->plotted;
+
+    return STATUS_SUCCESS;
+}
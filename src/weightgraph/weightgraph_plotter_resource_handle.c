@@ -0,0 +1,23 @@
+/**
+ * \file weightgraph/weightgraph_plotter_resource_handle.c
+ *
+ * \brief Get the resource handle for a plotter.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Get the resource handle for a plotter.
+ *
+ * \param plotter       The plotter.
+ *
+ * \returns the resource handle, which is used to release the plotter.
+ */
+RCPR_SYM(resource)* weightgraph_plotter_resource_handle(
+    weightgraph_plotter* plotter)
+{
+    return &plotter->hdr;
+}
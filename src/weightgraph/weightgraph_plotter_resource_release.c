@@ -0,0 +1,49 @@
+/**
+ * \file weightgraph/weightgraph_plotter_resource_release.c
+ *
+ * \brief Release a plotter resource.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+RCPR_IMPORT_allocator;
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Release a plotter resource.
+ *
+ * \param r         The resource to release.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_plotter_resource_release(RCPR_SYM(resource)* r)
+{
+    status out_retval, reclaim_retval;
+    weightgraph_plotter* plotter = (weightgraph_plotter*)r;
+
+    /* cache allocator. */
+    allocator* alloc = plotter->alloc;
+
+    /* release the output graph. */
+    out_retval = resource_release(&plotter->out->hdr);
+
+    /* reclaim memory. */
+    reclaim_retval =
+        weightgraph_memory_reclaim(
+            alloc, WEIGHTGRAPH_MEMORY_PLOTTER, plotter, sizeof(*plotter));
+
+    /* decode response. */
+    if (STATUS_SUCCESS != out_retval)
+    {
+        return out_retval;
+    }
+    else
+    {
+        return reclaim_retval;
+    }
+}
@@ -10,6 +10,8 @@
 #include <string.h>
 #include <weightgraph/weightgraph.h>
 
+#include "memory_internal.h"
+
 RCPR_IMPORT_allocator;
 RCPR_IMPORT_rbtree;
 RCPR_IMPORT_resource;
@@ -40,7 +42,9 @@ status weightgraph_resource_release(RCPR_SYM(resource)* r)
     }
 
     /* reclaim memory. */
-    reclaim_retval = allocator_reclaim(alloc, graph);
+    reclaim_retval =
+        weightgraph_memory_reclaim(
+            alloc, WEIGHTGRAPH_MEMORY_GRAPH, graph, sizeof(*graph));
 
     /* decode response. */
     if (STATUS_SUCCESS != rbtree_release_retval)
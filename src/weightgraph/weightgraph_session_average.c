@@ -0,0 +1,22 @@
+/**
+ * \file weightgraph/weightgraph_session_average.c
+ *
+ * \brief Get the current moving average of the session.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Get the moving average after the most recently pushed sample.
+ *
+ * \param session       The session.
+ *
+ * \returns the current moving average.
+ */
+double weightgraph_session_average(const weightgraph_session* session)
+{
+    return session->moving_average;
+}
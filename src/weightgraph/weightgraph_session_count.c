@@ -0,0 +1,22 @@
+/**
+ * \file weightgraph/weightgraph_session_count.c
+ *
+ * \brief Get the number of samples pushed onto the session.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Get the number of samples pushed onto the session.
+ *
+ * \param session       The session.
+ *
+ * \returns the number of samples.
+ */
+size_t weightgraph_session_count(const weightgraph_session* session)
+{
+    return session->count;
+}
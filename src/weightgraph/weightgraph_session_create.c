@@ -0,0 +1,60 @@
+/**
+ * \file weightgraph/weightgraph_session_create.c
+ *
+ * \brief Create an empty weight graph session.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "weightgraph_internal.h"
+
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Create an empty weight graph session.
+ *
+ * \param session       Pointer to receive the new session.
+ * \param alloc         The allocator to use for this operation.
+ * \param average       The initial moving average for this session.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_session_create(
+    weightgraph_session** session, RCPR_SYM(allocator)* alloc,
+    double average)
+{
+    status retval;
+    weightgraph_session* tmp;
+
+    /* allocate memory for the session. */
+    retval =
+        weightgraph_memory_allocate(
+            alloc, WEIGHTGRAPH_MEMORY_SESSION, (void**)&tmp, sizeof(*tmp));
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* clear memory. */
+    memset(tmp, 0, sizeof(*tmp));
+
+    /* set initial values. */
+    resource_init(&tmp->hdr, &weightgraph_session_resource_release);
+    tmp->alloc = alloc;
+    tmp->initial_average = average;
+    tmp->moving_average = average;
+    tmp->min_weight = average;
+    tmp->max_weight = average;
+
+    /* the window starts full of the initial average. */
+    weightgraph_window_init(&tmp->window, average);
+
+    /* success. */
+    *session = tmp;
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,73 @@
+/**
+ * \file weightgraph/weightgraph_session_filter.c
+ *
+ * \brief Filter the weights pushed onto a session for outliers.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Filter the weights pushed onto an empty session for outliers.
+ *
+ * Each weight is judged against the given number of weights pushed before
+ * it, with the Hampel identifier: it is rejected if it lies further from
+ * their median than the threshold times their median absolute deviation,
+ * scaled to the standard deviation of normally distributed weights, or times
+ * half of one percent of the median, if that is more.  The earlier weights
+ * are held in an order-statistic tree, so each weight is judged in time
+ * logarithmic in the window.  A rejected sample is kept, and marked, but
+ * left out of the moving average and the range of the weights.  Weights are
+ * only judged once the window is full.  The filter is kept when the session
+ * is reset.
+ *
+ * \param session       The session, which must be empty.
+ * \param window        The number of earlier weights against which each
+ *                      weight is judged, from 3 to
+ *                      \ref WEIGHTGRAPH_FILTER_MAX_WINDOW, or 0 to stop
+ *                      filtering.
+ * \param threshold     The threshold, which must be positive.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_BAD_ARGUMENTS if the session is not empty, or is a rollup, or
+ *        if the window or threshold is out of range.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_session_filter(
+    weightgraph_session* session, size_t window, double threshold)
+{
+    status retval;
+    weightgraph_filter* filter = NULL;
+
+    if (0 != session->count || NULL != session->periods
+     || (0 != window
+      && (window < 3 || window > WEIGHTGRAPH_FILTER_MAX_WINDOW
+       || !(threshold > 0.0))))
+    {
+        return ERROR_BAD_ARGUMENTS;
+    }
+
+    /* create the new filter before releasing the old one. */
+    if (0 != window)
+    {
+        retval =
+            weightgraph_filter_create(
+                &filter, session->alloc, window, threshold);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    if (NULL != session->filter)
+    {
+        weightgraph_filter_release(session->filter);
+    }
+
+    session->filter = filter;
+
+    return STATUS_SUCCESS;
+}
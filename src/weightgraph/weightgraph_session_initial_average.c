@@ -0,0 +1,22 @@
+/**
+ * \file weightgraph/weightgraph_session_initial_average.c
+ *
+ * \brief Get the initial moving average of the session.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Get the moving average from which the session started.
+ *
+ * \param session       The session.
+ *
+ * \returns the initial moving average.
+ */
+double weightgraph_session_initial_average(const weightgraph_session* session)
+{
+    return session->initial_average;
+}
@@ -0,0 +1,46 @@
+/**
+ * \file weightgraph/weightgraph_session_period.c
+ *
+ * \brief Get the aggregates of a period of a rollup.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Get the aggregates of a period of a rollup.
+ *
+ * \param rollup        The rollup.
+ * \param index         The index of the period, starting at 0.
+ * \param summary       Pointer to receive the aggregates, whose date remains
+ *                      valid until the rollup is reset or released.
+ *
+ * \returns true if the session is a rollup with such a period.
+ */
+bool weightgraph_session_period(
+    const weightgraph_session* rollup, size_t index,
+    weightgraph_period_summary* summary)
+{
+    const weightgraph_sample* sample;
+    const weightgraph_rollup_period* period;
+
+    if (NULL == rollup->periods || index >= rollup->count)
+    {
+        return false;
+    }
+
+    /* the samples of a rollup are never in fixed point. */
+    sample = &rollup->samples[index];
+    period = &rollup->periods[index];
+
+    summary->date = sample->date;
+    summary->count = period->count;
+    summary->mean = sample->weight;
+    summary->min_weight = period->min_weight;
+    summary->max_weight = period->max_weight;
+    summary->moving_average = sample->moving_average;
+
+    return true;
+}
@@ -0,0 +1,160 @@
+/**
+ * \file weightgraph/weightgraph_session_push.c
+ *
+ * \brief Push a sample onto the session.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Push a sample onto the session, updating the moving average.
+ *
+ * Samples must be pushed in date order.  The date is copied.  While every
+ * weight, and the initial average, is a whole number of hundredths, samples
+ * are held in fixed point, in half the space, and each moving average is
+ * computed exactly from an integer running sum.  A weight rejected by the
+ * outlier filter is kept, but leaves the moving average as it was.
+ *
+ * \param session       The session.
+ * \param date          The date of the sample.
+ * \param weight        The weight of the sample.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_BAD_ARGUMENTS if the session is a rollup.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_session_push(
+    weightgraph_session* session, const char* date, double weight)
+{
+    status retval;
+    char* date_copy;
+    size_t date_size = strlen(date) + 1;
+    int32_t fixed = 0;
+    bool rejected = false;
+
+    /* the samples of a rollup stand for periods, not entries. */
+    if (NULL != session->periods)
+    {
+        return ERROR_BAD_ARGUMENTS;
+    }
+
+    /* a weight that can't be held in fixed point widens the samples. */
+    if (NULL == session->samples
+     && (!session->window.fixed
+      || !weightgraph_weight_to_fixed(weight, &fixed)))
+    {
+        retval = weightgraph_session_widen(session);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    /* grow the sample array geometrically. */
+    if (session->count == session->capacity)
+    {
+        size_t capacity =
+            (0 == session->capacity) ? 64 : 2 * session->capacity;
+        size_t sample_size =
+            (NULL != session->samples)
+                ? sizeof(weightgraph_sample)
+                : sizeof(weightgraph_fixed_sample);
+        void* samples =
+            (NULL != session->samples)
+                ? (void*)session->samples : (void*)session->fixed_samples;
+
+        retval =
+            weightgraph_memory_reallocate(
+                session->alloc, WEIGHTGRAPH_MEMORY_SESSION, &samples,
+                session->capacity * sample_size, capacity * sample_size);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        if (NULL != session->samples)
+        {
+            session->samples = (weightgraph_sample*)samples;
+        }
+        else
+        {
+            session->fixed_samples = (weightgraph_fixed_sample*)samples;
+        }
+        session->capacity = capacity;
+    }
+
+    /* the filter marks each sample, rejected or not. */
+    if (NULL != session->filter)
+    {
+        retval =
+            weightgraph_filter_reserve(session->filter, session->count + 1);
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+    }
+
+    /* copy the date. */
+    retval =
+        weightgraph_memory_allocate(
+            session->alloc, WEIGHTGRAPH_MEMORY_DATE, (void**)&date_copy,
+            date_size);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+    memcpy(date_copy, date, date_size);
+
+    /* an outlier leaves the moving average as it was. */
+    if (NULL != session->filter)
+    {
+        uint64_t* word = &session->filter->marks[session->count / 64];
+        uint64_t bit = (uint64_t)1 << (session->count % 64);
+
+        rejected = weightgraph_filter_push(session->filter, weight);
+        *word = rejected ? (*word | bit) : (*word & ~bit);
+    }
+
+    /* compute the updated moving average. */
+    if (!rejected)
+    {
+        session->moving_average =
+            weightgraph_window_push(&session->window, weight);
+    }
+
+    /* record this sample. */
+    if (NULL != session->samples)
+    {
+        weightgraph_sample* sample = &session->samples[session->count++];
+
+        sample->date = date_copy;
+        sample->weight = weight;
+        sample->moving_average = session->moving_average;
+        sample->rejected = rejected;
+    }
+    else
+    {
+        weightgraph_fixed_sample* sample =
+            &session->fixed_samples[session->count++];
+
+        sample->date = date_copy;
+        sample->weight = fixed;
+        sample->moving_average = (int32_t)session->window.fixed_sum;
+    }
+
+    /* track the range of the weights that weren't rejected. */
+    if (!rejected)
+    {
+        session->min_weight = fmin(session->min_weight, weight);
+        session->max_weight = fmax(session->max_weight, weight);
+    }
+
+    return STATUS_SUCCESS;
+}
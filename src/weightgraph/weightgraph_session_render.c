@@ -0,0 +1,130 @@
+/**
+ * \file weightgraph/weightgraph_session_render.c
+ *
+ * \brief Render the samples in a session.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+RCPR_IMPORT_resource;
+
+/**
+ * \brief Render the samples in the session to the given sink.
+ *
+ * When resume state is given, only samples after the resume point are
+ * rendered, continuing the output from a previous render.  If those samples
+ * change the Y-axis of the graph, ERROR_CHECKPOINT_STALE is returned before
+ * anything is written to the sink.
+ *
+ * \param session       The session.
+ * \param options       The rendering options.
+ * \param sink          The sink to which output is written.
+ * \param state         Optional pointer to receive the point from which a
+ *                      later render could resume, or NULL.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_session_render(
+    weightgraph_session* session, const weightgraph_render_options* options,
+    const weightgraph_sink* sink, weightgraph_render_state* state)
+{
+    status retval, release_retval;
+    output_graph_options graph_options;
+    output_graph_file* out;
+    weightgraph_sample sample;
+    size_t first = 0;
+
+    /* the resume point must lie within the session. */
+    if (NULL != options->resume)
+    {
+        first = options->resume->count;
+        if (first > session->count)
+        {
+            return ERROR_CHECKPOINT_STALE;
+        }
+    }
+
+    /* the axis covers every weight not rejected, and the initial average. */
+    graph_options.format = options->format;
+    graph_options.raster_size = options->raster_size;
+    graph_options.page_size = options->page_size;
+    graph_options.page_count =
+        (session->count + options->page_size - 1) / options->page_size;
+    if (0 == graph_options.page_count)
+    {
+        graph_options.page_count = 1;
+    }
+    graph_options.min_value = session->min_weight;
+    graph_options.max_value = session->max_weight;
+    graph_options.appendable = options->appendable;
+    graph_options.resume = options->resume;
+
+    /* create the output graph, and write the initial values. */
+    retval =
+        output_graph_create(
+            &out, session->alloc, sink, &graph_options,
+            session->initial_average);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    /* plot the samples. */
+    if (NULL != options->resume)
+    {
+        /* only new samples are plotted, continuing the last page. */
+        for (size_t i = first; i < session->count; ++i)
+        {
+            weightgraph_session_sample(session, i, &sample);
+            retval =
+                output_graph_plot(
+                    out, sample.date, sample.weight, sample.moving_average,
+                    sample.rejected);
+            if (STATUS_SUCCESS != retval)
+            {
+                goto cleanup_out;
+            }
+        }
+    }
+    else
+    {
+        retval =
+            output_graph_plot_pages(out, session, options->threads);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_out;
+        }
+    }
+
+    /* write the final data to the graph. */
+    retval = output_graph_finalize(out);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_out;
+    }
+
+    /* return the resume point to the caller. */
+    if (NULL != state)
+    {
+        *state = out->resume;
+    }
+
+    /* success. */
+    retval = STATUS_SUCCESS;
+    goto cleanup_out;
+
+cleanup_out:
+    release_retval = resource_release(&out->hdr);
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+done:
+    return retval;
+}
@@ -0,0 +1,69 @@
+/**
+ * \file weightgraph/weightgraph_session_reset.c
+ *
+ * \brief Reset a weight graph session so that it can be reused.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Reset a session to empty, starting from a new initial average.
+ *
+ * The sample array is kept, so that a session reused for many graphs only
+ * grows it as far as the longest history requires, unless it was widened
+ * for a weight that couldn't be held in fixed point.  A rollup that is reset
+ * becomes an ordinary session.  An outlier filter is kept, with its window
+ * emptied.
+ *
+ * \param session       The session.
+ * \param average       The initial moving average for the next graph.
+ */
+void weightgraph_session_reset(weightgraph_session* session, double average)
+{
+    weightgraph_sample sample;
+
+    /* reclaim the dates of the previous samples. */
+    for (size_t i = 0; i < session->count; ++i)
+    {
+        weightgraph_session_sample(session, i, &sample);
+        weightgraph_memory_reclaim(
+            session->alloc, WEIGHTGRAPH_MEMORY_DATE, (void*)sample.date,
+            strlen(sample.date) + 1);
+    }
+
+    /* a rollup becomes an ordinary session. */
+    if (NULL != session->periods)
+    {
+        weightgraph_memory_reclaim(
+            session->alloc, WEIGHTGRAPH_MEMORY_ROLLUP, session->periods,
+            session->capacity * sizeof(weightgraph_rollup_period));
+        session->periods = NULL;
+    }
+
+    /* start over from the new average. */
+    session->count = 0;
+    session->initial_average = average;
+    session->moving_average = average;
+    session->min_weight = average;
+    session->max_weight = average;
+    weightgraph_window_init(&session->window, average);
+    if (NULL != session->filter)
+    {
+        weightgraph_filter_reset(session->filter);
+    }
+
+    /* samples widened for the last graph start over in fixed point. */
+    if (NULL != session->samples && session->window.fixed)
+    {
+        weightgraph_memory_reclaim(
+            session->alloc, WEIGHTGRAPH_MEMORY_SESSION, session->samples,
+            session->capacity * sizeof(weightgraph_sample));
+        session->samples = NULL;
+        session->capacity = 0;
+    }
+}
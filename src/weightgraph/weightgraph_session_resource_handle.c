@@ -0,0 +1,23 @@
+/**
+ * \file weightgraph/weightgraph_session_resource_handle.c
+ *
+ * \brief Get the resource handle for a session.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Get the resource handle for a session.
+ *
+ * \param session       The session.
+ *
+ * \returns the resource handle, which is used to release the session.
+ */
+RCPR_SYM(resource)* weightgraph_session_resource_handle(
+    weightgraph_session* session)
+{
+    return &session->hdr;
+}
@@ -0,0 +1,85 @@
+/**
+ * \file weightgraph/weightgraph_session_resource_release.c
+ *
+ * \brief Release a weight graph session resource.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <string.h>
+
+#include "weightgraph_internal.h"
+
+RCPR_IMPORT_allocator;
+
+/**
+ * \brief Release a weight graph session resource.
+ *
+ * \param r         The resource to release.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_session_resource_release(RCPR_SYM(resource)* r)
+{
+    status samples_retval = STATUS_SUCCESS;
+    status reclaim_retval;
+    weightgraph_session* session = (weightgraph_session*)r;
+    weightgraph_sample sample;
+
+    /* cache allocator. */
+    allocator* alloc = session->alloc;
+
+    /* reclaim the samples and their dates. */
+    for (size_t i = 0; i < session->count; ++i)
+    {
+        weightgraph_session_sample(session, i, &sample);
+        weightgraph_memory_reclaim(
+            alloc, WEIGHTGRAPH_MEMORY_DATE, (void*)sample.date,
+            strlen(sample.date) + 1);
+    }
+
+    if (NULL != session->samples)
+    {
+        samples_retval =
+            weightgraph_memory_reclaim(
+                alloc, WEIGHTGRAPH_MEMORY_SESSION, session->samples,
+                session->capacity * sizeof(weightgraph_sample));
+    }
+    else if (NULL != session->fixed_samples)
+    {
+        samples_retval =
+            weightgraph_memory_reclaim(
+                alloc, WEIGHTGRAPH_MEMORY_SESSION, session->fixed_samples,
+                session->capacity * sizeof(weightgraph_fixed_sample));
+    }
+
+    if (NULL != session->periods)
+    {
+        weightgraph_memory_reclaim(
+            alloc, WEIGHTGRAPH_MEMORY_ROLLUP, session->periods,
+            session->capacity * sizeof(weightgraph_rollup_period));
+    }
+
+    if (NULL != session->filter)
+    {
+        weightgraph_filter_release(session->filter);
+    }
+
+    /* reclaim memory. */
+    reclaim_retval =
+        weightgraph_memory_reclaim(
+            alloc, WEIGHTGRAPH_MEMORY_SESSION, session, sizeof(*session));
+
+    /* decode response. */
+    if (STATUS_SUCCESS != samples_retval)
+    {
+        return samples_retval;
+    }
+    else
+    {
+        return reclaim_retval;
+    }
+}
@@ -0,0 +1,619 @@
+/**
+ * \file weightgraph/weightgraph_session_rollup.c
+ *
+ * \brief Roll the samples of a session up into calendar periods.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#include "weightgraph_internal.h"
+
+RCPR_IMPORT_resource;
+
+/**
+ * \brief The number of samples in each chunk claimed by a thread.
+ */
+#define WEIGHTGRAPH_ROLLUP_CHUNK 4096
+
+/**
+ * \brief The passes over the chunks of a rollup.
+ */
+enum weightgraph_rollup_pass
+{
+    /* find the first day of the period of each sample. */
+    WEIGHTGRAPH_ROLLUP_PASS_PLACE,
+    /* compute the aggregates of the periods starting in each chunk. */
+    WEIGHTGRAPH_ROLLUP_PASS_AGGREGATE,
+};
+
+/**
+ * \brief Shared state for the rollup threads.
+ */
+typedef struct weightgraph_rollup_job weightgraph_rollup_job;
+
+struct weightgraph_rollup_job
+{
+    const weightgraph_session* session;
+    size_t count;
+    /* the period (WEIGHTGRAPH_PERIOD_*). */
+    int period;
+    /* the style of the dates, and the digits in their years. */
+    int date_style;
+    int year_width;
+    /* the number of threads, and the pass they run. */
+    size_t threads;
+    int pass;
+    /* the number of chunks, and the next to be claimed by a thread. */
+    size_t chunks;
+    atomic_size_t next_chunk;
+    /* the status of each chunk. */
+    status* results;
+    /* the first day of the period of each sample. */
+    int32_t* days;
+    /* the first period starting in each chunk, then the number of periods. */
+    size_t* chunk_periods;
+    /* the first sample of each period, then the number of samples. */
+    size_t* starts;
+    /* the rollup being filled in. */
+    weightgraph_session* rollup;
+};
+
+/* forward decls. */
+static status weightgraph_rollup_fill(weightgraph_rollup_job* job);
+static status weightgraph_rollup_run(weightgraph_rollup_job* job, int pass);
+static void* weightgraph_rollup_thread(void* context);
+static status weightgraph_rollup_place(
+    weightgraph_rollup_job* job, size_t chunk);
+static status weightgraph_rollup_aggregate(
+    weightgraph_rollup_job* job, size_t chunk);
+static int32_t weightgraph_rollup_period_start(
+    const weightgraph_rollup_job* job, int32_t day);
+
+/**
+ * \brief Roll the samples of a session up into calendar periods.
+ *
+ * The rollup is a new session with a sample per period, dated the first day
+ * of the period, whose weight is the mean of the weights in the period and
+ * whose moving average is the one after the last of them, so that it renders
+ * like any other session.  Its Y-axis covers the same range as the session
+ * rolled up.  The samples are split into chunks, which are claimed by up to
+ * the given number of threads, first to place each sample in its period,
+ * then to compute the aggregates of the periods that start in each chunk.
+ * Dates must all be "YYYY-MM-DD", or all "MM/DD", in which case weeks start
+ * no earlier than the first of January.  Samples rejected by the outlier
+ * filter are left out of the aggregates of their period, unless every sample
+ * in it was rejected, in which case they are aggregated and the period is
+ * marked rejected.
+ *
+ * \param rollup        Pointer to receive the rollup.
+ * \param alloc         The allocator to use for this operation.
+ * \param session       The session to roll up, which must be in date order.
+ * \param period        The period (WEIGHTGRAPH_PERIOD_*).
+ * \param threads       The number of threads to use.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_BAD_ARGUMENTS if the period is unknown.
+ *      - ERROR_ROLLUP_DATE if a date can't be placed in a period.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_session_rollup(
+    weightgraph_session** rollup, RCPR_SYM(allocator)* alloc,
+    const weightgraph_session* session, int period, size_t threads)
+{
+    status retval, release_retval;
+    weightgraph_rollup_job job;
+    weightgraph_session* tmp;
+    weightgraph_sample sample;
+    int32_t day;
+
+    if (period < 0 || period >= WEIGHTGRAPH_PERIOD_COUNT)
+    {
+        return ERROR_BAD_ARGUMENTS;
+    }
+
+    /* set up the job. */
+    memset(&job, 0, sizeof(job));
+    job.session = session;
+    job.count = session->count;
+    job.period = period;
+    job.threads = threads;
+    job.date_style = WEIGHTGRAPH_ARCHIVE_DATE_NONE;
+    job.chunks =
+        (job.count + WEIGHTGRAPH_ROLLUP_CHUNK - 1) / WEIGHTGRAPH_ROLLUP_CHUNK;
+    atomic_init(&job.next_chunk, 0);
+
+    /* the first date sets the style of the rest. */
+    if (job.count > 0)
+    {
+        weightgraph_session_sample(session, 0, &sample);
+        if (!weightgraph_archive_date_encode(
+                sample.date, &job.date_style, &job.year_width, &day))
+        {
+            return ERROR_ROLLUP_DATE;
+        }
+    }
+
+    retval =
+        weightgraph_session_create(&tmp, alloc, session->initial_average);
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    /* the rollup ends where the session does, on the same Y-axis. */
+    tmp->moving_average = session->moving_average;
+    tmp->min_weight = session->min_weight;
+    tmp->max_weight = session->max_weight;
+    job.rollup = tmp;
+
+    /* find the periods, and compute their aggregates. */
+    if (job.count > 0)
+    {
+        retval = weightgraph_rollup_fill(&job);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_rollup;
+        }
+    }
+
+    /* success. */
+    *rollup = tmp;
+    return STATUS_SUCCESS;
+
+cleanup_rollup:
+    release_retval = resource_release(weightgraph_session_resource_handle(tmp));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+    return retval;
+}
+
+/**
+ * \brief Find the periods of the samples, and fill in the rollup with their
+ * aggregates.
+ *
+ * \param job           The rollup job, whose session has samples.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_ROLLUP_DATE if a date can't be placed in a period.
+ *      - a non-zero error code on failure.
+ */
+static status weightgraph_rollup_fill(weightgraph_rollup_job* job)
+{
+    status retval, release_retval;
+    weightgraph_session* rollup = job->rollup;
+    RCPR_SYM(allocator)* alloc = rollup->alloc;
+    size_t periods = 0;
+    char date[WEIGHTGRAPH_ARCHIVE_DATE_SIZE];
+    char* date_copy;
+    size_t date_size;
+
+    /* allocate the work of the threads. */
+    retval =
+        weightgraph_memory_allocate(
+            alloc, WEIGHTGRAPH_MEMORY_ROLLUP, (void**)&job->results,
+            job->chunks * sizeof(status));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto done;
+    }
+
+    retval =
+        weightgraph_memory_allocate(
+            alloc, WEIGHTGRAPH_MEMORY_ROLLUP, (void**)&job->days,
+            job->count * sizeof(int32_t));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_results;
+    }
+
+    retval =
+        weightgraph_memory_allocate(
+            alloc, WEIGHTGRAPH_MEMORY_ROLLUP, (void**)&job->chunk_periods,
+            (job->chunks + 1) * sizeof(size_t));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_days;
+    }
+
+    /* place each sample in its period. */
+    retval = weightgraph_rollup_run(job, WEIGHTGRAPH_ROLLUP_PASS_PLACE);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_chunk_periods;
+    }
+
+    /* a period starts wherever the first day changes. */
+    for (size_t i = 0; i < job->count; ++i)
+    {
+        if (0 == i % WEIGHTGRAPH_ROLLUP_CHUNK)
+        {
+            job->chunk_periods[i / WEIGHTGRAPH_ROLLUP_CHUNK] = periods;
+        }
+
+        if (0 == i || job->days[i] != job->days[i - 1])
+        {
+            ++periods;
+        }
+    }
+    job->chunk_periods[job->chunks] = periods;
+
+    retval =
+        weightgraph_memory_allocate(
+            alloc, WEIGHTGRAPH_MEMORY_ROLLUP, (void**)&job->starts,
+            (periods + 1) * sizeof(size_t));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_chunk_periods;
+    }
+
+    periods = 0;
+    for (size_t i = 0; i < job->count; ++i)
+    {
+        if (0 == i || job->days[i] != job->days[i - 1])
+        {
+            job->starts[periods++] = i;
+        }
+    }
+    job->starts[periods] = job->count;
+
+    /* allocate the samples and aggregates of the rollup, which is dated as
+     * each period is. */
+    retval =
+        weightgraph_memory_allocate(
+            alloc, WEIGHTGRAPH_MEMORY_SESSION, (void**)&rollup->samples,
+            periods * sizeof(weightgraph_sample));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_starts;
+    }
+    rollup->capacity = periods;
+
+    retval =
+        weightgraph_memory_allocate(
+            alloc, WEIGHTGRAPH_MEMORY_ROLLUP, (void**)&rollup->periods,
+            periods * sizeof(weightgraph_rollup_period));
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_starts;
+    }
+
+    /* compute the aggregates. */
+    retval = weightgraph_rollup_run(job, WEIGHTGRAPH_ROLLUP_PASS_AGGREGATE);
+    if (STATUS_SUCCESS != retval)
+    {
+        goto cleanup_starts;
+    }
+
+    /* date each period by its first day. */
+    for (size_t i = 0; i < periods; ++i)
+    {
+        if (!weightgraph_archive_date_format(
+                date, job->date_style, job->year_width,
+                job->days[job->starts[i]]))
+        {
+            retval = ERROR_ROLLUP_DATE;
+            goto cleanup_starts;
+        }
+
+        date_size = strlen(date) + 1;
+        retval =
+            weightgraph_memory_allocate(
+                alloc, WEIGHTGRAPH_MEMORY_DATE, (void**)&date_copy,
+                date_size);
+        if (STATUS_SUCCESS != retval)
+        {
+            goto cleanup_starts;
+        }
+        memcpy(date_copy, date, date_size);
+
+        rollup->samples[i].date = date_copy;
+        rollup->count = i + 1;
+    }
+
+    /* success. */
+    retval = STATUS_SUCCESS;
+    goto cleanup_starts;
+
+cleanup_starts:
+    release_retval =
+        weightgraph_memory_reclaim(
+            alloc, WEIGHTGRAPH_MEMORY_ROLLUP, job->starts,
+            (periods + 1) * sizeof(size_t));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_chunk_periods:
+    release_retval =
+        weightgraph_memory_reclaim(
+            alloc, WEIGHTGRAPH_MEMORY_ROLLUP, job->chunk_periods,
+            (job->chunks + 1) * sizeof(size_t));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_days:
+    release_retval =
+        weightgraph_memory_reclaim(
+            alloc, WEIGHTGRAPH_MEMORY_ROLLUP, job->days,
+            job->count * sizeof(int32_t));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+cleanup_results:
+    release_retval =
+        weightgraph_memory_reclaim(
+            alloc, WEIGHTGRAPH_MEMORY_ROLLUP, job->results,
+            job->chunks * sizeof(status));
+    if (STATUS_SUCCESS != release_retval)
+    {
+        retval = release_retval;
+    }
+
+done:
+    return retval;
+}
+
+/**
+ * \brief Run a pass over every chunk of a rollup.
+ *
+ * \param job           The rollup job.
+ * \param pass          The pass (WEIGHTGRAPH_ROLLUP_PASS_*).
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - the failure of the first chunk that failed.
+ */
+static status weightgraph_rollup_run(weightgraph_rollup_job* job, int pass)
+{
+    status retval;
+    pthread_t* workers;
+    size_t threads = job->threads;
+    size_t started = 0;
+
+    job->pass = pass;
+    atomic_store(&job->next_chunk, 0);
+
+    /* there is no use for more threads than chunks. */
+    if (threads > job->chunks)
+    {
+        threads = job->chunks;
+    }
+
+    /* a single thread runs the pass in place. */
+    if (threads <= 1)
+    {
+        weightgraph_rollup_thread(job);
+    }
+    else
+    {
+        retval =
+            weightgraph_memory_allocate(
+                job->rollup->alloc, WEIGHTGRAPH_MEMORY_ROLLUP,
+                (void**)&workers, threads * sizeof(pthread_t));
+        if (STATUS_SUCCESS != retval)
+        {
+            return retval;
+        }
+
+        for (started = 0; started < threads; ++started)
+        {
+            if (0 !=
+                pthread_create(
+                    &workers[started], NULL, &weightgraph_rollup_thread, job))
+            {
+                break;
+            }
+        }
+
+        /* if no thread could be started, run the pass on this one. */
+        if (0 == started)
+        {
+            weightgraph_rollup_thread(job);
+        }
+
+        for (size_t i = 0; i < started; ++i)
+        {
+            pthread_join(workers[i], NULL);
+        }
+
+        weightgraph_memory_reclaim(
+            job->rollup->alloc, WEIGHTGRAPH_MEMORY_ROLLUP, workers,
+            threads * sizeof(pthread_t));
+    }
+
+    for (size_t i = 0; i < job->chunks; ++i)
+    {
+        if (STATUS_SUCCESS != job->results[i])
+        {
+            return job->results[i];
+        }
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Run the pass of a rollup over chunks until none remain.
+ *
+ * \param context       The rollup job.
+ *
+ * \returns NULL.
+ */
+static void* weightgraph_rollup_thread(void* context)
+{
+    weightgraph_rollup_job* job = (weightgraph_rollup_job*)context;
+    size_t chunk;
+
+    while ((chunk = atomic_fetch_add(&job->next_chunk, 1)) < job->chunks)
+    {
+        job->results[chunk] =
+            (WEIGHTGRAPH_ROLLUP_PASS_PLACE == job->pass)
+                ? weightgraph_rollup_place(job, chunk)
+                : weightgraph_rollup_aggregate(job, chunk);
+    }
+
+    return NULL;
+}
+
+/**
+ * \brief Find the first day of the period of each sample in a chunk.
+ *
+ * \param job           The rollup job.
+ * \param chunk         The index of the chunk.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - ERROR_ROLLUP_DATE if a date can't be placed in a period.
+ */
+static status weightgraph_rollup_place(
+    weightgraph_rollup_job* job, size_t chunk)
+{
+    size_t first = chunk * WEIGHTGRAPH_ROLLUP_CHUNK;
+    size_t last = first + WEIGHTGRAPH_ROLLUP_CHUNK;
+    int date_style = job->date_style;
+    int year_width = job->year_width;
+    weightgraph_sample sample;
+    int32_t day;
+
+    if (last > job->count)
+    {
+        last = job->count;
+    }
+
+    for (size_t i = first; i < last; ++i)
+    {
+        weightgraph_session_sample(job->session, i, &sample);
+        if (!weightgraph_archive_date_encode(
+                sample.date, &date_style, &year_width, &day))
+        {
+            return ERROR_ROLLUP_DATE;
+        }
+
+        job->days[i] = weightgraph_rollup_period_start(job, day);
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Compute the aggregates of the periods starting in a chunk.
+ *
+ * A period starting in the chunk is aggregated in full, even if it runs into
+ * the chunks after it.
+ *
+ * \param job           The rollup job.
+ * \param chunk         The index of the chunk.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ */
+static status weightgraph_rollup_aggregate(
+    weightgraph_rollup_job* job, size_t chunk)
+{
+    weightgraph_sample sample;
+
+    for (size_t p = job->chunk_periods[chunk];
+         p < job->chunk_periods[chunk + 1]; ++p)
+    {
+        weightgraph_rollup_period* period = &job->rollup->periods[p];
+        weightgraph_sample* out = &job->rollup->samples[p];
+        size_t first = job->starts[p];
+        size_t last = job->starts[p + 1];
+        double sum = 0.0;
+
+        /* rejected samples only count if there is nothing else. */
+        period->rejected = true;
+        for (size_t i = first; i < last && period->rejected; ++i)
+        {
+            weightgraph_session_sample(job->session, i, &sample);
+            period->rejected = sample.rejected;
+        }
+
+        period->count = 0;
+        period->min_weight = INFINITY;
+        period->max_weight = -INFINITY;
+
+        for (size_t i = first; i < last; ++i)
+        {
+            weightgraph_session_sample(job->session, i, &sample);
+            if (sample.rejected && !period->rejected)
+            {
+                continue;
+            }
+
+            ++period->count;
+            sum += sample.weight;
+            period->min_weight = fmin(period->min_weight, sample.weight);
+            period->max_weight = fmax(period->max_weight, sample.weight);
+        }
+
+        out->weight = sum / (double)period->count;
+        out->moving_average = sample.moving_average;
+        out->rejected = period->rejected;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * \brief Find the first day of the period holding a day.
+ *
+ * \param job           The rollup job.
+ * \param day           The day number.
+ *
+ * \returns the day number of the first day of the period.
+ */
+static int32_t weightgraph_rollup_period_start(
+    const weightgraph_rollup_job* job, int32_t day)
+{
+    long year, start;
+    int month, mday;
+
+    switch (job->period)
+    {
+        case WEIGHTGRAPH_PERIOD_WEEK:
+            /* day 5, 0000-03-06, was a Monday. */
+            start = day - (day + 2) % 7;
+
+            /* "MM/DD" dates have no year before theirs to start a week in. */
+            if (WEIGHTGRAPH_ARCHIVE_DATE_MONTH_DAY == job->date_style)
+            {
+                long first =
+                    weightgraph_archive_days_from_civil(
+                        WEIGHTGRAPH_ARCHIVE_MONTH_DAY_YEAR, 1, 1);
+
+                if (start < first)
+                {
+                    start = first;
+                }
+            }
+            return (int32_t)start;
+
+        case WEIGHTGRAPH_PERIOD_MONTH:
+            weightgraph_archive_civil_from_days(day, &year, &month, &mday);
+            return (int32_t)weightgraph_archive_days_from_civil(year, month, 1);
+
+        case WEIGHTGRAPH_PERIOD_YEAR:
+            weightgraph_archive_civil_from_days(day, &year, &month, &mday);
+            return (int32_t)weightgraph_archive_days_from_civil(year, 1, 1);
+
+        default:
+            return day;
+    }
+}
@@ -0,0 +1,68 @@
+/**
+ * \file weightgraph/weightgraph_session_sample.c
+ *
+ * \brief Get a sample that has been pushed onto the session.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Get a sample that has been pushed onto the session.
+ *
+ * While every weight is a whole number of hundredths, a session holds its
+ * samples in fixed point, and converts them to doubles only here.
+ *
+ * \param session       The session.
+ * \param index         The index of the sample, starting at 0.
+ * \param sample        Pointer to receive the sample, whose date remains
+ *                      valid until the session is reset or released.
+ *
+ * \returns true if there is such a sample.
+ */
+bool weightgraph_session_sample(
+    const weightgraph_session* session, size_t index,
+    weightgraph_sample* sample)
+{
+    const weightgraph_fixed_sample* fixed;
+
+    if (index >= session->count)
+    {
+        return false;
+    }
+
+    if (NULL != session->samples)
+    {
+        *sample = session->samples[index];
+    }
+    else
+    {
+        /* each division is exact to the nearest double. */
+        fixed = &session->fixed_samples[index];
+        sample->date = fixed->date;
+        sample->weight = (double)fixed->weight / WEIGHTGRAPH_FIXED_SCALE;
+        sample->moving_average =
+            (double)fixed->moving_average
+                / (WEIGHTGRAPH_AVERAGE_WINDOW * WEIGHTGRAPH_FIXED_SCALE);
+    }
+
+    /* the filter, or the rollup, marks the samples that were rejected. */
+    if (NULL != session->periods)
+    {
+        sample->rejected = session->periods[index].rejected;
+    }
+    else if (NULL != session->filter)
+    {
+        sample->rejected =
+            0 != (session->filter->marks[index / 64]
+                    & ((uint64_t)1 << (index % 64)));
+    }
+    else
+    {
+        sample->rejected = false;
+    }
+
+    return true;
+}
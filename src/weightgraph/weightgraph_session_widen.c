@@ -0,0 +1,55 @@
+/**
+ * \file weightgraph/weightgraph_session_widen.c
+ *
+ * \brief Convert the samples of a session from fixed point to doubles.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Convert the samples of a session from fixed point to doubles, for a
+ * weight that can't be held in fixed point.
+ *
+ * \param session       The session.
+ *
+ * \returns a status code indicating success or failure.
+ *      - STATUS_SUCCESS on success.
+ *      - a non-zero error code on failure.
+ */
+status weightgraph_session_widen(weightgraph_session* session)
+{
+    status retval;
+    weightgraph_sample* samples;
+    size_t capacity = (0 == session->capacity) ? 64 : session->capacity;
+
+    retval =
+        weightgraph_memory_allocate(
+            session->alloc, WEIGHTGRAPH_MEMORY_SESSION, (void**)&samples,
+            capacity * sizeof(weightgraph_sample));
+    if (STATUS_SUCCESS != retval)
+    {
+        return retval;
+    }
+
+    for (size_t i = 0; i < session->count; ++i)
+    {
+        weightgraph_session_sample(session, i, &samples[i]);
+    }
+
+    /* the fixed-point samples are no longer needed. */
+    if (NULL != session->fixed_samples)
+    {
+        weightgraph_memory_reclaim(
+            session->alloc, WEIGHTGRAPH_MEMORY_SESSION, session->fixed_samples,
+            session->capacity * sizeof(weightgraph_fixed_sample));
+    }
+
+    session->fixed_samples = NULL;
+    session->samples = samples;
+    session->capacity = capacity;
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,116 @@
+/**
+ * \file weightgraph/weightgraph_session_window.c
+ *
+ * \brief Get the moving average window as it stood before a given sample.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/* forward decls. */
+static void weightgraph_session_window_filtered(
+    const weightgraph_session* session, size_t index, double* window,
+    int* next);
+
+/**
+ * \brief Get the moving average window as it stood before a given sample.
+ *
+ * \param session       The session.
+ * \param index         The index of the sample, up to the sample count.
+ * \param window        Array of \ref WEIGHTGRAPH_AVERAGE_WINDOW values to
+ *                      receive the window.
+ * \param next          Pointer to receive the slot in the window that the
+ *                      sample replaces.
+ */
+void weightgraph_session_window(
+    const weightgraph_session* session, size_t index, double* window,
+    int* next)
+{
+    weightgraph_sample sample;
+
+    if (index > session->count)
+    {
+        index = session->count;
+    }
+
+    /* rejected samples never entered the window. */
+    if (NULL != session->filter)
+    {
+        weightgraph_session_window_filtered(session, index, window, next);
+        return;
+    }
+
+    /* slot i holds the latest earlier sample whose index is i modulo the
+     * window, or the initial average if there is none. */
+    for (size_t i = 0; i < WEIGHTGRAPH_AVERAGE_WINDOW; ++i)
+    {
+        if (index > i)
+        {
+            size_t latest =
+                i + WEIGHTGRAPH_AVERAGE_WINDOW
+                        * ((index - 1 - i) / WEIGHTGRAPH_AVERAGE_WINDOW);
+            weightgraph_session_sample(session, latest, &sample);
+            window[i] = sample.weight;
+        }
+        else
+        {
+            window[i] = session->initial_average;
+        }
+    }
+
+    *next = (int)(index % WEIGHTGRAPH_AVERAGE_WINDOW);
+}
+
+/**
+ * \brief Get the moving average window as it stood before a given sample of
+ * a session that rejects outliers.
+ *
+ * \param session       The session, which has an outlier filter.
+ * \param index         The index of the sample, up to the sample count.
+ * \param window        Array of \ref WEIGHTGRAPH_AVERAGE_WINDOW values to
+ *                      receive the window.
+ * \param next          Pointer to receive the slot in the window that the
+ *                      sample replaces.
+ */
+static void weightgraph_session_window_filtered(
+    const weightgraph_session* session, size_t index, double* window,
+    int* next)
+{
+    const uint64_t* marks = session->filter->marks;
+    weightgraph_sample sample;
+    size_t accepted = index;
+    size_t found = 0;
+
+    /* count the samples before this one that entered the window. */
+    for (size_t i = 0; i < index / 64; ++i)
+    {
+        accepted -= (size_t)__builtin_popcountll(marks[i]);
+    }
+    if (0 != index % 64)
+    {
+        accepted -=
+            (size_t)__builtin_popcountll(
+                marks[index / 64] & (((uint64_t)1 << (index % 64)) - 1));
+    }
+
+    for (size_t i = 0; i < WEIGHTGRAPH_AVERAGE_WINDOW; ++i)
+    {
+        window[i] = session->initial_average;
+    }
+
+    /* the latest of them fill the slots back from the one before next. */
+    for (size_t i = index; i > 0 && found < WEIGHTGRAPH_AVERAGE_WINDOW; --i)
+    {
+        weightgraph_session_sample(session, i - 1, &sample);
+        if (!sample.rejected)
+        {
+            ++found;
+            window[(accepted - found) % WEIGHTGRAPH_AVERAGE_WINDOW] =
+                sample.weight;
+        }
+    }
+
+    *next = (int)(accepted % WEIGHTGRAPH_AVERAGE_WINDOW);
+}
@@ -0,0 +1,42 @@
+/**
+ * \file weightgraph/weightgraph_weight_to_fixed.c
+ *
+ * \brief Convert a weight to fixed point.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include <math.h>
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Convert a weight to fixed point.
+ *
+ * \param weight        The weight.
+ * \param fixed         Pointer to receive the weight in fixed point.
+ *
+ * \returns true if the weight is a whole number of hundredths, no larger
+ * than \ref WEIGHTGRAPH_FIXED_MAX of them, and so converts back exactly.
+ */
+bool weightgraph_weight_to_fixed(double weight, int32_t* fixed)
+{
+    double scaled = weight * WEIGHTGRAPH_FIXED_SCALE;
+    long value;
+
+    /* this also turns away infinities and NaNs. */
+    if (!(fabs(scaled) <= WEIGHTGRAPH_FIXED_MAX))
+    {
+        return false;
+    }
+
+    value = lround(scaled);
+    if ((double)value / WEIGHTGRAPH_FIXED_SCALE != weight)
+    {
+        return false;
+    }
+
+    *fixed = (int32_t)value;
+    return true;
+}
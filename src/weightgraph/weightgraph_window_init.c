@@ -0,0 +1,32 @@
+/**
+ * \file weightgraph/weightgraph_window_init.c
+ *
+ * \brief Start a moving average window full of the initial average.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Start a moving average window full of the initial average.
+ *
+ * \param window        The window.
+ * \param average       The initial moving average.
+ */
+void weightgraph_window_init(weightgraph_window* window, double average)
+{
+    int32_t fixed = 0;
+
+    window->index = 0;
+    window->fixed = weightgraph_weight_to_fixed(average, &fixed);
+    window->fixed_sum = 0;
+
+    for (int i = 0; i < WEIGHTGRAPH_AVERAGE_WINDOW; ++i)
+    {
+        window->weights[i] = average;
+        window->fixed_weights[i] = fixed;
+        window->fixed_sum += fixed;
+    }
+}
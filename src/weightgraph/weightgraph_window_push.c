@@ -0,0 +1,58 @@
+/**
+ * \file weightgraph/weightgraph_window_push.c
+ *
+ * \brief Add a weight to a moving average window.
+ *
+ * \copyright 2022 Justin Handville.  Please see LICENSE.txt in this
+ * distribution for the license terms under which this software is distributed.
+ */
+
+#include "weightgraph_internal.h"
+
+/**
+ * \brief Add a weight to a moving average window.
+ *
+ * In fixed point, the weight replaces the oldest in the running sum, which
+ * is then divided once.  A weight that can't be held in fixed point drops
+ * the window back to summing its doubles for good.
+ *
+ * \param window        The window.
+ * \param weight        The weight to add.
+ *
+ * \returns the moving average of the window after adding the weight.
+ */
+double weightgraph_window_push(weightgraph_window* window, double weight)
+{
+    double average = 0;
+    int32_t fixed;
+    int index = window->index;
+
+    window->weights[index] = weight;
+    ++window->index;
+    if (window->index >= WEIGHTGRAPH_AVERAGE_WINDOW)
+    {
+        window->index = 0;
+    }
+
+    if (window->fixed)
+    {
+        if (weightgraph_weight_to_fixed(weight, &fixed))
+        {
+            window->fixed_sum += fixed - window->fixed_weights[index];
+            window->fixed_weights[index] = fixed;
+
+            return
+                (double)window->fixed_sum
+                    / (WEIGHTGRAPH_AVERAGE_WINDOW * WEIGHTGRAPH_FIXED_SCALE);
+        }
+
+        window->fixed = false;
+    }
+
+    for (int i = 0; i < WEIGHTGRAPH_AVERAGE_WINDOW; ++i)
+    {
+        average += window->weights[i] * 0.1;
+    }
+
+    return average;
+}